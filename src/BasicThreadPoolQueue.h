@@ -0,0 +1,125 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_BASICTHREADPOOLQUEUE_H
+#define CHAUDIERE_BASICTHREADPOOLQUEUE_H
+
+#include "ThreadPoolQueue.h"
+#include "ThreadPoolQueueImpl.h"
+
+namespace chaudiere
+{
+
+/**
+ * BasicThreadPoolQueue is a ThreadPoolQueue whose mutex and condition
+ * variables are the types named by LockPolicy (see LockPolicy.h), bound
+ * at compile time. With a native policy (PthreadsLockPolicy, StdLockPolicy,
+ * FutexLockPolicy), the queue's locking makes no virtual calls and no
+ * dynamic_cast, and lock and unlock of a StdMutex or FutexMutex are
+ * inlined. It can be used anywhere a ThreadPoolQueue is (e.g., given to a
+ * ThreadPool). Include the headers of the mutex and condition variable
+ * types a native policy names (e.g., FutexMutex.h and
+ * FutexConditionVariable.h for FutexLockPolicy) before instantiating it.
+ */
+template <typename LockPolicy = VirtualLockPolicy>
+class BasicThreadPoolQueue : public ThreadPoolQueue
+{
+public:
+   /**
+    *
+    * @param threadingFactory (used only by VirtualLockPolicy)
+    * @see ThreadingFactory()
+    */
+   explicit BasicThreadPoolQueue(ThreadingFactory* threadingFactory) :
+      ThreadPoolQueue(threadingFactory, false) {
+      initializeLocks(m_locks);
+   }
+
+   /**
+    * Destructor
+    */
+   ~BasicThreadPoolQueue() {
+      drain(m_locks);
+   }
+
+   bool addRequest(Runnable* runnableRequest) override {
+      return addRequestWith(m_locks, runnableRequest);
+   }
+
+   bool addRequest(Task&& task,
+                   PriorityClass priority = PriorityClass::Normal) override {
+      return addRequestWith(m_locks, std::move(task), priority);
+   }
+
+   void takeRequest(TakeRequestContext& ctx) override {
+      takeRequestWith(m_locks, ctx);
+   }
+
+   std::size_t addRequests(std::span<Runnable* const> runnableRequests) override {
+      return addRequestsWith(m_locks, runnableRequests);
+   }
+
+   void takeRequests(TakeRequestContext& ctx, std::size_t maxBatch) override {
+      takeRequestsWith(m_locks, ctx, maxBatch);
+   }
+
+   void interruptTakers() override {
+      interruptTakersWith(m_locks);
+   }
+
+   bool shutDown() override {
+      return shutDownWith(m_locks);
+   }
+
+   bool restart() override {
+      return restartWith(m_locks);
+   }
+
+   void setMaxQueueSize(std::size_t maxSize,
+                        QueueFullPolicy policy = QueueFullPolicy::Reject) override {
+      setMaxQueueSizeWith(m_locks, maxSize, policy);
+   }
+
+   bool setLaneMaxQueueSize(PriorityClass priority,
+                            std::size_t maxSize,
+                            QueueFullPolicy policy = QueueFullPolicy::Reject) override {
+      return setLaneMaxQueueSizeWith(m_locks, priority, maxSize, policy);
+   }
+
+   bool setPriorityScheduling(PriorityScheduling scheduling) override {
+      return setPrioritySchedulingWith(m_locks, scheduling);
+   }
+
+   bool setLaneWeight(PriorityClass priority, unsigned int weight) override {
+      return setLaneWeightWith(m_locks, priority, weight);
+   }
+
+   void setStarvationThreshold(std::uint64_t thresholdMicros) override {
+      setStarvationThresholdWith(m_locks, thresholdMicros);
+   }
+
+   bool setLoadShedding(std::uint64_t targetDelayMicros,
+                        std::uint64_t intervalMicros = 100000) override {
+      return setLoadSheddingWith(m_locks, targetDelayMicros, intervalMicros);
+   }
+
+   std::size_t getLaneSize(PriorityClass priority) const override {
+      return getLaneSizeWith(m_locks, priority);
+   }
+
+   std::uint64_t getOldestRequestWaitTime() const override {
+      return getOldestRequestWaitTimeWith(m_locks);
+   }
+
+
+private:
+   // disallow copies
+   BasicThreadPoolQueue(const BasicThreadPoolQueue&);
+   BasicThreadPoolQueue& operator=(const BasicThreadPoolQueue&);
+
+   QueueLocks<LockPolicy> m_locks;
+};
+
+}
+
+#endif
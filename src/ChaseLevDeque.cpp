@@ -0,0 +1,155 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "ChaseLevDeque.h"
+#include "Logger.h"
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+ChaseLevDeque::Buffer::Buffer(std::size_t bufferCapacity) :
+   capacity(bufferCapacity),
+   mask(static_cast<std::int64_t>(bufferCapacity) - 1),
+   slots(new std::atomic<Runnable*>[bufferCapacity]) {
+   for (std::size_t i = 0; i < capacity; ++i) {
+      slots[i].store(nullptr, std::memory_order_relaxed);
+   }
+}
+
+//******************************************************************************
+//******************************************************************************
+
+ChaseLevDeque::ChaseLevDeque(std::size_t initialCapacity) :
+   m_top(0),
+   m_bottom(0),
+   m_buffer(nullptr) {
+   LOG_INSTANCE_CREATE("ChaseLevDeque")
+
+   std::size_t capacity = 2;
+   while (capacity < initialCapacity) {
+      capacity <<= 1;
+   }
+
+   m_buffers.emplace_back(new Buffer(capacity));
+   m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+ChaseLevDeque::~ChaseLevDeque() {
+   LOG_INSTANCE_DESTROY("ChaseLevDeque")
+}
+
+//******************************************************************************
+
+void ChaseLevDeque::push(Runnable* runnable) {
+   const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+   const std::int64_t top = m_top.load(std::memory_order_acquire);
+   Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+   if (bottom - top > buffer->mask) {
+      buffer = grow(buffer, top, bottom);
+   }
+
+   buffer->put(bottom, runnable);
+   std::atomic_thread_fence(std::memory_order_release);
+   m_bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+Runnable* ChaseLevDeque::pop() {
+   const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+   Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+   m_bottom.store(bottom, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   std::int64_t top = m_top.load(std::memory_order_relaxed);
+
+   Runnable* runnable = nullptr;
+
+   if (top <= bottom) {
+      runnable = buffer->get(bottom);
+
+      if (top == bottom) {
+         // last request -- race any thieves for it
+         if (!m_top.compare_exchange_strong(top,
+                                            top + 1,
+                                            std::memory_order_seq_cst,
+                                            std::memory_order_relaxed)) {
+            runnable = nullptr;
+         }
+         m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      }
+   } else {
+      // already empty
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+   }
+
+   return runnable;
+}
+
+//******************************************************************************
+
+ChaseLevDeque::StealResult ChaseLevDeque::steal(Runnable*& runnable) {
+   std::int64_t top = m_top.load(std::memory_order_acquire);
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   const std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+   if (top >= bottom) {
+      return StealResult::Empty;
+   }
+
+   Buffer* buffer = m_buffer.load(std::memory_order_acquire);
+   Runnable* stolen = buffer->get(top);
+
+   if (!m_top.compare_exchange_strong(top,
+                                      top + 1,
+                                      std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return StealResult::Abort;
+   }
+
+   runnable = stolen;
+   return StealResult::Success;
+}
+
+//******************************************************************************
+
+std::size_t ChaseLevDeque::size() const {
+   const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+   const std::int64_t top = m_top.load(std::memory_order_relaxed);
+   return (bottom > top) ? static_cast<std::size_t>(bottom - top) : 0;
+}
+
+//******************************************************************************
+
+bool ChaseLevDeque::isEmpty() const {
+   return size() == 0;
+}
+
+//******************************************************************************
+
+std::size_t ChaseLevDeque::getCapacity() const {
+   return m_buffer.load(std::memory_order_relaxed)->capacity;
+}
+
+//******************************************************************************
+
+ChaseLevDeque::Buffer* ChaseLevDeque::grow(Buffer* buffer,
+                                           std::int64_t top,
+                                           std::int64_t bottom) {
+   Buffer* grownBuffer = new Buffer(buffer->capacity * 2);
+
+   for (std::int64_t i = top; i < bottom; ++i) {
+      grownBuffer->put(i, buffer->get(i));
+   }
+
+   // the old buffer stays alive (in m_buffers) for thieves still reading it
+   m_buffers.emplace_back(grownBuffer);
+   m_buffer.store(grownBuffer, std::memory_order_release);
+
+   return grownBuffer;
+}
+
+//******************************************************************************
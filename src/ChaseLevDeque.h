@@ -0,0 +1,126 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_CHASELEVDEQUE_H
+#define CHAUDIERE_CHASELEVDEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+namespace chaudiere
+{
+   class Runnable;
+
+/**
+ * ChaseLevDeque is the lock-free work-stealing deque of Chase and Lev (in
+ * the formulation for C11 atomics by Le, Pop, Cohen, and Zappa Nardelli).
+ * One thread -- the owner -- pushes and pops requests at the bottom, LIFO;
+ * any number of other threads steal from the top, FIFO. The owner only
+ * contends with thieves when the deque is down to its last request.
+ *
+ * The buffer grows (doubling) when the owner pushes onto a full deque.
+ * Buffers that have been grown out of are kept until the deque is
+ * destroyed, since a thief may still be reading from one.
+ */
+class ChaseLevDeque
+{
+public:
+   /**
+    * Result of a steal attempt
+    */
+   enum class StealResult {
+      Success,  // a request was stolen
+      Empty,    // the deque was empty
+      Abort     // lost a race with the owner or another thief; retry
+   };
+
+   /**
+    * Constructs an empty deque
+    * @param initialCapacity the initial capacity (rounded up to a power of 2)
+    */
+   explicit ChaseLevDeque(std::size_t initialCapacity = 256);
+
+   /**
+    * Destructor
+    */
+   ~ChaseLevDeque();
+
+   /**
+    * Pushes a request onto the bottom of the deque. Owner only.
+    * @param runnable the request
+    * @see Runnable()
+    */
+   void push(Runnable* runnable);
+
+   /**
+    * Pops the most recently pushed request from the bottom of the deque.
+    * Owner only.
+    * @return the request, or nullptr if the deque is empty
+    * @see Runnable()
+    */
+   Runnable* pop();
+
+   /**
+    * Steals the least recently pushed request from the top of the deque.
+    * May be called from any thread.
+    * @param runnable receives the request if the steal succeeds
+    * @return the outcome of the steal attempt
+    */
+   StealResult steal(Runnable*& runnable);
+
+   /**
+    * Retrieves the number of requests in the deque. Only a hint when other
+    * threads are pushing, popping, or stealing.
+    * @return the number of requests
+    */
+   std::size_t size() const;
+
+   /**
+    * Determines whether the deque is empty. Only a hint when other threads
+    * are pushing, popping, or stealing.
+    * @return boolean indicating if the deque is empty
+    */
+   bool isEmpty() const;
+
+   /**
+    * @return the capacity of the current buffer
+    */
+   std::size_t getCapacity() const;
+
+
+private:
+   struct Buffer {
+      explicit Buffer(std::size_t capacity);
+
+      Runnable* get(std::int64_t index) const {
+         return slots[index & mask].load(std::memory_order_relaxed);
+      }
+
+      void put(std::int64_t index, Runnable* runnable) {
+         slots[index & mask].store(runnable, std::memory_order_relaxed);
+      }
+
+      std::size_t capacity;
+      std::int64_t mask;
+      std::unique_ptr<std::atomic<Runnable*>[]> slots;
+   };
+
+   Buffer* grow(Buffer* buffer, std::int64_t top, std::int64_t bottom);
+
+   alignas(64) std::atomic<std::int64_t> m_top;
+   alignas(64) std::atomic<std::int64_t> m_bottom;
+   std::atomic<Buffer*> m_buffer;
+   std::vector<std::unique_ptr<Buffer>> m_buffers;
+
+   // copying not allowed
+   ChaseLevDeque(const ChaseLevDeque&);
+   ChaseLevDeque& operator=(const ChaseLevDeque&);
+};
+
+}
+
+#endif
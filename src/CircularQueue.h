@@ -0,0 +1,112 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_CIRCULARQUEUE_H
+#define CHAUDIERE_CIRCULARQUEUE_H
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace chaudiere
+{
+
+/**
+ * CircularQueue is a FIFO over a circular buffer that doubles when it
+ * fills up. Unlike std::deque, which allocates and frees a block every few
+ * elements as they stream through, it stops allocating once it has grown
+ * to the queue's high-water mark. Not thread safe.
+ */
+template <typename T>
+class CircularQueue
+{
+public:
+   /**
+    * Constructs an empty queue (allocates on the first push)
+    */
+   CircularQueue() :
+      m_capacity(0),
+      m_head(0),
+      m_size(0) {
+   }
+
+   /**
+    * Appends an element
+    * @param value the element to append
+    */
+   void push_back(T&& value) {
+      if (m_size == m_capacity) {
+         grow();
+      }
+
+      m_slots[(m_head + m_size) % m_capacity] = std::move(value);
+      ++m_size;
+   }
+
+   /**
+    * @return the oldest element (the queue must not be empty)
+    */
+   T& front() {
+      return m_slots[m_head];
+   }
+
+   /**
+    * @return the oldest element (the queue must not be empty)
+    */
+   const T& front() const {
+      return m_slots[m_head];
+   }
+
+   /**
+    * Removes the oldest element (the queue must not be empty)
+    */
+   void pop_front() {
+      // leave the slot in its default state, so that whatever the element
+      // held is released now rather than when the slot is reused
+      m_slots[m_head] = T();
+      m_head = (m_head + 1) % m_capacity;
+      --m_size;
+   }
+
+   /**
+    * @return the number of elements
+    */
+   std::size_t size() const {
+      return m_size;
+   }
+
+   /**
+    * @return boolean indicating if the queue is empty
+    */
+   bool empty() const {
+      return 0 == m_size;
+   }
+
+
+private:
+   void grow() {
+      const std::size_t newCapacity = (0 == m_capacity) ? 16 : m_capacity * 2;
+      std::unique_ptr<T[]> newSlots(new T[newCapacity]);
+
+      for (std::size_t i = 0; i < m_size; ++i) {
+         newSlots[i] = std::move(m_slots[(m_head + i) % m_capacity]);
+      }
+
+      m_slots = std::move(newSlots);
+      m_capacity = newCapacity;
+      m_head = 0;
+   }
+
+   std::unique_ptr<T[]> m_slots;
+   std::size_t m_capacity;
+   std::size_t m_head;
+   std::size_t m_size;
+
+   // disallow copies
+   CircularQueue(const CircularQueue&);
+   CircularQueue& operator=(const CircularQueue&);
+};
+
+}
+
+#endif
@@ -0,0 +1,288 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <sys/resource.h>
+
+#include "ConnectionStateTable.h"
+#include "ThreadingFactory.h"
+#include "SharedLock.h"
+#include "ExclusiveLock.h"
+#include "Logger.h"
+
+using namespace chaudiere;
+
+// layout of each state word:
+//   bit 0       busy flag
+//   bits 1-2    interest state
+//   bit 3       pending output flag
+//   bits 4-31   last activity tick
+//   bits 32-63  generation
+static const std::uint64_t BUSY_MASK        = 0x1;
+static const int           INTEREST_SHIFT   = 1;
+static const std::uint64_t INTEREST_MASK    = 0x3 << INTEREST_SHIFT;
+static const std::uint64_t OUTPUT_MASK      = 0x8;
+static const int           ACTIVITY_SHIFT   = 4;
+static const int           GENERATION_SHIFT = 32;
+static const std::uint64_t GENERATION_ONE   = std::uint64_t(1) << GENERATION_SHIFT;
+
+const std::size_t ConnectionStateTable::MAX_CAPACITY = 65536;
+const int ConnectionStateTable::ACTIVITY_TICK_BITS = 28;
+const std::uint32_t ConnectionStateTable::ACTIVITY_TICK_MASK = (std::uint32_t(1) << 28) - 1;
+
+static const std::uint64_t ACTIVITY_MASK =
+   std::uint64_t(ConnectionStateTable::ACTIVITY_TICK_MASK) << ACTIVITY_SHIFT;
+
+//******************************************************************************
+
+static inline ConnectionStateTable::InterestState interestFromWord(std::uint64_t word) {
+   return static_cast<ConnectionStateTable::InterestState>((word & INTEREST_MASK) >> INTEREST_SHIFT);
+}
+
+//******************************************************************************
+
+static inline std::uint64_t wordWithInterest(std::uint64_t word,
+                                             ConnectionStateTable::InterestState interest) {
+   return (word & ~INTEREST_MASK) |
+          (static_cast<std::uint64_t>(interest) << INTEREST_SHIFT);
+}
+
+//******************************************************************************
+
+std::size_t ConnectionStateTable::defaultCapacity() {
+   struct rlimit limit;
+   if (::getrlimit(RLIMIT_NOFILE, &limit) != 0 ||
+       limit.rlim_cur == RLIM_INFINITY ||
+       limit.rlim_cur > MAX_CAPACITY) {
+      return MAX_CAPACITY;
+   }
+
+   return static_cast<std::size_t>(limit.rlim_cur);
+}
+
+//******************************************************************************
+
+ConnectionStateTable::ConnectionStateTable() :
+   ConnectionStateTable(defaultCapacity()) {
+}
+
+//******************************************************************************
+
+ConnectionStateTable::ConnectionStateTable(std::size_t capacity) :
+   m_states(new std::atomic<std::uint64_t>[capacity]()),
+   m_capacity(capacity),
+   m_overflowLock(ThreadingFactory::getThreadingFactory()->createReadWriteLock("connectionStateOverflow")) {
+   LOG_INSTANCE_CREATE("ConnectionStateTable")
+}
+
+//******************************************************************************
+
+ConnectionStateTable::~ConnectionStateTable() {
+   LOG_INSTANCE_DESTROY("ConnectionStateTable")
+}
+
+//******************************************************************************
+
+std::size_t ConnectionStateTable::getCapacity() const {
+   return m_capacity;
+}
+
+//******************************************************************************
+
+std::atomic<std::uint64_t>* ConnectionStateTable::stateWord(int fd) const {
+   if (fd < 0) {
+      return nullptr;
+   }
+
+   if (static_cast<std::size_t>(fd) < m_capacity) {
+      return &m_states[fd];
+   }
+
+   return overflowStateWord(fd);
+}
+
+//******************************************************************************
+
+std::atomic<std::uint64_t>* ConnectionStateTable::overflowStateWord(int fd) const {
+   // entries are never erased, so a returned pointer stays valid for the
+   // life of the table and can be used after the lock is released
+   {
+      SharedLock locker(*m_overflowLock);
+      auto it = m_overflowStates.find(fd);
+      if (it != m_overflowStates.end()) {
+         return it->second.get();
+      }
+   }
+
+   ExclusiveLock locker(*m_overflowLock);
+   std::unique_ptr<std::atomic<std::uint64_t>>& word = m_overflowStates[fd];
+   if (!word) {
+      word.reset(new std::atomic<std::uint64_t>(0));
+   }
+   return word.get();
+}
+
+//******************************************************************************
+
+bool ConnectionStateTable::isBusy(int fd) const {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return false;
+   }
+
+   return (word->load(std::memory_order_acquire) & BUSY_MASK) != 0;
+}
+
+//******************************************************************************
+
+void ConnectionStateTable::setBusy(int fd, bool busy) {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return;
+   }
+
+   if (busy) {
+      word->fetch_or(BUSY_MASK, std::memory_order_acq_rel);
+   } else {
+      word->fetch_and(~BUSY_MASK, std::memory_order_acq_rel);
+   }
+}
+
+//******************************************************************************
+
+ConnectionStateTable::InterestState ConnectionStateTable::getInterestState(int fd) const {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return InterestState::Unregistered;
+   }
+
+   return interestFromWord(word->load(std::memory_order_acquire));
+}
+
+//******************************************************************************
+
+void ConnectionStateTable::setInterestState(int fd, InterestState interest) {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return;
+   }
+
+   std::uint64_t current = word->load(std::memory_order_relaxed);
+   while (!word->compare_exchange_weak(current,
+                                       wordWithInterest(current, interest),
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed)) {
+   }
+}
+
+//******************************************************************************
+
+bool ConnectionStateTable::compareAndSetInterestState(int fd,
+                                                      InterestState expected,
+                                                      InterestState desired) {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return false;
+   }
+
+   std::uint64_t current = word->load(std::memory_order_relaxed);
+   do {
+      if (interestFromWord(current) != expected) {
+         return false;
+      }
+   } while (!word->compare_exchange_weak(current,
+                                         wordWithInterest(current, desired),
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_relaxed));
+
+   return true;
+}
+
+//******************************************************************************
+
+std::uint32_t ConnectionStateTable::getGeneration(int fd) const {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return 0;
+   }
+
+   return static_cast<std::uint32_t>(word->load(std::memory_order_acquire) >> GENERATION_SHIFT);
+}
+
+//******************************************************************************
+
+std::uint32_t ConnectionStateTable::getLastActivity(int fd) const {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return 0;
+   }
+
+   return static_cast<std::uint32_t>((word->load(std::memory_order_acquire) & ACTIVITY_MASK) >> ACTIVITY_SHIFT);
+}
+
+//******************************************************************************
+
+void ConnectionStateTable::setLastActivity(int fd, std::uint32_t tick) {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return;
+   }
+
+   const std::uint64_t activity =
+      std::uint64_t(tick & ACTIVITY_TICK_MASK) << ACTIVITY_SHIFT;
+
+   std::uint64_t current = word->load(std::memory_order_relaxed);
+   while (!word->compare_exchange_weak(current,
+                                       (current & ~ACTIVITY_MASK) | activity,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed)) {
+   }
+}
+
+//******************************************************************************
+
+bool ConnectionStateTable::hasPendingOutput(int fd) const {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return false;
+   }
+
+   return (word->load(std::memory_order_acquire) & OUTPUT_MASK) != 0;
+}
+
+//******************************************************************************
+
+void ConnectionStateTable::setPendingOutput(int fd, bool pendingOutput) {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return;
+   }
+
+   if (pendingOutput) {
+      word->fetch_or(OUTPUT_MASK, std::memory_order_acq_rel);
+   } else {
+      word->fetch_and(~OUTPUT_MASK, std::memory_order_acq_rel);
+   }
+}
+
+//******************************************************************************
+
+bool ConnectionStateTable::reset(int fd) {
+   std::atomic<std::uint64_t>* word = stateWord(fd);
+   if (word == nullptr) {
+      return false;
+   }
+
+   std::uint64_t current = word->load(std::memory_order_relaxed);
+   std::uint64_t next;
+   do {
+      // keep only the generation (wrapping naturally) and advance it
+      next = (current & ~(GENERATION_ONE - 1)) + GENERATION_ONE;
+   } while (!word->compare_exchange_weak(current,
+                                         next,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_relaxed));
+
+   return (current & (BUSY_MASK | INTEREST_MASK)) != 0;
+}
+
+//******************************************************************************
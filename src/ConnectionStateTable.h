@@ -0,0 +1,195 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_CONNECTIONSTATETABLE_H
+#define CHAUDIERE_CONNECTIONSTATETABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "ReadWriteLock.h"
+
+
+namespace chaudiere
+{
+
+/**
+ * ConnectionStateTable holds the per-connection state a KernelEventServer
+ * needs on its event hot path (busy flag, kernel interest state, pending
+ * output flag, last activity tick, and a generation counter) as one atomic
+ * word per file descriptor, in a flat array indexed by the descriptor
+ * itself. Reads and updates are single
+ * atomic operations -- no hashing and no lock -- so the event loop thread
+ * and worker threads completing requests never contend on a mutex.
+ *
+ * The array is sized from the process's RLIMIT_NOFILE soft limit (capped,
+ * so a huge or unlimited limit doesn't allocate a huge table). Descriptors
+ * beyond the array -- only possible if the limit is above the cap or was
+ * raised after construction -- get a lazily created word kept in an
+ * overflow map behind a ReadWriteLock (lookups share it; only creating a
+ * word takes it exclusive).
+ */
+class ConnectionStateTable
+{
+public:
+   /**
+    * Kernel interest state of a connection's file descriptor
+    */
+   enum class InterestState {
+      Unregistered = 0,  // not known to the kernel event mechanism
+      Armed = 1,         // registered and able to deliver a read event
+      Disarmed = 2,      // registered, but its one-shot event was delivered
+      WriteArmed = 3     // registered and armed for write (not read) readiness
+   };
+
+   /**
+    * Upper bound on the number of entries the flat array will hold
+    */
+   static const std::size_t MAX_CAPACITY;
+
+   /**
+    * Number of bits of the last activity tick kept per fd. Tick differences
+    * must be computed modulo 2^ACTIVITY_TICK_BITS.
+    */
+   static const int ACTIVITY_TICK_BITS;
+
+   /**
+    * Mask for the bits of a tick kept as the last activity
+    */
+   static const std::uint32_t ACTIVITY_TICK_MASK;
+
+   /**
+    * Determines the table size to use from the RLIMIT_NOFILE soft limit
+    * @return the number of entries a default-constructed table holds
+    */
+   static std::size_t defaultCapacity();
+
+   /**
+    * Constructs a table sized from the RLIMIT_NOFILE soft limit
+    */
+   ConnectionStateTable();
+
+   /**
+    * Constructs a table with the given number of flat array entries
+    * @param capacity number of file descriptors (0..capacity-1) held in the array
+    */
+   explicit ConnectionStateTable(std::size_t capacity);
+
+   /**
+    * Destructor
+    */
+   ~ConnectionStateTable();
+
+   /**
+    * Retrieves the number of file descriptors held in the flat array
+    * @return the array capacity
+    */
+   std::size_t getCapacity() const;
+
+   /**
+    * Determines whether a worker is currently processing a request on the fd
+    * @param fd the file descriptor
+    * @return boolean indicating if the fd is busy
+    */
+   bool isBusy(int fd) const;
+
+   /**
+    * Sets or clears the busy flag for the fd
+    * @param fd the file descriptor
+    * @param busy the new busy flag
+    */
+   void setBusy(int fd, bool busy);
+
+   /**
+    * Retrieves the kernel interest state of the fd
+    * @param fd the file descriptor
+    * @return the interest state
+    */
+   InterestState getInterestState(int fd) const;
+
+   /**
+    * Unconditionally sets the kernel interest state of the fd
+    * @param fd the file descriptor
+    * @param interest the new interest state
+    */
+   void setInterestState(int fd, InterestState interest);
+
+   /**
+    * Atomically changes the interest state of the fd if it currently holds
+    * the expected value
+    * @param fd the file descriptor
+    * @param expected the interest state the fd must be in
+    * @param desired the interest state to change to
+    * @return boolean indicating if the state was changed
+    */
+   bool compareAndSetInterestState(int fd,
+                                   InterestState expected,
+                                   InterestState desired);
+
+   /**
+    * Retrieves the generation of the fd, which changes each time the fd
+    * is reset (i.e., each time the fd number is given to a new connection)
+    * @param fd the file descriptor
+    * @return the generation
+    */
+   std::uint32_t getGeneration(int fd) const;
+
+   /**
+    * Retrieves the tick of the last activity recorded for the fd (only the
+    * low ACTIVITY_TICK_BITS bits of the tick are kept)
+    * @param fd the file descriptor
+    * @return the last activity tick
+    */
+   std::uint32_t getLastActivity(int fd) const;
+
+   /**
+    * Records activity on the fd at the given tick
+    * @param fd the file descriptor
+    * @param tick the current tick (truncated to ACTIVITY_TICK_BITS bits)
+    */
+   void setLastActivity(int fd, std::uint32_t tick);
+
+   /**
+    * Determines whether output written asynchronously to the fd is still
+    * waiting to be sent
+    * @param fd the file descriptor
+    * @return boolean indicating if the fd has pending output
+    */
+   bool hasPendingOutput(int fd) const;
+
+   /**
+    * Sets or clears the pending output flag for the fd
+    * @param fd the file descriptor
+    * @param pendingOutput the new pending output flag
+    */
+   void setPendingOutput(int fd, bool pendingOutput);
+
+   /**
+    * Clears the busy flag, interest state, pending output flag, and last
+    * activity of the fd and advances its generation
+    * @param fd the file descriptor
+    * @return boolean indicating if the fd was busy or registered beforehand
+    */
+   bool reset(int fd);
+
+
+private:
+   std::atomic<std::uint64_t>* stateWord(int fd) const;
+   std::atomic<std::uint64_t>* overflowStateWord(int fd) const;
+
+   std::unique_ptr<std::atomic<std::uint64_t>[]> m_states;
+   std::size_t m_capacity;
+   mutable std::unordered_map<int, std::unique_ptr<std::atomic<std::uint64_t>>> m_overflowStates;
+   std::unique_ptr<ReadWriteLock> m_overflowLock;
+
+   // copying not allowed
+   ConnectionStateTable(const ConnectionStateTable&);
+   ConnectionStateTable& operator=(const ConnectionStateTable&);
+};
+
+}
+
+#endif
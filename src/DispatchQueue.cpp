@@ -0,0 +1,218 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <deque>
+#include <exception>
+
+#include "DispatchQueue.h"
+#include "ThreadPoolDispatcher.h"
+#include "ThreadingFactory.h"
+#include "Runnable.h"
+#include "Mutex.h"
+#include "MutexLock.h"
+#include "Logger.h"
+#include "BasicException.h"
+
+using namespace chaudiere;
+
+// requests a serial queue runs before giving its worker back to the pool,
+// so that one busy serial queue can't monopolize a worker
+static const int MAX_DRAIN_BATCH = 16;
+
+namespace chaudiere
+{
+
+/**
+ * The part of a serial queue that pending requests (and the drain running
+ * them) keep alive
+ */
+class DispatchQueue::SerialState
+{
+public:
+   SerialState(ThreadingFactory* threadingFactory,
+               ThreadPoolDispatcher& workers) :
+      m_workers(workers),
+      m_mutex(threadingFactory->createMutex("DispatchQueue")),
+      m_isScheduled(false) {
+   }
+
+   ThreadPoolDispatcher& m_workers;
+   std::unique_ptr<Mutex> m_mutex;
+   std::deque<Runnable*> m_pending;
+   bool m_isScheduled;   // is a drain in (or on its way to) the pool?
+};
+
+/**
+ * Runs a serial queue's requests one at a time on a pool worker
+ */
+class DispatchQueue::SerialDrain : public Runnable
+{
+public:
+   explicit SerialDrain(const std::shared_ptr<SerialState>& state) :
+      m_state(state) {
+      setAutoDelete();
+   }
+
+   void run() override;
+
+   /**
+    * Hands a new drain to the pool (only called with the state's lock held)
+    * @param state the serial queue's state
+    * @return boolean indicating if the pool accepted the drain
+    */
+   static bool schedule(const std::shared_ptr<SerialState>& state);
+
+private:
+   static void runRequest(Runnable* runnable);
+
+   std::shared_ptr<SerialState> m_state;
+};
+
+}
+
+//******************************************************************************
+
+bool DispatchQueue::SerialDrain::schedule(const std::shared_ptr<SerialState>& state) {
+   SerialDrain* drain = new SerialDrain(state);
+
+   if (!state->m_workers.addRequest(drain)) {
+      delete drain;
+      return false;
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+void DispatchQueue::SerialDrain::run() {
+   for (;;) {
+      for (int i = 0; i < MAX_DRAIN_BATCH; ++i) {
+         Runnable* runnable = nullptr;
+
+         {
+            MutexLock lock(*m_state->m_mutex, "DispatchQueue::SerialDrain::run");
+
+            if (m_state->m_pending.empty()) {
+               m_state->m_isScheduled = false;
+               return;
+            }
+
+            runnable = m_state->m_pending.front();
+            m_state->m_pending.pop_front();
+         }
+
+         runRequest(runnable);
+      }
+
+      // give the worker back and continue in a new drain, unless the pool
+      // won't take one (e.g., it's stopping) -- then keep going here
+      MutexLock lock(*m_state->m_mutex, "DispatchQueue::SerialDrain::run");
+
+      if (m_state->m_pending.empty()) {
+         m_state->m_isScheduled = false;
+         return;
+      }
+
+      if (schedule(m_state)) {
+         return;
+      }
+   }
+}
+
+//******************************************************************************
+
+void DispatchQueue::SerialDrain::runRequest(Runnable* runnable) {
+   runnable->notifyOnStart();
+
+   try {
+      runnable->run();
+   } catch (const BasicException& be) {
+      LOG_ERROR("exception running request: " + be.whatString())
+   } catch (const std::exception& e) {
+      LOG_ERROR("exception running request: " + std::string(e.what()))
+   } catch (...) {
+      LOG_ERROR("unknown exception running request")
+   }
+
+   runnable->notifyOnCompletion();
+
+   if (runnable->isAutoDelete()) {
+      delete runnable;
+   }
+}
+
+//******************************************************************************
+
+DispatchQueue::DispatchQueue(ThreadingFactory* threadingFactory,
+                             ThreadPoolDispatcher& workers,
+                             DispatchQueueType type,
+                             const std::string& label) :
+   m_workers(workers),
+   m_type(type),
+   m_label(label) {
+   LOG_INSTANCE_CREATE("DispatchQueue")
+
+   if (m_type == DispatchQueueType::Serial) {
+      m_serialState = std::make_shared<SerialState>(threadingFactory, workers);
+   }
+}
+
+//******************************************************************************
+
+DispatchQueue::~DispatchQueue() {
+   LOG_INSTANCE_DESTROY("DispatchQueue")
+}
+
+//******************************************************************************
+
+bool DispatchQueue::dispatchAsync(Runnable* runnable) {
+   if (nullptr == runnable) {
+      return false;
+   }
+
+   if (m_type == DispatchQueueType::Concurrent) {
+      return m_workers.addRequest(runnable);
+   }
+
+   MutexLock lock(*m_serialState->m_mutex, "DispatchQueue::dispatchAsync");
+
+   // a drain that's already scheduled will get to it
+   if (!m_serialState->m_isScheduled) {
+      if (!SerialDrain::schedule(m_serialState)) {
+         LOG_WARNING("dispatch queue '" + m_label + "' rejecting request, worker pool refused it")
+         return false;
+      }
+
+      m_serialState->m_isScheduled = true;
+   }
+
+   m_serialState->m_pending.push_back(runnable);
+
+   return true;
+}
+
+//******************************************************************************
+
+DispatchQueueType DispatchQueue::getType() const {
+   return m_type;
+}
+
+//******************************************************************************
+
+const std::string& DispatchQueue::getLabel() const {
+   return m_label;
+}
+
+//******************************************************************************
+
+std::size_t DispatchQueue::getNumberPending() const {
+   if (m_type == DispatchQueueType::Concurrent) {
+      return 0;
+   }
+
+   MutexLock lock(*m_serialState->m_mutex, "DispatchQueue::getNumberPending");
+   return m_serialState->m_pending.size();
+}
+
+//******************************************************************************
@@ -0,0 +1,101 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_DISPATCHQUEUE_H
+#define CHAUDIERE_DISPATCHQUEUE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+
+namespace chaudiere
+{
+   class Runnable;
+   class ThreadingFactory;
+   class ThreadPoolDispatcher;
+
+/**
+ * How a DispatchQueue runs the requests dispatched to it
+ */
+enum class DispatchQueueType {
+   Serial,       // one at a time, in the order they were dispatched
+   Concurrent    // as many at once as the worker pool has workers
+};
+
+/**
+ * DispatchQueue is a queue of requests in the style of Grand Central
+ * Dispatch, implemented natively on top of a shared worker pool (no
+ * libdispatch). A concurrent queue hands requests straight to the pool. A
+ * serial queue holds its requests itself and has at most one of them in
+ * the pool at a time, so that they run one after another (e.g., in the
+ * order they arrived on a connection) without tying up a thread of their
+ * own -- an idle serial queue costs nothing but its memory.
+ *
+ * A serial queue's pending requests keep running after the queue itself has
+ * been destroyed.
+ */
+class DispatchQueue
+{
+public:
+   /**
+    * Constructs a queue whose requests run on the given worker pool
+    * @param threadingFactory the threading factory (for the serial queue's mutex)
+    * @param workers the worker pool (must outlive every request dispatched)
+    * @param type serial or concurrent
+    * @param label the queue's name (for logging)
+    * @see ThreadPoolDispatcher()
+    */
+   DispatchQueue(ThreadingFactory* threadingFactory,
+                 ThreadPoolDispatcher& workers,
+                 DispatchQueueType type,
+                 const std::string& label);
+
+   /**
+    * Destructor
+    */
+   ~DispatchQueue();
+
+   /**
+    * Dispatches a request to run asynchronously on the queue
+    * @param runnable the request to run
+    * @return boolean indicating if the request was accepted
+    * @see Runnable()
+    */
+   bool dispatchAsync(Runnable* runnable);
+
+   /**
+    * @return the queue's type
+    */
+   DispatchQueueType getType() const;
+
+   /**
+    * @return the queue's label
+    */
+   const std::string& getLabel() const;
+
+   /**
+    * @return the number of requests waiting to run on a serial queue (0 for
+    * a concurrent queue, whose requests wait in the worker pool)
+    */
+   std::size_t getNumberPending() const;
+
+
+private:
+   class SerialState;
+   class SerialDrain;
+
+   ThreadPoolDispatcher& m_workers;
+   std::shared_ptr<SerialState> m_serialState;
+   DispatchQueueType m_type;
+   std::string m_label;
+
+   // disallow copies
+   DispatchQueue(const DispatchQueue&);
+   DispatchQueue& operator=(const DispatchQueue&);
+
+};
+
+}
+
+#endif
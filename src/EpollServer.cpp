@@ -109,7 +109,7 @@ int EpollServer::fileDescriptorForEventIndex(int eventIndex) {
 #ifdef EPOLL_SUPPORT
    struct epoll_event current_event;
    current_event = m_events[eventIndex];
-   client_fd = (int) current_event.data.fd;
+   client_fd = (int) (std::uint32_t) current_event.data.u64;
 #endif
 
    return client_fd;
@@ -117,12 +117,22 @@ int EpollServer::fileDescriptorForEventIndex(int eventIndex) {
 
 //******************************************************************************
 
+std::uint64_t EpollServer::eventTagForEventIndex(int eventIndex) {
+#ifdef EPOLL_SUPPORT
+   return m_events[eventIndex].data.u64;
+#else
+   return KernelEventServer::eventTagForEventIndex(eventIndex);
+#endif
+}
+
+//******************************************************************************
+
 bool EpollServer::addFileDescriptorForRead(int fileDescriptor) {
 #ifdef EPOLL_SUPPORT
    struct epoll_event ev;
    ::memset(&ev, 0, sizeof(struct epoll_event));
    ev.events = EPOLLIN | EPOLLRDHUP;
-   ev.data.fd = fileDescriptor;
+   ev.data.u64 = getEventTag(fileDescriptor);
 
    if (::epoll_ctl(m_epfd, EPOLL_CTL_ADD, fileDescriptor, &ev) < 0) {
       LOG_CRITICAL("epoll_ctl failed in add filter")
@@ -187,6 +197,91 @@ bool EpollServer::removeFileDescriptorFromRead(int fileDescriptor) {
 
 //******************************************************************************
 
+bool EpollServer::isOneShotSupported() const {
+#ifdef EPOLL_SUPPORT
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+bool EpollServer::addFileDescriptorForOneShotRead(int fileDescriptor) {
+#ifdef EPOLL_SUPPORT
+   struct epoll_event ev;
+   ::memset(&ev, 0, sizeof(struct epoll_event));
+   ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+   ev.data.u64 = getEventTag(fileDescriptor);
+
+   if (::epoll_ctl(m_epfd, EPOLL_CTL_ADD, fileDescriptor, &ev) < 0) {
+      LOG_CRITICAL("epoll_ctl failed in add one-shot filter")
+      return false;
+   } else {
+      return true;
+   }
+#endif
+
+   return false;
+}
+
+//******************************************************************************
+
+bool EpollServer::rearmFileDescriptorForRead(int fileDescriptor) {
+#ifdef EPOLL_SUPPORT
+   struct epoll_event ev;
+   ::memset(&ev, 0, sizeof(struct epoll_event));
+   ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+   ev.data.u64 = getEventTag(fileDescriptor);
+
+   if (::epoll_ctl(m_epfd, EPOLL_CTL_MOD, fileDescriptor, &ev) < 0) {
+      // ENOENT/EBADF: the descriptor was closed (a race with close)
+      if ((errno != ENOENT) && (errno != EBADF)) {
+         LOG_CRITICAL("epoll_ctl failed in re-arm filter")
+      }
+      return false;
+   } else {
+      return true;
+   }
+#endif
+
+   return false;
+}
+
+//******************************************************************************
+
+bool EpollServer::isOneShotWriteSupported() const {
+#ifdef EPOLL_SUPPORT
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+bool EpollServer::rearmFileDescriptorForWrite(int fileDescriptor) {
+#ifdef EPOLL_SUPPORT
+   // no EPOLLRDHUP: a peer that's done sending may still be reading, and
+   // a hangup or error is reported regardless
+   struct epoll_event ev;
+   ::memset(&ev, 0, sizeof(struct epoll_event));
+   ev.events = EPOLLOUT | EPOLLONESHOT;
+   ev.data.u64 = getEventTag(fileDescriptor);
+
+   if (::epoll_ctl(m_epfd, EPOLL_CTL_MOD, fileDescriptor, &ev) < 0) {
+      LOG_CRITICAL("epoll_ctl failed in re-arm write filter")
+      return false;
+   } else {
+      return true;
+   }
+#endif
+
+   return false;
+}
+
+//******************************************************************************
+
 bool EpollServer::isEventDisconnect(int eventIndex) {
 #ifdef EPOLL_SUPPORT
    struct epoll_event current_event;
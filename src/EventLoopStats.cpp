@@ -0,0 +1,85 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <chrono>
+
+#include "EventLoopStats.h"
+
+using namespace chaudiere;
+
+const std::size_t EventLoopStats::NUMBER_BRANCHES;
+
+//******************************************************************************
+
+EventLoopStats::Snapshot::Snapshot() {
+   for (std::size_t i = 0; i < NUMBER_BRANCHES; ++i) {
+      branchCounts[i] = 0;
+   }
+}
+
+//******************************************************************************
+
+std::uint64_t EventLoopStats::Snapshot::getBranchCount(Branch branch) const {
+   return branchCounts[static_cast<std::size_t>(branch)];
+}
+
+//******************************************************************************
+//******************************************************************************
+
+std::uint64_t EventLoopStats::now() {
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//******************************************************************************
+
+EventLoopStats::EventLoopStats() {
+   for (std::size_t i = 0; i < NUMBER_BRANCHES; ++i) {
+      m_branchCounts[i].store(0, std::memory_order_relaxed);
+   }
+}
+
+//******************************************************************************
+
+EventLoopStats::~EventLoopStats() {
+}
+
+//******************************************************************************
+
+void EventLoopStats::recordWake(int numberEvents) {
+   m_eventsPerWake.record(numberEvents > 0 ?
+                          static_cast<std::uint64_t>(numberEvents) : 0);
+}
+
+//******************************************************************************
+
+void EventLoopStats::recordBatchTime(std::uint64_t nanoseconds) {
+   m_batchTime.record(nanoseconds);
+}
+
+//******************************************************************************
+
+void EventLoopStats::recordDispatchLatency(std::uint64_t nanoseconds) {
+   m_dispatchLatency.record(nanoseconds);
+}
+
+//******************************************************************************
+
+void EventLoopStats::countBranch(Branch branch) {
+   m_branchCounts[static_cast<std::size_t>(branch)].fetch_add(1,
+                                                 std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void EventLoopStats::snapshot(Snapshot& snapshot) const {
+   m_eventsPerWake.snapshot(snapshot.eventsPerWake);
+   m_batchTime.snapshot(snapshot.batchTime);
+   m_dispatchLatency.snapshot(snapshot.dispatchLatency);
+
+   for (std::size_t i = 0; i < NUMBER_BRANCHES; ++i) {
+      snapshot.branchCounts[i] = m_branchCounts[i].load(std::memory_order_relaxed);
+   }
+}
+
+//******************************************************************************
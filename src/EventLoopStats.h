@@ -0,0 +1,128 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_EVENTLOOPSTATS_H
+#define CHAUDIERE_EVENTLOOPSTATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Histogram.h"
+
+
+namespace chaudiere
+{
+
+/**
+ * EventLoopStats holds the instrumentation for one kernel event loop: how
+ * many events each wait returned, how long the loop spent processing each
+ * batch of events, how long a dispatched request waited between its event
+ * being returned and its handler starting, and how often each branch of
+ * the loop was taken.
+ *
+ * Each KernelEventServer (and so each event loop thread) has its own
+ * EventLoopStats. Everything is recorded with relaxed atomics, so the
+ * loop and its worker threads never take a lock for it, and a snapshot can
+ * be taken from any thread while the loop keeps running.
+ */
+class EventLoopStats
+{
+public:
+   /**
+    * The branches of the event loop that are counted
+    */
+   enum class Branch {
+      Accept,
+      Read,
+      ReadClose,
+      Disconnect,
+      Write,
+      StaleEvent,
+      IdleTimer
+   };
+
+   static const std::size_t NUMBER_BRANCHES = 7;
+
+   /**
+    * Snapshot is a point-in-time copy of an EventLoopStats
+    */
+   struct Snapshot {
+      Snapshot();
+
+      /**
+       * Retrieves the count for a branch of the event loop
+       * @param branch the branch
+       * @return number of times the branch was taken
+       */
+      std::uint64_t getBranchCount(Branch branch) const;
+
+      Histogram::Snapshot eventsPerWake;
+      Histogram::Snapshot batchTime;
+      Histogram::Snapshot dispatchLatency;
+      std::uint64_t branchCounts[NUMBER_BRANCHES];
+   };
+
+   /**
+    * Retrieves the current time from a monotonic clock, for timestamps
+    * passed to the record methods
+    * @return the current monotonic time in nanoseconds
+    */
+   static std::uint64_t now();
+
+   /**
+    * Default constructor
+    */
+   EventLoopStats();
+
+   /**
+    * Destructor
+    */
+   ~EventLoopStats();
+
+   /**
+    * Records the number of events returned by one wait for kernel events
+    * @param numberEvents number of events returned
+    */
+   void recordWake(int numberEvents);
+
+   /**
+    * Records how long the loop spent processing one batch of events
+    * @param nanoseconds the processing time in nanoseconds
+    */
+   void recordBatchTime(std::uint64_t nanoseconds);
+
+   /**
+    * Records how long a request waited between its event being returned
+    * to the loop and its handler starting
+    * @param nanoseconds the dispatch latency in nanoseconds
+    */
+   void recordDispatchLatency(std::uint64_t nanoseconds);
+
+   /**
+    * Counts one pass through a branch of the event loop
+    * @param branch the branch taken
+    */
+   void countBranch(Branch branch);
+
+   /**
+    * Copies the current statistics
+    * @param snapshot receives the statistics
+    */
+   void snapshot(Snapshot& snapshot) const;
+
+
+private:
+   Histogram m_eventsPerWake;
+   Histogram m_batchTime;
+   Histogram m_dispatchLatency;
+   std::atomic<std::uint64_t> m_branchCounts[NUMBER_BRANCHES];
+
+   // copying not allowed
+   EventLoopStats(const EventLoopStats&);
+   EventLoopStats& operator=(const EventLoopStats&);
+};
+
+}
+
+#endif
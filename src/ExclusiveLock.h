@@ -0,0 +1,76 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_EXCLUSIVELOCK_H
+#define CHAUDIERE_EXCLUSIVELOCK_H
+
+#include "ReadWriteLock.h"
+
+namespace chaudiere
+{
+
+/**
+ * BasicExclusiveLock is a convenience class for holding a reader-writer lock
+ * exclusive (for writing) with RAII, in the manner of MutexLock. L is the
+ * lock type: ReadWriteLock (see ExclusiveLock) goes through its interface,
+ * while a concrete type binds the calls at compile time.
+ */
+template <typename L>
+class BasicExclusiveLock
+{
+public:
+   explicit BasicExclusiveLock(L& readWriteLock) :
+      m_lock(readWriteLock),
+      m_name(nullptr),
+      m_owns(true) {
+      m_lock.lockExclusive();
+   }
+
+   /**
+    * Locks the given lock exclusive
+    * @param readWriteLock the lock to lock
+    * @param name the call site's name (a string literal; not copied)
+    * @see ReadWriteLock()
+    */
+   explicit BasicExclusiveLock(L& readWriteLock, const char* name) :
+      m_lock(readWriteLock),
+      m_name(name),
+      m_owns(true) {
+      m_lock.lockExclusive();
+   }
+
+   /**
+    * Destructor - releases the lock (if not already released via unlock())
+    */
+   ~BasicExclusiveLock() {
+      if (m_owns) {
+         m_lock.unlockExclusive();
+      }
+   }
+
+   void unlock() {
+      if (m_owns) {
+         m_lock.unlockExclusive();
+         m_owns = false;
+      }
+   }
+
+private:
+   L& m_lock;
+   const char* m_name;
+   bool m_owns;
+
+   BasicExclusiveLock();
+   BasicExclusiveLock(const BasicExclusiveLock&);
+   BasicExclusiveLock& operator=(const BasicExclusiveLock&);
+
+};
+
+/**
+ * ExclusiveLock is a BasicExclusiveLock for any ReadWriteLock (through its interface)
+ */
+typedef BasicExclusiveLock<ReadWriteLock> ExclusiveLock;
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 
 #include "FileLogger.h"
 #include "PthreadsMutex.h"
+#include "ThreadingFactory.h"
 #include "MutexLock.h"
 
 using namespace chaudiere;
@@ -15,6 +16,17 @@ const std::string FileLogger::prefixInfo     = "Info:";
 const std::string FileLogger::prefixDebug    = "Debug:";
 const std::string FileLogger::prefixVerbose  = "Verbose:";
 
+// the lock comes from the process-wide ThreadingFactory (e.g., a futex
+// mutex under LinuxThreadingFactory), unless there isn't one yet
+static Mutex* createLoggerLock() {
+   ThreadingFactory* threadingFactory = ThreadingFactory::getThreadingFactory();
+   if (threadingFactory != nullptr) {
+      return threadingFactory->createMutex("fileLoggerLock");
+   } else {
+      return new PthreadsMutex("fileLoggerLock");
+   }
+}
+
 
 //******************************************************************************
 
@@ -22,7 +34,7 @@ FileLogger::FileLogger(const std::string& filePath) :
    m_filePath(filePath),
    f(nullptr),
    m_logLevel(Debug),
-   m_lock(new PthreadsMutex("fileLoggerLock")) {
+   m_lock(createLoggerLock()) {
 }
 
 //******************************************************************************
@@ -31,7 +43,7 @@ FileLogger::FileLogger(const std::string& filePath, LogLevel logLevel) :
    m_filePath(filePath),
    f(nullptr),
    m_logLevel(logLevel),
-   m_lock(new PthreadsMutex("fileLoggerLock")) {
+   m_lock(createLoggerLock()) {
 }
 
 //******************************************************************************
@@ -0,0 +1,89 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+
+#include "Futex.h"
+
+#ifdef FUTEX_SUPPORT
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace chaudiere;
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int),
+              "futex word must be a plain 32-bit int");
+
+//******************************************************************************
+
+bool Futex::isSupportedPlatform() {
+#ifdef FUTEX_SUPPORT
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+void Futex::wait(std::atomic<int>* word, int expectedValue) {
+#ifdef FUTEX_SUPPORT
+   // (EAGAIN -- word changed -- and EINTR both just mean "re-check")
+   ::syscall(SYS_futex, reinterpret_cast<int*>(word),
+             FUTEX_WAIT_PRIVATE, expectedValue, nullptr, nullptr, 0);
+#else
+   if (word->load(std::memory_order_relaxed) == expectedValue) {
+      ::sched_yield();
+   }
+#endif
+}
+
+//******************************************************************************
+
+void Futex::wake(std::atomic<int>* word, int numberToWake) {
+#ifdef FUTEX_SUPPORT
+   ::syscall(SYS_futex, reinterpret_cast<int*>(word),
+             FUTEX_WAKE_PRIVATE, numberToWake, nullptr, nullptr, 0);
+#else
+   (void) word;
+   (void) numberToWake;
+#endif
+}
+
+//******************************************************************************
+
+bool Futex::requeue(std::atomic<int>* word,
+                    int expectedValue,
+                    int numberToWake,
+                    std::atomic<int>* target) {
+#ifdef FUTEX_SUPPORT
+   // the number to requeue travels in the timeout argument
+   const long rc = ::syscall(SYS_futex, reinterpret_cast<int*>(word),
+                             FUTEX_CMP_REQUEUE_PRIVATE, numberToWake,
+                             reinterpret_cast<void*>(static_cast<long>(INT_MAX)),
+                             reinterpret_cast<int*>(target), expectedValue);
+   return !((rc == -1) && (errno == EAGAIN));
+#else
+   (void) word;
+   (void) expectedValue;
+   (void) numberToWake;
+   (void) target;
+   return true;
+#endif
+}
+
+//******************************************************************************
+
+void Futex::cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+   __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+   __asm__ __volatile__("yield");
+#endif
+}
+
+//******************************************************************************
@@ -0,0 +1,69 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_FUTEX_H
+#define CHAUDIERE_FUTEX_H
+
+#include <atomic>
+
+#ifdef __linux__
+#define FUTEX_SUPPORT 1
+#endif
+
+
+namespace chaudiere
+{
+
+/**
+ * Futex is a thin wrapper around the Linux futex system call (the kernel
+ * side of FutexMutex and FutexConditionVariable). On other platforms,
+ * wait() just yields the processor and the wake calls do nothing, which
+ * is correct (waiters re-check their futex word) but spins.
+ */
+class Futex
+{
+public:
+   /**
+    * Determines if futexes are supported on the current platform
+    * @return boolean indicating if futexes are supported
+    */
+   static bool isSupportedPlatform();
+
+   /**
+    * Sleeps until woken, as long as the futex word still holds the
+    * expected value (returns at once otherwise). May return spuriously.
+    * @param word the futex word
+    * @param expectedValue the value the word must hold to go to sleep
+    */
+   static void wait(std::atomic<int>* word, int expectedValue);
+
+   /**
+    * Wakes threads sleeping on a futex word
+    * @param word the futex word
+    * @param numberToWake the maximum number of threads to wake
+    */
+   static void wake(std::atomic<int>* word, int numberToWake);
+
+   /**
+    * Wakes threads sleeping on one futex word and moves the rest of its
+    * sleepers to another word, without waking them
+    * @param word the futex word that threads are sleeping on
+    * @param expectedValue the value word must hold (checked atomically)
+    * @param numberToWake the maximum number of threads to wake
+    * @param target the futex word that the remaining sleepers move to
+    * @return false if word no longer held the expected value (nothing done)
+    */
+   static bool requeue(std::atomic<int>* word,
+                       int expectedValue,
+                       int numberToWake,
+                       std::atomic<int>* target);
+
+   /**
+    * Tells the processor that the caller is busy-waiting
+    */
+   static void cpuRelax();
+};
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <limits.h>
+
+#include "FutexConditionVariable.h"
+#include "FutexMutex.h"
+#include "Futex.h"
+#include "Logger.h"
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+FutexConditionVariable::FutexConditionVariable() :
+   m_sequence(0),
+   m_numberWaiters(0),
+   m_mutex(nullptr) {
+   LOG_INSTANCE_CREATE("FutexConditionVariable")
+}
+
+//******************************************************************************
+
+FutexConditionVariable::FutexConditionVariable(const std::string& name) :
+   m_sequence(0),
+   m_numberWaiters(0),
+   m_mutex(nullptr),
+   m_name(name) {
+   LOG_INSTANCE_CREATE("FutexConditionVariable")
+}
+
+//******************************************************************************
+
+FutexConditionVariable::~FutexConditionVariable() {
+   LOG_INSTANCE_DESTROY("FutexConditionVariable")
+}
+
+//******************************************************************************
+
+bool FutexConditionVariable::wait(Mutex* mutex) {
+   if (mutex) {
+      FutexMutex* futexMutex = dynamic_cast<FutexMutex*>(mutex);
+
+      if (futexMutex) {
+         return wait(*futexMutex);
+      } else {
+         LOG_ERROR("mutex must be an instance of FutexMutex")
+      }
+   } else {
+      LOG_ERROR("no mutex given to wait on")
+   }
+
+   return false;
+}
+
+//******************************************************************************
+
+bool FutexConditionVariable::wait(FutexMutex& mutex) {
+   m_mutex.store(&mutex, std::memory_order_relaxed);
+
+   // count ourselves before sampling the sequence, so that a notifier
+   // that bumps the sequence after our sample sees us
+   m_numberWaiters.fetch_add(1, std::memory_order_seq_cst);
+   const int sequence = m_sequence.load(std::memory_order_seq_cst);
+
+   mutex.unlock();
+   Futex::wait(&m_sequence, sequence);
+   m_numberWaiters.fetch_sub(1, std::memory_order_relaxed);
+
+   // we may have been requeued onto the mutex by notifyAll, and the
+   // mutex's unlock only wakes sleepers when it's marked as having them
+   mutex.lockAndMarkSleepers();
+   return true;
+}
+
+//******************************************************************************
+
+void FutexConditionVariable::notifyOne() {
+   m_sequence.fetch_add(1, std::memory_order_seq_cst);
+
+   if (m_numberWaiters.load(std::memory_order_seq_cst) > 0) {
+      Futex::wake(&m_sequence, 1);
+   }
+}
+
+//******************************************************************************
+
+void FutexConditionVariable::notifyAll() {
+   int sequence = m_sequence.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+   if (m_numberWaiters.load(std::memory_order_seq_cst) == 0) {
+      return;
+   }
+
+   FutexMutex* mutex = m_mutex.load(std::memory_order_relaxed);
+
+   if (mutex == nullptr) {
+      Futex::wake(&m_sequence, INT_MAX);
+      return;
+   }
+
+   // (retry if another notify changed the sequence in the meantime)
+   while (!Futex::requeue(&m_sequence, sequence, 1, &mutex->m_state)) {
+      sequence = m_sequence.load(std::memory_order_seq_cst);
+   }
+}
+
+//******************************************************************************
+
+const std::string& FutexConditionVariable::getName() const {
+   return m_name;
+}
+
+//******************************************************************************
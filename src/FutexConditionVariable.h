@@ -0,0 +1,84 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_FUTEXCONDITIONVARIABLE_H
+#define CHAUDIERE_FUTEXCONDITIONVARIABLE_H
+
+#include <atomic>
+#include <string>
+
+#include "ConditionVariable.h"
+
+namespace chaudiere
+{
+   class FutexMutex;
+
+/**
+ * FutexConditionVariable is a ConditionVariable built on a futex word,
+ * for use with FutexMutex. Notifying with no waiters makes no system call.
+ * notifyAll wakes a single waiter and moves the rest onto the mutex's
+ * futex, so they're woken one at a time as the mutex is released rather
+ * than all at once only to contend for it.
+ */
+class FutexConditionVariable : public ConditionVariable
+{
+public:
+   /**
+    * Default constructor
+    */
+   FutexConditionVariable();
+
+   /**
+    * Constructs a condition variable with a name
+    * @param name the name of the condition variable
+    */
+   explicit FutexConditionVariable(const std::string& name);
+
+   /**
+    * Destructor
+    */
+   ~FutexConditionVariable();
+
+   /**
+    * Wait for the condition to occur
+    * @param mutex the FutexMutex that the caller currently has locked
+    * @return true if the wait happened, false if mutex isn't a FutexMutex
+    * @see FutexMutex()
+    */
+   bool wait(Mutex* mutex) final;
+
+   /**
+    * Wait for the condition to occur (with no check of the mutex's type)
+    * @param mutex the mutex that the caller currently has locked
+    * @return true
+    */
+   bool wait(FutexMutex& mutex);
+
+   /**
+    * Notify (wake up) a single waiting thread that the condition has occurred
+    */
+   void notifyOne() final;
+
+   /**
+    * Notify all waiting threads that the condition has occurred (one is
+    * woken, the others are requeued onto the mutex)
+    */
+   void notifyAll() final;
+
+   const std::string& getName() const;
+
+
+private:
+   // disallow copies
+   FutexConditionVariable(const FutexConditionVariable&);
+   FutexConditionVariable& operator=(const FutexConditionVariable&);
+
+   std::atomic<int> m_sequence;
+   std::atomic<int> m_numberWaiters;
+   std::atomic<FutexMutex*> m_mutex;
+   std::string m_name;
+};
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <stdio.h>
+#include <algorithm>
+
+#include "FutexMutex.h"
+#include "Futex.h"
+#include "Logger.h"
+
+static const std::string EMPTY_STRING = "";
+
+// bounds of the adaptive spin (in cpuRelax iterations)
+static const int MIN_SPIN_COUNT = 10;
+static const int MAX_SPIN_COUNT = 100;
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+FutexMutex::FutexMutex() :
+   FutexMutex(EMPTY_STRING) {
+}
+
+//******************************************************************************
+
+FutexMutex::FutexMutex(const std::string& mutexName) :
+   m_state(UNLOCKED),
+   m_spinEstimate(0),
+   m_mutexName(mutexName) {
+   LOG_INSTANCE_CREATE("FutexMutex")
+}
+
+//******************************************************************************
+
+FutexMutex::~FutexMutex() {
+   LOG_INSTANCE_DESTROY("FutexMutex")
+}
+
+//******************************************************************************
+
+void FutexMutex::lockContended() {
+   // spin about twice as long as spinning has recently taken to pay off
+   // (in the manner of glibc's adaptive mutexes), then sleep
+   const int estimate = m_spinEstimate.load(std::memory_order_relaxed);
+   const int spinLimit = getSpinLimit();
+   int spins = 0;
+
+   for (; spins < spinLimit; ++spins) {
+      Futex::cpuRelax();
+
+      int state = m_state.load(std::memory_order_relaxed);
+      if ((state == UNLOCKED) &&
+          m_state.compare_exchange_weak(state, LOCKED,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+         break;
+      }
+   }
+
+   m_spinEstimate.store(estimate + (spins - estimate) / 8,
+                        std::memory_order_relaxed);
+
+   if (spins == spinLimit) {
+      lockAndMarkSleepers();
+   }
+}
+
+//******************************************************************************
+
+void FutexMutex::wakeSleeper() {
+   // (the lock was marked as having sleepers)
+   m_state.store(UNLOCKED, std::memory_order_release);
+   Futex::wake(&m_state, 1);
+}
+
+//******************************************************************************
+
+bool FutexMutex::unlockFailed() const {
+   printf("error: mutex unlock failed, not locked, name='%s'\n", m_mutexName.c_str());
+   return false;
+}
+
+//******************************************************************************
+
+void FutexMutex::lockAndMarkSleepers() {
+   // whoever takes the lock this way leaves it marked as having sleepers,
+   // so that its unlock wakes the next one
+   while (m_state.exchange(LOCKED_WITH_SLEEPERS, std::memory_order_acquire) != UNLOCKED) {
+      Futex::wait(&m_state, LOCKED_WITH_SLEEPERS);
+   }
+}
+
+//******************************************************************************
+
+const std::string& FutexMutex::getName() const {
+   return m_mutexName;
+}
+
+//******************************************************************************
+
+int FutexMutex::getSpinLimit() const {
+   return std::min(2 * m_spinEstimate.load(std::memory_order_relaxed) + MIN_SPIN_COUNT,
+                   MAX_SPIN_COUNT);
+}
+
+//******************************************************************************
@@ -0,0 +1,136 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_FUTEXMUTEX_H
+#define CHAUDIERE_FUTEXMUTEX_H
+
+#include <atomic>
+#include <string>
+
+#include "Mutex.h"
+
+namespace chaudiere
+{
+
+/**
+ * FutexMutex is a Mutex built directly on a futex word. Locking and
+ * unlocking an uncontended FutexMutex is a single atomic operation with
+ * no system call. A contended lock first spins for a while (adapting how
+ * long to the spins that have paid off recently) and then sleeps in the
+ * kernel. Unlock only enters the kernel when some thread is sleeping.
+ */
+class FutexMutex : public Mutex
+{
+public:
+   /**
+    * Default constructor
+    */
+   FutexMutex();
+
+   /**
+    * Constructs mutex with a name
+    * @param mutexName the name of the mutex
+    */
+   explicit FutexMutex(const std::string& mutexName);
+
+   /**
+    * Destructor
+    */
+   ~FutexMutex();
+
+   /**
+    * Unlocks the mutex
+    * @return true if mutex was successfully unlocked, false if not locked
+    */
+   bool unlock() final {
+      if (m_state.load(std::memory_order_relaxed) == UNLOCKED) {
+         return unlockFailed();
+      }
+
+      if (m_state.fetch_sub(1, std::memory_order_release) != LOCKED) {
+         wakeSleeper();
+      }
+
+      return true;
+   }
+
+   /**
+    * Locks the mutex
+    * @return true (locking a FutexMutex doesn't fail)
+    */
+   bool lock() final {
+      int state = UNLOCKED;
+      if (!m_state.compare_exchange_strong(state, LOCKED,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+         lockContended();
+      }
+
+      return true;
+   }
+
+   /**
+    * Determines if the mutex is currently locked
+    * @return true if mutex is locked, false otherwise
+    */
+   bool isLocked() const final {
+      return m_state.load(std::memory_order_relaxed) != UNLOCKED;
+   }
+
+   /**
+    * Determines if a valid mutex is present (usable)
+    * @return true (a FutexMutex is always valid)
+    */
+   bool haveValidMutex() const final {
+      return true;
+   }
+
+   /**
+    * Retrieves the futex word (0 unlocked, 1 locked, 2 locked with
+    * sleepers)
+    * @return the futex word
+    */
+   std::atomic<int>& getPlatformPrimitive()
+   {
+      return m_state;
+   }
+
+   /**
+    * Retrieves the name of the mutex
+    * @return name of the mutex
+    */
+   const std::string& getName() const;
+
+   /**
+    * Retrieves how many times the mutex spins before sleeping, currently
+    * @return the current spin limit
+    */
+   int getSpinLimit() const;
+
+
+private:
+   friend class FutexConditionVariable;
+
+   // states of the futex word
+   static const int UNLOCKED = 0;
+   static const int LOCKED = 1;
+   static const int LOCKED_WITH_SLEEPERS = 2;
+
+   // copying not allowed
+   FutexMutex(const FutexMutex&);
+   FutexMutex& operator=(const FutexMutex&);
+
+   void lockContended();
+   void lockAndMarkSleepers();
+   void wakeSleeper();
+   bool unlockFailed() const;
+
+   std::atomic<int> m_state;
+   std::atomic<int> m_spinEstimate;
+   std::string m_mutexName;
+
+};
+
+}
+
+#endif
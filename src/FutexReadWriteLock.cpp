@@ -0,0 +1,156 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <stdio.h>
+#include <limits.h>
+
+#include "FutexReadWriteLock.h"
+#include "Futex.h"
+#include "Logger.h"
+
+static const std::string EMPTY_STRING = "";
+
+// how many times a blocked reader or writer retries (with cpuRelax)
+// before sleeping
+static const int SPIN_COUNT = 40;
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+FutexReadWriteLock::FutexReadWriteLock() :
+   FutexReadWriteLock(EMPTY_STRING) {
+}
+
+//******************************************************************************
+
+FutexReadWriteLock::FutexReadWriteLock(const std::string& name,
+                                       ReadWritePreference preference) :
+   m_state(UNLOCKED),
+   m_readerSequence(0),
+   m_writerSequence(0),
+   m_numberWaitingReaders(0),
+   m_numberWaitingWriters(0),
+   m_name(name),
+   m_isWriterPreferring(preference == ReadWritePreference::Writers) {
+   LOG_INSTANCE_CREATE("FutexReadWriteLock")
+}
+
+//******************************************************************************
+
+FutexReadWriteLock::~FutexReadWriteLock() {
+   LOG_INSTANCE_DESTROY("FutexReadWriteLock")
+}
+
+//******************************************************************************
+
+void FutexReadWriteLock::lockSharedContended() {
+   int spins = 0;
+
+   for (;;) {
+      int state = m_state.load(std::memory_order_relaxed);
+
+      if ((state >= 0) && !isBlockingReaders()) {
+         if (m_state.compare_exchange_weak(state, state + 1,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+            return;
+         }
+         continue;
+      }
+
+      if (spins < SPIN_COUNT) {
+         ++spins;
+         Futex::cpuRelax();
+         continue;
+      }
+
+      // sample the sequence and count ourselves before the last look at
+      // the state, so that a release after that look changes the sequence
+      const int sequence = m_readerSequence.load(std::memory_order_seq_cst);
+      m_numberWaitingReaders.fetch_add(1, std::memory_order_seq_cst);
+
+      if ((m_state.load(std::memory_order_seq_cst) < 0) || isBlockingReaders()) {
+         Futex::wait(&m_readerSequence, sequence);
+      }
+
+      m_numberWaitingReaders.fetch_sub(1, std::memory_order_relaxed);
+   }
+}
+
+//******************************************************************************
+
+void FutexReadWriteLock::lockExclusiveContended() {
+   // (while counted, a writer-preferring lock admits no new readers)
+   m_numberWaitingWriters.fetch_add(1, std::memory_order_seq_cst);
+   int spins = 0;
+
+   for (;;) {
+      int state = UNLOCKED;
+      if (m_state.compare_exchange_strong(state, WRITE_LOCKED,
+                                          std::memory_order_seq_cst)) {
+         break;
+      }
+
+      if (spins < SPIN_COUNT) {
+         ++spins;
+         Futex::cpuRelax();
+         continue;
+      }
+
+      const int sequence = m_writerSequence.load(std::memory_order_seq_cst);
+
+      if (m_state.load(std::memory_order_seq_cst) != UNLOCKED) {
+         Futex::wait(&m_writerSequence, sequence);
+      }
+   }
+
+   m_numberWaitingWriters.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+//******************************************************************************
+
+void FutexReadWriteLock::wakeWriter() {
+   m_writerSequence.fetch_add(1, std::memory_order_seq_cst);
+   Futex::wake(&m_writerSequence, 1);
+}
+
+//******************************************************************************
+
+void FutexReadWriteLock::wakeAfterExclusive() {
+   const bool isWriterWaiting =
+      m_numberWaitingWriters.load(std::memory_order_seq_cst) > 0;
+
+   if (isWriterWaiting) {
+      wakeWriter();
+   }
+
+   // readers held back by a waiting writer are woken when it unlocks
+   if ((m_numberWaitingReaders.load(std::memory_order_seq_cst) > 0) &&
+       !(m_isWriterPreferring && isWriterWaiting)) {
+      m_readerSequence.fetch_add(1, std::memory_order_seq_cst);
+      Futex::wake(&m_readerSequence, INT_MAX);
+   }
+}
+
+//******************************************************************************
+
+bool FutexReadWriteLock::unlockFailed() const {
+   printf("error: rwlock unlock failed, not locked that way, name='%s'\n", m_name.c_str());
+   return false;
+}
+
+//******************************************************************************
+
+ReadWritePreference FutexReadWriteLock::getPreference() const {
+   return m_isWriterPreferring ? ReadWritePreference::Writers :
+                                 ReadWritePreference::Readers;
+}
+
+//******************************************************************************
+
+const std::string& FutexReadWriteLock::getName() const {
+   return m_name;
+}
+
+//******************************************************************************
@@ -0,0 +1,132 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_FUTEXREADWRITELOCK_H
+#define CHAUDIERE_FUTEXREADWRITELOCK_H
+
+#include <atomic>
+#include <string>
+
+#include "ReadWriteLock.h"
+
+namespace chaudiere
+{
+
+/**
+ * FutexReadWriteLock is a ReadWriteLock built on a futex word holding
+ * the number of readers (or -1 while write-locked). Uncontended locking
+ * and unlocking, shared or exclusive, is a single atomic operation with
+ * no system call. Readers and writers that can't get in spin briefly and
+ * then sleep on separate futexes, so that a release wakes only the side
+ * that can proceed.
+ */
+class FutexReadWriteLock : public ReadWriteLock
+{
+public:
+   /**
+    * Default constructor
+    */
+   FutexReadWriteLock();
+
+   /**
+    * Constructs a lock with a name and preference
+    * @param name the name of the lock
+    * @param preference which side the lock favors
+    */
+   explicit FutexReadWriteLock(const std::string& name,
+                               ReadWritePreference preference = ReadWritePreference::Readers);
+
+   /**
+    * Destructor
+    */
+   ~FutexReadWriteLock();
+
+   bool lockShared() final {
+      int state = m_state.load(std::memory_order_relaxed);
+      if ((state < 0) || isBlockingReaders() ||
+          !m_state.compare_exchange_weak(state, state + 1,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+         lockSharedContended();
+      }
+
+      return true;
+   }
+
+   bool unlockShared() final {
+      if (m_state.load(std::memory_order_relaxed) <= 0) {
+         return unlockFailed();
+      }
+
+      if ((m_state.fetch_sub(1, std::memory_order_seq_cst) == 1) &&
+          (m_numberWaitingWriters.load(std::memory_order_seq_cst) > 0)) {
+         wakeWriter();
+      }
+
+      return true;
+   }
+
+   bool lockExclusive() final {
+      int state = UNLOCKED;
+      if (!m_state.compare_exchange_strong(state, WRITE_LOCKED,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+         lockExclusiveContended();
+      }
+
+      return true;
+   }
+
+   bool unlockExclusive() final {
+      if (m_state.load(std::memory_order_relaxed) != WRITE_LOCKED) {
+         return unlockFailed();
+      }
+
+      m_state.store(UNLOCKED, std::memory_order_seq_cst);
+
+      if ((m_numberWaitingWriters.load(std::memory_order_seq_cst) > 0) ||
+          (m_numberWaitingReaders.load(std::memory_order_seq_cst) > 0)) {
+         wakeAfterExclusive();
+      }
+
+      return true;
+   }
+
+   ReadWritePreference getPreference() const final;
+
+   const std::string& getName() const;
+
+
+private:
+   // states of the futex word (other than a count of readers)
+   static const int UNLOCKED = 0;
+   static const int WRITE_LOCKED = -1;
+
+   // copying not allowed
+   FutexReadWriteLock(const FutexReadWriteLock&);
+   FutexReadWriteLock& operator=(const FutexReadWriteLock&);
+
+   bool isBlockingReaders() const {
+      return m_isWriterPreferring &&
+             (m_numberWaitingWriters.load(std::memory_order_seq_cst) > 0);
+   }
+
+   void lockSharedContended();
+   void lockExclusiveContended();
+   void wakeWriter();
+   void wakeAfterExclusive();
+   bool unlockFailed() const;
+
+   std::atomic<int> m_state;
+   std::atomic<int> m_readerSequence;
+   std::atomic<int> m_writerSequence;
+   std::atomic<int> m_numberWaitingReaders;
+   std::atomic<int> m_numberWaitingWriters;
+   std::string m_name;
+   const bool m_isWriterPreferring;
+
+};
+
+}
+
+#endif
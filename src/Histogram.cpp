@@ -0,0 +1,147 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "Histogram.h"
+
+using namespace chaudiere;
+
+const std::size_t Histogram::NUMBER_BUCKETS;
+
+//******************************************************************************
+
+Histogram::Snapshot::Snapshot() :
+   count(0),
+   sum(0),
+   max(0) {
+   for (std::size_t i = 0; i < NUMBER_BUCKETS; ++i) {
+      buckets[i] = 0;
+   }
+}
+
+//******************************************************************************
+
+std::uint64_t Histogram::Snapshot::valueAtPercentile(double percentile) const {
+   std::uint64_t total = 0;
+   for (std::size_t i = 0; i < NUMBER_BUCKETS; ++i) {
+      total += buckets[i];
+   }
+
+   if (total == 0) {
+      return 0;
+   }
+
+   if (percentile < 0.0) {
+      percentile = 0.0;
+   } else if (percentile > 100.0) {
+      percentile = 100.0;
+   }
+
+   // rank of the sample we're after (1-based)
+   std::uint64_t rank =
+      static_cast<std::uint64_t>((percentile / 100.0) * total + 0.5);
+   if (rank == 0) {
+      rank = 1;
+   }
+
+   std::uint64_t seen = 0;
+   for (std::size_t i = 0; i < NUMBER_BUCKETS; ++i) {
+      seen += buckets[i];
+      if (seen >= rank) {
+         const std::uint64_t upperBound = bucketUpperBound(i);
+         return (max > 0 && max < upperBound) ? max : upperBound;
+      }
+   }
+
+   return max;
+}
+
+//******************************************************************************
+
+double Histogram::Snapshot::mean() const {
+   if (count == 0) {
+      return 0.0;
+   }
+
+   return static_cast<double>(sum) / static_cast<double>(count);
+}
+
+//******************************************************************************
+//******************************************************************************
+
+Histogram::Histogram() :
+   m_count(0),
+   m_sum(0),
+   m_max(0) {
+   for (std::size_t i = 0; i < NUMBER_BUCKETS; ++i) {
+      m_buckets[i].store(0, std::memory_order_relaxed);
+   }
+}
+
+//******************************************************************************
+
+Histogram::~Histogram() {
+}
+
+//******************************************************************************
+
+void Histogram::record(std::uint64_t value) {
+   m_buckets[bucketForValue(value)].fetch_add(1, std::memory_order_relaxed);
+   m_count.fetch_add(1, std::memory_order_relaxed);
+   m_sum.fetch_add(value, std::memory_order_relaxed);
+
+   std::uint64_t currentMax = m_max.load(std::memory_order_relaxed);
+   while (value > currentMax &&
+          !m_max.compare_exchange_weak(currentMax,
+                                       value,
+                                       std::memory_order_relaxed)) {
+   }
+}
+
+//******************************************************************************
+
+void Histogram::snapshot(Snapshot& snapshot) const {
+   snapshot.count = m_count.load(std::memory_order_relaxed);
+   snapshot.sum = m_sum.load(std::memory_order_relaxed);
+   snapshot.max = m_max.load(std::memory_order_relaxed);
+
+   for (std::size_t i = 0; i < NUMBER_BUCKETS; ++i) {
+      snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+   }
+}
+
+//******************************************************************************
+
+std::size_t Histogram::bucketForValue(std::uint64_t value) {
+   if (value == 0) {
+      return 0;
+   }
+
+#if defined(__GNUC__) || defined(__clang__)
+   return 64 - __builtin_clzll(value);
+#else
+   std::size_t bucket = 0;
+
+   while (value != 0) {
+      ++bucket;
+      value >>= 1;
+   }
+
+   return bucket;
+#endif
+}
+
+//******************************************************************************
+
+std::uint64_t Histogram::bucketUpperBound(std::size_t bucket) {
+   if (bucket == 0) {
+      return 0;
+   }
+
+   if (bucket >= 64) {
+      return UINT64_MAX;
+   }
+
+   return (static_cast<std::uint64_t>(1) << bucket) - 1;
+}
+
+//******************************************************************************
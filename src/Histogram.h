@@ -0,0 +1,104 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_HISTOGRAM_H
+#define CHAUDIERE_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace chaudiere
+{
+
+/**
+ * Histogram counts unsigned 64-bit samples (e.g., nanoseconds or event
+ * counts) in power-of-two buckets: bucket 0 holds 0, and bucket n holds
+ * values from 2^(n-1) up to 2^n - 1. Recording a sample is a handful of
+ * relaxed atomic increments with no lock, so any number of threads can
+ * record while another takes a snapshot. A snapshot taken while samples
+ * are being recorded may be off by the samples in flight.
+ */
+class Histogram
+{
+public:
+   static const std::size_t NUMBER_BUCKETS = 65;
+
+   /**
+    * Snapshot is a point-in-time copy of a Histogram's counts
+    */
+   struct Snapshot {
+      Snapshot();
+
+      /**
+       * Retrieves an upper bound on the value at a percentile of the
+       * recorded samples (the top of the bucket the percentile falls in)
+       * @param percentile the percentile (0.0 to 100.0)
+       * @return upper bound of the value at the percentile, or 0 if there
+       * are no samples
+       */
+      std::uint64_t valueAtPercentile(double percentile) const;
+
+      /**
+       * @return mean of the recorded samples, or 0 if there are none
+       */
+      double mean() const;
+
+      std::uint64_t count;
+      std::uint64_t sum;
+      std::uint64_t max;
+      std::uint64_t buckets[NUMBER_BUCKETS];
+   };
+
+   /**
+    * Default constructor
+    */
+   Histogram();
+
+   /**
+    * Destructor
+    */
+   ~Histogram();
+
+   /**
+    * Records a sample
+    * @param value the sample value
+    */
+   void record(std::uint64_t value);
+
+   /**
+    * Copies the current counts
+    * @param snapshot receives the counts
+    */
+   void snapshot(Snapshot& snapshot) const;
+
+   /**
+    * Retrieves the bucket a value is counted in
+    * @param value the sample value
+    * @return the bucket index
+    */
+   static std::size_t bucketForValue(std::uint64_t value);
+
+   /**
+    * Retrieves the largest value counted in a bucket
+    * @param bucket the bucket index
+    * @return the largest value for the bucket
+    */
+   static std::uint64_t bucketUpperBound(std::size_t bucket);
+
+
+private:
+   std::atomic<std::uint64_t> m_count;
+   std::atomic<std::uint64_t> m_sum;
+   std::atomic<std::uint64_t> m_max;
+   std::atomic<std::uint64_t> m_buckets[NUMBER_BUCKETS];
+
+   // copying not allowed
+   Histogram(const Histogram&);
+   Histogram& operator=(const Histogram&);
+};
+
+}
+
+#endif
@@ -0,0 +1,635 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <string>
+
+#include "IoUringServer.h"
+#include "ThreadingFactory.h"
+#include "MutexLock.h"
+#include "Logger.h"
+
+using namespace chaudiere;
+
+// number of submission queue entries; arming more connections than this
+// between two waits just flushes the queue early
+static const unsigned SUBMISSION_QUEUE_ENTRIES = 256;
+
+// set on the user data of internal requests (poll removal, the wakeup
+// eventfd's poll) whose completions are not events for the caller
+static const std::uint64_t INTERNAL_REQUEST = std::uint64_t(1) << 63;
+
+// set on the user data of polls registered with addFileDescriptorForRead
+// (e.g., the idle timer), which stay armed until removed
+static const std::uint64_t PERSISTENT_POLL = std::uint64_t(1) << 62;
+
+//******************************************************************************
+
+#ifdef IOURING_SUPPORT
+static int io_uring_setup(unsigned entries, struct io_uring_params* params) {
+   return (int) ::syscall(__NR_io_uring_setup, entries, params);
+}
+
+//******************************************************************************
+
+static int io_uring_enter(int ringFD,
+                          unsigned toSubmit,
+                          unsigned minComplete,
+                          unsigned flags) {
+   return (int) ::syscall(__NR_io_uring_enter,
+                          ringFD,
+                          toSubmit,
+                          minComplete,
+                          flags,
+                          nullptr,
+                          0);
+}
+#endif
+
+//******************************************************************************
+
+static bool probeIoUring() {
+#ifdef IOURING_SUPPORT
+   // io_uring can be compiled in but still unavailable at runtime (older
+   // kernel, kernel.io_uring_disabled, or a seccomp filter), so ask for a
+   // real ring. a single ring mmap and no dropped completions (5.5+) are
+   // also required.
+   struct io_uring_params params;
+   ::memset(&params, 0, sizeof(params));
+
+   const int ringFD = io_uring_setup(2, &params);
+   if (ringFD < 0) {
+      return false;
+   }
+
+   ::close(ringFD);
+
+   const unsigned requiredFeatures = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP;
+   return (params.features & requiredFeatures) == requiredFeatures;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+bool IoUringServer::isSupportedPlatform() {
+   static const bool isSupported = probeIoUring();
+   return isSupported;
+}
+
+//******************************************************************************
+
+IoUringServer::IoUringServer(Mutex& fdMutex, Mutex& hwmConnectionsMutex) :
+   KernelEventServer(fdMutex, hwmConnectionsMutex, "IoUringServer"),
+   m_wakeupPending(false),
+   m_events(nullptr),
+   m_ringMemory(nullptr),
+   m_ringMemorySize(0),
+   m_sqeMemory(nullptr),
+   m_sqeMemorySize(0),
+   m_sqHead(nullptr),
+   m_sqTail(nullptr),
+   m_sqRingMask(nullptr),
+   m_sqRingEntries(nullptr),
+   m_sqArray(nullptr),
+   m_cqHead(nullptr),
+   m_cqTail(nullptr),
+   m_cqRingMask(nullptr),
+   m_cqes(nullptr),
+   m_eventLoopThread(std::thread::id()),
+   m_ringFD(-1),
+   m_wakeupFD(-1),
+   m_multishotProbe(0),
+   m_multishotPoll(true),
+   m_multishotProbed(false),
+   m_listenerPollNeeded(false),
+   m_wakeupPollNeeded(false) {
+   LOG_INSTANCE_CREATE("IoUringServer")
+}
+
+//******************************************************************************
+
+IoUringServer::~IoUringServer() {
+   LOG_INSTANCE_DESTROY("IoUringServer")
+
+   if (nullptr != m_events) {
+      ::free(m_events);
+      m_events = nullptr;
+   }
+
+   if (nullptr != m_sqeMemory) {
+      ::munmap(m_sqeMemory, m_sqeMemorySize);
+   }
+
+   if (nullptr != m_ringMemory) {
+      ::munmap(m_ringMemory, m_ringMemorySize);
+   }
+
+   if (-1 != m_ringFD) {
+      ::close(m_ringFD);
+   }
+
+   if (-1 != m_wakeupFD) {
+      ::close(m_wakeupFD);
+   }
+}
+
+//******************************************************************************
+
+bool IoUringServer::init(SocketServiceHandler* socketServiceHandler,
+                         int serverPort,
+                         int maxConnections) {
+#ifndef IOURING_SUPPORT
+   return false;
+#endif
+
+#ifdef IOURING_SUPPORT
+   if (m_events) {
+      ::free(m_events);
+      m_events = nullptr;
+   }
+
+   if (KernelEventServer::init(socketServiceHandler, serverPort, maxConnections)) {
+      m_pendingRequestsMutex.reset(ThreadingFactory::getThreadingFactory()->createMutex("ioUringPendingRequests"));
+
+      if (!setupRing(maxConnections)) {
+         LOG_CRITICAL("io_uring setup failed")
+         return false;
+      }
+
+      m_wakeupFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (m_wakeupFD == -1) {
+         LOG_CRITICAL("unable to create eventfd for io_uring wakeups")
+         return false;
+      }
+
+      m_events = (Completion*) ::calloc(maxConnections, sizeof(Completion));
+
+      // both polls are submitted by the event loop thread once it starts
+      // (see the class comment for why nothing is submitted from here)
+      m_listenerPollNeeded = true;
+      m_wakeupPollNeeded = true;
+
+      return true;
+   }
+#endif
+
+   return false;
+}
+
+//******************************************************************************
+
+bool IoUringServer::setupRing(int maxConnections) {
+#ifdef IOURING_SUPPORT
+   struct io_uring_params params;
+   ::memset(&params, 0, sizeof(params));
+
+   // every connection can have a poll outstanding, so size the completion
+   // queue for all of them (the kernel keeps any overflow anyway)
+   params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+   params.cq_entries = 2 * SUBMISSION_QUEUE_ENTRIES;
+   if (params.cq_entries < (unsigned) maxConnections * 2) {
+      params.cq_entries = (unsigned) maxConnections * 2;
+   }
+
+   m_ringFD = io_uring_setup(SUBMISSION_QUEUE_ENTRIES, &params);
+   if (m_ringFD < 0) {
+      m_ringFD = -1;
+      return false;
+   }
+
+   if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+      LOG_CRITICAL("io_uring lacks single mmap support")
+      return false;
+   }
+
+   const std::size_t sqRingSize =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+   const std::size_t cqRingSize =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+   m_ringMemorySize = (sqRingSize > cqRingSize) ? sqRingSize : cqRingSize;
+   m_ringMemory = ::mmap(nullptr,
+                         m_ringMemorySize,
+                         PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE,
+                         m_ringFD,
+                         IORING_OFF_SQ_RING);
+   if (m_ringMemory == MAP_FAILED) {
+      m_ringMemory = nullptr;
+      return false;
+   }
+
+   m_sqeMemorySize = params.sq_entries * sizeof(struct io_uring_sqe);
+   m_sqeMemory = ::mmap(nullptr,
+                        m_sqeMemorySize,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE,
+                        m_ringFD,
+                        IORING_OFF_SQES);
+   if (m_sqeMemory == MAP_FAILED) {
+      m_sqeMemory = nullptr;
+      return false;
+   }
+
+   char* ring = (char*) m_ringMemory;
+   m_sqHead = (unsigned*) (ring + params.sq_off.head);
+   m_sqTail = (unsigned*) (ring + params.sq_off.tail);
+   m_sqRingMask = (unsigned*) (ring + params.sq_off.ring_mask);
+   m_sqRingEntries = (unsigned*) (ring + params.sq_off.ring_entries);
+   m_sqArray = (unsigned*) (ring + params.sq_off.array);
+   m_cqHead = (unsigned*) (ring + params.cq_off.head);
+   m_cqTail = (unsigned*) (ring + params.cq_off.tail);
+   m_cqRingMask = (unsigned*) (ring + params.cq_off.ring_mask);
+   m_cqes = ring + params.cq_off.cqes;
+
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+#ifdef IOURING_SUPPORT
+struct io_uring_sqe* IoUringServer::nextSubmissionEntry() {
+   // only ever called on the event loop thread
+   const unsigned tail = *m_sqTail;
+   unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+
+   if (tail - head >= *m_sqRingEntries) {
+      // queue is full of not-yet-submitted entries; hand them over now
+      io_uring_enter(m_ringFD, tail - head, 0, 0);
+      head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+      if (tail - head >= *m_sqRingEntries) {
+         return nullptr;
+      }
+   }
+
+   const unsigned index = tail & *m_sqRingMask;
+   struct io_uring_sqe* sqe = ((struct io_uring_sqe*) m_sqeMemory) + index;
+   ::memset(sqe, 0, sizeof(struct io_uring_sqe));
+   m_sqArray[index] = index;
+   return sqe;
+}
+#endif
+
+//******************************************************************************
+
+bool IoUringServer::isEventLoopThread() const {
+   return m_eventLoopThread.load(std::memory_order_relaxed) == std::this_thread::get_id();
+}
+
+//******************************************************************************
+
+bool IoUringServer::queueRequest(int fileDescriptor, RequestType requestType) {
+   // tagged now -- by the time the loop prepares the request the fd may
+   // have moved on to another connection
+   const std::uint64_t eventTag = getEventTag(fileDescriptor);
+
+   if (isEventLoopThread()) {
+      return prepareRequest(fileDescriptor, eventTag, requestType);
+   }
+
+   {
+      MutexLock locker(*m_pendingRequestsMutex);
+      PendingRequest request;
+      request.fileDescriptor = fileDescriptor;
+      request.eventTag = eventTag;
+      request.requestType = requestType;
+      m_pendingRequests.push_back(request);
+   }
+
+   // one wakeup covers every request queued before the loop picks them up
+   if (!m_wakeupPending.exchange(true)) {
+      const std::uint64_t increment = 1;
+      if (::write(m_wakeupFD, &increment, sizeof(increment)) < 0) {
+         LOG_CRITICAL("unable to wake io_uring event loop")
+         return false;
+      }
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+bool IoUringServer::prepareRequest(int fileDescriptor,
+                                   std::uint64_t eventTag,
+                                   RequestType requestType) {
+#ifdef IOURING_SUPPORT
+   struct io_uring_sqe* sqe = nextSubmissionEntry();
+   if (sqe == nullptr) {
+      LOG_CRITICAL("io_uring submission queue full")
+      return false;
+   }
+
+   if (requestType == RequestType::PollRemove) {
+      sqe->opcode = IORING_OP_POLL_REMOVE;
+      sqe->fd = -1;
+      // matched against the user data of the poll being removed (only
+      // one-shot polls, whose user data is exactly the tag, are removed)
+      sqe->addr = eventTag;
+      sqe->user_data = INTERNAL_REQUEST | eventTag;
+   } else {
+      std::uint32_t pollEvents = (requestType == RequestType::WritePoll) ?
+         POLLOUT : (POLLIN | POLLRDHUP);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      pollEvents = (pollEvents << 16) | (pollEvents >> 16);
+#endif
+
+      sqe->opcode = IORING_OP_POLL_ADD;
+      sqe->fd = fileDescriptor;
+      sqe->poll32_events = pollEvents;
+      sqe->user_data = eventTag;
+
+      bool isProbe = false;
+
+      if (requestType == RequestType::MultishotPoll) {
+         if (m_multishotPoll) {
+            sqe->len = IORING_POLL_ADD_MULTI;
+            isProbe = !m_multishotProbed;
+         }
+         sqe->user_data |= PERSISTENT_POLL;
+      }
+
+      if (fileDescriptor == m_wakeupFD) {
+         sqe->user_data |= INTERNAL_REQUEST;
+      }
+
+      if (isProbe) {
+         // the first multishot poll's completion tells whether the kernel
+         // supports them
+         m_multishotProbed = true;
+         m_multishotProbe = sqe->user_data;
+      }
+   }
+
+   __atomic_store_n(m_sqTail, *m_sqTail + 1, __ATOMIC_RELEASE);
+
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+void IoUringServer::preparePendingRequests() {
+   // cleared before taking the requests so that anything queued from here
+   // on triggers a fresh wakeup
+   m_wakeupPending.store(false);
+
+   {
+      MutexLock locker(*m_pendingRequestsMutex);
+      m_preparingRequests.swap(m_pendingRequests);
+   }
+
+   for (const PendingRequest& request : m_preparingRequests) {
+      prepareRequest(request.fileDescriptor, request.eventTag, request.requestType);
+   }
+
+   m_preparingRequests.clear();
+}
+
+//******************************************************************************
+
+bool IoUringServer::submitAndWait() {
+#ifdef IOURING_SUPPORT
+   const unsigned pending = *m_sqTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+
+   // one system call both submits everything queued and waits
+   return io_uring_enter(m_ringFD, pending, 1, IORING_ENTER_GETEVENTS) >= 0;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+int IoUringServer::getKernelEvents(int maxConnections) {
+#ifdef IOURING_SUPPORT
+   m_eventLoopThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+
+   const int listenerFD = getListenerSocketFileDescriptor();
+   const struct io_uring_cqe* cqes = (const struct io_uring_cqe*) m_cqes;
+   const unsigned mask = *m_cqRingMask;
+   int numberEvents = 0;
+
+   // completions that are only wakeups or removals don't count as events,
+   // so keep going until there's at least one for the caller
+   while (numberEvents == 0) {
+      if (m_listenerPollNeeded) {
+         m_listenerPollNeeded = false;
+         prepareRequest(listenerFD, getEventTag(listenerFD), RequestType::MultishotPoll);
+      }
+
+      if (m_wakeupPollNeeded) {
+         m_wakeupPollNeeded = false;
+         prepareRequest(m_wakeupFD, getEventTag(m_wakeupFD), RequestType::MultishotPoll);
+      }
+
+      for (int fd : m_repollFDs) {
+         prepareRequest(fd, getEventTag(fd), RequestType::MultishotPoll);
+      }
+      m_repollFDs.clear();
+
+      preparePendingRequests();
+
+      if (!submitAndWait()) {
+         if (errno != EINTR) {
+            LOG_CRITICAL("unable to retrieve events from io_uring")
+            return -1;
+         }
+         return 0;
+      }
+
+      unsigned head = *m_cqHead;
+      const unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+
+      while (head != tail && numberEvents < maxConnections) {
+         const struct io_uring_cqe& cqe = cqes[head & mask];
+         ++head;
+
+         const int fd = (int) (std::uint32_t) cqe.user_data;
+         const bool isMultishotEnded = !(cqe.flags & IORING_CQE_F_MORE);
+
+         if ((0 != m_multishotProbe) && (cqe.user_data == m_multishotProbe)) {
+            // only the probe's answer decides: an -EINVAL for any other
+            // poll (e.g., racing a close) says nothing about the kernel
+            m_multishotProbe = 0;
+
+            if (isMultishotEnded && cqe.res == -EINVAL) {
+               // kernel without multishot poll (pre-5.13); fall back to
+               // re-adding a one-shot poll after every event
+               m_multishotPoll = false;
+            }
+         }
+
+         if (cqe.user_data & INTERNAL_REQUEST) {
+            if (fd == m_wakeupFD) {
+               std::uint64_t value;
+               while (::read(m_wakeupFD, &value, sizeof(value)) > 0) {
+               }
+               if (isMultishotEnded) {
+                  m_wakeupPollNeeded = true;
+               }
+            }
+            continue;
+         }
+
+         if (fd == listenerFD) {
+            if (isMultishotEnded) {
+               m_listenerPollNeeded = true;
+            }
+
+            if (cqe.res < 0) {
+               continue;
+            }
+         } else if (cqe.res == -ECANCELED) {
+            // a removed poll
+            continue;
+         } else if (cqe.user_data & PERSISTENT_POLL) {
+            if (isMultishotEnded) {
+               m_repollFDs.push_back(fd);
+            }
+
+            if (cqe.res < 0) {
+               continue;
+            }
+         }
+
+         Completion& completion = m_events[numberEvents++];
+         completion.userData = cqe.user_data;
+         completion.result = cqe.res;
+         completion.flags = cqe.flags;
+      }
+
+      __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+   }
+
+   return numberEvents;
+#else
+   return 0;
+#endif
+}
+
+//******************************************************************************
+
+int IoUringServer::fileDescriptorForEventIndex(int eventIndex) {
+   int client_fd = -1;
+
+#ifdef IOURING_SUPPORT
+   client_fd = (int) (std::uint32_t) m_events[eventIndex].userData;
+#endif
+
+   return client_fd;
+}
+
+//******************************************************************************
+
+std::uint64_t IoUringServer::eventTagForEventIndex(int eventIndex) {
+#ifdef IOURING_SUPPORT
+   // the flag bits are ignored when the tag is checked
+   return m_events[eventIndex].userData;
+#else
+   return KernelEventServer::eventTagForEventIndex(eventIndex);
+#endif
+}
+
+//******************************************************************************
+
+bool IoUringServer::addFileDescriptorForRead(int fileDescriptor) {
+   return queueRequest(fileDescriptor, RequestType::MultishotPoll);
+}
+
+//******************************************************************************
+
+bool IoUringServer::removeFileDescriptorFromRead(int fileDescriptor) {
+   return queueRequest(fileDescriptor, RequestType::PollRemove);
+}
+
+//******************************************************************************
+
+bool IoUringServer::isOneShotSupported() const {
+#ifdef IOURING_SUPPORT
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+bool IoUringServer::addFileDescriptorForOneShotRead(int fileDescriptor) {
+   return queueRequest(fileDescriptor, RequestType::Poll);
+}
+
+//******************************************************************************
+
+bool IoUringServer::rearmFileDescriptorForRead(int fileDescriptor) {
+   // a completed one-shot poll leaves nothing behind in the kernel, so
+   // re-arming is just another poll
+   return queueRequest(fileDescriptor, RequestType::Poll);
+}
+
+//******************************************************************************
+
+bool IoUringServer::isOneShotWriteSupported() const {
+#ifdef IOURING_SUPPORT
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+bool IoUringServer::rearmFileDescriptorForWrite(int fileDescriptor) {
+   return queueRequest(fileDescriptor, RequestType::WritePoll);
+}
+
+//******************************************************************************
+
+bool IoUringServer::isEventDisconnect(int eventIndex) {
+#ifdef IOURING_SUPPORT
+   const std::int32_t result = m_events[eventIndex].result;
+   return (result < 0) || (result & (POLLHUP | POLLERR));
+#endif
+
+   return false;
+}
+
+//******************************************************************************
+
+bool IoUringServer::isEventReadClose(int eventIndex) {
+#ifdef IOURING_SUPPORT
+   const std::int32_t result = m_events[eventIndex].result;
+   return (result > 0) && (result & POLLRDHUP);
+#endif
+
+   return false;
+}
+
+//******************************************************************************
+
+bool IoUringServer::isEventRead(int eventIndex) {
+#ifdef IOURING_SUPPORT
+   const std::int32_t result = m_events[eventIndex].result;
+   return (result > 0) && (result & POLLIN);
+#endif
+
+   return false;
+}
+
+//******************************************************************************
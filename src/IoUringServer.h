@@ -0,0 +1,235 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_IOURINGSERVER_H
+#define CHAUDIERE_IOURINGSERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "KernelEventServer.h"
+
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define IOURING_SUPPORT 1
+#endif
+
+
+namespace chaudiere
+{
+   class SocketServiceHandler;
+   class Mutex;
+
+/**
+ * IoUringServer is a wrapper for working with the io_uring API on Linux,
+ * driven through the raw system calls (liburing is not required).
+ *
+ * Readiness is requested with poll operations placed on the submission
+ * queue: the listener gets a single multishot poll for its whole life,
+ * and each client connection gets a one-shot poll that is re-armed after
+ * every request. Queued polls go to the kernel in the same io_uring_enter
+ * call that waits for completions, so there's no per-connection control
+ * syscall like epoll_ctl.
+ *
+ * Only the event loop thread ever submits. io_uring ties a request to the
+ * thread that submitted it (and cancels it if that thread exits), so a
+ * worker re-arming a connection just hands the request to the event loop
+ * and wakes it through an eventfd the loop keeps a poll on.
+ */
+class IoUringServer : public KernelEventServer
+{
+public:
+   /**
+    * Determines if io_uring is supported (and enabled) on the running
+    * kernel
+    * @return boolean indicating if io_uring is supported
+    */
+   static bool isSupportedPlatform();
+
+   /**
+    *
+    * @param fdMutex
+    * @param hwmConnectionsMutex
+    */
+   IoUringServer(Mutex& fdMutex, Mutex& hwmConnectionsMutex);
+
+   /**
+    * Destructor
+    */
+   ~IoUringServer();
+
+   /**
+    *
+    * @param socketServiceHandler
+    * @param serverPort
+    * @param maxConnections
+    * @return
+    */
+   virtual bool init(SocketServiceHandler* socketServiceHandler,
+                     int serverPort,
+                     int maxConnections);
+
+   /**
+    *
+    * @param maxConnections
+    * @return
+    */
+   virtual int getKernelEvents(int maxConnections);
+
+   /**
+    *
+    * @param eventIndex
+    * @return
+    */
+   virtual int fileDescriptorForEventIndex(int eventIndex);
+
+   /**
+    *
+    * @param eventIndex
+    * @return
+    */
+   virtual std::uint64_t eventTagForEventIndex(int eventIndex);
+
+   /**
+    *
+    * @param fileDescriptor
+    * @return
+    */
+   virtual bool addFileDescriptorForRead(int fileDescriptor);
+
+   /**
+    *
+    * @param fileDescriptor
+    * @return
+    */
+   virtual bool removeFileDescriptorFromRead(int fileDescriptor);
+
+   /**
+    *
+    * @return
+    */
+   virtual bool isOneShotSupported() const;
+
+   /**
+    *
+    * @param fileDescriptor
+    * @return
+    */
+   virtual bool addFileDescriptorForOneShotRead(int fileDescriptor);
+
+   /**
+    *
+    * @param fileDescriptor
+    * @return
+    */
+   virtual bool rearmFileDescriptorForRead(int fileDescriptor);
+
+   /**
+    *
+    * @return
+    */
+   virtual bool isOneShotWriteSupported() const;
+
+   /**
+    *
+    * @param fileDescriptor
+    * @return
+    */
+   virtual bool rearmFileDescriptorForWrite(int fileDescriptor);
+
+   /**
+    *
+    * @param eventIndex
+    * @return
+    */
+   virtual bool isEventDisconnect(int eventIndex);
+
+   /**
+    *
+    * @param eventIndex
+    * @return
+    */
+   virtual bool isEventReadClose(int eventIndex);
+
+   /**
+    *
+    * @param eventIndex
+    * @return
+    */
+   virtual bool isEventRead(int eventIndex);
+
+
+private:
+   struct Completion {
+      std::uint64_t userData;
+      std::int32_t result;
+      std::uint32_t flags;
+   };
+
+   enum class RequestType {
+      Poll,
+      WritePoll,
+      MultishotPoll,
+      PollRemove
+   };
+
+   struct PendingRequest {
+      int fileDescriptor;
+      std::uint64_t eventTag;
+      RequestType requestType;
+   };
+
+   bool setupRing(int maxConnections);
+   bool queueRequest(int fileDescriptor, RequestType requestType);
+   bool prepareRequest(int fileDescriptor,
+                       std::uint64_t eventTag,
+                       RequestType requestType);
+   void preparePendingRequests();
+   bool submitAndWait();
+   bool isEventLoopThread() const;
+
+#ifdef IOURING_SUPPORT
+   struct io_uring_sqe* nextSubmissionEntry();
+#endif
+
+   std::unique_ptr<Mutex> m_pendingRequestsMutex;
+   std::vector<PendingRequest> m_pendingRequests;
+   std::vector<PendingRequest> m_preparingRequests;
+   std::vector<int> m_repollFDs;
+   std::atomic<bool> m_wakeupPending;
+   Completion* m_events;
+   void* m_ringMemory;
+   std::size_t m_ringMemorySize;
+   void* m_sqeMemory;
+   std::size_t m_sqeMemorySize;
+   unsigned* m_sqHead;
+   unsigned* m_sqTail;
+   unsigned* m_sqRingMask;
+   unsigned* m_sqRingEntries;
+   unsigned* m_sqArray;
+   unsigned* m_cqHead;
+   unsigned* m_cqTail;
+   unsigned* m_cqRingMask;
+   void* m_cqes;
+   std::atomic<std::thread::id> m_eventLoopThread;
+   int m_ringFD;
+   int m_wakeupFD;
+   std::uint64_t m_multishotProbe;   // user data of the first multishot poll
+   bool m_multishotPoll;
+   bool m_multishotProbed;
+   bool m_listenerPollNeeded;
+   bool m_wakeupPollNeeded;
+
+   // copying not allowed
+   IoUringServer(const IoUringServer&);
+   IoUringServer& operator=(const IoUringServer&);
+
+};
+
+}
+
+#endif
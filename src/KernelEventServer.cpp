@@ -11,6 +11,11 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
 
 #include <string>
 
@@ -18,15 +23,33 @@
 #include "Socket.h"
 #include "SocketServiceHandler.h"
 #include "SocketRequest.h"
-#include "MutexLock.h"
 #include "Logger.h"
 #include "ServerSocket.h"
 #include "BasicException.h"
 #include "ThreadingFactory.h"
+#include "MutexLock.h"
 
 using namespace std;
 using namespace chaudiere;
 
+// the idle timing wheel advances once a second; timeouts longer than one
+// revolution just carry extra rounds
+static const int IDLE_WHEEL_MAX_SLOTS = 4096;
+
+// event tag layout: fd in bits 0-31, generation in bits 32-61, and bits
+// 62-63 left to the kernel event server
+static const int           EVENT_TAG_GENERATION_SHIFT = 32;
+static const std::uint64_t EVENT_TAG_GENERATION_MASK  = 0x3FFFFFFF;
+static const std::uint64_t EVENT_TAG_MASK             = (std::uint64_t(1) << 62) - 1;
+
+// output sent by the event loop (or ahead of it) must never block, and a
+// peer that went away must not raise SIGPIPE
+#ifdef MSG_NOSIGNAL
+static const int NON_BLOCKING_SEND_FLAGS = MSG_DONTWAIT | MSG_NOSIGNAL;
+#else
+static const int NON_BLOCKING_SEND_FLAGS = MSG_DONTWAIT;
+#endif
+
 //******************************************************************************
 
 KernelEventServer::KernelEventServer(Mutex& fdMutex,
@@ -34,9 +57,22 @@ KernelEventServer::KernelEventServer(Mutex& fdMutex,
                                      const std::string& serverName) :
    m_serverPort(0),
    m_maxConnections(0),
-   m_listenBacklog(10),
+   m_listenBacklog(SOMAXCONN),
    m_listenerFD(-1),
-   m_numberEventsReturned(0) {
+   m_numberEventsReturned(0),
+   m_acceptedConnections(0),
+   m_acceptFailures(0),
+   m_acceptBatches(0),
+   m_idleConnectionsClosed(0),
+   m_deferredWrites(0),
+   m_idleTick(0),
+   m_idleTimeout(0),
+   m_idleTimerFD(-1),
+   m_wakeupReadFD(-1),
+   m_wakeupWriteFD(-1),
+   m_stopRequested(false),
+   m_reusePort(false),
+   m_oneShot(false) {
 }
 
 //******************************************************************************
@@ -45,6 +81,18 @@ KernelEventServer::~KernelEventServer() {
    if (-1 != m_listenerFD) {
       ::close(m_listenerFD);
    }
+
+   if (-1 != m_idleTimerFD) {
+      ::close(m_idleTimerFD);
+   }
+
+   if (-1 != m_wakeupReadFD) {
+      ::close(m_wakeupReadFD);
+   }
+
+   if (-1 != m_wakeupWriteFD) {
+      ::close(m_wakeupWriteFD);
+   }
 }
 
 //******************************************************************************
@@ -71,8 +119,20 @@ bool KernelEventServer::init(SocketServiceHandler* socketServiceHandler,
       return false;
    }
 
-   ThreadingFactory* tf = ThreadingFactory::getThreadingFactory();
-   m_busyFlagsMutex.reset(tf->createMutex("busyFlags"));
+   m_connectionStates.reset(new ConnectionStateTable());
+   m_pendingOutputMutex.reset(ThreadingFactory::getThreadingFactory()->createMutex("pendingOutput"));
+
+   // with one-shot registration, client fds stay registered for their
+   // whole lifetime and are just re-armed after each request
+   m_oneShot = isOneShotSupported();
+
+   if (m_idleTimeout > 0 && !createIdleTimer()) {
+      return false;
+   }
+
+   if (!createWakeupPipe()) {
+      return false;
+   }
 
    m_listenerFD = Socket::createSocket();
    if (m_listenerFD == -1) {
@@ -85,11 +145,23 @@ bool KernelEventServer::init(SocketServiceHandler* socketServiceHandler,
       return false;
    }
 
+   if (m_reusePort && !ServerSocket::setReusePort(m_listenerFD)) {
+      Logger::critical("unable to set REUSEPORT for socket");
+      return false;
+   }
+
    if (!ServerSocket::bind(m_listenerFD, m_serverPort)) {
       Logger::critical("bind failed");
       return false;
    }
 
+   // the listener is drained until accept() has nothing more to give, which
+   // must not block the event loop
+   if (!ServerSocket::setNonBlocking(m_listenerFD)) {
+      Logger::critical("unable to set listener socket non-blocking");
+      return false;
+   }
+
    if (!ServerSocket::listen(m_listenerFD, m_listenBacklog)) {
       Logger::critical("listen failed");
       return false;
@@ -100,27 +172,162 @@ bool KernelEventServer::init(SocketServiceHandler* socketServiceHandler,
 
 //******************************************************************************
 
-bool KernelEventServer::isValidDescriptor(int fd) const {
-   // fcntl(F_GETFD) returns the fd's flags (>= 0) if fd is open, or -1
-   // (with errno set to EBADF) if it isn't -- it never returns EBADF as
-   // its actual return value, so that can't be compared against directly.
-   // F_GETFD is POSIX and available on Linux, FreeBSD, and macOS alike.
-   return ::fcntl(fd, F_GETFD) != -1;
+bool KernelEventServer::createIdleTimer() {
+#ifdef __linux__
+   m_idleTimerFD = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+   if (m_idleTimerFD == -1) {
+      Logger::critical("unable to create idle timer");
+      return false;
+   }
+
+   struct itimerspec interval;
+   ::memset(&interval, 0, sizeof(interval));
+   interval.it_value.tv_sec = 1;
+   interval.it_interval.tv_sec = 1;
+
+   if (::timerfd_settime(m_idleTimerFD, 0, &interval, nullptr) != 0) {
+      Logger::critical("unable to start idle timer");
+      return false;
+   }
+
+   const int numberSlots = (m_idleTimeout < IDLE_WHEEL_MAX_SLOTS) ?
+      m_idleTimeout + 1 : IDLE_WHEEL_MAX_SLOTS;
+   m_idleWheel.reset(new TimingWheel(numberSlots));
+#else
+   Logger::warning("idle timeout not supported on this platform; idle connections are kept");
+#endif
+
+   return true;
 }
 
 //******************************************************************************
 
-void KernelEventServer::run() {
+bool KernelEventServer::createWakeupPipe() {
+   int fds[2];
+   if (::pipe(fds) != 0) {
+      Logger::critical("unable to create event loop wakeup pipe");
+      return false;
+   }
+
+   m_wakeupReadFD = fds[0];
+   m_wakeupWriteFD = fds[1];
+
+   // neither end may block: the loop drains whatever is there, and a stop
+   // request is already pending if the pipe is full
+   for (int fd : fds) {
+      ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+      ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+std::uint64_t KernelEventServer::getEventTag(int fd) const {
+   const std::uint64_t generation = m_connectionStates ?
+      m_connectionStates->getGeneration(fd) : 0;
+
+   return ((generation & EVENT_TAG_GENERATION_MASK) << EVENT_TAG_GENERATION_SHIFT) |
+          static_cast<std::uint32_t>(fd);
+}
+
+//******************************************************************************
+
+bool KernelEventServer::isCurrentEventTag(std::uint64_t eventTag) const {
+   const int fd = static_cast<int>(static_cast<std::uint32_t>(eventTag));
+   return (eventTag & EVENT_TAG_MASK) == getEventTag(fd);
+}
+
+//******************************************************************************
+
+std::uint64_t KernelEventServer::eventTagForEventIndex(int eventIndex) {
+   return getEventTag(fileDescriptorForEventIndex(eventIndex));
+}
+
+//******************************************************************************
+
+int KernelEventServer::acceptConnections() {
    struct sockaddr_in clientaddr;
-   socklen_t addrlen = sizeof(clientaddr);
-   int newfd;
+   socklen_t addrlen;
+   int numberAccepted = 0;
+
+   m_acceptBatches.fetch_add(1, std::memory_order_relaxed);
+
+   for (;;) {
+      addrlen = sizeof(clientaddr);
+#ifdef __linux__
+      // client sockets stay blocking -- handlers service them with
+      // Socket's blocking reads and writes
+      const int newfd = ::accept4(m_listenerFD,
+                                  (struct sockaddr *)&clientaddr,
+                                  &addrlen,
+                                  SOCK_CLOEXEC);
+#else
+      const int newfd = ::accept(m_listenerFD,
+                                 (struct sockaddr *)&clientaddr,
+                                 &addrlen);
+      if (newfd != -1) {
+         ::fcntl(newfd, F_SETFD, FD_CLOEXEC);
+      }
+#endif
+
+      if (newfd == -1) {
+         if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // backlog drained
+            break;
+         } else if (errno == EINTR) {
+            continue;
+         } else if (errno == ECONNABORTED) {
+            // the connection went away while queued; keep draining
+            m_acceptFailures.fetch_add(1, std::memory_order_relaxed);
+            continue;
+         } else {
+            // e.g. EMFILE/ENFILE -- leave the rest queued for a later pass
+            m_acceptFailures.fetch_add(1, std::memory_order_relaxed);
+            Logger::warning("server accept failed");
+            break;
+         }
+      }
+
+      ++numberAccepted;
+      m_acceptedConnections.fetch_add(1, std::memory_order_relaxed);
+
+      // the fd number may be a reused one; drop anything left
+      // over from the connection that previously had it
+      removeBusyFD(newfd);
+      if (!armFileDescriptorForRead(newfd)) {
+         Logger::critical("kernel event server failed adding read filter");
+         ::close(newfd);
+      } else if (m_idleWheel) {
+         touchFD(newfd);
+         scheduleIdleCheck(newfd, m_idleTimeout);
+      }
+   }
+
+   return numberAccepted;
+}
+
+//******************************************************************************
+
+void KernelEventServer::run() {
    //char msg[128];
 
    const std::string& handlerName = m_socketServiceHandler->getName();
 
    Logger::info(std::string("using handler: ") + handlerName);
 
-   for (;;) {
+   // the timer stays registered (level-triggered) for the life of the loop
+   if (m_idleTimerFD != -1 && !addFileDescriptorForRead(m_idleTimerFD)) {
+      Logger::critical("unable to add idle timer for read");
+   }
+
+   // as is the wakeup pipe, so that stop() can interrupt a wait
+   if (m_wakeupReadFD != -1 && !addFileDescriptorForRead(m_wakeupReadFD)) {
+      Logger::critical("unable to add wakeup pipe for read");
+   }
+
+   while (!m_stopRequested.load(std::memory_order_acquire)) {
 
       m_numberEventsReturned = getKernelEvents(m_maxConnections);
 
@@ -128,75 +335,77 @@ void KernelEventServer::run() {
          continue;
       }
 
+      const std::uint64_t wakeTime = EventLoopStats::now();
+      m_eventLoopStats.recordWake(m_numberEventsReturned);
+
       for (int index = 0; index < m_numberEventsReturned; ++index) {
 
          const int client_fd = fileDescriptorForEventIndex(index);
 
          if (client_fd == m_listenerFD) {
-            newfd = ::accept(m_listenerFD, (struct sockaddr *)&clientaddr, &addrlen);
-            if (newfd == -1) {
-               Logger::warning("server accept failed");
-            } else {
-               if (!addFileDescriptorForRead(newfd)) {
-                  Logger::critical("kernel event server failed adding read filter");
-               }
-            }
+            m_eventLoopStats.countBranch(EventLoopStats::Branch::Accept);
+            acceptConnections();
+         } else if (client_fd == m_idleTimerFD) {
+            m_eventLoopStats.countBranch(EventLoopStats::Branch::IdleTimer);
+            handleIdleTimerEvent();
+         } else if (client_fd == m_wakeupReadFD) {
+            // the loop condition sees the stop request once this batch is done
+            handleWakeupEvent();
          } else {
             if (client_fd == 0) {
                continue;
             }
 
-            if (!isValidDescriptor(client_fd)) {
-               removeBusyFD(client_fd);
-               removeFileDescriptorFromRead(client_fd);
+            if (!isCurrentEventTag(eventTagForEventIndex(index))) {
+               // queued for a connection that has since been closed (the
+               // fd number may already belong to a new one)
+               m_eventLoopStats.countBranch(EventLoopStats::Branch::StaleEvent);
                continue;
             }
 
-            if (isEventReadClose(index)) {
+            if (getInterestState(client_fd) == InterestState::WriteArmed) {
+               m_eventLoopStats.countBranch(EventLoopStats::Branch::Write);
+               handleWriteEvent(client_fd);
+               continue;
+            }
+
+            // every delivered event disarms a one-shot registration
+            if (m_oneShot) {
+               disarmFileDescriptorForRead(client_fd);
+            }
+
+            if (isEventReadClose(index) || isEventDisconnect(index)) {
+               m_eventLoopStats.countBranch(isEventReadClose(index) ?
+                                            EventLoopStats::Branch::ReadClose :
+                                            EventLoopStats::Branch::Disconnect);
+
                // don't close out from under a worker thread that's still
-               // actively processing a dispatched request on this fd
+               // actively processing a dispatched request on this fd.
+               // in one-shot mode the worker's completion re-arms the fd,
+               // and the still-pending hangup is reported again then.
                if (!isBusyFD(client_fd)) {
-                  removeBusyFD(client_fd);
-                  if (!removeFileDescriptorFromRead(client_fd)) {
-                     Logger::warning("kernel event server failed to delete read filter");
-                  }
-                  ::close(client_fd);
-               }
-            } else if (isEventDisconnect(index)) {
-               if (!isBusyFD(client_fd)) {
-                  removeBusyFD(client_fd);
-                  if (!removeFileDescriptorFromRead(client_fd)) {
-                     Logger::warning("kernel event server failed to delete read filter");
-                  }
-                  ::close(client_fd);
+                  closeClientFD(client_fd);
                }
             } else if (isEventRead(index)) {
-               if (removeFileDescriptorFromRead(client_fd)) {
+               m_eventLoopStats.countBranch(EventLoopStats::Branch::Read);
+
+               if (m_oneShot || disarmFileDescriptorForRead(client_fd)) {
                   // are we already busy with this socket?
                   const bool isAlreadyBusy = isBusyFD(client_fd);
 
                   if (!isAlreadyBusy) {
-                     //if (!removeFileDescriptorFromRead(client_fd)) {
-                     //   Logger::error("unable to remove file descriptor from read");
-                     //}
-
                      setBusyFD(client_fd, true);
+                     touchFD(client_fd);
 
                      SocketRequest* socketRequest =
-                        new SocketRequest(this, client_fd, nullptr);
+                        SocketRequest::create(this, client_fd, nullptr);
                      socketRequest->setSocketOwned(false);
                      socketRequest->setUserIndex(index);
                      socketRequest->setAutoDelete();
+                     socketRequest->setDispatchStats(&m_eventLoopStats, wakeTime);
 
-                     try {
-                        m_socketServiceHandler->serviceSocket(socketRequest);
-                     } catch (const BasicException& be) {
-                        Logger::error("exception in serviceSocket on handler: " + be.whatString());
-                     } catch (const std::exception& e) {
-                        Logger::error("exception in serviceSocket on handler: " + std::string(e.what()));
-                     } catch (...) {
-                        Logger::error("exception in serviceSocket on handler");
-                     }
+                     // serviced together once the whole batch is handled
+                     m_readyRequests.push_back(socketRequest);
                   } else {
                      //::snprintf(msg, 128, "already busy with socket %d", client_fd);
                      //Logger::warning(msg);
@@ -208,7 +417,45 @@ void KernelEventServer::run() {
             }
          }
       }
-   }  // for (;;)
+
+      if (!m_readyRequests.empty()) {
+         try {
+            m_socketServiceHandler->serviceSockets(m_readyRequests);
+         } catch (const BasicException& be) {
+            Logger::error("exception in serviceSockets on handler: " + be.whatString());
+         } catch (const std::exception& e) {
+            Logger::error("exception in serviceSockets on handler: " + std::string(e.what()));
+         } catch (...) {
+            Logger::error("exception in serviceSockets on handler");
+         }
+
+         m_readyRequests.clear();
+      }
+
+      m_eventLoopStats.recordBatchTime(EventLoopStats::now() - wakeTime);
+   }  // while (!m_stopRequested)
+}
+
+//******************************************************************************
+
+void KernelEventServer::stop() {
+   m_stopRequested.store(true, std::memory_order_release);
+
+   if (m_wakeupWriteFD != -1) {
+      const char wakeup = 'x';
+      // a full pipe (EAGAIN) already has a wakeup pending
+      if (::write(m_wakeupWriteFD, &wakeup, 1) < 0 && errno != EAGAIN) {
+         Logger::error("unable to wake event loop");
+      }
+   }
+}
+
+//******************************************************************************
+
+void KernelEventServer::handleWakeupEvent() {
+   char buffer[64];
+   while (::read(m_wakeupReadFD, buffer, sizeof(buffer)) > 0) {
+   }
 }
 
 //******************************************************************************
@@ -219,24 +466,408 @@ void KernelEventServer::notifySocketComplete(Socket* socket) {
       return;
    }
 
+   // the request counts as activity. recorded before the busy flag is
+   // cleared so the idle expiry never sees the fd as both idle and stale.
+   touchFD(socketFD);
+
+   if (m_connectionStates->hasPendingOutput(socketFD)) {
+      // the request isn't done until its queued output is sent; the fd
+      // stays busy and the event loop finishes the request
+      if (socket->isConnected() && armFileDescriptorForWrite(socketFD)) {
+         return;
+      }
+
+      discardPendingOutput(socketFD);
+   }
+
    // mark the fd as not being busy anymore
    setBusyFD(socketFD, false);
 
-   if (!isValidDescriptor(socketFD)) {
-      //if (!removeFileDescriptorFromRead(socketFD)) {
-      //   Logger::error("unable to remove file descriptor from read");
-      //}
-      removeBusyFD(socketFD);
+   // the socket still holds the fd open, so it can't have been reused
+   if (socket->isConnected()) {
+      // add socket back to watch (re-arming it if it's still registered)
+      if (!armFileDescriptorForRead(socketFD)) {
+         Logger::critical("kernel event add read filter failed");
+      }
    } else {
-      // add socket back to watch
-      if (socket->isConnected()) {
-         if (!addFileDescriptorForRead(socketFD)) {
-            Logger::critical("kernel event add read filter failed");
+      removeBusyFD(socketFD);
+   }
+}
+
+//******************************************************************************
+
+void KernelEventServer::notifySocketDropped(Socket* socket) {
+   // the fd is still busy (so the event loop leaves it alone) and its
+   // registration is disarmed, so nothing else will ever close it
+   const int socketFD = socket->releaseFileDescriptor();
+   if (socketFD == -1) {
+      return;
+   }
+
+   // this runs on a worker thread, so unlike closeClientFD it leaves the
+   // idle wheel alone -- resetting the fd's state makes its entry stale.
+   // the reset comes before the close, since the fd number can be reused
+   // by the next accept as soon as it's closed.
+   discardPendingOutput(socketFD);
+   removeBusyFD(socketFD);
+   ::close(socketFD);
+}
+
+//******************************************************************************
+
+bool KernelEventServer::isAsyncWriteSupported() const {
+   return m_oneShot && isOneShotWriteSupported();
+}
+
+//******************************************************************************
+
+bool KernelEventServer::writeAsync(int socketFD,
+                                   const char* buffer,
+                                   std::size_t bufferLength) {
+   if (!m_connectionStates->hasPendingOutput(socketFD)) {
+      // nothing queued ahead of this, so whatever the socket buffer has
+      // room for can go out right now (usually all of it)
+      while (bufferLength > 0) {
+         const ssize_t bytesSent =
+            ::send(socketFD, buffer, bufferLength, NON_BLOCKING_SEND_FLAGS);
+         if (bytesSent > 0) {
+            buffer += bytesSent;
+            bufferLength -= bytesSent;
+         } else if (bytesSent < 0 && errno == EINTR) {
+            continue;
+         } else if (bytesSent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+         } else {
+            return false;
          }
+      }
+
+      if (bufferLength == 0) {
+         return true;
+      }
+   }
+
+   {
+      MutexLock locker(*m_pendingOutputMutex);
+      PendingOutput& output = m_pendingOutput[socketFD];
+
+      if (m_connectionStates->hasPendingOutput(socketFD)) {
+         output.data.append(buffer, bufferLength);
       } else {
-         removeBusyFD(socketFD);
+         // anything left in the entry belongs to an earlier connection
+         // that was closed before its output was sent
+         output.data.assign(buffer, bufferLength);
+         output.offset = 0;
       }
    }
+
+   m_connectionStates->setPendingOutput(socketFD, true);
+   m_deferredWrites.fetch_add(1, std::memory_order_relaxed);
+
+   return true;
+}
+
+//******************************************************************************
+
+bool KernelEventServer::armFileDescriptorForWrite(int fd) {
+   // claimed before the kernel call, since the event can be delivered
+   // before the call even returns
+   m_connectionStates->setInterestState(fd, InterestState::WriteArmed);
+
+   if (rearmFileDescriptorForWrite(fd)) {
+      return true;
+   }
+
+   m_connectionStates->setInterestState(fd, InterestState::Disarmed);
+   return false;
+}
+
+//******************************************************************************
+
+void KernelEventServer::handleWriteEvent(int fd) {
+   // the one-shot write registration fired -- writable, or an error or
+   // hangup that the next send will report
+   m_connectionStates->compareAndSetInterestState(fd,
+                                                  InterestState::WriteArmed,
+                                                  InterestState::Disarmed);
+
+   PendingOutput* output = nullptr;
+
+   {
+      // the entry can only be erased by whoever has the connection (now
+      // this thread), so it stays valid after the lock is released
+      MutexLock locker(*m_pendingOutputMutex);
+      std::unordered_map<int, PendingOutput>::iterator it = m_pendingOutput.find(fd);
+      if (it != m_pendingOutput.end()) {
+         output = &it->second;
+      }
+   }
+
+   bool failed = false;
+
+   if (output != nullptr) {
+      while (output->offset < output->data.size()) {
+         const ssize_t bytesSent = ::send(fd,
+                                          output->data.data() + output->offset,
+                                          output->data.size() - output->offset,
+                                          NON_BLOCKING_SEND_FLAGS);
+         if (bytesSent > 0) {
+            output->offset += bytesSent;
+         } else if (bytesSent < 0 && errno == EINTR) {
+            continue;
+         } else if (bytesSent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+         } else {
+            failed = true;
+            break;
+         }
+      }
+   }
+
+   if (failed) {
+      closeClientFD(fd);
+   } else if (output != nullptr && output->offset < output->data.size()) {
+      // the peer is still reading; progress counts as activity
+      touchFD(fd);
+      if (!armFileDescriptorForWrite(fd)) {
+         Logger::critical("kernel event add write filter failed");
+         closeClientFD(fd);
+      }
+   } else {
+      // all sent, so the request is finally complete
+      discardPendingOutput(fd);
+      touchFD(fd);
+      setBusyFD(fd, false);
+      if (!armFileDescriptorForRead(fd)) {
+         Logger::critical("kernel event add read filter failed");
+      }
+   }
+}
+
+//******************************************************************************
+
+void KernelEventServer::discardPendingOutput(int fd) {
+   if (m_connectionStates->hasPendingOutput(fd)) {
+      {
+         MutexLock locker(*m_pendingOutputMutex);
+         m_pendingOutput.erase(fd);
+      }
+      m_connectionStates->setPendingOutput(fd, false);
+   }
+}
+
+//******************************************************************************
+
+bool KernelEventServer::isOneShotWriteSupported() const {
+   return false;
+}
+
+//******************************************************************************
+
+bool KernelEventServer::rearmFileDescriptorForWrite(int /*fileDescriptor*/) {
+   return false;
+}
+
+//******************************************************************************
+
+bool KernelEventServer::isOneShotSupported() const {
+   return false;
+}
+
+//******************************************************************************
+
+bool KernelEventServer::addFileDescriptorForOneShotRead(int fileDescriptor) {
+   return addFileDescriptorForRead(fileDescriptor);
+}
+
+//******************************************************************************
+
+bool KernelEventServer::rearmFileDescriptorForRead(int fileDescriptor) {
+   return addFileDescriptorForRead(fileDescriptor);
+}
+
+//******************************************************************************
+
+void KernelEventServer::setReusePort(bool reusePort) {
+   m_reusePort = reusePort;
+}
+
+//******************************************************************************
+
+bool KernelEventServer::isReusePort() const {
+   return m_reusePort;
+}
+
+//******************************************************************************
+
+void KernelEventServer::setListenBacklog(int listenBacklog) {
+   m_listenBacklog = listenBacklog;
+}
+
+//******************************************************************************
+
+int KernelEventServer::getListenBacklog() const {
+   return m_listenBacklog;
+}
+
+//******************************************************************************
+
+std::uint64_t KernelEventServer::getNumberAcceptedConnections() const {
+   return m_acceptedConnections.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+std::uint64_t KernelEventServer::getNumberAcceptFailures() const {
+   return m_acceptFailures.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+std::uint64_t KernelEventServer::getNumberAcceptBatches() const {
+   return m_acceptBatches.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void KernelEventServer::setIdleTimeout(int idleTimeoutSeconds) {
+   m_idleTimeout = (idleTimeoutSeconds > 0) ? idleTimeoutSeconds : 0;
+}
+
+//******************************************************************************
+
+int KernelEventServer::getIdleTimeout() const {
+   return m_idleTimeout;
+}
+
+//******************************************************************************
+
+std::uint64_t KernelEventServer::getNumberIdleConnectionsClosed() const {
+   return m_idleConnectionsClosed.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+std::uint64_t KernelEventServer::getNumberDeferredWrites() const {
+   return m_deferredWrites.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void KernelEventServer::getEventLoopStats(EventLoopStats::Snapshot& snapshot) const {
+   m_eventLoopStats.snapshot(snapshot);
+}
+
+//******************************************************************************
+
+int KernelEventServer::getIdleTimerFileDescriptor() const {
+   return m_idleTimerFD;
+}
+
+//******************************************************************************
+
+void KernelEventServer::touchFD(int fd) {
+   // called from the event loop and from worker threads, so this is only an
+   // atomic store; the wheel itself is left alone until the fd comes due
+   if (m_idleWheel) {
+      m_connectionStates->setLastActivity(fd, m_idleTick.load(std::memory_order_relaxed));
+   }
+}
+
+//******************************************************************************
+
+void KernelEventServer::scheduleIdleCheck(int fd, std::uint32_t ticksFromNow) {
+   if (static_cast<std::size_t>(fd) >= m_idleGenerations.size()) {
+      m_idleGenerations.resize(fd + 1);
+   }
+
+   // remembered so that a check for an fd number that has since been
+   // closed (and possibly reused) by someone else is recognized as stale
+   m_idleGenerations[fd] = m_connectionStates->getGeneration(fd);
+   m_idleWheel->schedule(fd, ticksFromNow);
+}
+
+//******************************************************************************
+
+void KernelEventServer::handleIdleTimerEvent() {
+#ifdef __linux__
+   std::uint64_t expirations = 0;
+   if (::read(m_idleTimerFD, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+      expireIdleConnections(expirations);
+   }
+#endif
+}
+
+//******************************************************************************
+
+int KernelEventServer::expireIdleConnections(std::uint64_t ticks) {
+   if (!m_idleWheel) {
+      return 0;
+   }
+
+   const std::uint32_t timeout = static_cast<std::uint32_t>(m_idleTimeout);
+   int numberClosed = 0;
+
+   for (std::uint64_t i = 0; i < ticks; ++i) {
+      const std::uint32_t tick = m_idleTick.fetch_add(1, std::memory_order_relaxed) + 1;
+
+      m_expiredFDs.clear();
+      m_idleWheel->advance(m_expiredFDs);
+
+      for (int fd : m_expiredFDs) {
+         if (m_connectionStates->getGeneration(fd) != m_idleGenerations[fd]) {
+            // closed (and reset) since it was scheduled
+            continue;
+         }
+
+         // a connection waiting on a slow reader is held by the event
+         // loop rather than a worker, and its progress is its activity
+         if (isBusyFD(fd) && getInterestState(fd) != InterestState::WriteArmed) {
+            scheduleIdleCheck(fd, timeout);
+            continue;
+         }
+
+         const std::uint32_t idle =
+            (tick - m_connectionStates->getLastActivity(fd)) &
+            ConnectionStateTable::ACTIVITY_TICK_MASK;
+
+         if (idle < timeout) {
+            scheduleIdleCheck(fd, timeout - idle);
+         } else {
+            closeIdleFD(fd);
+            ++numberClosed;
+         }
+      }
+   }
+
+   return numberClosed;
+}
+
+//******************************************************************************
+
+void KernelEventServer::closeIdleFD(int fd) {
+   closeClientFD(fd);
+   m_idleConnectionsClosed.fetch_add(1, std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void KernelEventServer::closeClientFD(int fd) {
+   // unlike epoll and kqueue, a pending io_uring poll keeps the socket alive
+   // past close(), so an armed registration is removed explicitly first.
+   // otherwise closing the fd drops its kernel registration, and removing
+   // it beforehand would be a wasted syscall.
+   const InterestState interest = getInterestState(fd);
+   if (interest == InterestState::Armed || interest == InterestState::WriteArmed) {
+      removeFileDescriptorFromRead(fd);
+   }
+
+   discardPendingOutput(fd);
+   removeBusyFD(fd);
+   if (m_idleWheel) {
+      m_idleWheel->cancel(fd);
+   }
+   ::close(fd);
 }
 
 //******************************************************************************
@@ -248,39 +879,86 @@ int KernelEventServer::getListenerSocketFileDescriptor() const {
 //******************************************************************************
 
 bool KernelEventServer::isBusyFD(int fd) const {
-   MutexLock locker(*m_busyFlagsMutex);
-   unordered_map<int,bool>::const_iterator it = m_busyFlags.find(fd);
-   if (it != m_busyFlags.end()) {
-      return it->second;
-   } else {
-      return false;
-   }
+   return m_connectionStates->isBusy(fd);
 }
 
 //******************************************************************************
 
 void KernelEventServer::setBusyFD(int fd, bool busy) {
-   MutexLock locker(*m_busyFlagsMutex);
-   unordered_map<int,bool>::iterator it = m_busyFlags.find(fd);
-   if (it != m_busyFlags.end()) {
-      it->second = busy;
-   } else {
-      m_busyFlags[fd] = busy;
-   }
+   m_connectionStates->setBusy(fd, busy);
 }
 
 //******************************************************************************
 
 bool KernelEventServer::removeBusyFD(int fd) {
-   MutexLock locker(*m_busyFlagsMutex);
-   unordered_map<int,bool>::iterator it = m_busyFlags.find(fd);
-   if (it != m_busyFlags.end()) {
-      m_busyFlags.erase(it);
+   return m_connectionStates->reset(fd);
+}
+
+//******************************************************************************
+
+KernelEventServer::InterestState KernelEventServer::getInterestState(int fd) const {
+   return m_connectionStates->getInterestState(fd);
+}
+
+//******************************************************************************
+
+bool KernelEventServer::armFileDescriptorForRead(int fd) {
+   // claim the Armed state *before* the kernel call: once the fd is armed
+   // an event can be delivered (and the fd marked Disarmed by the event
+   // loop) at any moment, which must not be overwritten afterwards. the
+   // compare-and-set also keeps two threads from both issuing the call.
+   for (;;) {
+      const InterestState current = m_connectionStates->getInterestState(fd);
+      if (current == InterestState::Armed) {
+         return true;
+      }
+
+      if (!m_connectionStates->compareAndSetInterestState(fd, current, InterestState::Armed)) {
+         continue;
+      }
+
+      bool armed;
+      if (current == InterestState::Disarmed) {
+         armed = rearmFileDescriptorForRead(fd);
+      } else if (m_oneShot) {
+         armed = addFileDescriptorForOneShotRead(fd);
+      } else {
+         armed = addFileDescriptorForRead(fd);
+      }
+
+      if (!armed) {
+         m_connectionStates->compareAndSetInterestState(fd, InterestState::Armed, current);
+      }
+
+      return armed;
+   }
+}
+
+//******************************************************************************
+
+bool KernelEventServer::disarmFileDescriptorForRead(int fd) {
+   if (m_oneShot) {
+      m_connectionStates->compareAndSetInterestState(fd,
+                                                     InterestState::Armed,
+                                                     InterestState::Disarmed);
+      return true;
+   }
+
+   if (!m_connectionStates->compareAndSetInterestState(fd,
+                                                       InterestState::Armed,
+                                                       InterestState::Unregistered)) {
+      // nothing registered with the kernel
+      return true;
+   }
+
+   if (removeFileDescriptorFromRead(fd)) {
       return true;
    } else {
+      m_connectionStates->compareAndSetInterestState(fd,
+                                                     InterestState::Unregistered,
+                                                     InterestState::Armed);
       return false;
    }
 }
 
 //******************************************************************************
-
@@ -4,9 +4,16 @@
 #ifndef CHAUDIERE_KERNELEVENTSERVER_H
 #define CHAUDIERE_KERNELEVENTSERVER_H
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "ConnectionStateTable.h"
+#include "EventLoopStats.h"
+#include "TimingWheel.h"
 #include "Socket.h"
 #include "SocketCompletionObserver.h"
 #include "Mutex.h"
@@ -15,6 +22,7 @@
 namespace chaudiere
 {
    class Mutex;
+   class SocketRequest;
    class SocketServiceHandler;
 
 /**
@@ -56,6 +64,12 @@ public:
     */
    virtual void run();
 
+   /**
+    * Asks the event loop to return from run(), waking it if it's waiting
+    * for events. May be called from any thread, and before run() starts.
+    */
+   void stop();
+
    /**
     *
     * @param maxConnections
@@ -70,6 +84,15 @@ public:
     */
    virtual int fileDescriptorForEventIndex(int eventIndex) = 0;
 
+   /**
+    * Retrieves the event tag (see getEventTag) that the file descriptor was
+    * registered with for the event. The default implementation returns the
+    * file descriptor's current tag, i.e., it can't detect stale events.
+    * @param eventIndex
+    * @return the event tag
+    */
+   virtual std::uint64_t eventTagForEventIndex(int eventIndex);
+
    /**
     *
     * @param fileDescriptor
@@ -84,6 +107,47 @@ public:
     */
    virtual bool removeFileDescriptorFromRead(int fileDescriptor) = 0;
 
+   /**
+    * Determines whether the kernel event mechanism can register a file
+    * descriptor for one-shot read notification (disarmed by the kernel
+    * once an event is delivered, then re-armed without re-registering)
+    * @return boolean indicating if one-shot registration is supported
+    */
+   virtual bool isOneShotSupported() const;
+
+   /**
+    * Registers a file descriptor for one-shot read notification. The
+    * default implementation falls back to addFileDescriptorForRead.
+    * @param fileDescriptor the file descriptor to register
+    * @return boolean indicating if the file descriptor was registered
+    */
+   virtual bool addFileDescriptorForOneShotRead(int fileDescriptor);
+
+   /**
+    * Re-arms a file descriptor previously registered for one-shot read
+    * notification whose event has since been delivered. The default
+    * implementation falls back to addFileDescriptorForRead.
+    * @param fileDescriptor the file descriptor to re-arm
+    * @return boolean indicating if the file descriptor was re-armed
+    */
+   virtual bool rearmFileDescriptorForRead(int fileDescriptor);
+
+   /**
+    * Determines whether the kernel event mechanism can switch a one-shot
+    * registration over to write readiness (needed for writeAsync)
+    * @return boolean indicating if one-shot write notification is supported
+    */
+   virtual bool isOneShotWriteSupported() const;
+
+   /**
+    * Re-arms a file descriptor previously registered for one-shot read
+    * notification whose event has since been delivered, but for write
+    * readiness instead of read. The default implementation fails.
+    * @param fileDescriptor the file descriptor to re-arm
+    * @return boolean indicating if the file descriptor was re-armed
+    */
+   virtual bool rearmFileDescriptorForWrite(int fileDescriptor);
+
    /**
     *
     * @param eventIndex
@@ -111,14 +175,178 @@ public:
     */
    void notifySocketComplete(Socket* socket);
 
+   /**
+    * Closes the connection of a request that was dropped before it ran
+    * @param socket the socket whose request was dropped
+    */
+   void notifySocketDropped(Socket* socket);
+
+   /**
+    * @return whether client sockets can hand output to the event loop
+    * (requires one-shot read and write notification)
+    */
+   virtual bool isAsyncWriteSupported() const;
+
+   /**
+    * Sends what the socket takes right away and queues the rest for the
+    * event loop, which sends it as the socket becomes writable. Called by a
+    * worker thread while it has the connection; once it completes the
+    * request, the connection only goes back to being watched for read
+    * after the queued output has been sent.
+    * @param socketFD the client socket's file descriptor
+    * @param buffer the bytes to write
+    * @param bufferLength the number of bytes to write
+    * @return boolean indicating whether the write was accepted
+    */
+   virtual bool writeAsync(int socketFD, const char* buffer, std::size_t bufferLength);
+
+   /**
+    * Sets whether init() creates its listener with SO_REUSEPORT, so that
+    * several KernelEventServer instances (each run on its own thread) can
+    * listen on the same port and have the kernel spread incoming
+    * connections across them. Must be called before init().
+    * @param reusePort whether the listener should be created with SO_REUSEPORT
+    */
+   void setReusePort(bool reusePort);
+
+   /**
+    * @return whether the listener is (or will be) created with SO_REUSEPORT
+    */
+   bool isReusePort() const;
+
+   /**
+    * Sets the backlog passed to listen() for the listener. Must be called
+    * before init(). Defaults to SOMAXCONN.
+    * @param listenBacklog the listen backlog
+    */
+   void setListenBacklog(int listenBacklog);
+
+   /**
+    * @return the listen backlog used for the listener
+    */
+   int getListenBacklog() const;
+
+   /**
+    * @return number of client connections accepted so far
+    */
+   std::uint64_t getNumberAcceptedConnections() const;
+
+   /**
+    * @return number of accept calls that failed with a real error (i.e.,
+    * not just "no more pending connections")
+    */
+   std::uint64_t getNumberAcceptFailures() const;
+
+   /**
+    * @return number of times the listener was reported ready and drained
+    */
+   std::uint64_t getNumberAcceptBatches() const;
+
+   /**
+    * Sets how long a client connection may sit idle (no events and no
+    * request in progress) before the event loop closes it. Idle connections
+    * are tracked on a timing wheel advanced once a second by a timerfd, so
+    * the timeout has one second granularity. Must be called before init().
+    * Not supported on platforms without timerfd.
+    * @param idleTimeoutSeconds the idle timeout in seconds (0 disables it)
+    */
+   void setIdleTimeout(int idleTimeoutSeconds);
+
+   /**
+    * @return the idle timeout in seconds (0 if idle connections are kept)
+    */
+   int getIdleTimeout() const;
+
+   /**
+    * @return number of client connections closed for being idle
+    */
+   std::uint64_t getNumberIdleConnectionsClosed() const;
+
+   /**
+    * @return number of asynchronous writes that couldn't be sent right away
+    * and were queued for the event loop
+    */
+   std::uint64_t getNumberDeferredWrites() const;
+
+   /**
+    * Copies the event loop's statistics (events per wake, batch processing
+    * time, dispatch latency, and branch counts). Safe to call from any
+    * thread while the loop runs.
+    * @param snapshot receives the statistics
+    * @see EventLoopStats()
+    */
+   void getEventLoopStats(EventLoopStats::Snapshot& snapshot) const;
+
 
 protected:
+   typedef ConnectionStateTable::InterestState InterestState;
+
    /**
     *
     * @return
     */
    int getListenerSocketFileDescriptor() const;
 
+   /**
+    * Retrieves the tag to register a file descriptor with as the user data
+    * of its kernel event: the fd in the low 32 bits and its current
+    * generation above that. The top two bits are always clear and free for
+    * a kernel event server's own use.
+    * @param fd the file descriptor
+    * @return the event tag
+    */
+   std::uint64_t getEventTag(int fd) const;
+
+   /**
+    * Determines whether an event tag belongs to the connection currently on
+    * its file descriptor (i.e., the fd hasn't been closed and reused since
+    * it was registered). The top two bits of the tag are ignored.
+    * @param eventTag the event tag
+    * @return boolean indicating if the tag is current
+    */
+   bool isCurrentEventTag(std::uint64_t eventTag) const;
+
+   /**
+    * Retrieves the tracked kernel interest state for a file descriptor
+    * @param fd the file descriptor
+    * @return the interest state (Unregistered if the fd isn't tracked)
+    */
+   InterestState getInterestState(int fd) const;
+
+   /**
+    * Makes sure the file descriptor is armed for read notification, issuing
+    * the registration (or one-shot re-arm) only when the tracked interest
+    * state says the kernel doesn't already have it armed
+    * @param fd the file descriptor to arm
+    * @return boolean indicating if the file descriptor is armed
+    */
+   bool armFileDescriptorForRead(int fd);
+
+   /**
+    * Switches a file descriptor whose one-shot read event was delivered over
+    * to one-shot write notification
+    * @param fd the file descriptor to arm
+    * @return boolean indicating if the file descriptor is armed for write
+    */
+   bool armFileDescriptorForWrite(int fd);
+
+   /**
+    * Sends queued output for a file descriptor whose write notification
+    * fired, completing its request once everything has gone out
+    * @param fd the file descriptor
+    */
+   void handleWriteEvent(int fd);
+
+   /**
+    * Stops read notification for a file descriptor that just had an event
+    * delivered. In one-shot mode the kernel has already disarmed it, so
+    * only the tracked state changes; otherwise it is removed from the
+    * kernel event mechanism.
+    * @param fd the file descriptor to disarm
+    * @return boolean indicating if the file descriptor is disarmed
+    */
+   bool disarmFileDescriptorForRead(int fd);
+
    /**
     *
     * @param fd
@@ -134,28 +362,83 @@ protected:
    void setBusyFD(int fd, bool busy);
 
    /**
-    *
+    * Forgets all tracked state (busy flag and interest state) for a file
+    * descriptor and advances its generation, which makes any event still
+    * queued for it stale
     * @param fd
     */
    bool removeBusyFD(int fd);
 
    /**
-    *
-    * @param fd
-    * @return
+    * Accepts every connection pending on the (non-blocking) listener and
+    * registers each for read
+    * @return number of connections accepted
+    */
+   int acceptConnections();
+
+   /**
+    * Retrieves the file descriptor of the timer that drives idle expiry
+    * @return the timer file descriptor, or -1 if there's no idle timeout
     */
-   bool isValidDescriptor(int fd) const;
+   int getIdleTimerFileDescriptor() const;
+
+   /**
+    * Advances the idle timing wheel, closing connections that have been
+    * idle for the idle timeout. Connections busy with a request or active
+    * since they were scheduled are rescheduled instead.
+    * @param ticks number of ticks (seconds) to advance
+    * @return number of connections closed
+    */
+   int expireIdleConnections(std::uint64_t ticks);
 
 
 private:
+   bool createIdleTimer();
+   void handleIdleTimerEvent();
+   bool createWakeupPipe();
+   void handleWakeupEvent();
+   void touchFD(int fd);
+   void scheduleIdleCheck(int fd, std::uint32_t ticksFromNow);
+   void closeIdleFD(int fd);
+   void closeClientFD(int fd);
+   void discardPendingOutput(int fd);
+
+   struct PendingOutput {
+      PendingOutput() :
+         offset(0) {
+      }
+
+      std::string data;
+      std::size_t offset;
+   };
+
    std::unique_ptr<SocketServiceHandler> m_socketServiceHandler;
-   std::unordered_map<int,bool> m_busyFlags;
-   std::unique_ptr<Mutex> m_busyFlagsMutex;
+   std::unique_ptr<ConnectionStateTable> m_connectionStates;
+   std::unique_ptr<Mutex> m_pendingOutputMutex;
+   std::unordered_map<int, PendingOutput> m_pendingOutput;
    int m_serverPort;
    int m_maxConnections;
    int m_listenBacklog;
    int m_listenerFD;
    int m_numberEventsReturned;
+   std::atomic<std::uint64_t> m_acceptedConnections;
+   std::atomic<std::uint64_t> m_acceptFailures;
+   std::atomic<std::uint64_t> m_acceptBatches;
+   std::atomic<std::uint64_t> m_idleConnectionsClosed;
+   std::atomic<std::uint64_t> m_deferredWrites;
+   std::atomic<std::uint32_t> m_idleTick;
+   EventLoopStats m_eventLoopStats;
+   std::unique_ptr<TimingWheel> m_idleWheel;
+   std::vector<int> m_expiredFDs;
+   std::vector<SocketRequest*> m_readyRequests;
+   std::vector<std::uint32_t> m_idleGenerations;
+   int m_idleTimeout;
+   int m_idleTimerFD;
+   int m_wakeupReadFD;
+   int m_wakeupWriteFD;
+   std::atomic<bool> m_stopRequested;
+   bool m_reusePort;
+   bool m_oneShot;
 
    // copying not allowed
    KernelEventServer(const KernelEventServer&);
@@ -130,10 +130,26 @@ int KqueueServer::fileDescriptorForEventIndex(int eventIndex) {
 
 //******************************************************************************
 
+std::uint64_t KqueueServer::eventTagForEventIndex(int eventIndex) {
+#ifdef KQUEUE_SUPPORT
+   // udata only has room for the whole tag with 64-bit pointers
+   if (sizeof(void*) < sizeof(std::uint64_t)) {
+      return KernelEventServer::eventTagForEventIndex(eventIndex);
+   }
+
+   return (std::uint64_t) (std::uintptr_t) m_events[eventIndex].udata;
+#else
+   return KernelEventServer::eventTagForEventIndex(eventIndex);
+#endif
+}
+
+//******************************************************************************
+
 bool KqueueServer::addFileDescriptorForRead(int fileDescriptor) {
 #ifdef KQUEUE_SUPPORT
    struct kevent ev;
-   EV_SET(&ev, fileDescriptor, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+   EV_SET(&ev, fileDescriptor, EVFILT_READ, EV_ADD, 0, 0,
+          (void*) (std::uintptr_t) getEventTag(fileDescriptor));
 
    if (::kevent(m_kqfd, &ev, 1, nullptr, 0, nullptr) < 0) {
       LOG_CRITICAL("kevent failed adding read filter")
@@ -165,6 +181,82 @@ bool KqueueServer::removeFileDescriptorFromRead(int fileDescriptor) {
 
 //******************************************************************************
 
+bool KqueueServer::isOneShotSupported() const {
+#ifdef KQUEUE_SUPPORT
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+bool KqueueServer::addFileDescriptorForOneShotRead(int fileDescriptor) {
+#ifdef KQUEUE_SUPPORT
+   // EV_DISPATCH disables (but keeps) the filter once its event is delivered
+   struct kevent ev;
+   EV_SET(&ev, fileDescriptor, EVFILT_READ, EV_ADD | EV_DISPATCH, 0, 0,
+          (void*) (std::uintptr_t) getEventTag(fileDescriptor));
+
+   if (::kevent(m_kqfd, &ev, 1, nullptr, 0, nullptr) < 0) {
+      LOG_CRITICAL("kevent failed adding one-shot read filter")
+   } else {
+      return true;
+   }
+#endif
+
+   return false;
+}
+
+//******************************************************************************
+
+bool KqueueServer::rearmFileDescriptorForRead(int fileDescriptor) {
+#ifdef KQUEUE_SUPPORT
+   struct kevent ev;
+   EV_SET(&ev, fileDescriptor, EVFILT_READ, EV_ENABLE | EV_DISPATCH, 0, 0,
+          (void*) (std::uintptr_t) getEventTag(fileDescriptor));
+
+   if (::kevent(m_kqfd, &ev, 1, nullptr, 0, nullptr) < 0) {
+      LOG_CRITICAL("kevent failed re-enabling read filter")
+   } else {
+      return true;
+   }
+#endif
+
+   return false;
+}
+
+//******************************************************************************
+
+bool KqueueServer::isOneShotWriteSupported() const {
+#ifdef KQUEUE_SUPPORT
+   return true;
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+bool KqueueServer::rearmFileDescriptorForWrite(int fileDescriptor) {
+#ifdef KQUEUE_SUPPORT
+   // a separate filter; the read filter stays disabled until re-enabled
+   struct kevent ev;
+   EV_SET(&ev, fileDescriptor, EVFILT_WRITE, EV_ADD | EV_ONESHOT, 0, 0,
+          (void*) (std::uintptr_t) getEventTag(fileDescriptor));
+
+   if (::kevent(m_kqfd, &ev, 1, nullptr, 0, nullptr) < 0) {
+      LOG_CRITICAL("kevent failed adding one-shot write filter")
+   } else {
+      return true;
+   }
+#endif
+
+   return false;
+}
+
+//******************************************************************************
+
 bool KqueueServer::isEventDisconnect(int eventIndex) {
 #ifdef KQUEUE_SUPPORT
    return m_events[eventIndex].flags & EV_EOF;
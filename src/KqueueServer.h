@@ -70,6 +70,13 @@ public:
     */
    virtual int fileDescriptorForEventIndex(int eventIndex);
 
+   /**
+    *
+    * @param eventIndex
+    * @return
+    */
+   virtual std::uint64_t eventTagForEventIndex(int eventIndex);
+
    /**
     *
     * @param fileDescriptor
@@ -84,6 +91,39 @@ public:
     */
    virtual bool removeFileDescriptorFromRead(int fileDescriptor);
 
+   /**
+    *
+    * @return
+    */
+   virtual bool isOneShotSupported() const;
+
+   /**
+    *
+    * @param fileDescriptor
+    * @return
+    */
+   virtual bool addFileDescriptorForOneShotRead(int fileDescriptor);
+
+   /**
+    *
+    * @param fileDescriptor
+    * @return
+    */
+   virtual bool rearmFileDescriptorForRead(int fileDescriptor);
+
+   /**
+    *
+    * @return
+    */
+   virtual bool isOneShotWriteSupported() const;
+
+   /**
+    *
+    * @param fileDescriptor
+    * @return
+    */
+   virtual bool rearmFileDescriptorForWrite(int fileDescriptor);
+
    /**
     *
     * @param eventIndex
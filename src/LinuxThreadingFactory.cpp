@@ -0,0 +1,66 @@
+// Copyright Paul Dardeau, SwampBits LLC 2015
+// BSD License
+
+#include "LinuxThreadingFactory.h"
+#include "FutexMutex.h"
+#include "FutexConditionVariable.h"
+#include "FutexReadWriteLock.h"
+#include "Futex.h"
+#include "BasicThreadPoolQueue.h"
+#include "ThreadPool.h"
+#include "Logger.h"
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+bool LinuxThreadingFactory::isSupportedPlatform() {
+   return Futex::isSupportedPlatform();
+}
+
+//******************************************************************************
+
+LinuxThreadingFactory::LinuxThreadingFactory() {
+   LOG_INSTANCE_CREATE("LinuxThreadingFactory")
+}
+
+//******************************************************************************
+
+LinuxThreadingFactory::~LinuxThreadingFactory() {
+   LOG_INSTANCE_DESTROY("LinuxThreadingFactory")
+}
+
+//******************************************************************************
+
+Mutex* LinuxThreadingFactory::createMutex(const std::string& name) {
+   return new FutexMutex(name);
+}
+
+//******************************************************************************
+
+ConditionVariable* LinuxThreadingFactory::createConditionVariable(const std::string& name) {
+   return new FutexConditionVariable(name);
+}
+
+//******************************************************************************
+
+ReadWriteLock* LinuxThreadingFactory::createReadWriteLock(const std::string& name,
+             ReadWritePreference preference) {
+   return new FutexReadWriteLock(name, preference);
+}
+
+//******************************************************************************
+
+ThreadPoolDispatcher* LinuxThreadingFactory::createThreadPoolDispatcher(int numberThreads,
+                                                                        const std::string& name) {
+   if (getThreadPoolType() == ThreadPoolType::Shared) {
+      return new ThreadPool(this,
+                            new BasicThreadPoolQueue<FutexLockPolicy>(this),
+                            numberThreads,
+                            name);
+   }
+
+   return PthreadsThreadingFactory::createThreadPoolDispatcher(numberThreads, name);
+}
+
+//******************************************************************************
@@ -0,0 +1,82 @@
+// Copyright Paul Dardeau, SwampBits LLC 2015
+// BSD License
+
+#ifndef CHAUDIERE_LINUXTHREADINGFACTORY_H
+#define CHAUDIERE_LINUXTHREADINGFACTORY_H
+
+#include "PthreadsThreadingFactory.h"
+
+
+namespace chaudiere
+{
+
+/**
+ * LinuxThreadingFactory is a factory for creating futex-based versions
+ * of Mutex and ConditionVariable (FutexMutex, FutexConditionVariable),
+ * with Pthreads versions of Thread, ThreadPoolDispatcher, etc.
+ */
+class LinuxThreadingFactory : public PthreadsThreadingFactory
+{
+public:
+   /**
+    * Determines if futexes are supported on the current platform
+    * @return boolean indicating if the factory's primitives are native
+    */
+   static bool isSupportedPlatform();
+
+   /**
+    * Constructs a LinuxThreadingFactory instance
+    */
+   LinuxThreadingFactory();
+
+   /**
+    * Destructor
+    */
+   ~LinuxThreadingFactory();
+
+  /**
+   * Create a new named FutexMutex
+   * @param name the name for the new Mutex
+   * @return pointer to the newly created Mutex
+   * @see Mutex()
+   */
+  virtual Mutex* createMutex(const std::string& name);
+
+  /**
+   * Create a new FutexConditionVariable
+   * @return pointer to the newly created ConditionVariable
+   * @see ConditionVariable()
+   */
+  virtual ConditionVariable* createConditionVariable(const std::string& name);
+
+  /**
+   * Create a new named FutexReadWriteLock
+   * @param name the name for the new ReadWriteLock
+   * @param preference which side the lock favors
+   * @return pointer to the newly created ReadWriteLock
+   * @see ReadWriteLock()
+   */
+  virtual ReadWriteLock* createReadWriteLock(const std::string& name,
+             ReadWritePreference preference = ReadWritePreference::Readers);
+
+  /**
+   * Create a new ThreadPoolDispatcher. A shared pool's queue is a
+   * BasicThreadPoolQueue<FutexLockPolicy>, which locks without virtual calls.
+   * @param numberThreads the number of worker threads
+   * @param name the name of the thread pool
+   * @return pointer to the newly created ThreadPoolDispatcher
+   * @see ThreadPoolDispatcher()
+   */
+  virtual ThreadPoolDispatcher* createThreadPoolDispatcher(int numberThreads,
+                                                           const std::string& name);
+
+private:
+   // disallow copies
+   LinuxThreadingFactory(const LinuxThreadingFactory&);
+   LinuxThreadingFactory& operator=(const LinuxThreadingFactory&);
+
+};
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_LOCKPOLICY_H
+#define CHAUDIERE_LOCKPOLICY_H
+
+#include <string>
+
+#include "ThreadingFactory.h"
+#include "Mutex.h"
+#include "ConditionVariable.h"
+
+namespace chaudiere
+{
+   class PthreadsMutex;
+   class PthreadsConditionVariable;
+   class StdMutex;
+   class StdConditionVariable;
+   class FutexMutex;
+   class FutexConditionVariable;
+
+/**
+ * A lock policy names the mutex and condition variable types that a
+ * templated class (e.g., BasicThreadPoolQueue) locks and waits with, and
+ * how to create them. VirtualLockPolicy works through the Mutex and
+ * ConditionVariable interfaces, with whatever a ThreadingFactory creates.
+ * The native policies bind a concrete pair at compile time, so that lock,
+ * unlock, wait and notify are called directly (and lock and unlock can be
+ * inlined).
+ */
+struct VirtualLockPolicy {
+   typedef Mutex MutexType;
+   typedef ConditionVariable ConditionVariableType;
+
+   static MutexType* createMutex(ThreadingFactory* threadingFactory,
+                                 const std::string& name) {
+      return threadingFactory->createMutex(name);
+   }
+
+   static ConditionVariableType* createConditionVariable(ThreadingFactory* threadingFactory,
+                                                         const std::string& name) {
+      return threadingFactory->createConditionVariable(name);
+   }
+
+   static bool wait(ConditionVariableType& conditionVariable, MutexType& mutex) {
+      return conditionVariable.wait(&mutex);
+   }
+};
+
+/**
+ * NativeLockPolicy binds a concrete mutex type M and the condition
+ * variable type CV that waits with it (a ThreadingFactory isn't needed).
+ * Using one requires the headers of M and CV.
+ */
+template <typename M, typename CV>
+struct NativeLockPolicy {
+   typedef M MutexType;
+   typedef CV ConditionVariableType;
+
+   static MutexType* createMutex(ThreadingFactory*, const std::string& name) {
+      return new MutexType(name);
+   }
+
+   static ConditionVariableType* createConditionVariable(ThreadingFactory*,
+                                                         const std::string& name) {
+      return new ConditionVariableType(name);
+   }
+
+   static bool wait(ConditionVariableType& conditionVariable, MutexType& mutex) {
+      return conditionVariable.wait(mutex);
+   }
+};
+
+typedef NativeLockPolicy<PthreadsMutex, PthreadsConditionVariable> PthreadsLockPolicy;
+typedef NativeLockPolicy<StdMutex, StdConditionVariable> StdLockPolicy;
+typedef NativeLockPolicy<FutexMutex, FutexConditionVariable> FutexLockPolicy;
+
+}
+
+#endif
@@ -0,0 +1,218 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <stdio.h>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+#include "LockProfiler.h"
+
+using namespace chaudiere;
+
+// (the profiler locks its buffers with std::mutex rather than Mutex, so
+// that it doesn't record itself)
+
+static const char* UNNAMED = "(unnamed)";
+
+namespace {
+
+struct ThreadBuffer;
+
+/**
+ * The buffers of live threads, and the counters of exited ones
+ */
+struct BufferRegistry {
+   std::mutex mutex;
+   std::vector<ThreadBuffer*> buffers;
+   std::vector<LockSiteStats> retiredStats;
+
+   static BufferRegistry& instance() {
+      static BufferRegistry registry;
+      return registry;
+   }
+};
+
+/**
+ * One thread's counters, keyed by call site (a string literal, so its
+ * address identifies it) and then by mutex name. The owning thread locks
+ * the buffer's mutex only to record; it's only contended while counters
+ * are being read.
+ */
+struct ThreadBuffer {
+   std::mutex mutex;
+   std::unordered_map<const char*, std::vector<LockSiteStats>> sites;
+
+   ThreadBuffer() {
+      BufferRegistry& registry = BufferRegistry::instance();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.buffers.push_back(this);
+   }
+
+   ~ThreadBuffer() {
+      BufferRegistry& registry = BufferRegistry::instance();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.buffers.erase(std::find(registry.buffers.begin(),
+                                       registry.buffers.end(),
+                                       this));
+      for (auto& site : sites) {
+         registry.retiredStats.insert(registry.retiredStats.end(),
+                                      site.second.begin(),
+                                      site.second.end());
+      }
+   }
+
+   static ThreadBuffer& forThisThread() {
+      // (the registry first, so that it outlives every thread's buffer)
+      BufferRegistry::instance();
+      static thread_local ThreadBuffer buffer;
+      return buffer;
+   }
+};
+
+void mergeStats(std::vector<LockSiteStats>& merged, const LockSiteStats& stats) {
+   for (LockSiteStats& existing : merged) {
+      if ((existing.mutexName == stats.mutexName) &&
+          (existing.callSite == stats.callSite)) {
+         existing.add(stats);
+         return;
+      }
+   }
+
+   merged.push_back(stats);
+}
+
+}
+
+std::atomic<bool> LockProfiler::profilingEnabled(false);
+
+//******************************************************************************
+
+void LockSiteStats::add(const LockSiteStats& other) {
+   acquisitions += other.acquisitions;
+   contendedAcquisitions += other.contendedAcquisitions;
+   totalWaitNanos += other.totalWaitNanos;
+   maxWaitNanos = std::max(maxWaitNanos, other.maxWaitNanos);
+   totalHoldNanos += other.totalHoldNanos;
+   maxHoldNanos = std::max(maxHoldNanos, other.maxHoldNanos);
+}
+
+//******************************************************************************
+
+void LockProfiler::setEnabled(bool isEnabled) {
+   profilingEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void LockProfiler::record(const std::string& mutexName,
+                          const char* callSite,
+                          bool isContended,
+                          std::uint64_t waitNanos,
+                          std::uint64_t holdNanos) {
+   if (callSite == nullptr) {
+      callSite = UNNAMED;
+   }
+
+   ThreadBuffer& buffer = ThreadBuffer::forThisThread();
+   std::lock_guard<std::mutex> lock(buffer.mutex);
+
+   std::vector<LockSiteStats>& mutexes = buffer.sites[callSite];
+   LockSiteStats* stats = nullptr;
+
+   for (LockSiteStats& candidate : mutexes) {
+      if (candidate.mutexName == mutexName) {
+         stats = &candidate;
+         break;
+      }
+   }
+
+   if (stats == nullptr) {
+      mutexes.emplace_back();
+      stats = &mutexes.back();
+      stats->mutexName = mutexName.empty() ? UNNAMED : mutexName;
+      stats->callSite = callSite;
+   }
+
+   ++stats->acquisitions;
+   if (isContended) {
+      ++stats->contendedAcquisitions;
+   }
+   stats->totalWaitNanos += waitNanos;
+   stats->maxWaitNanos = std::max(stats->maxWaitNanos, waitNanos);
+   stats->totalHoldNanos += holdNanos;
+   stats->maxHoldNanos = std::max(stats->maxHoldNanos, holdNanos);
+}
+
+//******************************************************************************
+
+std::vector<LockSiteStats> LockProfiler::getStats() {
+   std::vector<LockSiteStats> merged;
+   BufferRegistry& registry = BufferRegistry::instance();
+   std::lock_guard<std::mutex> registryLock(registry.mutex);
+
+   for (const LockSiteStats& stats : registry.retiredStats) {
+      mergeStats(merged, stats);
+   }
+
+   for (ThreadBuffer* buffer : registry.buffers) {
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+      for (const auto& site : buffer->sites) {
+         for (const LockSiteStats& stats : site.second) {
+            mergeStats(merged, stats);
+         }
+      }
+   }
+
+   std::sort(merged.begin(), merged.end(),
+             [](const LockSiteStats& a, const LockSiteStats& b) {
+                return a.totalWaitNanos > b.totalWaitNanos;
+             });
+
+   return merged;
+}
+
+//******************************************************************************
+
+std::string LockProfiler::dump() {
+   const std::vector<LockSiteStats> allStats = getStats();
+   std::string table;
+   char line[512];
+
+   snprintf(line, sizeof(line), "%-24s %-40s %12s %12s %14s %12s %14s %12s\n",
+            "mutex", "call site", "acquired", "contended",
+            "wait-total-us", "wait-max-us", "hold-total-us", "hold-max-us");
+   table += line;
+
+   for (const LockSiteStats& stats : allStats) {
+      snprintf(line, sizeof(line),
+               "%-24s %-40s %12llu %12llu %14llu %12llu %14llu %12llu\n",
+               stats.mutexName.c_str(),
+               stats.callSite.c_str(),
+               static_cast<unsigned long long>(stats.acquisitions),
+               static_cast<unsigned long long>(stats.contendedAcquisitions),
+               static_cast<unsigned long long>(stats.totalWaitNanos / 1000),
+               static_cast<unsigned long long>(stats.maxWaitNanos / 1000),
+               static_cast<unsigned long long>(stats.totalHoldNanos / 1000),
+               static_cast<unsigned long long>(stats.maxHoldNanos / 1000));
+      table += line;
+   }
+
+   return table;
+}
+
+//******************************************************************************
+
+void LockProfiler::reset() {
+   BufferRegistry& registry = BufferRegistry::instance();
+   std::lock_guard<std::mutex> registryLock(registry.mutex);
+
+   registry.retiredStats.clear();
+
+   for (ThreadBuffer* buffer : registry.buffers) {
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+      buffer->sites.clear();
+   }
+}
+
+//******************************************************************************
@@ -0,0 +1,125 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_LOCKPROFILER_H
+#define CHAUDIERE_LOCKPROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chaudiere
+{
+
+/**
+ * Contention counters of one named mutex as locked from one call site
+ */
+struct LockSiteStats {
+   std::string mutexName;
+   std::string callSite;
+   std::uint64_t acquisitions;
+   std::uint64_t contendedAcquisitions;  // the mutex was locked on arrival
+   std::uint64_t totalWaitNanos;
+   std::uint64_t maxWaitNanos;
+   std::uint64_t totalHoldNanos;
+   std::uint64_t maxHoldNanos;
+
+   LockSiteStats() :
+      acquisitions(0),
+      contendedAcquisitions(0),
+      totalWaitNanos(0),
+      maxWaitNanos(0),
+      totalHoldNanos(0),
+      maxHoldNanos(0) {
+   }
+
+   /**
+    * Adds another's counters to these
+    * @param other counters of the same mutex and call site
+    */
+   void add(const LockSiteStats& other);
+};
+
+/**
+ * LockProfiler is an opt-in contention profiler for the mutexes held
+ * with MutexLock (or any BasicMutexLock). Once enabled, each lock records
+ * how long it waited to acquire the mutex and how long it held it, under
+ * the mutex's name and the lock's call site name. Counters are kept in a
+ * buffer per thread (so profiling adds no shared state to the locks being
+ * measured) and merged when they're read. Hold times include any time
+ * spent waiting on a condition variable with the mutex.
+ */
+class LockProfiler
+{
+public:
+   /**
+    * Turns profiling on or off (off by default). Locks taken before
+    * profiling is turned on aren't recorded.
+    * @param isEnabled whether to record locks
+    */
+   static void setEnabled(bool isEnabled);
+
+   /**
+    * Determines if profiling is on
+    * @return boolean indicating if locks are being recorded
+    */
+   static bool isEnabled() {
+      return profilingEnabled.load(std::memory_order_relaxed);
+   }
+
+   /**
+    * Retrieves the current time for lock timings
+    * @return monotonic time in nanoseconds
+    */
+   static std::uint64_t now() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   /**
+    * Records one acquisition of a mutex in the calling thread's buffer
+    * @param mutexName the name of the mutex
+    * @param callSite the lock's call site name (nullptr if unnamed)
+    * @param isContended whether the mutex was locked on arrival
+    * @param waitNanos time taken to acquire the mutex
+    * @param holdNanos time the mutex was held
+    */
+   static void record(const std::string& mutexName,
+                      const char* callSite,
+                      bool isContended,
+                      std::uint64_t waitNanos,
+                      std::uint64_t holdNanos);
+
+   /**
+    * Merges the counters of all threads (including threads that have
+    * exited)
+    * @return counters per mutex and call site, most total wait first
+    */
+   static std::vector<LockSiteStats> getStats();
+
+   /**
+    * Formats the merged counters as a table, one line per mutex and call
+    * site, most total wait first
+    * @return the table
+    */
+   static std::string dump();
+
+   /**
+    * Clears the counters of all threads
+    */
+   static void reset();
+
+
+private:
+   static std::atomic<bool> profilingEnabled;
+
+   LockProfiler();
+   LockProfiler(const LockProfiler&);
+   LockProfiler& operator=(const LockProfiler&);
+};
+
+}
+
+#endif
@@ -4,64 +4,121 @@
 #ifndef CHAUDIERE_MUTEXLOCK_H
 #define CHAUDIERE_MUTEXLOCK_H
 
+#include <cstdint>
+#include <string>
+
 #include "Mutex.h"
+#include "LockProfiler.h"
 
 namespace chaudiere
 {
 
 /**
- * MutexLock is a convenience class for locking and unlocking a Mutex. This
- * class is meant to be used with RAII (i.e., on the stack) to get a lock
- * and then have the destructor release the lock.
+ * BasicMutexLock is a convenience class for locking and unlocking a mutex.
+ * This class is meant to be used with RAII (i.e., on the stack) to get a
+ * lock and then have the destructor release the lock. M is the mutex
+ * type: Mutex (see MutexLock) goes through the Mutex interface, while a
+ * concrete type such as FutexMutex binds lock and unlock at compile time,
+ * so that they can be inlined. While the LockProfiler is enabled, each
+ * lock's wait and hold times are recorded under the mutex's name and the
+ * lock's name.
  */
-class MutexLock
+template <typename M>
+class BasicMutexLock
 {
 public:
-   explicit MutexLock(Mutex& mutex) :
+   explicit BasicMutexLock(M& mutex) :
       m_mutex(mutex),
-      m_owns(true) {
-      m_mutex.lock();
+      m_name(nullptr),
+      m_owns(true),
+      m_isContended(false),
+      m_acquiredTime(0),
+      m_waitNanos(0) {
+      lock();
    }
 
    /**
-    * Locks the given Mutex
+    * Locks the given mutex
     * @param mutex the mutex to lock
+    * @param name the call site's name (a string literal; not copied)
     * @see Mutex()
     */
-   explicit MutexLock(Mutex& mutex, const std::string& name) :
+   explicit BasicMutexLock(M& mutex, const char* name) :
       m_mutex(mutex),
       m_name(name),
-      m_owns(true) {
-      m_mutex.lock();
+      m_owns(true),
+      m_isContended(false),
+      m_acquiredTime(0),
+      m_waitNanos(0) {
+      lock();
    }
 
    /**
     * Destructor - unlocks the mutex (if not already unlocked via unlock())
     */
-   ~MutexLock() {
+   ~BasicMutexLock() {
       if (m_owns) {
-         m_mutex.unlock();
+         release();
       }
    }
 
    void unlock() {
       if (m_owns) {
-         m_mutex.unlock();
+         release();
          m_owns = false;
       }
    }
 
 private:
-   Mutex& m_mutex;
-   std::string m_name;
+   void lock() {
+      if (LockProfiler::isEnabled()) {
+         lockProfiled();
+      } else {
+         m_mutex.lock();
+      }
+   }
+
+   void lockProfiled() {
+      // (a mutex that's locked on arrival counts as contended)
+      m_isContended = m_mutex.isLocked();
+      const std::uint64_t arrivalTime = LockProfiler::now();
+      m_mutex.lock();
+      m_acquiredTime = LockProfiler::now();
+      m_waitNanos = m_acquiredTime - arrivalTime;
+   }
+
+   void release() {
+      if (m_acquiredTime == 0) {
+         m_mutex.unlock();
+      } else {
+         const std::uint64_t holdNanos = LockProfiler::now() - m_acquiredTime;
+         // copied while the mutex is still held: once it's unlocked, another
+         // thread may destroy it (and whatever owns it)
+         const std::string mutexName = m_mutex.getName();
+         m_mutex.unlock();
+         LockProfiler::record(mutexName, m_name, m_isContended,
+                              m_waitNanos, holdNanos);
+      }
+   }
+
+   M& m_mutex;
+   const char* m_name;
    bool m_owns;
+   bool m_isContended;
+   std::uint64_t m_acquiredTime;   // (0 unless profiled)
+   std::uint64_t m_waitNanos;
 
-   MutexLock();
-   MutexLock(const Mutex&);
-   Mutex& operator=(const Mutex&);
+   BasicMutexLock();
+   BasicMutexLock(const BasicMutexLock&);
+   BasicMutexLock& operator=(const BasicMutexLock&);
 
 };
 
+/**
+ * MutexLock is a BasicMutexLock for any Mutex (through its interface)
+ */
+typedef BasicMutexLock<Mutex> MutexLock;
+
 }
 
 #endif
@@ -0,0 +1,200 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_OBJECTPOOL_H
+#define CHAUDIERE_OBJECTPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace chaudiere
+{
+
+/**
+ * Counters of an ObjectPool
+ */
+struct ObjectPoolStats {
+   std::uint64_t hits;      // acquires served with a recycled object
+   std::uint64_t misses;    // acquires that found nothing to recycle
+   std::uint64_t discards;  // releases deleted because the pool was full
+
+   ObjectPoolStats() :
+      hits(0),
+      misses(0),
+      discards(0) {
+   }
+};
+
+/**
+ * ObjectPool recycles idle objects of type T (one pool per type). Each
+ * thread keeps a small cache of idle objects that it acquires from and
+ * releases to without locking. Caches exchange objects in batches through
+ * a shared depot, so that objects created on one thread (e.g., an event
+ * loop) and released on another (e.g., a pool worker) keep circulating.
+ *
+ * Pooled objects are ordinary heap objects: the pool hands them out as
+ * they were released, and the caller resets them. Deleting one instead of
+ * releasing it is fine.
+ */
+template <typename T>
+class ObjectPool
+{
+public:
+   /**
+    * @return the pool for type T
+    */
+   static ObjectPool& instance() {
+      static ObjectPool pool;
+      return pool;
+   }
+
+   /**
+    * Takes an idle object from the pool
+    * @return an idle object, or nullptr if there's none to recycle
+    */
+   T* acquire() {
+      ThreadCache& cache = threadCache();
+
+      if (cache.idle.empty()) {
+         refill(cache);
+      }
+
+      if (cache.idle.empty()) {
+         m_misses.fetch_add(1, std::memory_order_relaxed);
+         return nullptr;
+      }
+
+      T* object = cache.idle.back();
+      cache.idle.pop_back();
+      m_hits.fetch_add(1, std::memory_order_relaxed);
+      return object;
+   }
+
+   /**
+    * Returns an object to the pool for reuse (or deletes it if the pool
+    * already holds as many idle objects as it keeps)
+    * @param object the object to release
+    */
+   void release(T* object) {
+      ThreadCache& cache = threadCache();
+      cache.idle.push_back(object);
+
+      if (cache.idle.size() >= 2 * BATCH_SIZE) {
+         spill(cache, BATCH_SIZE);
+      }
+   }
+
+   /**
+    * Sets how many idle objects the shared depot keeps (beyond the
+    * per-thread caches); releases past that are deleted
+    * @param maxIdle the maximum number of idle objects in the depot
+    */
+   void setMaxIdle(std::size_t maxIdle) {
+      std::lock_guard<std::mutex> lock(m_depotMutex);
+      m_maxIdle = maxIdle;
+   }
+
+   /**
+    * @return the pool's hit, miss and discard counters
+    */
+   ObjectPoolStats getStats() const {
+      ObjectPoolStats stats;
+      stats.hits = m_hits.load(std::memory_order_relaxed);
+      stats.misses = m_misses.load(std::memory_order_relaxed);
+      stats.discards = m_discards.load(std::memory_order_relaxed);
+      return stats;
+   }
+
+   /**
+    * Destructor (deletes the idle objects in the depot)
+    */
+   ~ObjectPool() {
+      for (T* object : m_depot) {
+         delete object;
+      }
+   }
+
+
+private:
+   // objects moved between a thread's cache and the depot at a time
+   static constexpr std::size_t BATCH_SIZE = 32;
+   static constexpr std::size_t DEFAULT_MAX_IDLE = 4096;
+
+   struct ThreadCache {
+      std::vector<T*> idle;
+
+      ThreadCache() {
+         idle.reserve(2 * BATCH_SIZE);
+      }
+
+      ~ThreadCache() {
+         // a thread's idle objects outlive it in the depot
+         ObjectPool::instance().spill(*this, idle.size());
+      }
+   };
+
+   ObjectPool() :
+      m_maxIdle(DEFAULT_MAX_IDLE),
+      m_hits(0),
+      m_misses(0),
+      m_discards(0) {
+   }
+
+   static ThreadCache& threadCache() {
+      // (instance() first, so that the pool outlives every thread's cache)
+      instance();
+      static thread_local ThreadCache cache;
+      return cache;
+   }
+
+   void refill(ThreadCache& cache) {
+      std::lock_guard<std::mutex> lock(m_depotMutex);
+
+      const std::size_t numberToMove = std::min(BATCH_SIZE, m_depot.size());
+      cache.idle.insert(cache.idle.end(), m_depot.end() - numberToMove, m_depot.end());
+      m_depot.resize(m_depot.size() - numberToMove);
+   }
+
+   void spill(ThreadCache& cache, std::size_t numberToMove) {
+      std::size_t numberToDelete = 0;
+
+      {
+         std::lock_guard<std::mutex> lock(m_depotMutex);
+
+         const std::size_t room =
+            (m_maxIdle > m_depot.size()) ? m_maxIdle - m_depot.size() : 0;
+         const std::size_t numberToKeep = std::min(numberToMove, room);
+         numberToDelete = numberToMove - numberToKeep;
+
+         m_depot.insert(m_depot.end(), cache.idle.end() - numberToKeep, cache.idle.end());
+         cache.idle.resize(cache.idle.size() - numberToKeep);
+      }
+
+      // the depot is full -- let the rest go
+      for (std::size_t i = 0; i < numberToDelete; ++i) {
+         delete cache.idle.back();
+         cache.idle.pop_back();
+      }
+
+      m_discards.fetch_add(numberToDelete, std::memory_order_relaxed);
+   }
+
+   std::mutex m_depotMutex;
+   std::vector<T*> m_depot;
+   std::size_t m_maxIdle;
+   std::atomic<std::uint64_t> m_hits;
+   std::atomic<std::uint64_t> m_misses;
+   std::atomic<std::uint64_t> m_discards;
+
+   // disallow copies
+   ObjectPool(const ObjectPool&);
+   ObjectPool& operator=(const ObjectPool&);
+};
+
+}
+
+#endif
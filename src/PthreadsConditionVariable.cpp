@@ -49,23 +49,31 @@ PthreadsConditionVariable::~PthreadsConditionVariable() {
 //******************************************************************************
 
 bool PthreadsConditionVariable::wait(Mutex* mutex) {
+   if (mutex) {
+      PthreadsMutex* pthreadsMutex =
+         dynamic_cast<PthreadsMutex*>(mutex);
+
+      if (pthreadsMutex) {
+         return wait(*pthreadsMutex);
+      } else {
+         LOG_ERROR("mutex must be an instance of PthreadsMutex")
+      }
+   } else {
+      LOG_ERROR("no mutex given to wait on")
+   }
+
+   return false;
+}
+
+//******************************************************************************
+
+bool PthreadsConditionVariable::wait(PthreadsMutex& mutex) {
    if (m_initialized) {
-      if (mutex) {
-         PthreadsMutex* pthreadsMutex =
-            dynamic_cast<PthreadsMutex*>(mutex);
-
-         if (pthreadsMutex) {
-            if (0 != ::pthread_cond_wait(&m_cond,
-                                         &pthreadsMutex->getPlatformPrimitive())) {
-               LOG_ERROR("unable to wait on condition variable")
-            } else {
-               return true;
-            }
-         } else {
-            LOG_ERROR("mutex must be an instance of PthreadsMutex")
-         }
+      if (0 != ::pthread_cond_wait(&m_cond,
+                                   &mutex.getPlatformPrimitive())) {
+         LOG_ERROR("unable to wait on condition variable")
       } else {
-         LOG_ERROR("no mutex given to wait on")
+         return true;
       }
    } else {
       LOG_ERROR("unable to wait on condition variable that hasn't been initialized")
@@ -11,6 +11,7 @@
 
 namespace chaudiere
 {
+   class PthreadsMutex;
 
 /**
  *
@@ -36,17 +37,24 @@ public:
     * @return
     * @see Mutex()
     */
-   virtual bool wait(Mutex* mutex);
+   bool wait(Mutex* mutex) final;
+
+   /**
+    * Wait for the condition to occur (with no check of the mutex's type)
+    * @param mutex the mutex that the caller currently has locked
+    * @return boolean indicating if the wait happened
+    */
+   bool wait(PthreadsMutex& mutex);
 
    /**
     *
     */
-   virtual void notifyOne();
+   void notifyOne() final;
 
    /**
     *
     */
-   virtual void notifyAll();
+   void notifyAll() final;
 
    virtual const std::string& getName() const;
 
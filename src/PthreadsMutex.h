@@ -43,25 +43,25 @@ public:
     *
     * @return
     */
-   virtual bool unlock();
+   bool unlock() final;
 
    /**
     *
     * @return
     */
-   virtual bool lock();
+   bool lock() final;
 
    /**
     *
     * @return
     */
-   virtual bool isLocked() const;
+   bool isLocked() const final;
 
    /**
     *
     * @return
     */
-   virtual bool haveValidMutex() const;
+   bool haveValidMutex() const final;
 
    /**
     * Retrieves the primitive data type for the underlying platform
@@ -0,0 +1,148 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <stdio.h>
+
+#include "PthreadsReadWriteLock.h"
+#include "BasicException.h"
+#include "Logger.h"
+
+static const std::string EMPTY_STRING = "";
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+PthreadsReadWriteLock::PthreadsReadWriteLock() :
+   PthreadsReadWriteLock(EMPTY_STRING) {
+}
+
+//******************************************************************************
+
+PthreadsReadWriteLock::PthreadsReadWriteLock(const std::string& name,
+                                             ReadWritePreference preference) :
+   m_name(name),
+   m_preference(preference),
+   m_haveValidLock(false) {
+   LOG_INSTANCE_CREATE("PthreadsReadWriteLock")
+   initialize();
+}
+
+//******************************************************************************
+
+PthreadsReadWriteLock::~PthreadsReadWriteLock() {
+   LOG_INSTANCE_DESTROY("PthreadsReadWriteLock")
+
+   if (m_haveValidLock) {
+      ::pthread_rwlock_destroy(&m_rwlock);
+   }
+}
+
+//******************************************************************************
+
+void PthreadsReadWriteLock::initialize() {
+   char buffer[128];
+   int rc;
+
+   pthread_rwlockattr_t attr;
+   rc = ::pthread_rwlockattr_init(&attr);
+   if (0 != rc) {
+      snprintf(buffer, 128, "unable to initialize rwlock attributes, rc=%d", rc);
+      LOG_ERROR(buffer)
+      throw BasicException(buffer);
+   }
+
+#if defined(__GLIBC__)
+   if (m_preference == ReadWritePreference::Writers) {
+      // (glibc's default kind admits readers ahead of waiting writers)
+      rc = ::pthread_rwlockattr_setkind_np(&attr,
+                                           PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+      if (0 != rc) {
+         ::pthread_rwlockattr_destroy(&attr);
+         snprintf(buffer, 128, "unable to set pthreads rwlock kind, rc=%d", rc);
+         LOG_ERROR(buffer)
+         throw BasicException(buffer);
+      }
+   }
+#endif
+
+   rc = ::pthread_rwlock_init(&m_rwlock, &attr);
+   ::pthread_rwlockattr_destroy(&attr);
+
+   if (0 == rc) {
+      m_haveValidLock = true;
+   } else {
+      snprintf(buffer, 128, "unable to create pthreads rwlock, rc=%d", rc);
+      LOG_ERROR(buffer)
+      throw BasicException(buffer);
+   }
+}
+
+//******************************************************************************
+
+bool PthreadsReadWriteLock::checkResult(int rc, const char* operation) const {
+   if (0 == rc) {
+      return true;
+   }
+
+   printf("error: rwlock %s failed, name='%s', rc=%d\n", operation, m_name.c_str(), rc);
+   return false;
+}
+
+//******************************************************************************
+
+bool PthreadsReadWriteLock::lockShared() {
+   if (!m_haveValidLock) {
+      printf("locking not attempted, no valid rwlock, name='%s'\n", m_name.c_str());
+      return false;
+   }
+
+   return checkResult(::pthread_rwlock_rdlock(&m_rwlock), "read lock");
+}
+
+//******************************************************************************
+
+bool PthreadsReadWriteLock::unlockShared() {
+   if (!m_haveValidLock) {
+      printf("error: rwlock unlock called, missing valid rwlock\n");
+      return false;
+   }
+
+   return checkResult(::pthread_rwlock_unlock(&m_rwlock), "read unlock");
+}
+
+//******************************************************************************
+
+bool PthreadsReadWriteLock::lockExclusive() {
+   if (!m_haveValidLock) {
+      printf("locking not attempted, no valid rwlock, name='%s'\n", m_name.c_str());
+      return false;
+   }
+
+   return checkResult(::pthread_rwlock_wrlock(&m_rwlock), "write lock");
+}
+
+//******************************************************************************
+
+bool PthreadsReadWriteLock::unlockExclusive() {
+   if (!m_haveValidLock) {
+      printf("error: rwlock unlock called, missing valid rwlock\n");
+      return false;
+   }
+
+   return checkResult(::pthread_rwlock_unlock(&m_rwlock), "write unlock");
+}
+
+//******************************************************************************
+
+ReadWritePreference PthreadsReadWriteLock::getPreference() const {
+   return m_preference;
+}
+
+//******************************************************************************
+
+const std::string& PthreadsReadWriteLock::getName() const {
+   return m_name;
+}
+
+//******************************************************************************
@@ -0,0 +1,77 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_PTHREADSREADWRITELOCK_H
+#define CHAUDIERE_PTHREADSREADWRITELOCK_H
+
+#include <string>
+#include <pthread.h>
+
+#include "ReadWriteLock.h"
+
+namespace chaudiere
+{
+
+/**
+ * PthreadsReadWriteLock is a wrapper class for working with reader-writer
+ * locks (pthread_rwlock_t) from pthreads. Writer preference is requested
+ * with glibc's rwlock kind; elsewhere, the platform's rwlocks already
+ * favor writers (e.g., FreeBSD) or ignore the preference.
+ */
+class PthreadsReadWriteLock : public ReadWriteLock
+{
+public:
+   /**
+    * Default constructor
+    */
+   PthreadsReadWriteLock();
+
+   /**
+    * Constructs a lock with a name and preference
+    * @param name the name of the lock
+    * @param preference which side the lock favors
+    */
+   explicit PthreadsReadWriteLock(const std::string& name,
+                                  ReadWritePreference preference = ReadWritePreference::Readers);
+
+   /**
+    * Destructor
+    */
+   ~PthreadsReadWriteLock();
+
+   bool lockShared() final;
+   bool unlockShared() final;
+   bool lockExclusive() final;
+   bool unlockExclusive() final;
+   ReadWritePreference getPreference() const final;
+
+   /**
+    * Retrieves the primitive data type for the underlying platform
+    * @return the platform's primitive data type for the lock
+    */
+   pthread_rwlock_t& getPlatformPrimitive()
+   {
+      return m_rwlock;
+   }
+
+   const std::string& getName() const;
+
+
+private:
+   // copying not allowed
+   PthreadsReadWriteLock(const PthreadsReadWriteLock&);
+   PthreadsReadWriteLock& operator=(const PthreadsReadWriteLock&);
+
+   void initialize();
+   bool checkResult(int rc, const char* operation) const;
+
+   pthread_rwlock_t m_rwlock;
+   std::string m_name;
+   ReadWritePreference m_preference;
+   bool m_haveValidLock;
+
+};
+
+}
+
+#endif
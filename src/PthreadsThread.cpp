@@ -92,6 +92,9 @@ void* PthreadsThread::runThread(void* pArgs) {
 
    unsigned long rc = 0L;
 
+   // name, place and schedule ourselves before running anything
+   pThread->getThreadAttributes().applyToCurrentThread(pThread->m_name);
+
    try {
       pThread->setAlive(true);
 
@@ -125,11 +128,28 @@ void* PthreadsThread::runThread(void* pArgs) {
 
 bool PthreadsThread::start() {
    bool isSuccess = false;
+   pthread_attr_t attr;
+   pthread_attr_t* pAttr = nullptr;
+   const std::size_t stackSize = getThreadAttributes().getStackSize();
+
+   // the stack size is the one attribute that has to be set at creation
+   if ((stackSize > 0) && (0 == ::pthread_attr_init(&attr))) {
+      if (0 == ::pthread_attr_setstacksize(&attr, stackSize)) {
+         pAttr = &attr;
+      } else {
+         LOG_WARNING("unable to set stack size for thread '" + m_name + "'")
+         ::pthread_attr_destroy(&attr);
+      }
+   }
 
-   if (0 == ::pthread_create(&m_threadHandle, 0, runThread, (void*) this)) {
+   if (0 == ::pthread_create(&m_threadHandle, pAttr, runThread, (void*) this)) {
       isSuccess = true;
    }
 
+   if (nullptr != pAttr) {
+      ::pthread_attr_destroy(pAttr);
+   }
+
    return isSuccess;
 }
 
@@ -7,8 +7,12 @@
 #include "PthreadsMutex.h"
 #include "PthreadsThread.h"
 #include "ThreadPool.h"
+#include "RingThreadPoolQueue.h"
+#include "ThreadPoolDispatch.h"
+#include "WorkStealingThreadPool.h"
 #include "Logger.h"
 #include "PthreadsConditionVariable.h"
+#include "PthreadsReadWriteLock.h"
 
 using namespace chaudiere;
 
@@ -40,7 +44,9 @@ Thread* PthreadsThreadingFactory::createThread(const std::string& name) {
 
 Thread* PthreadsThreadingFactory::createThread(Runnable* runnable,
            const std::string& name) {
-   return new PthreadsThread(runnable, name);
+   PthreadsThread* thread = new PthreadsThread(runnable, name);
+   thread->setThreadAttributes(getThreadAttributes());
+   return thread;
 }
 
 //******************************************************************************
@@ -51,8 +57,23 @@ ConditionVariable* PthreadsThreadingFactory::createConditionVariable(const std::
 
 //******************************************************************************
 
+ReadWriteLock* PthreadsThreadingFactory::createReadWriteLock(const std::string& name,
+             ReadWritePreference preference) {
+   return new PthreadsReadWriteLock(name, preference);
+}
+
+//******************************************************************************
+
 ThreadPoolDispatcher* PthreadsThreadingFactory::createThreadPoolDispatcher(int numberThreads,
                                                                            const std::string& name) {
+   if (getThreadPoolType() == ThreadPoolType::WorkStealing) {
+      return new WorkStealingThreadPool(this, numberThreads, name);
+   } else if (getThreadPoolType() == ThreadPoolType::SharedRing) {
+      return new ThreadPool(this, new RingThreadPoolQueue(this), numberThreads, name);
+   } else if (getThreadPoolType() == ThreadPoolType::Dispatch) {
+      return new ThreadPoolDispatch(this, numberThreads, name);
+   }
+
    return new ThreadPool(this, numberThreads, name);
 }
 
@@ -60,7 +60,18 @@ public:
   virtual ConditionVariable* createConditionVariable(const std::string& name);
 
   /**
-   * Creates a new Pthreads compatible ThreadPool
+   * Create a new named PthreadsReadWriteLock
+   * @param name the name for the new ReadWriteLock
+   * @param preference which side the lock favors
+   * @return pointer to the newly created ReadWriteLock
+   * @see ReadWriteLock()
+   */
+  virtual ReadWriteLock* createReadWriteLock(const std::string& name,
+             ReadWritePreference preference = ReadWritePreference::Readers);
+
+  /**
+   * Creates a new Pthreads compatible ThreadPool (or WorkStealingThreadPool,
+   * per getThreadPoolType)
    * @param numberThreads the number of threads to initialize in the pool dispatcher
    * @return pointer to newly created ThreadPoolDispatcher
    */
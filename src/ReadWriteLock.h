@@ -0,0 +1,82 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_READWRITELOCK_H
+#define CHAUDIERE_READWRITELOCK_H
+
+#include <string>
+
+namespace chaudiere
+{
+
+/**
+ * Which side a ReadWriteLock favors when readers and writers contend
+ */
+enum class ReadWritePreference {
+   Readers,  // readers are admitted while the lock is read-locked, even
+             // with writers waiting (best throughput, writers can starve)
+   Writers   // once a writer is waiting, new readers wait behind it
+};
+
+/**
+ * ReadWriteLock is an interface for working with abstract reader-writer
+ * locks: any number of threads may hold the lock shared (for reading),
+ * or a single thread may hold it exclusive (for writing). Shared locking
+ * isn't recursive, and a shared lock can't be upgraded to exclusive.
+ */
+class ReadWriteLock
+{
+public:
+   /**
+    * Default constructor
+    */
+   ReadWriteLock() {}
+
+   /**
+    * Destructor
+    */
+   virtual ~ReadWriteLock() {}
+
+   /**
+    * Locks the lock shared (for reading)
+    * @return true if the lock was successfully locked, false otherwise
+    */
+   virtual bool lockShared() = 0;
+
+   /**
+    * Releases a shared lock
+    * @return true if the lock was successfully unlocked, false otherwise
+    */
+   virtual bool unlockShared() = 0;
+
+   /**
+    * Locks the lock exclusive (for writing)
+    * @return true if the lock was successfully locked, false otherwise
+    */
+   virtual bool lockExclusive() = 0;
+
+   /**
+    * Releases an exclusive lock
+    * @return true if the lock was successfully unlocked, false otherwise
+    */
+   virtual bool unlockExclusive() = 0;
+
+   /**
+    * Retrieves which side the lock favors
+    * @return the lock's preference
+    */
+   virtual ReadWritePreference getPreference() const = 0;
+
+   virtual const std::string& getName() const = 0;
+
+
+private:
+   // copying not allowed
+   ReadWriteLock(const ReadWriteLock&);
+   ReadWriteLock& operator=(const ReadWriteLock&);
+
+};
+
+}
+
+#endif
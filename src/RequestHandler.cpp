@@ -1,6 +1,9 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
+#include <cstddef>
+#include <new>
+
 #include "RequestHandler.h"
 #include "Socket.h"
 #include "SocketRequest.h"
@@ -11,6 +14,38 @@
 
 using namespace chaudiere;
 
+namespace {
+
+// storage for a handler of up to N bytes
+template <std::size_t N>
+struct HandlerBlock {
+   alignas(std::max_align_t) unsigned char bytes[N];
+};
+
+// handlers larger than the largest block come from the heap
+static constexpr std::size_t HANDLER_BLOCK_SIZES[] = { 64, 128, 256, 512 };
+
+template <std::size_t N>
+void* acquireBlock() {
+   HandlerBlock<N>* block = ObjectPool<HandlerBlock<N>>::instance().acquire();
+   return (nullptr != block) ? block : new HandlerBlock<N>;
+}
+
+template <std::size_t N>
+void releaseBlock(void* p) {
+   ObjectPool<HandlerBlock<N>>::instance().release(static_cast<HandlerBlock<N>*>(p));
+}
+
+template <std::size_t N>
+void addStats(ObjectPoolStats& stats) {
+   const ObjectPoolStats blockStats = ObjectPool<HandlerBlock<N>>::instance().getStats();
+   stats.hits += blockStats.hits;
+   stats.misses += blockStats.misses;
+   stats.discards += blockStats.discards;
+}
+
+}
+
 //******************************************************************************
 
 RequestHandler::RequestHandler(SocketRequest* socketRequest) :
@@ -45,12 +80,74 @@ RequestHandler::~RequestHandler() {
    }
 
    if ((nullptr != m_socketRequest) && m_socketRequest->isAutoDelete()) {
-      delete m_socketRequest;
+      SocketRequest::recycle(m_socketRequest);
    }
 }
 
 //******************************************************************************
 
+void* RequestHandler::operator new(std::size_t size) {
+   if (size <= HANDLER_BLOCK_SIZES[0]) {
+      return acquireBlock<HANDLER_BLOCK_SIZES[0]>();
+   } else if (size <= HANDLER_BLOCK_SIZES[1]) {
+      return acquireBlock<HANDLER_BLOCK_SIZES[1]>();
+   } else if (size <= HANDLER_BLOCK_SIZES[2]) {
+      return acquireBlock<HANDLER_BLOCK_SIZES[2]>();
+   } else if (size <= HANDLER_BLOCK_SIZES[3]) {
+      return acquireBlock<HANDLER_BLOCK_SIZES[3]>();
+   }
+
+   return ::operator new(size);
+}
+
+//******************************************************************************
+
+void RequestHandler::operator delete(void* p, std::size_t size) noexcept {
+   if (nullptr == p) {
+      return;
+   }
+
+   if (size <= HANDLER_BLOCK_SIZES[0]) {
+      releaseBlock<HANDLER_BLOCK_SIZES[0]>(p);
+   } else if (size <= HANDLER_BLOCK_SIZES[1]) {
+      releaseBlock<HANDLER_BLOCK_SIZES[1]>(p);
+   } else if (size <= HANDLER_BLOCK_SIZES[2]) {
+      releaseBlock<HANDLER_BLOCK_SIZES[2]>(p);
+   } else if (size <= HANDLER_BLOCK_SIZES[3]) {
+      releaseBlock<HANDLER_BLOCK_SIZES[3]>(p);
+   } else {
+      ::operator delete(p);
+   }
+}
+
+//******************************************************************************
+
+void* RequestHandler::operator new(std::size_t size, std::align_val_t alignment) {
+   // the pools' blocks are only aligned for std::max_align_t
+   return ::operator new(size, alignment);
+}
+
+//******************************************************************************
+
+void RequestHandler::operator delete(void* p,
+                                     std::size_t size,
+                                     std::align_val_t alignment) noexcept {
+   ::operator delete(p, size, alignment);
+}
+
+//******************************************************************************
+
+ObjectPoolStats RequestHandler::getPoolStats() {
+   ObjectPoolStats stats;
+   addStats<HANDLER_BLOCK_SIZES[0]>(stats);
+   addStats<HANDLER_BLOCK_SIZES[1]>(stats);
+   addStats<HANDLER_BLOCK_SIZES[2]>(stats);
+   addStats<HANDLER_BLOCK_SIZES[3]>(stats);
+   return stats;
+}
+
+//******************************************************************************
+
 void RequestHandler::setThreadPooling(bool isThreadPooling) {
    m_isThreadPooling = isThreadPooling;
 }
@@ -89,6 +186,21 @@ void RequestHandler::setSocketOwned(bool socketOwned) {
 
 //******************************************************************************
 
+bool RequestHandler::isInlineCapable() const {
+   return false;
+}
+
+//******************************************************************************
+
+void RequestHandler::notifyOnStart() {
+   Runnable::notifyOnStart();
+   if (nullptr != m_socketRequest) {
+      m_socketRequest->notifyOnStart();
+   }
+}
+
+//******************************************************************************
+
 void RequestHandler::notifyOnCompletion() {
    Runnable::notifyOnCompletion();
    if (nullptr != m_socketRequest) {
@@ -98,3 +210,14 @@ void RequestHandler::notifyOnCompletion() {
 
 //******************************************************************************
 
+void RequestHandler::notifyOnDropped() {
+   Runnable::notifyOnCompletion();
+   if (nullptr != m_socketRequest) {
+      m_socketRequest->notifyOnDropped();
+   } else if (nullptr != m_socket) {
+      m_socket->shutdownConnection();
+   }
+}
+
+//******************************************************************************
+
@@ -5,6 +5,10 @@
 #define CHAUDIERE_REQUESTHANDLER_H
 
 
+#include <cstddef>
+#include <new>
+
+#include "ObjectPool.h"
 #include "Runnable.h"
 
 
@@ -71,7 +75,58 @@ public:
    bool isSocketOwned() const;
    void setSocketOwned(bool socketOwned);
 
+   /**
+    * Determines whether the handler is cheap enough (e.g., microseconds of
+    * work with no blocking calls) that a SocketServer should run it inline
+    * on the kernel event loop thread instead of handing it to the thread
+    * pool. The default implementation returns false.
+    * @return boolean indicating if the handler may run on the event loop
+    */
+   virtual bool isInlineCapable() const;
+
+   virtual void notifyOnStart();
    virtual void notifyOnCompletion();
+   virtual void notifyOnDropped();
+
+   /**
+    * Allocates a handler (of any subclass) from per-size recycling pools,
+    * so that creating a handler per request doesn't go to the heap once
+    * the pools are warm
+    * @param size the size of the handler
+    * @return storage for the handler
+    */
+   static void* operator new(std::size_t size);
+
+   /**
+    * Returns a handler's storage to its pool
+    * @param p the handler's storage
+    * @param size the size of the handler
+    */
+   static void operator delete(void* p, std::size_t size) noexcept;
+
+   /**
+    * Allocates an over-aligned handler (one with an alignas member wider
+    * than the pools' blocks are aligned for) from the heap
+    * @param size the size of the handler
+    * @param alignment the handler's alignment
+    * @return storage for the handler
+    */
+   static void* operator new(std::size_t size, std::align_val_t alignment);
+
+   /**
+    * Frees an over-aligned handler's storage
+    * @param p the handler's storage
+    * @param size the size of the handler
+    * @param alignment the handler's alignment
+    */
+   static void operator delete(void* p,
+                               std::size_t size,
+                               std::align_val_t alignment) noexcept;
+
+   /**
+    * @return the combined hit, miss and discard counters of the handler pools
+    */
+   static ObjectPoolStats getPoolStats();
 };
 
 }
@@ -0,0 +1,536 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "RingThreadPoolQueue.h"
+#include "TaskRunnable.h"
+#include "Logger.h"
+
+using namespace chaudiere;
+
+const std::size_t RingThreadPoolQueue::DEFAULT_CAPACITY;
+
+//******************************************************************************
+
+RingThreadPoolQueue::RingThreadPoolQueue(ThreadingFactory* threadingFactory,
+                                         std::size_t capacity) :
+   ThreadPoolQueue(threadingFactory),
+   m_mask(0),
+   m_enqueuePos(0),
+   m_dequeuePos(0),
+   m_notEmptyEpoch(0),
+   m_waitingTakers(0),
+   m_notFullEpoch(0),
+   m_waitingAdders(0),
+   m_maxQueueSize(0),
+   m_queueFullPolicy(QueueFullPolicy::Reject),
+   m_isRunning(true) {
+   LOG_INSTANCE_CREATE("RingThreadPoolQueue")
+
+   std::size_t ringCapacity = 2;
+   while (ringCapacity < capacity) {
+      ringCapacity <<= 1;
+   }
+
+   m_cells.reset(new Cell[ringCapacity]);
+   m_mask = ringCapacity - 1;
+
+   for (std::size_t i = 0; i < ringCapacity; ++i) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+      m_cells[i].addedTime.store(0, std::memory_order_relaxed);
+      m_cells[i].runnable = nullptr;
+   }
+}
+
+//******************************************************************************
+
+RingThreadPoolQueue::~RingThreadPoolQueue() {
+   LOG_INSTANCE_DESTROY("RingThreadPoolQueue")
+   shutDown();
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::tryEnqueue(Runnable* runnableRequest) {
+   std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+
+   for (;;) {
+      Cell& cell = m_cells[pos & m_mask];
+      const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const std::intptr_t diff =
+         static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+
+      if (diff == 0) {
+         // slot is free for this position -- claim it
+         if (m_enqueuePos.compare_exchange_weak(pos,
+                                                pos + 1,
+                                                std::memory_order_relaxed)) {
+            cell.runnable = runnableRequest;
+            cell.addedTime.store(now(), std::memory_order_relaxed);
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+         }
+      } else if (diff < 0) {
+         // slot still holds the request from one lap ago -- ring is full
+         return false;
+      } else {
+         // another producer claimed this position first
+         pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+   }
+}
+
+//******************************************************************************
+
+Runnable* RingThreadPoolQueue::tryDequeue() {
+   std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+
+   for (;;) {
+      Cell& cell = m_cells[pos & m_mask];
+      const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const std::intptr_t diff =
+         static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+
+      if (diff == 0) {
+         if (m_dequeuePos.compare_exchange_weak(pos,
+                                                pos + 1,
+                                                std::memory_order_relaxed)) {
+            Runnable* runnable = cell.runnable;
+            // free the slot for the producer one lap ahead
+            cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+            return runnable;
+         }
+      } else if (diff < 0) {
+         // slot hasn't been filled yet -- ring is empty
+         return nullptr;
+      } else {
+         pos = m_dequeuePos.load(std::memory_order_relaxed);
+      }
+   }
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::isAtLimit() const {
+   const std::size_t maxQueueSize = m_maxQueueSize.load(std::memory_order_relaxed);
+
+   if (maxQueueSize == 0) {
+      return false;
+   }
+
+   const std::size_t enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+   const std::size_t dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+
+   return (enqueuePos - dequeuePos) >= maxQueueSize;
+}
+
+//******************************************************************************
+
+void RingThreadPoolQueue::wakeTakers(std::size_t numberAdded) {
+   // pairs with the fence in parkTaker: either a parking taker sees our
+   // requests, or we see it counted as waiting and wake it
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+
+   const int numberWaiting = m_waitingTakers.load(std::memory_order_relaxed);
+
+   if ((numberWaiting > 0) && (numberAdded > 0)) {
+      m_notEmptyEpoch.fetch_add(1, std::memory_order_release);
+
+      // one wake-up per request, and none for takers that would find nothing
+      if (numberAdded >= static_cast<std::size_t>(numberWaiting)) {
+         m_notEmptyEpoch.notify_all();
+      } else {
+         for (std::size_t i = 0; i < numberAdded; ++i) {
+            m_notEmptyEpoch.notify_one();
+         }
+      }
+   }
+}
+
+//******************************************************************************
+
+void RingThreadPoolQueue::wakeAdders(std::size_t numberTaken) {
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+
+   if (m_waitingAdders.load(std::memory_order_relaxed) > 0) {
+      m_notFullEpoch.fetch_add(1, std::memory_order_release);
+
+      if (numberTaken > 1) {
+         m_notFullEpoch.notify_all();
+      } else {
+         m_notFullEpoch.notify_one();
+      }
+   }
+}
+
+//******************************************************************************
+
+void RingThreadPoolQueue::parkAdder() {
+   // announce ourselves and re-check before sleeping, in case a take freed
+   // a slot in the meantime
+   const std::uint32_t epoch = m_notFullEpoch.load(std::memory_order_acquire);
+   m_waitingAdders.fetch_add(1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+
+   if (m_isRunning.load(std::memory_order_relaxed) &&
+       (isAtLimit() || (m_enqueuePos.load(std::memory_order_relaxed) -
+                        m_dequeuePos.load(std::memory_order_relaxed) > m_mask))) {
+      m_notFullEpoch.wait(epoch, std::memory_order_acquire);
+   }
+
+   m_waitingAdders.fetch_sub(1, std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void RingThreadPoolQueue::parkTaker(const TakeRequestContext& ctx) {
+   if (spinUntil([this]() { return !isEmpty(); })) {
+      return;
+   }
+
+   // announce ourselves and re-check before sleeping, in case an add
+   // slipped in
+   const std::uint32_t epoch = m_notEmptyEpoch.load(std::memory_order_acquire);
+   m_waitingTakers.fetch_add(1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+
+   if (m_isRunning.load(std::memory_order_relaxed) && isEmpty() &&
+       !ctx.isStopRequested()) {
+      recordPark();
+      m_notEmptyEpoch.wait(epoch, std::memory_order_acquire);
+   }
+
+   m_waitingTakers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::addRequest(Runnable* runnableRequest) {
+   return addRequests(std::span<Runnable* const>(&runnableRequest, 1)) == 1;
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::addRequest(Task&& task, PriorityClass priority) {
+   (void) priority;
+
+   if (!task) {
+      LOG_WARNING("RingThreadPoolQueue::addRequest rejecting empty task")
+      return false;
+   }
+
+   // slots only hold Runnable pointers
+   TaskRunnable* taskRunnable = new TaskRunnable(std::move(task));
+   taskRunnable->setAutoDelete();
+
+   if (addRequest(taskRunnable)) {
+      return true;
+   }
+
+   // hand the task back to the caller
+   task = std::move(taskRunnable->getTask());
+   delete taskRunnable;
+   return false;
+}
+
+//******************************************************************************
+
+std::size_t RingThreadPoolQueue::addRequests(std::span<Runnable* const> runnableRequests) {
+   std::size_t numberAdded = 0;
+   std::size_t numberNotNotified = 0;
+
+   for (Runnable* runnableRequest : runnableRequests) {
+      if (nullptr == runnableRequest) {
+         LOG_WARNING("RingThreadPoolQueue::addRequest rejecting nullptr request")
+         break;
+      }
+
+      bool isAdded = false;
+
+      for (;;) {
+         if (!m_isRunning.load(std::memory_order_acquire)) {
+            LOG_WARNING("RingThreadPoolQueue::addRequest rejecting request, queue is shutting down")
+            break;
+         }
+
+         if (!isAtLimit() && tryEnqueue(runnableRequest)) {
+            isAdded = true;
+            break;
+         }
+
+         // at the max size, or the ring is full
+         const bool isRingFull = !isAtLimit();
+         if ((m_queueFullPolicy.load(std::memory_order_relaxed) == QueueFullPolicy::Reject) &&
+             !(isRingFull && (m_maxQueueSize.load(std::memory_order_relaxed) == 0))) {
+            LOG_WARNING("RingThreadPoolQueue::addRequest rejecting request, queue is full")
+            break;
+         }
+
+         // takers can only free up a slot for the requests they've been
+         // woken for
+         wakeTakers(numberNotNotified);
+         numberNotNotified = 0;
+
+         parkAdder();
+      }
+
+      if (!isAdded) {
+         break;
+      }
+
+      ++numberAdded;
+      ++numberNotNotified;
+   }
+
+   wakeTakers(numberNotNotified);
+
+   return numberAdded;
+}
+
+//******************************************************************************
+
+void RingThreadPoolQueue::takeRequest(TakeRequestContext& ctx) {
+   ctx.runnable = nullptr;
+   ctx.task.reset();
+   std::vector<Runnable*> dropped;
+
+   for (;;) {
+      if (!m_isRunning.load(std::memory_order_acquire)) {
+         ctx.isQueueRunning = false;
+         break;
+      }
+
+      ctx.isQueueRunning = true;
+
+      Runnable* runnable = tryDequeue();
+      if (nullptr != runnable) {
+         wakeAdders(1);
+
+         if (runnable->isExpired(now())) {
+            recordExpired();
+            dropped.push_back(runnable);
+            continue;
+         }
+
+         ctx.runnable = runnable;
+         break;
+      }
+
+      if (!ctx.waitIfNone || ctx.isStopRequested()) {
+         break;
+      }
+
+      parkTaker(ctx);
+   }
+
+   dropRequests(dropped);
+}
+
+//******************************************************************************
+
+void RingThreadPoolQueue::takeRequests(TakeRequestContext& ctx, std::size_t maxBatch) {
+   ctx.runnable = nullptr;
+   ctx.task.reset();
+   ctx.runnables.clear();
+   ctx.tasks.clear();
+   ctx.taskPriorities.clear();
+   std::vector<Runnable*> dropped;
+
+   for (;;) {
+      if (!m_isRunning.load(std::memory_order_acquire)) {
+         ctx.isQueueRunning = false;
+         break;
+      }
+
+      ctx.isQueueRunning = true;
+
+      // leave an even share for the takers that are still waiting
+      const std::size_t queued = m_enqueuePos.load(std::memory_order_relaxed) -
+                                 m_dequeuePos.load(std::memory_order_relaxed);
+      const std::size_t fairShare = queued /
+         static_cast<std::size_t>(m_waitingTakers.load(std::memory_order_relaxed) + 1);
+      const std::size_t numberToTake =
+         std::max(static_cast<std::size_t>(1), std::min(fairShare, maxBatch));
+
+      const std::uint64_t currentTime = now();
+      std::size_t numberDequeued = 0;
+
+      while (ctx.runnables.size() < numberToTake) {
+         Runnable* runnable = tryDequeue();
+         if (nullptr == runnable) {
+            break;
+         }
+
+         ++numberDequeued;
+
+         if (runnable->isExpired(currentTime)) {
+            recordExpired();
+            dropped.push_back(runnable);
+         } else {
+            ctx.runnables.push_back(runnable);
+         }
+      }
+
+      if (numberDequeued > 0) {
+         wakeAdders(numberDequeued);
+      }
+
+      if (!ctx.runnables.empty() || !ctx.waitIfNone || ctx.isStopRequested()) {
+         break;
+      }
+
+      parkTaker(ctx);
+   }
+
+   dropRequests(dropped);
+}
+
+//******************************************************************************
+
+void RingThreadPoolQueue::interruptTakers() {
+   // a taker checks its stop flag after announcing itself, so either it
+   // sees the flag or it's parked on an epoch this bump invalidates
+   m_notEmptyEpoch.fetch_add(1, std::memory_order_seq_cst);
+   m_notEmptyEpoch.notify_all();
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::shutDown() {
+   bool expected = true;
+
+   if (!m_isRunning.compare_exchange_strong(expected, false)) {
+      return false;
+   }
+
+   // wake everyone parked so that they see the queue is shutting down
+   m_notEmptyEpoch.fetch_add(1, std::memory_order_release);
+   m_notEmptyEpoch.notify_all();
+   m_notFullEpoch.fetch_add(1, std::memory_order_release);
+   m_notFullEpoch.notify_all();
+
+   return true;
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::restart() {
+   bool expected = false;
+   return m_isRunning.compare_exchange_strong(expected, true);
+}
+
+//******************************************************************************
+
+void RingThreadPoolQueue::setMaxQueueSize(std::size_t maxSize, QueueFullPolicy policy) {
+   m_maxQueueSize.store(maxSize, std::memory_order_relaxed);
+   m_queueFullPolicy.store(policy, std::memory_order_relaxed);
+
+   // raising or removing the limit may unblock an adder under Block
+   m_notFullEpoch.fetch_add(1, std::memory_order_release);
+   m_notFullEpoch.notify_all();
+}
+
+//******************************************************************************
+
+std::size_t RingThreadPoolQueue::getMaxQueueSize() const {
+   return m_maxQueueSize.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::setLaneMaxQueueSize(PriorityClass priority,
+                                              std::size_t maxSize,
+                                              QueueFullPolicy policy) {
+   (void) priority;
+   (void) maxSize;
+   (void) policy;
+   return false;
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::setPriorityScheduling(PriorityScheduling scheduling) {
+   (void) scheduling;
+   return false;
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::setLaneWeight(PriorityClass priority, unsigned int weight) {
+   (void) priority;
+   (void) weight;
+   return false;
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::setLoadShedding(std::uint64_t targetDelayMicros,
+                                          std::uint64_t intervalMicros) {
+   (void) targetDelayMicros;
+   (void) intervalMicros;
+   return false;
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::isRunning() const {
+   return m_isRunning.load(std::memory_order_acquire);
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::isEmpty() const {
+   // a slot that's claimed but not yet filled counts as not empty (its
+   // producer will wake any taker parked on it)
+   return m_enqueuePos.load(std::memory_order_relaxed) ==
+          m_dequeuePos.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+std::size_t RingThreadPoolQueue::getQueueSize() const {
+   const std::size_t dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+   const std::size_t enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+
+   // read in this order, a racing take can't make the size look negative
+   return (enqueuePos > dequeuePos) ? (enqueuePos - dequeuePos) : 0;
+}
+
+//******************************************************************************
+
+std::uint64_t RingThreadPoolQueue::getOldestRequestWaitTime() const {
+   const std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+   const Cell& cell = m_cells[pos & m_mask];
+
+   if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+      return 0;
+   }
+
+   // a sample -- the request may be taken (and the slot reused) meanwhile
+   const std::uint64_t addedTime = cell.addedTime.load(std::memory_order_relaxed);
+   const std::uint64_t currentTime = now();
+   return (currentTime > addedTime) ? (currentTime - addedTime) : 0;
+}
+
+//******************************************************************************
+
+std::size_t RingThreadPoolQueue::getNumberWaitingTakers() const {
+   return static_cast<std::size_t>(m_waitingTakers.load(std::memory_order_relaxed));
+}
+
+//******************************************************************************
+
+bool RingThreadPoolQueue::isInitialized() const {
+   return m_cells != nullptr;
+}
+
+//******************************************************************************
+
+std::size_t RingThreadPoolQueue::getCapacity() const {
+   return m_mask + 1;
+}
+
+//******************************************************************************
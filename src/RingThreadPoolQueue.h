@@ -0,0 +1,234 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_RINGTHREADPOOLQUEUE_H
+#define CHAUDIERE_RINGTHREADPOOLQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "ThreadPoolQueue.h"
+
+
+namespace chaudiere
+{
+
+/**
+ * RingThreadPoolQueue is a ThreadPoolQueue backed by a bounded lock-free
+ * multi-producer/multi-consumer ring (Dmitry Vyukov's design): each slot
+ * carries a sequence number that tells producers and consumers whether
+ * it's theirs to fill or empty, so adding or taking a request is one
+ * compare-and-swap on a cache-line-padded position counter, with no mutex.
+ *
+ * Threads only park when they have to -- a taker when the ring is empty,
+ * an adder under QueueFullPolicy::Block when it's full -- and they park on
+ * an eventcount built on C++20 atomic wait/notify (a futex on Linux). The
+ * other side only makes the wake-up system call when someone is actually
+ * parked.
+ *
+ * The ring's capacity is fixed at construction. setMaxQueueSize can lower
+ * the limit further; with no max size set (0), the ring's capacity is the
+ * limit and a full ring blocks the adder, so that requests are never
+ * dropped by a queue that's nominally unbounded.
+ *
+ * The ring is a single FIFO: it has no priority lanes, so a Runnable's
+ * priority class is ignored (and the lane settings are refused). Requests
+ * past their deadline are dropped when taken. Load shedding isn't
+ * supported: although slots record when they were filled, shedding also
+ * depends on when the queue was last empty, which the base class tracks
+ * under its lock and the ring's lock-free takers have no consistent way
+ * to maintain.
+ */
+class RingThreadPoolQueue : public ThreadPoolQueue
+{
+public:
+   static const std::size_t DEFAULT_CAPACITY = 4096;
+
+   /**
+    * Constructs a ring queue
+    * @param threadingFactory the threading factory
+    * @param capacity the ring's capacity (rounded up to a power of 2)
+    * @see ThreadingFactory()
+    */
+   RingThreadPoolQueue(ThreadingFactory* threadingFactory,
+                       std::size_t capacity = DEFAULT_CAPACITY);
+
+   /**
+    * Destructor
+    */
+   ~RingThreadPoolQueue();
+
+   /**
+    *
+    * @param runnableRequest
+    * @return
+    * @see Runnable()
+    */
+   bool addRequest(Runnable* runnableRequest) override;
+
+   /**
+    * Adds a task, wrapped in a TaskRunnable since the ring's slots only
+    * hold Runnables (so unlike ThreadPoolQueue, this allocates)
+    * @param task the task (moved from only if it's added)
+    * @param priority ignored (the ring has no priority lanes)
+    * @return boolean indicating if the task was added
+    */
+   bool addRequest(Task&& task,
+                   PriorityClass priority = PriorityClass::Normal) override;
+
+   /**
+    *
+    * @param ctx
+    */
+   void takeRequest(TakeRequestContext& ctx) override;
+
+   /**
+    * Adds a batch of requests, waking no more parked takers than there
+    * are requests
+    * @param runnableRequests the requests to add
+    * @return the number of requests added (a prefix of runnableRequests)
+    */
+   std::size_t addRequests(std::span<Runnable* const> runnableRequests) override;
+
+   /**
+    * Takes up to maxBatch requests at once into ctx.runnables
+    * @param ctx receives the requests taken and whether the queue is running
+    * @param maxBatch the maximum number of requests to take
+    */
+   void takeRequests(TakeRequestContext& ctx, std::size_t maxBatch) override;
+
+   /**
+    * Wakes every parked taker
+    */
+   void interruptTakers() override;
+
+   /**
+    *
+    * @return
+    */
+   bool shutDown() override;
+
+   /**
+    *
+    * @return
+    */
+   bool restart() override;
+
+   /**
+    * Sets a maximum number of pending requests below the ring's capacity,
+    * and how addRequest() behaves once that limit (or a full ring) is
+    * reached
+    * @param maxSize maximum number of pending requests (0 == ring capacity)
+    * @param policy what addRequest() does once the queue is at maxSize
+    */
+   void setMaxQueueSize(std::size_t maxSize,
+                        QueueFullPolicy policy = QueueFullPolicy::Reject) override;
+
+   /**
+    * @return the configured maximum queue size (0 == ring capacity)
+    */
+   std::size_t getMaxQueueSize() const override;
+
+   /**
+    * Not supported (the ring has a single lane)
+    * @return false
+    */
+   bool setLaneMaxQueueSize(PriorityClass priority,
+                            std::size_t maxSize,
+                            QueueFullPolicy policy = QueueFullPolicy::Reject) override;
+
+   /**
+    * Not supported (the ring has a single lane)
+    * @return false
+    */
+   bool setPriorityScheduling(PriorityScheduling scheduling) override;
+
+   /**
+    * Not supported (the ring has a single lane)
+    * @return false
+    */
+   bool setLaneWeight(PriorityClass priority, unsigned int weight) override;
+
+   /**
+    * Not supported (the ring doesn't track when it was last empty)
+    * @return false
+    */
+   bool setLoadShedding(std::uint64_t targetDelayMicros,
+                        std::uint64_t intervalMicros = 100000) override;
+
+   /**
+    *
+    * @return
+    */
+   bool isRunning() const override;
+
+   /**
+    *
+    * @return
+    */
+   bool isEmpty() const override;
+
+   /**
+    * @return the number of requests waiting to be taken
+    */
+   std::size_t getQueueSize() const override;
+
+   /**
+    * @return how long (in microseconds) the oldest request has been waiting
+    */
+   std::uint64_t getOldestRequestWaitTime() const override;
+
+   /**
+    * @return the number of parked takers
+    */
+   std::size_t getNumberWaitingTakers() const override;
+
+   /**
+    *
+    * @return
+    */
+   bool isInitialized() const override;
+
+   /**
+    * @return the ring's capacity
+    */
+   std::size_t getCapacity() const;
+
+
+private:
+   struct alignas(64) Cell {
+      std::atomic<std::size_t> sequence;
+      std::atomic<std::uint64_t> addedTime;
+      Runnable* runnable;
+   };
+
+   bool tryEnqueue(Runnable* runnableRequest);
+   Runnable* tryDequeue();
+   bool isAtLimit() const;
+   void wakeTakers(std::size_t numberAdded);
+   void wakeAdders(std::size_t numberTaken);
+   void parkTaker(const TakeRequestContext& ctx);
+   void parkAdder();
+
+   std::unique_ptr<Cell[]> m_cells;
+   std::size_t m_mask;
+   alignas(64) std::atomic<std::size_t> m_enqueuePos;
+   alignas(64) std::atomic<std::size_t> m_dequeuePos;
+   alignas(64) std::atomic<std::uint32_t> m_notEmptyEpoch;
+   std::atomic<int> m_waitingTakers;
+   alignas(64) std::atomic<std::uint32_t> m_notFullEpoch;
+   std::atomic<int> m_waitingAdders;
+   std::atomic<std::size_t> m_maxQueueSize;
+   std::atomic<QueueFullPolicy> m_queueFullPolicy;
+   std::atomic<bool> m_isRunning;
+
+   // disallow copies
+   RingThreadPoolQueue(const RingThreadPoolQueue&);
+   RingThreadPoolQueue& operator=(const RingThreadPoolQueue&);
+};
+
+}
+
+#endif
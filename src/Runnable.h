@@ -4,6 +4,9 @@
 #ifndef CHAUDIERE_RUNNABLE_H
 #define CHAUDIERE_RUNNABLE_H
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <memory>
 
@@ -13,6 +16,20 @@
 namespace chaudiere
 {
 
+/**
+ * Priority class of a Runnable. A ThreadPoolQueue keeps a lane per class,
+ * so that latency-critical requests (health checks, admin commands) don't
+ * wait behind bulk work.
+ */
+enum class PriorityClass {
+   Critical = 0,
+   High = 1,
+   Normal = 2,   // default
+   Bulk = 3
+};
+
+static const std::size_t NUMBER_PRIORITY_CLASSES = 4;
+
 /**
  * Runnable is an abstract base class that's conceptually very similar to
  * Java's Runnable interface for classes that can be used in background
@@ -27,6 +44,9 @@ public:
    Runnable() :
       m_completionObserver(nullptr),
       m_runByThreadId(0),
+      m_priority(PriorityClass::Normal),
+      m_enqueuedTime(0),
+      m_deadline(0),
       m_autoDelete(false) {
    }
 
@@ -82,6 +102,25 @@ public:
        m_completionObserver = completionObserver;
    }
 
+   /**
+    * This should only be called immediately BEFORE the run method is called
+    * (i.e., on the thread that's about to run it)
+    */
+   virtual void notifyOnStart() {
+   }
+
+   /**
+    * Called instead of run (and notifyOnCompletion) when the Runnable is
+    * dropped without being run, e.g., by a ThreadPoolQueue because its
+    * deadline passed or to shed load. Observers still hear about it as a
+    * completion, so that whatever waits on the Runnable isn't left hanging.
+    */
+   virtual void notifyOnDropped() {
+      if (m_completionObserver != nullptr) {
+         m_completionObserver->notifyRunComplete(this);
+      }
+   }
+
    /**
     * This should only be called AFTER the run method has completed
     */
@@ -91,6 +130,82 @@ public:
       }
    }
 
+   /**
+    * Sets the priority class that the Runnable is queued under
+    * @param priority the priority class
+    */
+   virtual void setPriority(PriorityClass priority) {
+      m_priority = priority;
+   }
+
+   /**
+    * @return the priority class (Normal by default)
+    */
+   virtual PriorityClass getPriority() const {
+      return m_priority;
+   }
+
+   /**
+    * Sets when the Runnable became ready to run (e.g., when its request
+    * arrived), so that a queue measures its wait from then rather than
+    * from when it was queued
+    * @param enqueuedTime steady clock time in microseconds (0 == unset)
+    * @see currentTimeMicros()
+    */
+   void setEnqueuedTime(std::uint64_t enqueuedTime) {
+      m_enqueuedTime = enqueuedTime;
+   }
+
+   /**
+    * @return when the Runnable became ready to run (0 if unset)
+    */
+   std::uint64_t getEnqueuedTime() const {
+      return m_enqueuedTime;
+   }
+
+   /**
+    * Sets a deadline after which the Runnable isn't worth running anymore
+    * (e.g., because its client has given up). A queue drops it, rather
+    * than handing it to a worker, once the deadline has passed.
+    * @param deadline steady clock time in microseconds (0 == no deadline)
+    * @see currentTimeMicros()
+    */
+   void setDeadline(std::uint64_t deadline) {
+      m_deadline = deadline;
+   }
+
+   /**
+    * Sets the deadline relative to now
+    * @param timeoutMicros microseconds from now
+    */
+   void setTimeout(std::uint64_t timeoutMicros) {
+      m_deadline = currentTimeMicros() + timeoutMicros;
+   }
+
+   /**
+    * @return the deadline (0 if none)
+    */
+   std::uint64_t getDeadline() const {
+      return m_deadline;
+   }
+
+   /**
+    * @param now the current steady clock time in microseconds
+    * @return boolean indicating if the Runnable has a deadline that has passed
+    */
+   bool isExpired(std::uint64_t now) const {
+      return (m_deadline > 0) && (now > m_deadline);
+   }
+
+   /**
+    * @return the current steady clock time in microseconds (the time base
+    * for enqueued times and deadlines)
+    */
+   static std::uint64_t currentTimeMicros() {
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
    virtual bool isAutoDelete() const {
       return m_autoDelete;
    }
@@ -99,10 +214,28 @@ public:
       m_autoDelete = true;
    }
 
+protected:
+   /**
+    * Restores the state of a newly constructed Runnable, for a Runnable
+    * that's recycled rather than deleted
+    */
+   void resetRunnable() {
+      m_completionObserver = nullptr;
+      m_runByThreadWorkerId.clear();
+      m_runByThreadId = 0;
+      m_priority = PriorityClass::Normal;
+      m_enqueuedTime = 0;
+      m_deadline = 0;
+      m_autoDelete = false;
+   }
+
 private:
    RunCompletionObserver* m_completionObserver;
    std::string m_runByThreadWorkerId;
    int m_runByThreadId;
+   PriorityClass m_priority;
+   std::uint64_t m_enqueuedTime;
+   std::uint64_t m_deadline;
    bool m_autoDelete;
 
    // disallow copies
@@ -5,6 +5,7 @@
 #include <cstring>
 
 #include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 #include "ServerSocket.h"
@@ -37,6 +38,37 @@ bool ServerSocket::setReuseAddr(int socketFD) {
 
 //******************************************************************************
 
+bool ServerSocket::setReusePort(int socketFD) {
+#ifdef SO_REUSEPORT
+   int val_to_set = 1;
+
+   if (0 == ::setsockopt(socketFD,
+                         SOL_SOCKET,
+                         SO_REUSEPORT,
+                         (char *) &val_to_set,
+                         sizeof(val_to_set))) {
+      return true;
+   } else {
+      return false;
+   }
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+bool ServerSocket::setNonBlocking(int socketFD) {
+   const int flags = ::fcntl(socketFD, F_GETFL, 0);
+   if (flags == -1) {
+      return false;
+   }
+
+   return ::fcntl(socketFD, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+//******************************************************************************
+
 bool ServerSocket::listen(int socketFD, int backlog) {
    if (::listen(socketFD, backlog) != 0) {
       LOG_ERROR("unable to listen on server socket")
@@ -109,8 +141,15 @@ bool ServerSocket::bind(int socketFD, int port) {
 //******************************************************************************
 
 ServerSocket::ServerSocket(int port) :
+   ServerSocket(port, BACKLOG) {
+}
+
+//******************************************************************************
+
+ServerSocket::ServerSocket(int port, int backlog) :
    m_serverSocket(-1),
-   m_port(port) {
+   m_port(port),
+   m_backlog(backlog) {
    LOG_INSTANCE_CREATE("ServerSocket")
 
    if (!create()) {
@@ -147,7 +186,7 @@ bool ServerSocket::create() {
 //******************************************************************************
 
 bool ServerSocket::listen() {
-   return ServerSocket::listen(m_serverSocket, BACKLOG);
+   return ServerSocket::listen(m_serverSocket, m_backlog);
 }
 
 //******************************************************************************
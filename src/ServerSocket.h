@@ -29,6 +29,23 @@ class ServerSocket
        */
       static bool setReuseAddr(int socketFD);
 
+      /**
+       * Turns on the reuse port option (SO_REUSEPORT) on the specified
+       * socket, allowing several sockets to bind the same port so the
+       * kernel can load-balance incoming connections across them
+       * @param socketFD the socket file descriptor to change
+       * @return boolean indicating whether the update succeeded (always
+       *         false on platforms without SO_REUSEPORT)
+       */
+      static bool setReusePort(int socketFD);
+
+      /**
+       * Puts the specified socket into non-blocking mode
+       * @param socketFD the socket file descriptor to change
+       * @return boolean indicating whether the update succeeded
+       */
+      static bool setNonBlocking(int socketFD);
+
       /**
        * Starts the listening on the specified socket
        * @param socketFD the socket file descriptor to listen
@@ -52,6 +69,14 @@ class ServerSocket
        */
       explicit ServerSocket(int port);
 
+      /**
+       * Creates a new server socket and starts listening on the specified port
+       * @param port the port number to listen on
+       * @param backlog the backlog value for listening
+       * @throw BasicException
+       */
+      ServerSocket(int port, int backlog);
+
       /**
        * Destructor
        */
@@ -90,6 +115,7 @@ class ServerSocket
 
       int m_serverSocket;
       int m_port;
+      int m_backlog;
 };
 
 }
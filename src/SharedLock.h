@@ -0,0 +1,76 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_SHAREDLOCK_H
+#define CHAUDIERE_SHAREDLOCK_H
+
+#include "ReadWriteLock.h"
+
+namespace chaudiere
+{
+
+/**
+ * BasicSharedLock is a convenience class for holding a reader-writer lock
+ * shared (for reading) with RAII, in the manner of MutexLock. L is the
+ * lock type: ReadWriteLock (see SharedLock) goes through its interface,
+ * while a concrete type binds the calls at compile time.
+ */
+template <typename L>
+class BasicSharedLock
+{
+public:
+   explicit BasicSharedLock(L& readWriteLock) :
+      m_lock(readWriteLock),
+      m_name(nullptr),
+      m_owns(true) {
+      m_lock.lockShared();
+   }
+
+   /**
+    * Locks the given lock shared
+    * @param readWriteLock the lock to lock
+    * @param name the call site's name (a string literal; not copied)
+    * @see ReadWriteLock()
+    */
+   explicit BasicSharedLock(L& readWriteLock, const char* name) :
+      m_lock(readWriteLock),
+      m_name(name),
+      m_owns(true) {
+      m_lock.lockShared();
+   }
+
+   /**
+    * Destructor - releases the lock (if not already released via unlock())
+    */
+   ~BasicSharedLock() {
+      if (m_owns) {
+         m_lock.unlockShared();
+      }
+   }
+
+   void unlock() {
+      if (m_owns) {
+         m_lock.unlockShared();
+         m_owns = false;
+      }
+   }
+
+private:
+   L& m_lock;
+   const char* m_name;
+   bool m_owns;
+
+   BasicSharedLock();
+   BasicSharedLock(const BasicSharedLock&);
+   BasicSharedLock& operator=(const BasicSharedLock&);
+
+};
+
+/**
+ * SharedLock is a BasicSharedLock for any ReadWriteLock (through its interface)
+ */
+typedef BasicSharedLock<ReadWriteLock> SharedLock;
+
+}
+
+#endif
@@ -169,6 +169,15 @@ void Socket::closeConnection() {
 
 //******************************************************************************
 
+void Socket::shutdownConnection() {
+   if (m_socketFD > -1) {
+      shutdown(m_socketFD, SHUT_RDWR);
+      m_isConnected = false;
+   }
+}
+
+//******************************************************************************
+
 void Socket::close() {
    if (m_socketFD > -1) {
       shutdown(m_socketFD, SHUT_RDWR);
@@ -196,6 +205,32 @@ int Socket::getFileDescriptor() const {
 
 //******************************************************************************
 
+int Socket::releaseFileDescriptor() {
+   const int socketFD = m_socketFD;
+   m_socketFD = -1;
+   m_isConnected = false;
+   return socketFD;
+}
+
+//******************************************************************************
+
+void Socket::resetBorrowed(SocketCompletionObserver* completionObserver,
+                           int socketFD) {
+   m_completionObserver = completionObserver;
+   m_lineInputBuffer.clear();
+   m_serverAddress.clear();
+   m_socketFD = socketFD;
+   m_userIndex = -1;
+   m_port = -1;
+   m_isConnected = true;  // a guess (we have no way of knowing for sure)
+   m_includeMessageSize = false;
+   m_borrowedDescriptor = true;
+   m_inBufferSize = DEFAULT_BUFFER_SIZE;
+   m_lastReadSize = 0;
+}
+
+//******************************************************************************
+
 void Socket::requestComplete() {
    if (m_completionObserver) {
       m_completionObserver->notifySocketComplete(this);
@@ -204,6 +239,14 @@ void Socket::requestComplete() {
 
 //******************************************************************************
 
+void Socket::requestDropped() {
+   if (m_completionObserver) {
+      m_completionObserver->notifySocketDropped(this);
+   }
+}
+
+//******************************************************************************
+
 void Socket::setUserIndex(int userIndex) {
    m_userIndex = userIndex;
 }
@@ -917,6 +960,44 @@ bool Socket::write(const std::string& payload) {
 
 //******************************************************************************
 
+bool Socket::writeAsync(const char* buffer, unsigned long bufsize) {
+   if (!isConnected()) {
+      LOG_WARNING("unable to write message, socket is closed")
+      return false;
+   }
+
+   if ((nullptr == m_completionObserver) ||
+       !m_completionObserver->isAsyncWriteSupported()) {
+      return sendPayload(buffer, bufsize, 0);
+   }
+
+   if (m_includeMessageSize) {
+      if (bufsize > 65535) {
+         return false;
+      }
+
+      // the size prefix and payload must stay together in the queue
+      const uint16_t nOrderSize = htons((uint16_t) bufsize);
+      std::string message;
+      message.reserve(sizeof(uint16_t) + bufsize);
+      message.append((const char*) &nOrderSize, sizeof(uint16_t));
+      message.append(buffer, bufsize);
+      return m_completionObserver->writeAsync(m_socketFD,
+                                              message.data(),
+                                              message.size());
+   }
+
+   return m_completionObserver->writeAsync(m_socketFD, buffer, bufsize);
+}
+
+//******************************************************************************
+
+bool Socket::writeAsync(const std::string& payload) {
+   return writeAsync(payload.c_str(), payload.length());
+}
+
+//******************************************************************************
+
 int Socket::getPort() const {
    return m_port;
 }
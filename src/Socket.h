@@ -119,6 +119,28 @@ public:
     */
    bool write(const std::string& payload);
 
+   /**
+    * Writes the specified buffer without tying up the calling thread until
+    * the peer has read it. If the completion observer (e.g., a kernel event
+    * server) supports it, the bytes that can't be sent right away are handed
+    * to it and sent from its event loop once the socket is writable;
+    * otherwise this is the same as write(). Don't mix with write() within a
+    * request -- bytes still queued would be overtaken.
+    * @param buffer the buffer to write from
+    * @param bufsize the size of the buffer
+    * @return boolean indicating whether the write succeeded (or was queued)
+    */
+   bool writeAsync(const char* buffer, unsigned long bufsize);
+
+   /**
+    * Writes the specified string without tying up the calling thread until
+    * the peer has read it
+    * @param payload the string to write
+    * @return boolean indicating whether the write succeeded (or was queued)
+    * @see writeAsync(const char*, unsigned long)
+    */
+   bool writeAsync(const std::string& payload);
+
    /**
     * Low-level receive of data from socket into specified buffer and with specified flags
     * @param receiveBuffer the buffer to receive the data read
@@ -181,18 +203,48 @@ public:
     */
    void closeConnection();
 
+   /**
+    * Shuts down both directions of the connection without closing the file
+    * descriptor (which is left to whoever owns it, see requestDropped)
+    */
+   void shutdownConnection();
+
    /**
     * Returns the file descriptor for the socket
     * @return the file descriptor or -1 if one has not been set or if the connection has been closed
     */
    int getFileDescriptor() const;
 
+   /**
+    * Gives up ownership of the file descriptor without closing it, so that
+    * something else (e.g. a kernel event server) controls its lifetime
+    * @return the released file descriptor, or -1 if there wasn't one
+    */
+   int releaseFileDescriptor();
+
+   /**
+    * Reinitializes the socket for another borrowed file descriptor, as if
+    * it had just been constructed with it, keeping the buffers it has
+    * already allocated (for recycling sockets instead of reallocating)
+    * @param completionObserver the observer to notify on completion
+    * @param socketFD the borrowed file descriptor
+    * @see SocketCompletionObserver()
+    */
+   void resetBorrowed(SocketCompletionObserver* completionObserver, int socketFD);
+
    /**
     * A signalling method to indicate that the necessary processing is complete. Calling this
     * method will trigger a call to the completion observer if one has been set.
     */
    void requestComplete();
 
+   /**
+    * Signals that the request on the socket was dropped without being
+    * processed. Calling this method will trigger a call to the completion
+    * observer's notifySocketDropped if one has been set.
+    */
+   void requestDropped();
+
    /**
     * Sets the user index for the socket
     * @param userIndex the user index to set
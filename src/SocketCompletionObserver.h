@@ -4,6 +4,7 @@
 #ifndef CHAUDIERE_SOCKETCOMPLETIONOBSERVER_H
 #define CHAUDIERE_SOCKETCOMPLETIONOBSERVER_H
 
+#include <cstddef>
 #include <memory>
 
 
@@ -29,6 +30,42 @@ public:
     */
    virtual void notifySocketComplete(Socket* socket) = 0;
 
+   /**
+    * Notifies the observer that the request on the specified socket was
+    * dropped (expired or shed) before it ran, and its connection shut down.
+    * The connection won't be used again, so an observer that watches the
+    * socket's file descriptor closes it.
+    * @param socket the socket whose request was dropped
+    */
+   virtual void notifySocketDropped(Socket* socket) {
+      notifySocketComplete(socket);
+   }
+
+   /**
+    * Determines whether the observer can take over sending output for its
+    * sockets (see writeAsync)
+    * @return boolean indicating if asynchronous writes are supported
+    */
+   virtual bool isAsyncWriteSupported() const {
+      return false;
+   }
+
+   /**
+    * Sends whatever part of the buffer can go out without blocking and keeps
+    * the rest to be sent once the socket is writable. The request that did
+    * the write isn't complete (and its connection isn't watched for the next
+    * request) until all of it has been sent.
+    * @param socketFD the socket's file descriptor
+    * @param buffer the bytes to write
+    * @param bufferLength the number of bytes to write
+    * @return boolean indicating whether the write was accepted
+    */
+   virtual bool writeAsync(int /*socketFD*/,
+                           const char* /*buffer*/,
+                           std::size_t /*bufferLength*/) {
+      return false;
+   }
+
 };
 
 }
@@ -5,6 +5,7 @@
 
 #include "SocketRequest.h"
 #include "SocketServiceHandler.h"
+#include "EventLoopStats.h"
 #include "Logger.h"
 #include "BasicException.h"
 
@@ -18,8 +19,11 @@ SocketRequest::SocketRequest(Socket* socket,
    m_socket(socket),
    m_borrowedSocket(socket),
    m_handler(handler),
+   m_eventLoopStats(nullptr),
+   m_readyTime(0),
    m_containedSocket(-1),  // not used
-   m_socketOwned(true) {
+   m_socketOwned(true),
+   m_isPooled(false) {
    LOG_INSTANCE_CREATE("SocketRequest")
 }
 
@@ -32,8 +36,11 @@ SocketRequest::SocketRequest(SocketCompletionObserver* completionObserver,
    m_socket(nullptr),
    m_borrowedSocket(nullptr),  // not used
    m_handler(handler),
+   m_eventLoopStats(nullptr),
+   m_readyTime(0),
    m_containedSocket(completionObserver, socketFD),
-   m_socketOwned(false) {
+   m_socketOwned(false),
+   m_isPooled(false) {
    LOG_INSTANCE_CREATE("SocketRequest")
    m_socket = &m_containedSocket;
 }
@@ -46,11 +53,62 @@ SocketRequest::~SocketRequest() {
       delete m_borrowedSocket;
       m_borrowedSocket = nullptr;
       m_socket = nullptr;
+   } else if (!m_socketOwned) {
+      // the kernel event server that created us keeps the connection open
+      // (and watched) across requests, so don't close it on the way out
+      m_containedSocket.releaseFileDescriptor();
    }
 }
 
 //******************************************************************************
 
+SocketRequest* SocketRequest::create(SocketCompletionObserver* completionObserver,
+                                     int socketFD,
+                                     SocketServiceHandler* handler) {
+   SocketRequest* socketRequest = ObjectPool<SocketRequest>::instance().acquire();
+
+   if (nullptr == socketRequest) {
+      socketRequest = new SocketRequest(completionObserver, socketFD, handler);
+   } else {
+      // (idle requests have released their socket's descriptor)
+      socketRequest->resetRunnable();
+      socketRequest->m_handler = handler;
+      socketRequest->m_eventLoopStats = nullptr;
+      socketRequest->m_readyTime = 0;
+      socketRequest->m_containedSocket.resetBorrowed(completionObserver, socketFD);
+      socketRequest->m_socketOwned = false;
+   }
+
+   socketRequest->m_isPooled = true;
+
+   return socketRequest;
+}
+
+//******************************************************************************
+
+void SocketRequest::recycle(SocketRequest* socketRequest) {
+   if (nullptr == socketRequest) {
+      return;
+   }
+
+   // (a request that took ownership of its socket closes it on deletion)
+   if (!socketRequest->m_isPooled || socketRequest->m_socketOwned) {
+      delete socketRequest;
+      return;
+   }
+
+   socketRequest->m_containedSocket.releaseFileDescriptor();
+   ObjectPool<SocketRequest>::instance().release(socketRequest);
+}
+
+//******************************************************************************
+
+ObjectPoolStats SocketRequest::getPoolStats() {
+   return ObjectPool<SocketRequest>::instance().getStats();
+}
+
+//******************************************************************************
+
 void SocketRequest::run() {
    if (Logger::isLogging(Debug)) {
       char msg[128];
@@ -116,6 +174,27 @@ void SocketRequest::setUserIndex(int userIndex) {
 
 //******************************************************************************
 
+void SocketRequest::setDispatchStats(EventLoopStats* eventLoopStats,
+                                     std::uint64_t readyTime) {
+   m_eventLoopStats = eventLoopStats;
+   m_readyTime = readyTime;
+}
+
+//******************************************************************************
+
+void SocketRequest::notifyOnStart() {
+   Runnable::notifyOnStart();
+   if (nullptr != m_eventLoopStats) {
+      const std::uint64_t startTime = EventLoopStats::now();
+      m_eventLoopStats->recordDispatchLatency(
+         startTime > m_readyTime ? startTime - m_readyTime : 0);
+      // only the first start counts
+      m_eventLoopStats = nullptr;
+   }
+}
+
+//******************************************************************************
+
 void SocketRequest::notifyOnCompletion() {
    requestComplete();
    Runnable::notifyOnCompletion();
@@ -124,3 +203,14 @@ void SocketRequest::notifyOnCompletion() {
 
 //******************************************************************************
 
+void SocketRequest::notifyOnDropped() {
+   if (nullptr != m_socket) {
+      m_socket->shutdownConnection();
+      m_socket->requestDropped();
+   }
+
+   Runnable::notifyOnCompletion();
+}
+
+//******************************************************************************
+
@@ -4,7 +4,9 @@
 #ifndef CHAUDIERE_SOCKETREQUEST_H
 #define CHAUDIERE_SOCKETREQUEST_H
 
+#include <cstdint>
 #include <memory>
+#include "ObjectPool.h"
 #include "Runnable.h"
 #include "Socket.h"
 
@@ -13,6 +15,7 @@ namespace chaudiere
 {
    class SocketServiceHandler;
    class SocketCompletionObserver;
+   class EventLoopStats;
 
 /**
  *
@@ -38,6 +41,30 @@ public:
     */
    ~SocketRequest();
 
+   /**
+    * Creates a SocketRequest for a borrowed file descriptor (as with the
+    * constructor), recycling an idle one from the pool when there is one
+    * @param completionObserver the observer to notify on completion
+    * @param socketFD the borrowed file descriptor
+    * @param handler the handler to use for processing with the Socket
+    * @return the request (give it back with recycle)
+    */
+   static SocketRequest* create(SocketCompletionObserver* completionObserver,
+                                int socketFD,
+                                SocketServiceHandler* handler);
+
+   /**
+    * Finishes with a request: one from create goes back to the pool, and
+    * any other is deleted
+    * @param socketRequest the request
+    */
+   static void recycle(SocketRequest* socketRequest);
+
+   /**
+    * @return the hit, miss and discard counters of the request pool
+    */
+   static ObjectPoolStats getPoolStats();
+
    /**
     * Services the socket using the specified handler
     */
@@ -78,17 +105,42 @@ public:
     */
    void setUserIndex(int index);
 
+   /**
+    * Sets the event loop statistics that the request's dispatch latency is
+    * recorded to when its handler starts
+    * @param eventLoopStats the event loop's statistics
+    * @param readyTime when the request's event was returned to the event
+    * loop (see EventLoopStats::now)
+    * @see EventLoopStats()
+    */
+   void setDispatchStats(EventLoopStats* eventLoopStats, std::uint64_t readyTime);
+
+   /**
+    * Records the request's dispatch latency (if dispatch statistics were set)
+    */
+   virtual void notifyOnStart();
+
    /**
     *
     */
    virtual void notifyOnCompletion();
 
+   /**
+    * Shuts down the connection of a request that was dropped (expired or
+    * shed) before it ran, and tells the socket's completion observer, which
+    * closes the connection
+    */
+   virtual void notifyOnDropped();
+
 private:
    Socket* m_socket;
    Socket* m_borrowedSocket;
    SocketServiceHandler* m_handler;
+   EventLoopStats* m_eventLoopStats;
+   std::uint64_t m_readyTime;
    Socket m_containedSocket;
    bool m_socketOwned;
+   bool m_isPooled;
 
    // copies not allowed
    SocketRequest(const SocketRequest&);
@@ -1,8 +1,11 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <exception>
+#include <utility>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -20,6 +23,7 @@
 
 // utils
 #include "BasicException.h"
+#include "NumberFormatException.h"
 #include "IniReader.h"
 #include "KeyValuePairs.h"
 #include "StrUtils.h"
@@ -28,15 +32,19 @@
 
 // threading
 #include "Mutex.h"
+#include "LockProfiler.h"
 #include "Runnable.h"
 #include "Thread.h"
+#include "ThreadPool.h"
 #include "ThreadPoolDispatcher.h"
 #include "ThreadingFactory.h"
 #include "PthreadsThreadingFactory.h"
-//#include "StdThreadingFactory.h"
+#include "StdThreadingFactory.h"
+#include "LinuxThreadingFactory.h"
 
 // kernel events
 #include "EpollServer.h"
+#include "IoUringServer.h"
 #include "KqueueServer.h"
 
 #include "AutoPointer.h"
@@ -58,6 +66,18 @@ static const int CFG_DEFAULT_PORT_NUMBER          = 9000;
 
 static const int CFG_DEFAULT_THREAD_POOL_SIZE     = 4;
 
+static const int CFG_DEFAULT_EVENT_LOOPS          = 1;
+static const int CFG_DEFAULT_LISTEN_BACKLOG       = SOMAXCONN;
+static const int CFG_DEFAULT_IDLE_TIMEOUT         = 0;
+static const int CFG_DEFAULT_INLINE_THRESHOLD     = 0;
+static const int CFG_DEFAULT_POOL_TARGET_DELAY    = 10;      // ms
+static const int CFG_DEFAULT_POOL_IDLE_COOLDOWN   = 10000;   // ms
+static const int CFG_DEFAULT_LOAD_SHEDDING_INTERVAL = 100;   // ms
+
+// while adaptive inlining has measured handlers as too slow, one request in
+// this many is still run inline so that the measurement can recover
+static const std::uint64_t INLINE_PROBE_INTERVAL  = 64;
+
 
 // configuration sections
 static const std::string CFG_SECTION_SERVER                 = "server";
@@ -71,7 +91,28 @@ static const std::string CFG_SECTION_SERVER                 = "server";
 static const std::string CFG_SERVER_PORT                    = "port";
 static const std::string CFG_SERVER_THREADING               = "threading";
 static const std::string CFG_SERVER_THREAD_POOL_SIZE        = "thread_pool_size";
+static const std::string CFG_SERVER_THREAD_POOL_TYPE        = "thread_pool_type";
+static const std::string CFG_SERVER_THREAD_POOL_MIN_SIZE    = "thread_pool_min_size";
+static const std::string CFG_SERVER_THREAD_POOL_MAX_SIZE    = "thread_pool_max_size";
+static const std::string CFG_SERVER_THREAD_POOL_TARGET_DELAY = "thread_pool_target_delay_ms";
+static const std::string CFG_SERVER_THREAD_POOL_IDLE_COOLDOWN = "thread_pool_idle_cooldown_ms";
+static const std::string CFG_SERVER_THREAD_POOL_SCHEDULING  = "thread_pool_scheduling";
+static const std::string CFG_SERVER_THREAD_POOL_STARVATION  = "thread_pool_starvation_ms";
+static const std::string CFG_SERVER_REQUEST_TIMEOUT         = "request_timeout_ms";
+static const std::string CFG_SERVER_LOAD_SHEDDING_TARGET    = "load_shedding_target_ms";
+static const std::string CFG_SERVER_LOAD_SHEDDING_INTERVAL  = "load_shedding_interval_ms";
+static const std::string CFG_SERVER_THREAD_CPUS             = "thread_cpus";
+static const std::string CFG_SERVER_NUMA_NODE               = "numa_node";
+static const std::string CFG_SERVER_THREAD_STACK_SIZE       = "thread_stack_size_kb";
+static const std::string CFG_SERVER_THREAD_SCHEDULING       = "thread_scheduling";
+static const std::string CFG_SERVER_THREAD_PRIORITY         = "thread_priority";
+static const std::string CFG_SERVER_EVENT_LOOPS             = "event_loops";
+static const std::string CFG_SERVER_LISTEN_BACKLOG          = "listen_backlog";
+static const std::string CFG_SERVER_IDLE_TIMEOUT            = "idle_timeout";
+static const std::string CFG_SERVER_INLINE_THRESHOLD        = "inline_threshold_us";
+static const std::string CFG_SERVER_IO_URING                = "io_uring";
 static const std::string CFG_SERVER_LOG_LEVEL               = "log_level";
+static const std::string CFG_SERVER_LOCK_PROFILING          = "lock_profiling";
 static const std::string CFG_SERVER_SEND_BUFFER_SIZE        = "socket_send_buffer_size";
 static const std::string CFG_SERVER_RECEIVE_BUFFER_SIZE     = "socket_receive_buffer_size";
 //static const std::string CFG_SERVER_ALLOW_BUILTIN_HANDLERS  = "allow_builtin_handlers";
@@ -87,8 +128,18 @@ static const std::string CFG_SOCKETS_KERNEL_EVENTS          = "kernel_events";
 static const std::string CFG_THREADING_PTHREADS             = "pthreads";
 static const std::string CFG_THREADING_CPP11                = "c++11";
 static const std::string CFG_THREADING_GCD_LIBDISPATCH      = "gcd_libdispatch";
+static const std::string CFG_THREADING_FUTEX                = "futex";
 static const std::string CFG_THREADING_NONE                 = "none";
 
+// thread pool types
+static const std::string CFG_THREAD_POOL_SHARED             = "shared";
+static const std::string CFG_THREAD_POOL_RING               = "ring";
+static const std::string CFG_THREAD_POOL_WORK_STEALING      = "work_stealing";
+
+// thread pool priority scheduling
+static const std::string CFG_SCHEDULING_STRICT              = "strict";
+static const std::string CFG_SCHEDULING_WEIGHTED            = "weighted";
+
 // logging level options
 static const std::string CFG_LOGGING_CRITICAL               = "critical";
 static const std::string CFG_LOGGING_ERROR                  = "error";
@@ -120,23 +171,70 @@ static const char* LOG_MONTH_NAME[12] = {
 
 using namespace chaudiere;
 
+namespace {
+
+// Runs one KernelEventServer's event loop on a thread of its own (used
+// when more than one event loop has been configured).
+class KernelEventServerRunner : public Runnable
+{
+public:
+   explicit KernelEventServerRunner(KernelEventServer& kernelEventServer) :
+      m_kernelEventServer(kernelEventServer) {
+   }
+
+   void run() override {
+      try {
+         m_kernelEventServer.run();
+      } catch (const BasicException& be) {
+         LOG_CRITICAL("exception running kernel event loop: " + be.whatString())
+      } catch (const std::exception& e) {
+         LOG_CRITICAL("exception running kernel event loop: " + std::string(e.what()))
+      } catch (...) {
+         LOG_CRITICAL("unidentified exception running kernel event loop")
+      }
+   }
+
+private:
+   KernelEventServer& m_kernelEventServer;
+};
+
+}
+
 //******************************************************************************
 //******************************************************************************
 
 SocketServer::SocketServer(const std::string& serverName,
                            const std::string& serverVersion,
                            const std::string& configFilePath) :
-   m_kernelEventServer(nullptr),
    m_threadPool(nullptr),
    m_threadingFactory(nullptr),
+   m_replacedThreadingFactory(nullptr),
    m_configFilePath(configFilePath),
    m_serverName(serverName),
    m_serverVersion(serverVersion),
    m_isDone(false),
    m_isThreaded(true),
    m_isUsingKernelEventServer(false),
+   m_isUsingIoUring(true),
    m_isFullyInitialized(false),
    m_threadPoolSize(CFG_DEFAULT_THREAD_POOL_SIZE),
+   m_threadPoolMinSize(0),
+   m_threadPoolMaxSize(0),
+   m_threadPoolTargetDelay(CFG_DEFAULT_POOL_TARGET_DELAY),
+   m_threadPoolIdleCooldown(CFG_DEFAULT_POOL_IDLE_COOLDOWN),
+   m_priorityScheduling(PriorityScheduling::Strict),
+   m_starvationThreshold(-1),
+   m_requestTimeout(0),
+   m_loadSheddingTarget(0),
+   m_loadSheddingInterval(CFG_DEFAULT_LOAD_SHEDDING_INTERVAL),
+   m_numberEventLoops(CFG_DEFAULT_EVENT_LOOPS),
+   m_listenBacklog(CFG_DEFAULT_LISTEN_BACKLOG),
+   m_idleTimeout(CFG_DEFAULT_IDLE_TIMEOUT),
+   m_inlineThreshold(CFG_DEFAULT_INLINE_THRESHOLD),
+   m_inlineServiceTime(0),
+   m_inlineRequests(0),
+   m_offloadedRequests(0),
+   m_rejectedRequests(0),
    m_serverPort(CFG_DEFAULT_PORT_NUMBER) {
    LOG_INSTANCE_CREATE("SocketServer")
    init(CFG_DEFAULT_PORT_NUMBER);
@@ -168,6 +266,71 @@ const std::string& SocketServer::getServerId() const {
 
 //******************************************************************************
 
+const std::string& SocketServer::getThreadPoolType() const {
+   return m_threadPoolType;
+}
+
+//******************************************************************************
+
+int SocketServer::getNumberEventLoops() const {
+   return m_numberEventLoops;
+}
+
+//******************************************************************************
+
+int SocketServer::getListenBacklog() const {
+   return m_listenBacklog;
+}
+
+//******************************************************************************
+
+int SocketServer::getIdleTimeout() const {
+   return m_idleTimeout;
+}
+
+//******************************************************************************
+
+int SocketServer::getInlineThreshold() const {
+   return m_inlineThreshold;
+}
+
+//******************************************************************************
+
+std::uint64_t SocketServer::getNumberInlineRequests() const {
+   return m_inlineRequests.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+std::uint64_t SocketServer::getNumberOffloadedRequests() const {
+   return m_offloadedRequests.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+std::uint64_t SocketServer::getNumberRejectedRequests() const {
+   return m_rejectedRequests.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void SocketServer::getEventLoopStats(std::vector<EventLoopStats::Snapshot>& snapshots) const {
+   snapshots.clear();
+   snapshots.resize(m_kernelEventServers.size());
+
+   for (std::size_t i = 0; i < m_kernelEventServers.size(); ++i) {
+      m_kernelEventServers[i]->getEventLoopStats(snapshots[i]);
+   }
+}
+
+//******************************************************************************
+
+bool SocketServer::isUsingIoUring() const {
+   return m_isUsingIoUring;
+}
+
+//******************************************************************************
+
 bool SocketServer::hasTrueValue(const KeyValuePairs& kvp,
                                 const std::string& setting) const {
    bool hasTrueValue = false;
@@ -203,6 +366,32 @@ int SocketServer::getIntValue(const KeyValuePairs& kvp,
 
 //******************************************************************************
 
+int SocketServer::getNonNegativeIntValue(const KeyValuePairs& kvp,
+                                         const std::string& setting) const {
+   int value = -1;
+
+   if (kvp.hasKey(setting)) {
+      const std::string& valueAsString = kvp.getValue(setting);
+
+      try {
+         const int intValue = StrUtils::parseInt(valueAsString);
+
+         if (intValue >= 0) {
+            value = intValue;
+         }
+      } catch (const NumberFormatException&) {
+      }
+
+      if (value < 0) {
+         LOG_WARNING("invalid " + setting + " '" + valueAsString + "', ignoring")
+      }
+   }
+
+   return value;
+}
+
+//******************************************************************************
+
 void SocketServer::replaceVariables(const KeyValuePairs& kvp,
                                     std::string& s) const {
    if (!s.empty()) {
@@ -248,6 +437,7 @@ bool SocketServer::init(int port)
    // start out with our default settings
    m_socketSendBufferSize = CFG_DEFAULT_SEND_BUFFER_SIZE;
    m_socketReceiveBufferSize = CFG_DEFAULT_RECEIVE_BUFFER_SIZE;
+   m_threadPoolType = CFG_THREAD_POOL_SHARED;
 
    try {
       KeyValuePairs kvpServerSettings;
@@ -283,7 +473,8 @@ bool SocketServer::init(int port)
             if (!threading.empty()) {
                if ((threading == CFG_THREADING_PTHREADS) ||
                    (threading == CFG_THREADING_CPP11) ||
-                   (threading == CFG_THREADING_GCD_LIBDISPATCH)) {
+                   (threading == CFG_THREADING_GCD_LIBDISPATCH) ||
+                   (threading == CFG_THREADING_FUTEX)) {
                   m_threading = threading;
                   m_isThreaded = true;
                } else if (threading == CFG_THREADING_NONE) {
@@ -301,6 +492,203 @@ bool SocketServer::init(int port)
             }
          }
 
+         if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_POOL_TYPE)) {
+            const std::string& threadPoolType =
+               kvpServerSettings.getValue(CFG_SERVER_THREAD_POOL_TYPE);
+
+            if (threadPoolType == CFG_THREAD_POOL_WORK_STEALING) {
+               m_threadPoolType = CFG_THREAD_POOL_WORK_STEALING;
+            } else if (threadPoolType == CFG_THREAD_POOL_RING) {
+               m_threadPoolType = CFG_THREAD_POOL_RING;
+            } else if (threadPoolType != CFG_THREAD_POOL_SHARED) {
+               LOG_WARNING("unrecognized thread_pool_type '" + threadPoolType +
+                           "', using " + CFG_THREAD_POOL_SHARED)
+            }
+         }
+
+         // auto-scaling: the pool grows and shrinks between min and max
+         // size (both default to thread_pool_size, i.e., a fixed pool)
+         if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_POOL_MIN_SIZE)) {
+            const int minSize =
+               getIntValue(kvpServerSettings, CFG_SERVER_THREAD_POOL_MIN_SIZE);
+
+            if (minSize > 0) {
+               m_threadPoolMinSize = minSize;
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_POOL_MAX_SIZE)) {
+            const int maxSize =
+               getIntValue(kvpServerSettings, CFG_SERVER_THREAD_POOL_MAX_SIZE);
+
+            if (maxSize > 0) {
+               m_threadPoolMaxSize = maxSize;
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_POOL_TARGET_DELAY)) {
+            const int targetDelay =
+               getIntValue(kvpServerSettings, CFG_SERVER_THREAD_POOL_TARGET_DELAY);
+
+            if (targetDelay > 0) {
+               m_threadPoolTargetDelay = targetDelay;
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_POOL_IDLE_COOLDOWN)) {
+            const int idleCooldown =
+               getNonNegativeIntValue(kvpServerSettings, CFG_SERVER_THREAD_POOL_IDLE_COOLDOWN);
+
+            if (idleCooldown >= 0) {
+               m_threadPoolIdleCooldown = idleCooldown;
+            }
+         }
+
+         // how the pool's queue chooses between priority lanes
+         if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_POOL_SCHEDULING)) {
+            const std::string& scheduling =
+               kvpServerSettings.getValue(CFG_SERVER_THREAD_POOL_SCHEDULING);
+
+            if (scheduling == CFG_SCHEDULING_WEIGHTED) {
+               m_priorityScheduling = PriorityScheduling::WeightedRoundRobin;
+            } else if (scheduling != CFG_SCHEDULING_STRICT) {
+               LOG_WARNING("unrecognized thread_pool_scheduling '" + scheduling +
+                           "', using " + CFG_SCHEDULING_STRICT)
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_POOL_STARVATION)) {
+            const int starvationMillis =
+               getNonNegativeIntValue(kvpServerSettings, CFG_SERVER_THREAD_POOL_STARVATION);
+
+            if (starvationMillis >= 0) {
+               m_starvationThreshold = starvationMillis;
+            }
+         }
+
+         // requests still queued this long after they arrived are dropped
+         // (their connections closed) instead of run
+         if (kvpServerSettings.hasKey(CFG_SERVER_REQUEST_TIMEOUT)) {
+            const int requestTimeout =
+               getIntValue(kvpServerSettings, CFG_SERVER_REQUEST_TIMEOUT);
+
+            if (requestTimeout >= 0) {
+               m_requestTimeout = requestTimeout;
+            }
+         }
+
+         // shed load once the queue has a standing backlog
+         if (kvpServerSettings.hasKey(CFG_SERVER_LOAD_SHEDDING_TARGET)) {
+            const int sheddingTarget =
+               getIntValue(kvpServerSettings, CFG_SERVER_LOAD_SHEDDING_TARGET);
+
+            if (sheddingTarget >= 0) {
+               m_loadSheddingTarget = sheddingTarget;
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_LOAD_SHEDDING_INTERVAL)) {
+            const int sheddingInterval =
+               getIntValue(kvpServerSettings, CFG_SERVER_LOAD_SHEDDING_INTERVAL);
+
+            if (sheddingInterval > 0) {
+               m_loadSheddingInterval = sheddingInterval;
+            }
+         }
+
+         // placement and scheduling of every server thread (event loops
+         // and pool workers alike, so that they can share a NUMA node)
+         if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_CPUS)) {
+            const std::string& threadCpus =
+               kvpServerSettings.getValue(CFG_SERVER_THREAD_CPUS);
+            std::vector<int> cpus;
+
+            if (ThreadAttributes::parseCpuList(threadCpus, cpus)) {
+               m_threadAttributes.setCpuSet(cpus);
+            } else {
+               LOG_WARNING("invalid thread_cpus '" + threadCpus + "', ignoring")
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_NUMA_NODE)) {
+            const int numaNode =
+               getNonNegativeIntValue(kvpServerSettings, CFG_SERVER_NUMA_NODE);
+
+            if (numaNode >= 0) {
+               m_threadAttributes.setNumaNode(numaNode);
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_STACK_SIZE)) {
+            const int stackSizeKb =
+               getIntValue(kvpServerSettings, CFG_SERVER_THREAD_STACK_SIZE);
+
+            if (stackSizeKb > 0) {
+               m_threadAttributes.setStackSize(
+                  static_cast<std::size_t>(stackSizeKb) * 1024);
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_SCHEDULING)) {
+            const std::string& scheduling =
+               kvpServerSettings.getValue(CFG_SERVER_THREAD_SCHEDULING);
+            ThreadSchedulingPolicy policy;
+
+            if (ThreadAttributes::parseSchedulingPolicy(scheduling, policy)) {
+               int priority = 0;
+
+               if (kvpServerSettings.hasKey(CFG_SERVER_THREAD_PRIORITY)) {
+                  const int configuredPriority =
+                     getNonNegativeIntValue(kvpServerSettings, CFG_SERVER_THREAD_PRIORITY);
+
+                  if (configuredPriority >= 0) {
+                     priority = configuredPriority;
+                  }
+               }
+
+               m_threadAttributes.setSchedulingPolicy(policy, priority);
+            } else {
+               LOG_WARNING("unrecognized thread_scheduling '" + scheduling +
+                           "', using default")
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_EVENT_LOOPS)) {
+            const int eventLoops =
+               getIntValue(kvpServerSettings, CFG_SERVER_EVENT_LOOPS);
+
+            if (eventLoops > 0) {
+               m_numberEventLoops = eventLoops;
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_LISTEN_BACKLOG)) {
+            const int listenBacklog =
+               getIntValue(kvpServerSettings, CFG_SERVER_LISTEN_BACKLOG);
+
+            if (listenBacklog > 0) {
+               m_listenBacklog = listenBacklog;
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_IDLE_TIMEOUT)) {
+            const int idleTimeout =
+               getIntValue(kvpServerSettings, CFG_SERVER_IDLE_TIMEOUT);
+
+            if (idleTimeout >= 0) {
+               m_idleTimeout = idleTimeout;
+            }
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_INLINE_THRESHOLD)) {
+            const int inlineThreshold =
+               getIntValue(kvpServerSettings, CFG_SERVER_INLINE_THRESHOLD);
+
+            if (inlineThreshold >= 0) {
+               m_inlineThreshold = inlineThreshold;
+            }
+         }
+
          // defaults
          m_sockets = CFG_SOCKETS_SOCKET_SERVER;
 
@@ -312,6 +700,16 @@ bool SocketServer::init(int port)
             }
          }
 
+         if (kvpServerSettings.hasKey(CFG_SERVER_IO_URING)) {
+            m_isUsingIoUring =
+               hasTrueValue(kvpServerSettings, CFG_SERVER_IO_URING);
+         }
+
+         if (kvpServerSettings.hasKey(CFG_SERVER_LOCK_PROFILING)) {
+            LockProfiler::setEnabled(
+               hasTrueValue(kvpServerSettings, CFG_SERVER_LOCK_PROFILING));
+         }
+
          if (kvpServerSettings.hasKey(CFG_SERVER_LOG_LEVEL)) {
             m_logLevel =
                kvpServerSettings.getValue(CFG_SERVER_LOG_LEVEL);
@@ -416,7 +814,7 @@ bool SocketServer::init(int port)
             LOG_DEBUG(msg)
          }
 
-         m_serverSocket.reset(new ServerSocket(port));
+         m_serverSocket.reset(new ServerSocket(port, m_listenBacklog));
       } catch (...) {
          std::string exception = "unable to open server socket port '";
          exception += StrUtils::toString(port);
@@ -433,31 +831,114 @@ bool SocketServer::init(int port)
 
       if (m_threading == CFG_THREADING_PTHREADS) {
          m_threadingFactory = new PthreadsThreadingFactory();
-      //} else if (m_threading == CFG_THREADING_CPP11) {
-      //   m_threadingFactory = new StdThreadingFactory();
-      //} else if (m_threading == CFG_THREADING_GCD_LIBDISPATCH) {
-      //   isUsingLibDispatch = true;
-      //   m_threadingFactory = new PthreadsThreadingFactory();
+      } else if (m_threading == CFG_THREADING_CPP11) {
+         m_threadingFactory = new StdThreadingFactory();
+      } else if (m_threading == CFG_THREADING_FUTEX) {
+         if (LinuxThreadingFactory::isSupportedPlatform()) {
+            m_threadingFactory = new LinuxThreadingFactory();
+         } else {
+            LOG_WARNING("futex threading is only supported on Linux, using pthreads")
+            m_threadingFactory = new PthreadsThreadingFactory();
+         }
+      } else if (m_threading == CFG_THREADING_GCD_LIBDISPATCH) {
+         // native dispatch queues (no libdispatch needed)
+         isUsingLibDispatch = true;
+         m_threadingFactory = new PthreadsThreadingFactory();
       } else {
          m_threadingFactory = new PthreadsThreadingFactory();
       }
 
+      m_replacedThreadingFactory = ThreadingFactory::getThreadingFactory();
       ThreadingFactory::setThreadingFactory(m_threadingFactory);
+      m_threadingFactory->setThreadAttributes(m_threadAttributes);
+
+      if (isUsingLibDispatch) {
+         m_threadingFactory->setThreadPoolType(ThreadPoolType::Dispatch);
+      } else if (m_threadPoolType == CFG_THREAD_POOL_WORK_STEALING) {
+         m_threadingFactory->setThreadPoolType(ThreadPoolType::WorkStealing);
+      } else if (m_threadPoolType == CFG_THREAD_POOL_RING) {
+         m_threadingFactory->setThreadPoolType(ThreadPoolType::SharedRing);
+      }
+
+      const int minPoolSize =
+         (m_threadPoolMinSize > 0) ? m_threadPoolMinSize : m_threadPoolSize;
+      const int maxPoolSize =
+         std::max(minPoolSize,
+                  (m_threadPoolMaxSize > 0) ? m_threadPoolMaxSize : m_threadPoolSize);
+      const bool isAutoScaling = maxPoolSize > minPoolSize;
+
+      if (isAutoScaling) {
+         // start in range, then let the auto-scaler take it from there
+         m_threadPoolSize =
+            std::min(std::max(m_threadPoolSize, minPoolSize), maxPoolSize);
+      }
 
       m_threadPool.reset(
          m_threadingFactory->createThreadPoolDispatcher(m_threadPoolSize, "threadpool"));
       m_threadPool->start();
 
+      ThreadPool* sharedQueuePool = dynamic_cast<ThreadPool*>(m_threadPool.get());
+
+      if (nullptr != sharedQueuePool) {
+         sharedQueuePool->setPriorityScheduling(m_priorityScheduling);
+
+         if (m_starvationThreshold >= 0) {
+            sharedQueuePool->setStarvationThreshold(
+               static_cast<std::uint64_t>(m_starvationThreshold) * 1000);
+         }
+
+         if (m_loadSheddingTarget > 0) {
+            if (!sharedQueuePool->setLoadShedding(
+                   static_cast<std::uint64_t>(m_loadSheddingTarget) * 1000,
+                   static_cast<std::uint64_t>(m_loadSheddingInterval) * 1000)) {
+               LOG_WARNING("thread pool queue doesn't support load shedding")
+            }
+         }
+      }
+
+      if (isAutoScaling) {
+         ThreadPool* threadPool = sharedQueuePool;
+
+         if (nullptr != threadPool) {
+            AutoScalingPolicy policy;
+            policy.minWorkers = minPoolSize;
+            policy.maxWorkers = maxPoolSize;
+            policy.targetDelayMicros =
+               static_cast<std::uint64_t>(m_threadPoolTargetDelay) * 1000;
+            policy.idleCooldownMillis =
+               static_cast<std::uint64_t>(m_threadPoolIdleCooldown);
+            threadPool->enableAutoScaling(policy);
+         } else {
+            LOG_WARNING("thread pool auto-scaling is not supported by thread_pool_type '" +
+                        m_threadPoolType + "', using a fixed size pool")
+         }
+      }
+
       concurrencyModel = "multithreaded - ";
       concurrencyModel += m_threading;
 
-      if (isUsingLibDispatch) {
-         concurrencyModel += " [libdispatch]";
+      const ThreadPool* threadPool =
+         dynamic_cast<const ThreadPool*>(m_threadPool.get());
+      char numberThreads[128];
+
+      if ((nullptr != threadPool) && threadPool->isAutoScaling()) {
+         const AutoScalingPolicy& policy =
+            threadPool->getAutoScaler()->getPolicy();
+         ::snprintf(numberThreads, 128, " [%d-%d threads]",
+                    policy.minWorkers, policy.maxWorkers);
       } else {
-         char numberThreads[128];
          ::snprintf(numberThreads, 128, " [%d threads]",
-                       m_threadPoolSize);
-         concurrencyModel += numberThreads;
+                    m_threadPoolSize);
+      }
+
+      concurrencyModel += numberThreads;
+
+      if (isUsingLibDispatch) {
+         concurrencyModel += " [dispatch queues]";
+      } else if (m_threadPoolType == CFG_THREAD_POOL_WORK_STEALING) {
+         concurrencyModel += " [work stealing]";
+      } else if (m_threadPoolType == CFG_THREAD_POOL_RING) {
+         concurrencyModel += " [ring queue]";
       }
    } else {
       concurrencyModel = "serial";
@@ -478,6 +959,11 @@ bool SocketServer::init(int port)
    startupMsg += ")";
    startupMsg += " (sockets: ";
    startupMsg += m_sockets;
+   if (m_isUsingKernelEventServer && (m_numberEventLoops > 1)) {
+      startupMsg += ", ";
+      startupMsg += StrUtils::toString(m_numberEventLoops);
+      startupMsg += " event loops";
+   }
    startupMsg += ")";
 
    ::printf("%s\n", startupMsg.c_str());
@@ -492,6 +978,9 @@ bool SocketServer::init(int port)
 SocketServer::~SocketServer() {
    LOG_INSTANCE_DESTROY("SocketServer")
 
+   // before anything the event loops use is freed
+   stopEventLoops();
+
    if (m_serverSocket) {
       m_serverSocket->close();
    }
@@ -500,7 +989,15 @@ SocketServer::~SocketServer() {
       m_threadPool->stop();
    }
 
+   if (LockProfiler::isEnabled()) {
+      LOG_INFO("lock contention profile:\n" + LockProfiler::dump())
+   }
+
    if (m_threadingFactory) {
+      // don't leave the process-wide factory pointing at a deleted instance
+      if (ThreadingFactory::getThreadingFactory() == m_threadingFactory) {
+         ThreadingFactory::setThreadingFactory(m_replacedThreadingFactory);
+      }
       delete m_threadingFactory;
    }
 }
@@ -558,27 +1055,183 @@ int SocketServer::platformPointerSizeBits() const {
 
 //******************************************************************************
 
+bool SocketServer::isRunInline(const RequestHandler* requestHandler) const {
+   if (requestHandler->isInlineCapable()) {
+      return true;
+   }
+
+   if (m_inlineThreshold <= 0) {
+      return false;
+   }
+
+   const std::uint64_t thresholdNanos =
+      static_cast<std::uint64_t>(m_inlineThreshold) * 1000;
+
+   if (m_inlineServiceTime.load(std::memory_order_relaxed) < thresholdNanos) {
+      return true;
+   }
+
+   // measured as too slow -- probe now and then in case that's changed
+   return (m_offloadedRequests.load(std::memory_order_relaxed) %
+           INLINE_PROBE_INTERVAL) == (INLINE_PROBE_INTERVAL - 1);
+}
+
+//******************************************************************************
+
 void SocketServer::serviceSocket(SocketRequest* socketRequest) {
-   if (nullptr != m_threadPool) {
+   RequestHandler* requestHandler = handlerForSocketRequest(socketRequest);
+
+   if ((nullptr != m_threadPool) && !isRunInline(requestHandler)) {
       // Hand off the request to the thread pool for asynchronous processing
-      RequestHandler* requestHandler = handlerForSocketRequest(socketRequest);
-      requestHandler->setThreadPooling(true);
-      requestHandler->setSocketOwned(socketRequest->isSocketOwned());
-      requestHandler->setAutoDelete();
+      prepareForThreadPool(requestHandler, socketRequest);
       // the pool deletes requestHandler once it's done being processed
       // on a worker thread
-      m_threadPool->addRequest(requestHandler);
+      if (!m_threadPool->addRequest(requestHandler)) {
+         dropRequest(requestHandler);
+      }
    } else {
-      // no thread pool available -- process it synchronously
-      RequestHandler* requestHandler = handlerForSocketRequest(socketRequest);
+      // no thread pool available, or the handler is cheap enough that the
+      // hand-off would cost more than running it -- process it synchronously
+      runInline(requestHandler);
+   }
+}
+
+//******************************************************************************
+
+void SocketServer::serviceSockets(std::span<SocketRequest* const> socketRequests) {
+   if (nullptr == m_threadPool) {
+      for (SocketRequest* socketRequest : socketRequests) {
+         serviceSocket(socketRequest);
+      }
+      return;
+   }
+
+   // per event loop thread, reused from batch to batch
+   static thread_local std::vector<Runnable*> pooledHandlers;
+   static thread_local std::vector<RequestHandler*> inlineHandlers;
+   pooledHandlers.clear();
+   inlineHandlers.clear();
+
+   for (SocketRequest* socketRequest : socketRequests) {
       try {
-         requestHandler->run();
+         RequestHandler* requestHandler = handlerForSocketRequest(socketRequest);
+
+         if (isRunInline(requestHandler)) {
+            inlineHandlers.push_back(requestHandler);
+         } else {
+            prepareForThreadPool(requestHandler, socketRequest);
+            pooledHandlers.push_back(requestHandler);
+         }
+      } catch (const BasicException& be) {
+         LOG_ERROR("exception creating handler for socket request: " + be.whatString())
+      } catch (const std::exception& e) {
+         LOG_ERROR("exception creating handler for socket request: " + std::string(e.what()))
       } catch (...) {
-         delete requestHandler;
-         throw;
+         LOG_ERROR("exception creating handler for socket request")
+      }
+   }
+
+   // the pooled requests go first (in one hand-off) so that they aren't
+   // held up behind the ones run inline
+   if (!pooledHandlers.empty()) {
+      const std::size_t numberAdded = m_threadPool->addRequests(pooledHandlers);
+
+      // whatever the pool didn't take (e.g., its queue is full) is dropped
+      // -- running it here would stall the event loop just when the queue
+      // limit is asking for back-pressure
+      for (std::size_t i = numberAdded; i < pooledHandlers.size(); ++i) {
+         dropRequest(static_cast<RequestHandler*>(pooledHandlers[i]));
       }
+   }
+
+   for (RequestHandler* requestHandler : inlineHandlers) {
+      try {
+         runInline(requestHandler);
+      } catch (const BasicException& be) {
+         LOG_ERROR("exception running request handler inline: " + be.whatString())
+      } catch (const std::exception& e) {
+         LOG_ERROR("exception running request handler inline: " + std::string(e.what()))
+      } catch (...) {
+         LOG_ERROR("exception running request handler inline")
+      }
+   }
+}
+
+//******************************************************************************
+
+void SocketServer::prepareForThreadPool(RequestHandler* requestHandler,
+                                        SocketRequest* socketRequest) {
+   requestHandler->setThreadPooling(true);
+   requestHandler->setSocketOwned(socketRequest->isSocketOwned());
+   requestHandler->setAutoDelete();
+
+   if (m_requestTimeout > 0) {
+      requestHandler->setTimeout(static_cast<std::uint64_t>(m_requestTimeout) * 1000);
+   }
+
+   m_offloadedRequests.fetch_add(1, std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void SocketServer::dropRequest(RequestHandler* requestHandler) {
+   m_rejectedRequests.fetch_add(1, std::memory_order_relaxed);
+
+   // closes the connection the same way the queue does for a request that
+   // expires while waiting
+   try {
+      requestHandler->notifyOnDropped();
+   } catch (const BasicException& be) {
+      LOG_ERROR("exception dropping request: " + be.whatString())
+   } catch (const std::exception& e) {
+      LOG_ERROR("exception dropping request: " + std::string(e.what()))
+   } catch (...) {
+      LOG_ERROR("exception dropping request")
+   }
+
+   delete requestHandler;
+}
+
+//******************************************************************************
+
+void SocketServer::runInline(RequestHandler* requestHandler) {
+   const bool isTimed = (nullptr != m_threadPool) &&
+                        (m_inlineThreshold > 0) &&
+                        !requestHandler->isInlineCapable();
+   const std::chrono::steady_clock::time_point startTime =
+      isTimed ? std::chrono::steady_clock::now() :
+                std::chrono::steady_clock::time_point();
+
+   requestHandler->notifyOnStart();
+
+   try {
+      requestHandler->run();
+   } catch (...) {
       delete requestHandler;
+      throw;
+   }
+
+   if (nullptr != m_threadPool) {
+      m_inlineRequests.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   if (isTimed) {
+      const std::uint64_t serviceTime =
+         std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - startTime).count();
+
+      // exponentially weighted moving average (1/8 weight per sample);
+      // racing event loops may drop a sample, which doesn't matter here
+      const std::uint64_t average =
+         m_inlineServiceTime.load(std::memory_order_relaxed);
+      m_inlineServiceTime.store(average - (average / 8) + (serviceTime / 8),
+                                std::memory_order_relaxed);
    }
+
+   // same as a pool worker would -- lets a kernel event server watch
+   // the connection again for its next request
+   requestHandler->notifyOnCompletion();
+   delete requestHandler;
 }
 
 //******************************************************************************
@@ -640,60 +1293,134 @@ int SocketServer::runSocketServer() {
 
 //******************************************************************************
 
+KernelEventServer* SocketServer::createKernelEventServer() {
+   KernelEventServer* kernelEventServer = nullptr;
+
+   Mutex* mutexFD = m_threadingFactory->createMutex("fdMutex");
+   Mutex* mutexHWMConnections =
+      m_threadingFactory->createMutex("hwmConnectionsMutex");
+
+   if (KqueueServer::isSupportedPlatform()) {
+      kernelEventServer = new KqueueServer(*mutexFD, *mutexHWMConnections);
+   } else if (m_isUsingIoUring && IoUringServer::isSupportedPlatform()) {
+      kernelEventServer = new IoUringServer(*mutexFD, *mutexHWMConnections);
+   } else if (EpollServer::isSupportedPlatform()) {
+      kernelEventServer = new EpollServer(*mutexFD, *mutexHWMConnections);
+   } else {
+      LOG_CRITICAL("no kernel event server available for platform")
+   }
+
+   // KernelEventServer's constructor takes these by reference but does
+   // not retain them (it creates its own internal busy-flags mutex), so
+   // they're safe to free once construction has completed.
+   delete mutexFD;
+   delete mutexHWMConnections;
+
+   return kernelEventServer;
+}
+
+//******************************************************************************
+
 int SocketServer::runKernelEventServer() {
    const int MAX_CON = 1200;
 
-   int rc = 0;
+   if (m_threadingFactory == nullptr) {
+      LOG_CRITICAL("no threading factory configured")
+      return 1;
+   }
 
-   if (m_threadingFactory != nullptr) {
-      Mutex* mutexFD = m_threadingFactory->createMutex("fdMutex");
-      Mutex* mutexHWMConnections =
-         m_threadingFactory->createMutex("hwmConnectionsMutex");
+   // with more than one loop, every loop binds its own listener to the
+   // same port (SO_REUSEPORT) and the kernel spreads new connections
+   // across them -- each loop then owns the connections it accepted
+   const bool isMultiReactor = m_numberEventLoops > 1;
 
-      m_kernelEventServer.reset();
+   m_kernelEventServers.clear();
 
-      if (KqueueServer::isSupportedPlatform()) {
-         m_kernelEventServer.reset(
-            new KqueueServer(*mutexFD, *mutexHWMConnections));
-      } else if (EpollServer::isSupportedPlatform()) {
-         m_kernelEventServer.reset(
-            new EpollServer(*mutexFD, *mutexHWMConnections));
-      } else {
-         LOG_CRITICAL("no kernel event server available for platform")
-         rc = 1;
+   for (int i = 0; i < m_numberEventLoops; ++i) {
+      KernelEventServer* kernelEventServer = createKernelEventServer();
+      if (kernelEventServer == nullptr) {
+         return 1;
       }
 
-      // KernelEventServer's constructor takes these by reference but does
-      // not retain them (it creates its own internal busy-flags mutex), so
-      // they're safe to free once construction has completed.
-      delete mutexFD;
-      delete mutexHWMConnections;
+      m_kernelEventServers.emplace_back(kernelEventServer);
+      kernelEventServer->setReusePort(isMultiReactor);
+      kernelEventServer->setListenBacklog(m_listenBacklog);
+      kernelEventServer->setIdleTimeout(m_idleTimeout);
 
-      if (m_kernelEventServer != nullptr) {
-         try {
-            SocketServiceHandler* serviceHandler = createSocketServiceHandler();
+      try {
+         SocketServiceHandler* serviceHandler = createSocketServiceHandler();
 
-            if (m_kernelEventServer->init(serviceHandler, m_serverPort, MAX_CON)) {
-               m_kernelEventServer->run();
-            } else {
-               rc = 1;
-            }
-         } catch (const BasicException& be) {
-            LOG_CRITICAL("exception running kernel event server: " +
-                         be.whatString())
-         } catch (const std::exception& e) {
-            LOG_CRITICAL("exception running kernel event server: " +
-                         std::string(e.what()))
-         } catch (...) {
-            LOG_CRITICAL("unidentified exception running kernel event server")
+         if (!kernelEventServer->init(serviceHandler, m_serverPort, MAX_CON)) {
+            return 1;
          }
+      } catch (const BasicException& be) {
+         LOG_CRITICAL("exception initializing kernel event server: " +
+                      be.whatString())
+         return 1;
+      } catch (const std::exception& e) {
+         LOG_CRITICAL("exception initializing kernel event server: " +
+                      std::string(e.what()))
+         return 1;
+      } catch (...) {
+         LOG_CRITICAL("unidentified exception initializing kernel event server")
+         return 1;
       }
-   } else {
-      LOG_CRITICAL("no threading factory configured")
-      rc = 1;
    }
 
-   return rc;
+   // all but the last loop get a thread of their own
+   for (int i = 0; i < m_numberEventLoops - 1; ++i) {
+      Runnable* runner = new KernelEventServerRunner(*m_kernelEventServers[i]);
+      m_eventLoopRunners.emplace_back(runner);
+
+      std::unique_ptr<Thread> eventLoopThread(
+         m_threadingFactory->createThread(runner,
+            "eventloop-" + StrUtils::toString(i + 1)));
+
+      if (!eventLoopThread->start()) {
+         LOG_CRITICAL("unable to start kernel event loop thread")
+         stopEventLoops();
+         return 1;
+      }
+
+      // (only started threads are kept, since only they can be joined)
+      m_eventLoopThreads.push_back(std::move(eventLoopThread));
+   }
+
+   // the last loop runs on the calling thread; place it alongside the rest
+   m_threadingFactory->getThreadAttributes().applyToCurrentThread("");
+
+   try {
+      m_kernelEventServers.back()->run();
+   } catch (const BasicException& be) {
+      LOG_CRITICAL("exception running kernel event server: " +
+                   be.whatString())
+   } catch (const std::exception& e) {
+      LOG_CRITICAL("exception running kernel event server: " +
+                   std::string(e.what()))
+   } catch (...) {
+      LOG_CRITICAL("unidentified exception running kernel event server")
+   }
+
+   // the other loops would otherwise keep running on servers that are
+   // freed along with this object
+   stopEventLoops();
+
+   return 0;
+}
+
+//******************************************************************************
+
+void SocketServer::stopEventLoops() {
+   for (auto& kernelEventServer : m_kernelEventServers) {
+      kernelEventServer->stop();
+   }
+
+   for (auto& eventLoopThread : m_eventLoopThreads) {
+      eventLoopThread->join();
+   }
+
+   m_eventLoopThreads.clear();
+   m_eventLoopRunners.clear();
 }
 
 //******************************************************************************
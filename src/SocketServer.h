@@ -4,19 +4,27 @@
 #ifndef CHAUDIERE_SOCKETSERVER_H
 #define CHAUDIERE_SOCKETSERVER_H
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "KernelEventServer.h"
 #include "KeyValuePairs.h"
+#include "ThreadAttributes.h"
+#include "ThreadPoolQueue.h"
 
 
 namespace chaudiere
 {
    class RequestHandler;
+   class Runnable;
    class ServerSocket;
    class Socket;
    class SocketRequest;
+   class Thread;
    class ThreadPoolDispatcher;
    class SectionedConfigDataSource;
    class ThreadingFactory;
@@ -79,7 +87,11 @@ class SocketServer
       int runSocketServer();
 
       /**
-       * Runs a kernel event server (e.g., kqueue or epoll)
+       * Runs a kernel event server (e.g., kqueue or epoll). When more than
+       * one event loop is configured ("event_loops" in the server section),
+       * each loop gets its own kernel event server with its own SO_REUSEPORT
+       * listener and runs on its own thread; the last one runs on the
+       * calling thread.
        * @return exit code for the server process
        */
       int runKernelEventServer();
@@ -115,6 +127,78 @@ class SocketServer
        */
       const std::string& getServerId() const;
 
+      /**
+       * Retrieves the kind of thread pool used when threading is enabled
+       * ("thread_pool_type" in the server section)
+       * @return "shared", "ring", or "work_stealing"
+       */
+      const std::string& getThreadPoolType() const;
+
+      /**
+       * Retrieves the number of kernel event loops used by runKernelEventServer
+       * @return number of kernel event loops
+       */
+      int getNumberEventLoops() const;
+
+      /**
+       * Retrieves the backlog passed to listen() for the server's listener(s)
+       * @return the listen backlog
+       */
+      int getListenBacklog() const;
+
+      /**
+       * Retrieves the number of seconds a kernel event server connection may
+       * sit idle before it's closed
+       * @return the idle timeout in seconds (0 means idle connections are kept)
+       */
+      int getIdleTimeout() const;
+
+      /**
+       * Retrieves the adaptive inline threshold: when a thread pool is in use,
+       * kernel event requests whose handlers have been measured to run in
+       * less than this many microseconds are run inline on the event loop
+       * thread rather than handed to the pool
+       * @return the inline threshold in microseconds (0 means adaptive
+       * inlining is off)
+       */
+      int getInlineThreshold() const;
+
+      /**
+       * Retrieves the number of kernel event requests run inline on an event
+       * loop thread while a thread pool was available
+       * @return number of requests run inline
+       */
+      std::uint64_t getNumberInlineRequests() const;
+
+      /**
+       * Retrieves the number of kernel event requests handed to the thread pool
+       * @return number of requests handed to the thread pool
+       */
+      std::uint64_t getNumberOffloadedRequests() const;
+
+      /**
+       * Retrieves the number of kernel event requests dropped because the
+       * thread pool wouldn't take them (e.g., its queue was full)
+       * @return number of requests the thread pool rejected
+       */
+      std::uint64_t getNumberRejectedRequests() const;
+
+      /**
+       * Copies the statistics of each kernel event loop (one snapshot per
+       * loop, empty if no kernel event server is running). Safe to call from
+       * any thread while the loops run.
+       * @param snapshots receives the statistics
+       * @see EventLoopStats()
+       */
+      void getEventLoopStats(std::vector<EventLoopStats::Snapshot>& snapshots) const;
+
+      /**
+       * Determines whether runKernelEventServer uses io_uring when the
+       * running kernel supports it
+       * @return boolean indicating if io_uring is allowed
+       */
+      bool isUsingIoUring() const;
+
       /**
        * Retrieves the size in bytes of a generic (void*) pointer
        * @return platform pointer size
@@ -122,12 +206,27 @@ class SocketServer
       int platformPointerSizeBits() const;
 
       /**
-       * Service a request for a socket when using a kernel event server
+       * Service a request for a socket when using a kernel event server. With
+       * a thread pool, the request is handed to the pool unless its handler
+       * is inline capable (see RequestHandler::isInlineCapable) or adaptive
+       * inlining has measured handlers as cheap (see getInlineThreshold), in
+       * which case it runs on the calling event loop thread.
        * @param socketRequest the SocketRequest to process
        * @see SocketRequest()
        */
       void serviceSocket(SocketRequest* socketRequest);
 
+      /**
+       * Service the requests from one kernel event batch. The requests
+       * destined for the thread pool are handed to it in a single
+       * ThreadPoolDispatcher::addRequests call, ahead of any run inline;
+       * any the pool won't take are dropped (their connections closed).
+       * A SocketServiceHandler can forward its serviceSockets here.
+       * @param socketRequests the SocketRequests to process
+       * @see SocketRequest()
+       */
+      void serviceSockets(std::span<SocketRequest* const> socketRequests);
+
       /**
        * Convenience method to retrieve a setting and convert it to a boolean
        * @param kvp the collection of key/value pair settings
@@ -148,6 +247,18 @@ class SocketServer
       int getIntValue(const KeyValuePairs& kvp,
                       const std::string& setting) const;
 
+      /**
+       * Convenience method to retrieve a setting that may be zero and convert
+       * it to an integer
+       * @param kvp the collection of key/value pair settings
+       * @param setting the name of the setting whose value is to be retrieved and converted
+       * @see KeyValuePairs()
+       * @return integer value (or -1 if the value is missing, not a number,
+       * or negative)
+       */
+      int getNonNegativeIntValue(const KeyValuePairs& kvp,
+                                 const std::string& setting) const;
+
       /**
        * Convenience method to replace all occurrences of keys in collection with their values
        * @param kvp the collection of key/value pairs for replacement
@@ -167,28 +278,91 @@ class SocketServer
        */
       virtual bool init(int port);
 
+      /**
+       * Creates a kernel event server appropriate for the current platform
+       * @return new kernel event server, or nullptr if none is available
+       */
+      KernelEventServer* createKernelEventServer();
+
+      /**
+       * Determines whether a request's handler should be run inline on the
+       * event loop thread instead of being handed to the thread pool
+       * @param requestHandler the handler for the request
+       * @return boolean indicating if the handler should be run inline
+       */
+      bool isRunInline(const RequestHandler* requestHandler) const;
+
+      /**
+       * Readies a request's handler to be run (and deleted) by the pool
+       * @param requestHandler the handler for the request
+       * @param socketRequest the request
+       */
+      void prepareForThreadPool(RequestHandler* requestHandler,
+                                SocketRequest* socketRequest);
+
+      /**
+       * Runs and deletes a request's handler on the calling thread
+       * @param requestHandler the handler for the request
+       */
+      void runInline(RequestHandler* requestHandler);
+
+      /**
+       * Drops and deletes a request's handler that the thread pool wouldn't
+       * take, closing its connection
+       * @param requestHandler the handler for the request
+       */
+      void dropRequest(RequestHandler* requestHandler);
+
+      /**
+       * Stops every kernel event loop and joins the threads running them
+       */
+      void stopEventLoops();
+
 
 
    private:
-      std::unique_ptr<KernelEventServer> m_kernelEventServer;
+      std::vector<std::unique_ptr<KernelEventServer>> m_kernelEventServers;
+      std::vector<std::unique_ptr<Runnable>> m_eventLoopRunners;
+      std::vector<std::unique_ptr<Thread>> m_eventLoopThreads;
       std::unique_ptr<ServerSocket> m_serverSocket;
       std::unique_ptr<ThreadPoolDispatcher> m_threadPool;
       ThreadingFactory* m_threadingFactory;
+      ThreadingFactory* m_replacedThreadingFactory;
       KeyValuePairs m_properties;
+      ThreadAttributes m_threadAttributes;
       std::string m_logLevel;
       std::string m_concurrencyModel;
       std::string m_configFilePath;
       std::string m_startupTime;
       std::string m_serverString;
       std::string m_threading;
+      std::string m_threadPoolType;
       std::string m_sockets;
       std::string m_serverName;
       std::string m_serverVersion;
       bool m_isDone;
       bool m_isThreaded;
       bool m_isUsingKernelEventServer;
+      bool m_isUsingIoUring;
       bool m_isFullyInitialized;
       int m_threadPoolSize;
+      int m_threadPoolMinSize;
+      int m_threadPoolMaxSize;
+      int m_threadPoolTargetDelay;
+      int m_threadPoolIdleCooldown;
+      PriorityScheduling m_priorityScheduling;
+      int m_starvationThreshold;   // ms (-1 == queue's default)
+      int m_requestTimeout;        // ms (0 == none)
+      int m_loadSheddingTarget;    // ms (0 == off)
+      int m_loadSheddingInterval;  // ms
+      int m_numberEventLoops;
+      int m_listenBacklog;
+      int m_idleTimeout;
+      int m_inlineThreshold;
+      std::atomic<std::uint64_t> m_inlineServiceTime;
+      std::atomic<std::uint64_t> m_inlineRequests;
+      std::atomic<std::uint64_t> m_offloadedRequests;
+      std::atomic<std::uint64_t> m_rejectedRequests;
       int m_serverPort;
       int m_socketSendBufferSize;
       int m_socketReceiveBufferSize;
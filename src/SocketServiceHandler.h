@@ -4,6 +4,7 @@
 #ifndef CHAUDIERE_SOCKETSERVICEHANDLER_H
 #define CHAUDIERE_SOCKETSERVICEHANDLER_H
 
+#include <span>
 #include <string>
 
 
@@ -29,6 +30,20 @@ public:
     */
    virtual void serviceSocket(SocketRequest* socketRequest) = 0;
 
+   /**
+    * Process the SocketRequests for every connection that became readable
+    * in one kernel event batch. Handlers that can hand off a batch more
+    * cheaply than one request at a time (see SocketServer::serviceSockets)
+    * override this.
+    * @param socketRequests the SocketRequests to process
+    * @see SocketRequest()
+    */
+   virtual void serviceSockets(std::span<SocketRequest* const> socketRequests) {
+      for (SocketRequest* socketRequest : socketRequests) {
+         serviceSocket(socketRequest);
+      }
+   }
+
    /**
     * Retrieves the name of the handler. This is primarily an aid for debugging.
     * @return the name of the handler
@@ -40,25 +40,48 @@ public:
     *
     * @return
     */
-   virtual bool unlock();
+   bool unlock() final {
+      // Deliberately not gated on m_isLocked: see the identical comment in
+      // PthreadsMutex::unlock(). This mutex can be shared across threads via
+      // a ConditionVariable, whose wait() adopts/releases the underlying
+      // std::mutex directly (bypassing m_isLocked), so the bookkeeping flag
+      // can be stale relative to which thread actually holds the real lock.
+      // Gating on it can skip the real unlock() call and deadlock permanently.
+      //
+      // m_isLocked is std::atomic<bool> specifically because it's read and
+      // written from whichever threads lock()/unlock() this object (and by
+      // isLocked() from any thread), which a plain bool cannot do safely
+      // (confirmed as a real data race with ThreadSanitizer).
+      m_mutex.unlock();
+      m_isLocked = false;
+      return true;
+   }
 
    /**
     *
     * @return
     */
-   virtual bool lock();
+   bool lock() final {
+      m_mutex.lock();
+      m_isLocked = true;
+      return true;
+   }
 
    /**
     *
     * @return
     */
-   virtual bool isLocked() const;
+   bool isLocked() const final {
+      return m_isLocked;
+   }
 
    /**
     *
     * @return
     */
-   virtual bool haveValidMutex() const;
+   bool haveValidMutex() const final {
+      return true;
+   }
 
    /**
     *
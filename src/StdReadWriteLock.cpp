@@ -0,0 +1,46 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "StdReadWriteLock.h"
+#include "Logger.h"
+
+static const std::string EMPTY_STRING = "";
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+StdReadWriteLock::StdReadWriteLock() :
+   StdReadWriteLock(EMPTY_STRING) {
+}
+
+//******************************************************************************
+
+StdReadWriteLock::StdReadWriteLock(const std::string& name,
+                                   ReadWritePreference preference) :
+   m_numberWaitingWriters(0),
+   m_name(name),
+   m_isWriterPreferring(preference == ReadWritePreference::Writers) {
+   LOG_INSTANCE_CREATE("StdReadWriteLock")
+}
+
+//******************************************************************************
+
+StdReadWriteLock::~StdReadWriteLock() {
+   LOG_INSTANCE_DESTROY("StdReadWriteLock")
+}
+
+//******************************************************************************
+
+ReadWritePreference StdReadWriteLock::getPreference() const {
+   return m_isWriterPreferring ? ReadWritePreference::Writers :
+                                 ReadWritePreference::Readers;
+}
+
+//******************************************************************************
+
+const std::string& StdReadWriteLock::getName() const {
+   return m_name;
+}
+
+//******************************************************************************
@@ -0,0 +1,111 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_STDREADWRITELOCK_H
+#define CHAUDIERE_STDREADWRITELOCK_H
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+#include "ReadWriteLock.h"
+
+
+namespace chaudiere
+{
+
+/**
+ * StdReadWriteLock is a ReadWriteLock that is implemented as a wrapper
+ * around std::shared_mutex (C++ 17). Since std::shared_mutex doesn't say
+ * which side it favors, a writer-preferring lock adds a gate: waiting
+ * writers hold it, and readers that arrive while a writer is waiting
+ * pass through it before locking.
+ */
+class StdReadWriteLock : public ReadWriteLock
+{
+public:
+   /**
+    * Default constructor
+    */
+   StdReadWriteLock();
+
+   /**
+    * Constructs a lock with a name and preference
+    * @param name the name of the lock
+    * @param preference which side the lock favors
+    */
+   explicit StdReadWriteLock(const std::string& name,
+                             ReadWritePreference preference = ReadWritePreference::Readers);
+
+   /**
+    * Destructor
+    */
+   ~StdReadWriteLock();
+
+   bool lockShared() final {
+      if (m_isWriterPreferring &&
+          (m_numberWaitingWriters.load(std::memory_order_acquire) > 0)) {
+         // wait behind the writers
+         m_writerGate.lock();
+         m_writerGate.unlock();
+      }
+
+      m_mutex.lock_shared();
+      return true;
+   }
+
+   bool unlockShared() final {
+      m_mutex.unlock_shared();
+      return true;
+   }
+
+   bool lockExclusive() final {
+      if (m_isWriterPreferring) {
+         m_numberWaitingWriters.fetch_add(1, std::memory_order_acq_rel);
+         m_writerGate.lock();
+         m_mutex.lock();
+         m_numberWaitingWriters.fetch_sub(1, std::memory_order_acq_rel);
+      } else {
+         m_mutex.lock();
+      }
+
+      return true;
+   }
+
+   bool unlockExclusive() final {
+      m_mutex.unlock();
+
+      if (m_isWriterPreferring) {
+         m_writerGate.unlock();
+      }
+
+      return true;
+   }
+
+   ReadWritePreference getPreference() const final;
+
+   std::shared_mutex& getPlatformPrimitive()
+   {
+      return m_mutex;
+   }
+
+   const std::string& getName() const;
+
+
+private:
+   // copying not allowed
+   StdReadWriteLock(const StdReadWriteLock&);
+   StdReadWriteLock& operator=(const StdReadWriteLock&);
+
+   std::shared_mutex m_mutex;
+   std::mutex m_writerGate;
+   std::atomic<int> m_numberWaitingWriters;
+   std::string m_name;
+   const bool m_isWriterPreferring;
+
+};
+
+}
+
+#endif
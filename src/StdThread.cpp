@@ -21,6 +21,10 @@ void StdThread::runThread(StdThread* thread)
 
    thread->setThreadId(threadIdString);
 
+   // std::thread has no way to set the stack size, but the rest of the
+   // attributes can be applied from within the thread
+   thread->getThreadAttributes().applyToCurrentThread(thread->getName());
+
    //unsigned long rc = 0L;
 
    try {
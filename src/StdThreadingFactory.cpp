@@ -5,8 +5,12 @@
 #include "StdMutex.h"
 #include "StdThread.h"
 #include "ThreadPool.h"
+#include "RingThreadPoolQueue.h"
+#include "ThreadPoolDispatch.h"
+#include "WorkStealingThreadPool.h"
 #include "Logger.h"
 #include "StdConditionVariable.h"
+#include "StdReadWriteLock.h"
 
 using namespace chaudiere;
 
@@ -37,11 +41,16 @@ Thread* StdThreadingFactory::createThread(const std::string& name) {
 //******************************************************************************
 
 Thread* StdThreadingFactory::createThread(Runnable* runnable, const std::string& name) {
+   StdThread* thread;
+
    if (runnable != nullptr) {
-      return new StdThread(runnable, name);
+      thread = new StdThread(runnable, name);
    } else {
-      return new StdThread(name);
+      thread = new StdThread(name);
    }
+
+   thread->setThreadAttributes(getThreadAttributes());
+   return thread;
 }
 
 //******************************************************************************
@@ -52,7 +61,22 @@ ConditionVariable* StdThreadingFactory::createConditionVariable(const std::strin
 
 //******************************************************************************
 
+ReadWriteLock* StdThreadingFactory::createReadWriteLock(const std::string& name,
+             ReadWritePreference preference) {
+   return new StdReadWriteLock(name, preference);
+}
+
+//******************************************************************************
+
 ThreadPoolDispatcher* StdThreadingFactory::createThreadPoolDispatcher(int numberThreads, const std::string& name) {
+   if (getThreadPoolType() == ThreadPoolType::WorkStealing) {
+      return new WorkStealingThreadPool(this, numberThreads, name);
+   } else if (getThreadPoolType() == ThreadPoolType::SharedRing) {
+      return new ThreadPool(this, new RingThreadPoolQueue(this), numberThreads, name);
+   } else if (getThreadPoolType() == ThreadPoolType::Dispatch) {
+      return new ThreadPoolDispatch(this, numberThreads, name);
+   }
+
    return new ThreadPool(this, numberThreads, name);
 }
 
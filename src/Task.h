@@ -0,0 +1,196 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TASK_H
+#define CHAUDIERE_TASK_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace chaudiere
+{
+
+/**
+ * Task is a move-only, type-erased unit of work: any callable taking no
+ * arguments (a lambda, a function object, a function pointer). Callables of
+ * up to INLINE_SIZE bytes that can be moved without throwing are stored in
+ * the Task itself, so that creating, queueing and running one does no heap
+ * allocation; larger ones are moved to the heap.
+ *
+ * Tasks are the allocation-free alternative to a heap-allocated Runnable
+ * for a ThreadPool. Unlike a Runnable, a Task has no completion observer,
+ * deadline or auto-delete flag: whatever it needs done when it finishes, it
+ * does at the end of its callable.
+ */
+class Task
+{
+public:
+   static const std::size_t INLINE_SIZE = 64;
+
+   /**
+    * Constructs an empty Task
+    */
+   Task() noexcept :
+      m_ops(nullptr) {
+   }
+
+   /**
+    * Constructs a Task that runs the given callable
+    * @param callable the callable (moved or copied into the Task)
+    */
+   template <typename Callable,
+             typename = std::enable_if_t<
+                !std::is_same_v<std::decay_t<Callable>, Task> &&
+                std::is_invocable_v<std::decay_t<Callable>&>>>
+   Task(Callable&& callable) :
+      m_ops(nullptr) {
+      using Stored = std::decay_t<Callable>;
+
+      if constexpr (isInlineable<Stored>()) {
+         ::new (static_cast<void*>(m_storage)) Stored(std::forward<Callable>(callable));
+         m_ops = &InlineOps<Stored>::ops;
+      } else {
+         Stored* heapCallable = new Stored(std::forward<Callable>(callable));
+         ::new (static_cast<void*>(m_storage)) Stored*(heapCallable);
+         m_ops = &HeapOps<Stored>::ops;
+      }
+   }
+
+   /**
+    * Move constructor (leaves other empty)
+    * @param other the Task to move from
+    */
+   Task(Task&& other) noexcept :
+      m_ops(other.m_ops) {
+      if (nullptr != m_ops) {
+         m_ops->move(other.m_storage, m_storage);
+         other.m_ops = nullptr;
+      }
+   }
+
+   /**
+    * Move assignment (leaves other empty)
+    * @param other the Task to move from
+    * @return this Task
+    */
+   Task& operator=(Task&& other) noexcept {
+      if (this != &other) {
+         reset();
+
+         if (nullptr != other.m_ops) {
+            other.m_ops->move(other.m_storage, m_storage);
+            m_ops = other.m_ops;
+            other.m_ops = nullptr;
+         }
+      }
+
+      return *this;
+   }
+
+   /**
+    * Destructor
+    */
+   ~Task() {
+      reset();
+   }
+
+   /**
+    * Runs the callable (the Task must not be empty)
+    */
+   void operator()() {
+      m_ops->invoke(m_storage);
+   }
+
+   /**
+    * @return boolean indicating if the Task has a callable
+    */
+   explicit operator bool() const noexcept {
+      return nullptr != m_ops;
+   }
+
+   /**
+    * @return boolean indicating if the callable is stored inline (no heap)
+    */
+   bool isInline() const noexcept {
+      return (nullptr != m_ops) && m_ops->isInline;
+   }
+
+   /**
+    * Destroys the callable, leaving the Task empty
+    */
+   void reset() noexcept {
+      if (nullptr != m_ops) {
+         m_ops->destroy(m_storage);
+         m_ops = nullptr;
+      }
+   }
+
+
+private:
+   struct Ops {
+      void (*invoke)(void* storage);
+      void (*move)(void* from, void* to) noexcept;
+      void (*destroy)(void* storage) noexcept;
+      bool isInline;
+   };
+
+   template <typename Stored>
+   static constexpr bool isInlineable() {
+      return (sizeof(Stored) <= INLINE_SIZE) &&
+             (alignof(Stored) <= alignof(std::max_align_t)) &&
+             std::is_nothrow_move_constructible_v<Stored>;
+   }
+
+   template <typename Stored>
+   struct InlineOps {
+      static void invoke(void* storage) {
+         (*static_cast<Stored*>(storage))();
+      }
+
+      static void move(void* from, void* to) noexcept {
+         Stored* source = static_cast<Stored*>(from);
+         ::new (to) Stored(std::move(*source));
+         source->~Stored();
+      }
+
+      static void destroy(void* storage) noexcept {
+         static_cast<Stored*>(storage)->~Stored();
+      }
+
+      static constexpr Ops ops = { &invoke, &move, &destroy, true };
+   };
+
+   template <typename Stored>
+   struct HeapOps {
+      static Stored*& pointer(void* storage) {
+         return *static_cast<Stored**>(storage);
+      }
+
+      static void invoke(void* storage) {
+         (*pointer(storage))();
+      }
+
+      static void move(void* from, void* to) noexcept {
+         ::new (to) Stored*(pointer(from));
+      }
+
+      static void destroy(void* storage) noexcept {
+         delete pointer(storage);
+      }
+
+      static constexpr Ops ops = { &invoke, &move, &destroy, false };
+   };
+
+   alignas(std::max_align_t) unsigned char m_storage[INLINE_SIZE];
+   const Ops* m_ops;
+
+   // disallow copies
+   Task(const Task&);
+   Task& operator=(const Task&);
+};
+
+}
+
+#endif
@@ -0,0 +1,52 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TASKRUNNABLE_H
+#define CHAUDIERE_TASKRUNNABLE_H
+
+#include <utility>
+
+#include "Runnable.h"
+#include "Task.h"
+
+namespace chaudiere
+{
+
+/**
+ * TaskRunnable adapts a Task to the Runnable interface, for dispatchers
+ * and queues that only hold Runnables. It costs the heap allocation that
+ * a Task otherwise avoids.
+ */
+class TaskRunnable : public Runnable
+{
+public:
+   /**
+    * Constructs a TaskRunnable that runs the given task
+    * @param task the task (moved into the TaskRunnable)
+    */
+   explicit TaskRunnable(Task&& task) :
+      m_task(std::move(task)) {
+   }
+
+   /**
+    * Runs the task
+    */
+   void run() override {
+      m_task();
+   }
+
+   /**
+    * @return the task (e.g., to hand it back when it couldn't be queued)
+    */
+   Task& getTask() {
+      return m_task;
+   }
+
+
+private:
+   Task m_task;
+};
+
+}
+
+#endif
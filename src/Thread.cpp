@@ -199,6 +199,18 @@ const std::string& Thread::getWorkerId() const {
 
 //******************************************************************************
 
+void Thread::setThreadAttributes(const ThreadAttributes& threadAttributes) {
+   m_threadAttributes = threadAttributes;
+}
+
+//******************************************************************************
+
+const ThreadAttributes& Thread::getThreadAttributes() const {
+   return m_threadAttributes;
+}
+
+//******************************************************************************
+
 void Thread::sleep(long msec) {
    struct timespec ts;
    int res;
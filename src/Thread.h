@@ -7,6 +7,7 @@
 
 #include "Runnable.h"
 #include "KeyValuePairs.h"
+#include "ThreadAttributes.h"
 
 
 namespace chaudiere {
@@ -164,6 +165,20 @@ public:
     */
    const std::string& getWorkerId() const;
 
+   /**
+    * Sets how the thread is to be placed and scheduled once started
+    * (must be called before start)
+    * @param threadAttributes the thread's cpu affinity, stack size, etc.
+    * @see ThreadAttributes()
+    */
+   void setThreadAttributes(const ThreadAttributes& threadAttributes);
+
+   /**
+    *
+    * @return
+    */
+   const ThreadAttributes& getThreadAttributes() const;
+
    virtual void join() = 0;
 
    static void sleep(long msec);
@@ -176,6 +191,7 @@ private:
    Mutex* m_mutexAlive; // weak
    ThreadCompletionObserver* m_threadCompletionObserver;
    KeyValuePairs m_attributes;
+   ThreadAttributes m_threadAttributes;
 
    // disallow copying
    Thread(const Thread&);
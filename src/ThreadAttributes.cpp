@@ -0,0 +1,294 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "ThreadAttributes.h"
+#include "Logger.h"
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+ThreadAttributes::ThreadAttributes() :
+   m_numaNode(-1),
+   m_stackSize(0),
+   m_schedulingPolicy(ThreadSchedulingPolicy::Default),
+   m_schedulingPriority(0) {
+}
+
+//******************************************************************************
+
+void ThreadAttributes::setCpuSet(const std::vector<int>& cpus) {
+   m_cpus = cpus;
+}
+
+//******************************************************************************
+
+const std::vector<int>& ThreadAttributes::getCpuSet() const {
+   return m_cpus;
+}
+
+//******************************************************************************
+
+void ThreadAttributes::setNumaNode(int numaNode) {
+   m_numaNode = numaNode;
+}
+
+//******************************************************************************
+
+int ThreadAttributes::getNumaNode() const {
+   return m_numaNode;
+}
+
+//******************************************************************************
+
+void ThreadAttributes::setStackSize(std::size_t stackSize) {
+   m_stackSize = stackSize;
+}
+
+//******************************************************************************
+
+std::size_t ThreadAttributes::getStackSize() const {
+   return m_stackSize;
+}
+
+//******************************************************************************
+
+void ThreadAttributes::setSchedulingPolicy(ThreadSchedulingPolicy policy,
+                                           int priority) {
+   m_schedulingPolicy = policy;
+   m_schedulingPriority = priority;
+}
+
+//******************************************************************************
+
+ThreadSchedulingPolicy ThreadAttributes::getSchedulingPolicy() const {
+   return m_schedulingPolicy;
+}
+
+//******************************************************************************
+
+int ThreadAttributes::getSchedulingPriority() const {
+   return m_schedulingPriority;
+}
+
+//******************************************************************************
+
+bool ThreadAttributes::hasCpuAffinity() const {
+   return !m_cpus.empty() || (m_numaNode >= 0);
+}
+
+//******************************************************************************
+
+bool ThreadAttributes::resolveCpus(std::vector<int>& cpus) const {
+   cpus.clear();
+
+   if (!m_cpus.empty()) {
+      cpus = m_cpus;
+   } else if (m_numaNode >= 0) {
+      getNumaNodeCpus(m_numaNode, cpus);
+   }
+
+   return !cpus.empty();
+}
+
+//******************************************************************************
+
+bool ThreadAttributes::applyToCurrentThread(const std::string& name) const {
+   bool isSuccess = true;
+
+   if (!name.empty()) {
+      // naming is cosmetic; not being able to doesn't count as a failure
+      setCurrentThreadName(name);
+   }
+
+   if (hasCpuAffinity()) {
+#if defined(__linux__)
+      std::vector<int> cpus;
+      cpu_set_t cpuSet;
+      CPU_ZERO(&cpuSet);
+
+      if (resolveCpus(cpus)) {
+         for (int cpu : cpus) {
+            if ((cpu >= 0) && (cpu < CPU_SETSIZE)) {
+               CPU_SET(cpu, &cpuSet);
+            }
+         }
+      }
+
+      if ((0 == CPU_COUNT(&cpuSet)) ||
+          (0 != ::pthread_setaffinity_np(::pthread_self(),
+                                         sizeof(cpuSet),
+                                         &cpuSet))) {
+         LOG_WARNING("unable to set cpu affinity for thread '" + name + "'")
+         isSuccess = false;
+      }
+#else
+      LOG_WARNING("cpu affinity is not supported on this platform")
+      isSuccess = false;
+#endif
+   }
+
+   if (m_schedulingPolicy != ThreadSchedulingPolicy::Default) {
+      int policy = SCHED_OTHER;
+
+      switch (m_schedulingPolicy) {
+         case ThreadSchedulingPolicy::Fifo:
+            policy = SCHED_FIFO;
+            break;
+         case ThreadSchedulingPolicy::RoundRobin:
+            policy = SCHED_RR;
+            break;
+#if defined(__linux__)
+         case ThreadSchedulingPolicy::Batch:
+            policy = SCHED_BATCH;
+            break;
+         case ThreadSchedulingPolicy::Idle:
+            policy = SCHED_IDLE;
+            break;
+#endif
+         default:
+            policy = SCHED_OTHER;
+            break;
+      }
+
+      struct sched_param param;
+      param.sched_priority =
+         ((policy == SCHED_FIFO) || (policy == SCHED_RR)) ? m_schedulingPriority : 0;
+
+      if (0 != ::pthread_setschedparam(::pthread_self(), policy, &param)) {
+         LOG_WARNING("unable to set scheduling policy for thread '" + name + "'")
+         isSuccess = false;
+      }
+   }
+
+   return isSuccess;
+}
+
+//******************************************************************************
+
+bool ThreadAttributes::setCurrentThreadName(const std::string& name) {
+#if defined(__linux__)
+   // the kernel limits names to 16 bytes, including the terminator
+   const std::string shortName = name.substr(0, 15);
+   return 0 == ::pthread_setname_np(::pthread_self(), shortName.c_str());
+#elif defined(__APPLE__)
+   return 0 == ::pthread_setname_np(name.c_str());
+#else
+   return false;
+#endif
+}
+
+//******************************************************************************
+
+bool ThreadAttributes::parseCpuList(const std::string& cpuList,
+                                    std::vector<int>& cpus) {
+   cpus.clear();
+
+   std::string::size_type posStart = 0;
+
+   while (posStart < cpuList.length()) {
+      std::string::size_type posComma = cpuList.find(',', posStart);
+      if (posComma == std::string::npos) {
+         posComma = cpuList.length();
+      }
+
+      const std::string range = cpuList.substr(posStart, posComma - posStart);
+      posStart = posComma + 1;
+
+      if (range.empty() || (range.find_first_not_of(" \t\r\n") == std::string::npos)) {
+         continue;
+      }
+
+      const char* rangeStart = range.c_str();
+      char* rangeEnd = nullptr;
+      const long first = ::strtol(rangeStart, &rangeEnd, 10);
+
+      if ((rangeEnd == rangeStart) || (first < 0)) {
+         cpus.clear();
+         return false;
+      }
+
+      long last = first;
+
+      if ('-' == *rangeEnd) {
+         const char* lastStart = rangeEnd + 1;
+         last = ::strtol(lastStart, &rangeEnd, 10);
+
+         if ((rangeEnd == lastStart) || (last < first)) {
+            cpus.clear();
+            return false;
+         }
+      }
+
+      // allow trailing whitespace (sysfs files end with a newline)
+      while ((' ' == *rangeEnd) || ('\t' == *rangeEnd) ||
+             ('\r' == *rangeEnd) || ('\n' == *rangeEnd)) {
+         ++rangeEnd;
+      }
+
+      if ('\0' != *rangeEnd) {
+         cpus.clear();
+         return false;
+      }
+
+      for (long cpu = first; cpu <= last; ++cpu) {
+         cpus.push_back(static_cast<int>(cpu));
+      }
+   }
+
+   return !cpus.empty();
+}
+
+//******************************************************************************
+
+bool ThreadAttributes::getNumaNodeCpus(int numaNode, std::vector<int>& cpus) {
+   cpus.clear();
+
+   if (numaNode < 0) {
+      return false;
+   }
+
+   const std::string path = "/sys/devices/system/node/node" +
+                            std::to_string(numaNode) + "/cpulist";
+   std::ifstream cpuListFile(path);
+   std::string cpuList;
+
+   if (!cpuListFile || !std::getline(cpuListFile, cpuList)) {
+      LOG_WARNING("unable to read cpus of NUMA node " + std::to_string(numaNode))
+      return false;
+   }
+
+   return parseCpuList(cpuList, cpus);
+}
+
+//******************************************************************************
+
+bool ThreadAttributes::parseSchedulingPolicy(const std::string& name,
+                                             ThreadSchedulingPolicy& policy) {
+   if (name == "default") {
+      policy = ThreadSchedulingPolicy::Default;
+   } else if (name == "other") {
+      policy = ThreadSchedulingPolicy::Other;
+   } else if (name == "batch") {
+      policy = ThreadSchedulingPolicy::Batch;
+   } else if (name == "idle") {
+      policy = ThreadSchedulingPolicy::Idle;
+   } else if (name == "fifo") {
+      policy = ThreadSchedulingPolicy::Fifo;
+   } else if (name == "rr") {
+      policy = ThreadSchedulingPolicy::RoundRobin;
+   } else {
+      return false;
+   }
+
+   return true;
+}
+
+//******************************************************************************
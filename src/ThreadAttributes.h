@@ -0,0 +1,159 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_THREADATTRIBUTES_H
+#define CHAUDIERE_THREADATTRIBUTES_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace chaudiere
+{
+
+/**
+ * OS scheduling policy for a thread
+ */
+enum class ThreadSchedulingPolicy {
+   Default,      // leave whatever the thread inherits
+   Other,        // SCHED_OTHER (normal time-sharing)
+   Batch,        // SCHED_BATCH (cpu-bound, non-interactive)
+   Idle,         // SCHED_IDLE (only when nothing else wants the cpu)
+   Fifo,         // SCHED_FIFO (real-time, needs privileges)
+   RoundRobin    // SCHED_RR (real-time, needs privileges)
+};
+
+/**
+ * ThreadAttributes describes how a thread should be placed and scheduled:
+ * the cpus it may run on (an explicit cpu set, or all the cpus of one NUMA
+ * node), its stack size, its scheduling policy and priority. Threads are
+ * also given their name at the OS level, so that they show up by name in
+ * tools like top and perf.
+ *
+ * Placement and scheduling are best effort: a setting the platform doesn't
+ * support (or the process isn't allowed to use) is logged and skipped, and
+ * the thread runs anyway.
+ */
+class ThreadAttributes
+{
+public:
+   /**
+    * Constructs attributes that leave every setting at the OS default
+    */
+   ThreadAttributes();
+
+   /**
+    * Restricts the thread to the given cpus (takes precedence over a NUMA node)
+    * @param cpus the cpu numbers (empty == no restriction)
+    */
+   void setCpuSet(const std::vector<int>& cpus);
+
+   /**
+    * @return the explicit cpu set (empty if none)
+    */
+   const std::vector<int>& getCpuSet() const;
+
+   /**
+    * Restricts the thread to the cpus of one NUMA node
+    * @param numaNode the node number (-1 == no restriction)
+    */
+   void setNumaNode(int numaNode);
+
+   /**
+    * @return the NUMA node (-1 if none)
+    */
+   int getNumaNode() const;
+
+   /**
+    * Sets the thread's stack size
+    * @param stackSize the stack size in bytes (0 == OS default)
+    */
+   void setStackSize(std::size_t stackSize);
+
+   /**
+    * @return the stack size in bytes (0 == OS default)
+    */
+   std::size_t getStackSize() const;
+
+   /**
+    * Sets the thread's scheduling policy and priority
+    * @param policy the scheduling policy
+    * @param priority the priority (only meaningful for Fifo and RoundRobin)
+    */
+   void setSchedulingPolicy(ThreadSchedulingPolicy policy, int priority = 0);
+
+   /**
+    * @return the scheduling policy
+    */
+   ThreadSchedulingPolicy getSchedulingPolicy() const;
+
+   /**
+    * @return the scheduling priority
+    */
+   int getSchedulingPriority() const;
+
+   /**
+    * @return boolean indicating if the thread's cpus are restricted
+    */
+   bool hasCpuAffinity() const;
+
+   /**
+    * Resolves the cpus the thread is restricted to
+    * @param cpus receives the explicit cpu set, or the NUMA node's cpus
+    * @return boolean indicating if there's a (non-empty) restriction
+    */
+   bool resolveCpus(std::vector<int>& cpus) const;
+
+   /**
+    * Names, places and schedules the calling thread. (The stack size has to
+    * be applied when the thread is created, so it isn't applied here.)
+    * @param name the thread's name (empty == leave the name alone)
+    * @return boolean indicating if every setting was applied
+    */
+   bool applyToCurrentThread(const std::string& name) const;
+
+   /**
+    * Sets the calling thread's OS-level name (truncated to the platform's
+    * limit -- 15 characters on Linux)
+    * @param name the thread's name
+    * @return boolean indicating if the name was set
+    */
+   static bool setCurrentThreadName(const std::string& name);
+
+   /**
+    * Parses a cpu list in the kernel's format (e.g., "0-3,8,10-11")
+    * @param cpuList the cpu list
+    * @param cpus receives the cpu numbers
+    * @return boolean indicating if the list was valid
+    */
+   static bool parseCpuList(const std::string& cpuList, std::vector<int>& cpus);
+
+   /**
+    * Retrieves the cpus of a NUMA node (from sysfs)
+    * @param numaNode the node number
+    * @param cpus receives the node's cpu numbers
+    * @return boolean indicating if the node's cpus could be read
+    */
+   static bool getNumaNodeCpus(int numaNode, std::vector<int>& cpus);
+
+   /**
+    * Parses a scheduling policy name (default, other, batch, idle, fifo, rr)
+    * @param name the policy name
+    * @param policy receives the policy
+    * @return boolean indicating if the name was recognized
+    */
+   static bool parseSchedulingPolicy(const std::string& name,
+                                     ThreadSchedulingPolicy& policy);
+
+
+private:
+   std::vector<int> m_cpus;
+   int m_numaNode;
+   std::size_t m_stackSize;
+   ThreadSchedulingPolicy m_schedulingPolicy;
+   int m_schedulingPriority;
+};
+
+}
+
+#endif
@@ -2,9 +2,11 @@
 // BSD License
 
 #include <cstdio>
+#include <utility>
 
 #include "ThreadPool.h"
 #include "ThreadPoolQueue.h"
+#include "MutexLock.h"
 #include "Logger.h"
 
 using namespace chaudiere;
@@ -13,7 +15,8 @@ using namespace chaudiere;
 
 ThreadPool::ThreadPool(int numberWorkers) :
    m_threadingFactory(ThreadingFactory::getThreadingFactory()),
-   m_queue(m_threadingFactory),
+   m_queue(new ThreadPoolQueue(m_threadingFactory)),
+   m_mutexWorkers(m_threadingFactory->createMutex("ThreadPool")),
    m_workerCount(numberWorkers),
    m_workersCreated(0),
    m_isRunning(false),
@@ -25,7 +28,8 @@ ThreadPool::ThreadPool(int numberWorkers) :
 
 ThreadPool::ThreadPool(int numberWorkers, const std::string& name) :
    m_threadingFactory(ThreadingFactory::getThreadingFactory()),
-   m_queue(m_threadingFactory),
+   m_queue(new ThreadPoolQueue(m_threadingFactory)),
+   m_mutexWorkers(m_threadingFactory->createMutex("ThreadPool")),
    m_workerCount(numberWorkers),
    m_workersCreated(0),
    m_isRunning(false),
@@ -38,7 +42,8 @@ ThreadPool::ThreadPool(int numberWorkers, const std::string& name) :
 ThreadPool::ThreadPool(ThreadingFactory* threadingFactory,
                        int numberWorkers) :
    m_threadingFactory(threadingFactory),
-   m_queue(m_threadingFactory),
+   m_queue(new ThreadPoolQueue(m_threadingFactory)),
+   m_mutexWorkers(m_threadingFactory->createMutex("ThreadPool")),
    m_workerCount(numberWorkers),
    m_workersCreated(0),
    m_isRunning(false),
@@ -52,7 +57,25 @@ ThreadPool::ThreadPool(ThreadingFactory* threadingFactory,
                        int numberWorkers,
                        const std::string& name) :
    m_threadingFactory(threadingFactory),
-   m_queue(m_threadingFactory),
+   m_queue(new ThreadPoolQueue(m_threadingFactory)),
+   m_mutexWorkers(m_threadingFactory->createMutex("ThreadPool")),
+   m_workerCount(numberWorkers),
+   m_workersCreated(0),
+   m_isRunning(false),
+   m_name(name) {
+   LOG_INSTANCE_CREATE("ThreadPool")
+   start();
+}
+
+//*****************************************************************************
+
+ThreadPool::ThreadPool(ThreadingFactory* threadingFactory,
+                       ThreadPoolQueue* queue,
+                       int numberWorkers,
+                       const std::string& name) :
+   m_threadingFactory(threadingFactory),
+   m_queue(queue),
+   m_mutexWorkers(m_threadingFactory->createMutex("ThreadPool")),
    m_workerCount(numberWorkers),
    m_workersCreated(0),
    m_isRunning(false),
@@ -70,6 +93,8 @@ ThreadPool::~ThreadPool() {
       stop();
    }
 
+   m_autoScaler.reset();
+
    for (auto& worker : m_listWorkers) {
       delete worker;
    }
@@ -80,19 +105,18 @@ ThreadPool::~ThreadPool() {
 //******************************************************************************
 
 bool ThreadPool::start() {
+   MutexLock lock(*m_mutexWorkers, "ThreadPool::start");
    bool didStart = false;
    int oldCreatedCount = m_workersCreated;
 
    if (!m_isRunning) {
-      if (!m_queue.isRunning()) {
-         m_queue.restart();
+      if (!m_queue->isRunning()) {
+         m_queue->restart();
       }
 
       if (m_workerCount > 0) {
          for (int i = 0; i < m_workerCount; ++i) {
-            ++m_workersCreated;
-            ThreadPoolWorker* worker =
-               new ThreadPoolWorker(m_threadingFactory, m_queue, m_workersCreated);
+            ThreadPoolWorker* worker = createWorker();
             worker->start();
             m_listWorkers.push_back(worker);
          }
@@ -106,6 +130,12 @@ bool ThreadPool::start() {
       }
    }
 
+   lock.unlock();
+
+   if (didStart && m_autoScaler) {
+      m_autoScaler->start(m_threadingFactory);
+   }
+
    return didStart;
 }
 
@@ -114,8 +144,15 @@ bool ThreadPool::start() {
 bool ThreadPool::stop() {
    bool didStop = false;
 
+   // the auto-scaler adjusts the workers under the lock, so stop it first
+   if (m_autoScaler) {
+      m_autoScaler->stop();
+   }
+
+   MutexLock lock(*m_mutexWorkers, "ThreadPool::stop");
+
    if (m_isRunning) {
-      m_queue.shutDown();
+      m_queue->shutDown();
 
       for (auto& worker : m_listWorkers) {
          worker->stop();
@@ -137,7 +174,7 @@ bool ThreadPool::addRequest(Runnable* runnableRequest) {
    bool requestAdded = false;
 
    if (m_isRunning && (nullptr != runnableRequest)) {
-      m_queue.addRequest(runnableRequest);
+      m_queue->addRequest(runnableRequest);
       requestAdded = true;
    }
 
@@ -146,6 +183,26 @@ bool ThreadPool::addRequest(Runnable* runnableRequest) {
 
 //******************************************************************************
 
+bool ThreadPool::addRequest(Task&& task) {
+   if (!m_isRunning) {
+      return false;
+   }
+
+   return m_queue->addRequest(std::move(task));
+}
+
+//******************************************************************************
+
+std::size_t ThreadPool::addRequests(std::span<Runnable* const> runnableRequests) {
+   if (!m_isRunning) {
+      return 0;
+   }
+
+   return m_queue->addRequests(runnableRequests);
+}
+
+//******************************************************************************
+
 Thread* ThreadPool::createThreadWithRunnable(Runnable* runnable) {
    return m_threadingFactory->createThread(runnable, "threadpool");
 }
@@ -179,6 +236,7 @@ bool ThreadPool::removeWorkers(int numberWorkersToRemove) {
 //******************************************************************************
 
 bool ThreadPool::adjustNumberWorkers(int numberToAddOrDelete) {
+   MutexLock lock(*m_mutexWorkers, "ThreadPool::adjustNumberWorkers");
    bool requestSatisfied = false;
 
    if (numberToAddOrDelete > 0) {   // adding?
@@ -186,10 +244,8 @@ bool ThreadPool::adjustNumberWorkers(int numberToAddOrDelete) {
       const int newNumberWorkers = m_workerCount + numberToAddOrDelete;
 
       for (int i = m_workerCount; i < newNumberWorkers; ++i) {
-         ++m_workersCreated;
          ++m_workerCount;
-         ThreadPoolWorker* worker =
-            new ThreadPoolWorker(m_threadingFactory, m_queue, m_workersCreated);
+         ThreadPoolWorker* worker = createWorker();
 
          if (m_isRunning) {
             worker->start();
@@ -202,13 +258,25 @@ bool ThreadPool::adjustNumberWorkers(int numberToAddOrDelete) {
       if (m_isRunning) {
          int numToRemove = -numberToAddOrDelete;
          if (numToRemove <= m_workerCount) {
+            std::list<ThreadPoolWorker*> listRetiring;
+
             while (numToRemove > 0) {
                ThreadPoolWorker* lastWorker = m_listWorkers.back();
                m_listWorkers.pop_back();
                --m_workerCount;
                --numToRemove;
-               lastWorker->stop();
-               delete lastWorker;
+               lastWorker->requestStop();
+               listRetiring.push_back(lastWorker);
+            }
+
+            // the queue keeps running for the remaining workers, so the
+            // retiring ones have to be woken up to notice their stop
+            // request. each finishes the requests it has already taken.
+            m_queue->interruptTakers();
+
+            for (auto& worker : listRetiring) {
+               worker->stop();
+               delete worker;
             }
             requestSatisfied = true;
          }
@@ -223,6 +291,20 @@ bool ThreadPool::adjustNumberWorkers(int numberToAddOrDelete) {
 
 //******************************************************************************
 
+ThreadPoolWorker* ThreadPool::createWorker() {
+   ++m_workersCreated;
+   ThreadPoolWorker* worker =
+      new ThreadPoolWorker(m_threadingFactory, *m_queue, m_workersCreated);
+
+   if (m_workerAttributes) {
+      worker->setThreadAttributes(*m_workerAttributes);
+   }
+
+   return worker;
+}
+
+//******************************************************************************
+
 const std::string& ThreadPool::getName() const {
    return m_name;
 }
@@ -236,14 +318,103 @@ bool ThreadPool::isRunning() const {
 //******************************************************************************
 
 void ThreadPool::setMaxQueueSize(std::size_t maxSize, QueueFullPolicy policy) {
-   m_queue.setMaxQueueSize(maxSize, policy);
+   m_queue->setMaxQueueSize(maxSize, policy);
 }
 
 //******************************************************************************
 
 std::size_t ThreadPool::getMaxQueueSize() const {
-   return m_queue.getMaxQueueSize();
+   return m_queue->getMaxQueueSize();
+}
+
+//******************************************************************************
+
+bool ThreadPool::setPriorityScheduling(PriorityScheduling scheduling) {
+   return m_queue->setPriorityScheduling(scheduling);
 }
 
 //******************************************************************************
 
+bool ThreadPool::setLaneWeight(PriorityClass priority, unsigned int weight) {
+   return m_queue->setLaneWeight(priority, weight);
+}
+
+//******************************************************************************
+
+bool ThreadPool::setLaneMaxQueueSize(PriorityClass priority,
+                                     std::size_t maxSize,
+                                     QueueFullPolicy policy) {
+   return m_queue->setLaneMaxQueueSize(priority, maxSize, policy);
+}
+
+//******************************************************************************
+
+void ThreadPool::setStarvationThreshold(std::uint64_t thresholdMicros) {
+   m_queue->setStarvationThreshold(thresholdMicros);
+}
+
+//******************************************************************************
+
+bool ThreadPool::setLoadShedding(std::uint64_t targetDelayMicros,
+                                 std::uint64_t intervalMicros) {
+   return m_queue->setLoadShedding(targetDelayMicros, intervalMicros);
+}
+
+//******************************************************************************
+
+void ThreadPool::setSpinLimit(std::size_t maxSpins) {
+   m_queue->setSpinLimit(maxSpins);
+}
+
+//******************************************************************************
+
+std::size_t ThreadPool::getSpinLimit() const {
+   return m_queue->getSpinLimit();
+}
+
+//******************************************************************************
+
+bool ThreadPool::setWorkerThreadAttributes(const ThreadAttributes& threadAttributes) {
+   MutexLock lock(*m_mutexWorkers, "ThreadPool::setWorkerThreadAttributes");
+   m_workerAttributes.reset(new ThreadAttributes(threadAttributes));
+   return true;
+}
+
+//******************************************************************************
+
+bool ThreadPool::enableAutoScaling(const AutoScalingPolicy& policy) {
+   if (m_autoScaler) {
+      return false;
+   }
+
+   m_autoScaler.reset(new ThreadPoolAutoScaler(*this, policy));
+
+   if (m_isRunning) {
+      m_autoScaler->start(m_threadingFactory);
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+bool ThreadPool::isAutoScaling() const {
+   return nullptr != m_autoScaler;
+}
+
+//******************************************************************************
+
+const ThreadPoolAutoScaler* ThreadPool::getAutoScaler() const {
+   return m_autoScaler.get();
+}
+
+//******************************************************************************
+
+void ThreadPool::sampleLoad(AutoScalingSample& sample) const {
+   sample.queueSize = m_queue->getQueueSize();
+   sample.oldestWaitMicros = m_queue->getOldestRequestWaitTime();
+   sample.idleWorkers = m_queue->getNumberWaitingTakers();
+   sample.numberWorkers = m_workerCount;
+}
+
+//******************************************************************************
@@ -4,14 +4,17 @@
 #ifndef CHAUDIERE_THREADPOOL_H
 #define CHAUDIERE_THREADPOOL_H
 
+#include <atomic>
 #include <string>
 #include <list>
 #include <memory>
 
+#include "Mutex.h"
 #include "Thread.h"
 #include "ThreadPoolQueue.h"
 #include "ThreadPoolWorker.h"
 #include "ThreadPoolDispatcher.h"
+#include "ThreadPoolAutoScaler.h"
 #include "ThreadingFactory.h"
 
 namespace chaudiere
@@ -41,6 +44,17 @@ public:
    ThreadPool(ThreadingFactory* threadingFactory, int numberWorkers,
               const std::string& name);
 
+   /**
+    * Constructs a pool whose workers take requests from the given queue
+    * (e.g., a RingThreadPoolQueue) instead of a default ThreadPoolQueue
+    * @param threadingFactory
+    * @param queue the queue (the pool takes ownership of it)
+    * @param numberWorkers
+    * @param name
+    */
+   ThreadPool(ThreadingFactory* threadingFactory, ThreadPoolQueue* queue,
+              int numberWorkers, const std::string& name);
+
    /**
     * Destructor
     */
@@ -67,6 +81,23 @@ public:
     */
    virtual bool addRequest(Runnable* runnableRequest);
 
+   /**
+    * Adds a task to the pool's queue as is (no allocation when the task's
+    * callable is stored inline)
+    * @param task the task (moved from only if it's added)
+    * @return boolean indicating if the task was added
+    * @see Task()
+    */
+   virtual bool addRequest(Task&& task);
+
+   /**
+    * Adds a batch of requests to the pool's queue in one hand-off
+    * @param runnableRequests the requests to add
+    * @return the number of requests added (a prefix of runnableRequests)
+    * @see Runnable()
+    */
+   virtual std::size_t addRequests(std::span<Runnable* const> runnableRequests);
+
    /**
     *
     * @param runnable
@@ -117,6 +148,104 @@ public:
     */
    std::size_t getMaxQueueSize() const;
 
+   /**
+    * Sets how the pool's queue chooses between its priority lanes
+    * @param scheduling strict priority (default) or weighted round-robin
+    * @return boolean indicating if the queue supports priority lanes
+    * @see ThreadPoolQueue::setPriorityScheduling
+    */
+   bool setPriorityScheduling(PriorityScheduling scheduling);
+
+   /**
+    * Sets a lane's weight for weighted round-robin
+    * @param priority the lane's priority class
+    * @param weight the lane's weight (at least 1)
+    * @return boolean indicating if the queue supports priority lanes
+    * @see ThreadPoolQueue::setLaneWeight
+    */
+   bool setLaneWeight(PriorityClass priority, unsigned int weight);
+
+   /**
+    * Sets a maximum number of pending requests for one priority lane
+    * @param priority the lane's priority class
+    * @param maxSize maximum number of pending requests (0 == unbounded)
+    * @param policy what addRequest() does once the lane is at maxSize
+    * @return boolean indicating if the queue supports priority lanes
+    * @see ThreadPoolQueue::setLaneMaxQueueSize
+    */
+   bool setLaneMaxQueueSize(PriorityClass priority,
+                            std::size_t maxSize,
+                            QueueFullPolicy policy = QueueFullPolicy::Reject);
+
+   /**
+    * Sets how long a request may wait under strict priority before its
+    * lane is served ahead of higher priority lanes
+    * @param thresholdMicros the starvation threshold (0 == never)
+    * @see ThreadPoolQueue::setStarvationThreshold
+    */
+   void setStarvationThreshold(std::uint64_t thresholdMicros);
+
+   /**
+    * Turns on CoDel-style load shedding in the pool's queue: once a backlog
+    * has stood for the interval, requests that have waited longer than the
+    * target are dropped instead of run
+    * @param targetDelayMicros the acceptable queueing delay (0 == off)
+    * @param intervalMicros how long a backlog may stand before shedding
+    * @return boolean indicating if the queue supports load shedding
+    * @see ThreadPoolQueue::setLoadShedding
+    */
+   bool setLoadShedding(std::uint64_t targetDelayMicros,
+                        std::uint64_t intervalMicros = 100000);
+
+   /**
+    * Lets idle workers spin for a while before parking, so that bursts
+    * are picked up without a sleep and wake-up round trip
+    * @param maxSpins upper bound on spin iterations (0 == park right away)
+    * @see ThreadPoolQueue::setSpinLimit
+    */
+   void setSpinLimit(std::size_t maxSpins);
+
+   /**
+    * @return the configured upper bound on spin iterations
+    */
+   std::size_t getSpinLimit() const;
+
+   /**
+    * Sets the attributes (cpu affinity, stack size, scheduling) of the
+    * pool's worker threads, in place of the threading factory's. Applies to
+    * workers started afterwards (restart the pool to apply to all of them).
+    * @param threadAttributes the attributes for worker threads
+    * @return true
+    * @see ThreadAttributes()
+    */
+   virtual bool setWorkerThreadAttributes(const ThreadAttributes& threadAttributes);
+
+   /**
+    * Lets the pool grow and shrink on its own between the policy's min and
+    * max number of workers, driven by how long requests wait in the queue.
+    * A controller thread samples the queue while the pool is running.
+    * @param policy the limits and targets
+    * @return boolean indicating if auto-scaling was enabled
+    * @see ThreadPoolAutoScaler
+    */
+   bool enableAutoScaling(const AutoScalingPolicy& policy);
+
+   /**
+    * @return boolean indicating if auto-scaling is enabled
+    */
+   bool isAutoScaling() const;
+
+   /**
+    * @return the auto-scaling controller (nullptr if not enabled)
+    */
+   const ThreadPoolAutoScaler* getAutoScaler() const;
+
+   /**
+    * Samples the pool's current load (used by the auto-scaler)
+    * @param sample receives the queue size, oldest wait and idle workers
+    */
+   void sampleLoad(AutoScalingSample& sample) const;
+
 
 protected:
    /**
@@ -125,13 +254,22 @@ protected:
     */
    bool adjustNumberWorkers(int numberToAddOrDelete);
 
+   /**
+    * Creates a (not yet started) worker with the pool's worker attributes
+    * @return the new worker
+    */
+   ThreadPoolWorker* createWorker();
+
 private:
    ThreadingFactory* m_threadingFactory;
    std::list<ThreadPoolWorker*> m_listWorkers;
-   ThreadPoolQueue m_queue;
-   int m_workerCount;
+   std::unique_ptr<ThreadPoolQueue> m_queue;
+   std::unique_ptr<Mutex> m_mutexWorkers;
+   std::unique_ptr<ThreadPoolAutoScaler> m_autoScaler;
+   std::unique_ptr<ThreadAttributes> m_workerAttributes;
+   std::atomic<int> m_workerCount;
    int m_workersCreated;
-   bool m_isRunning;
+   std::atomic<bool> m_isRunning;
    std::string m_name;
 
    // disallow copies
@@ -0,0 +1,202 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <algorithm>
+#include <chrono>
+
+#include "ThreadPoolAutoScaler.h"
+#include "ThreadPool.h"
+#include "Thread.h"
+#include "ThreadingFactory.h"
+#include "Logger.h"
+
+using namespace chaudiere;
+
+// longest the controller sleeps at a time, so that stop() is prompt
+static const std::uint64_t MAX_SLEEP_MILLIS = 10;
+
+//******************************************************************************
+
+static std::uint64_t currentTimeMillis() {
+   return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//******************************************************************************
+
+ThreadPoolAutoScaler::ThreadPoolAutoScaler(ThreadPool& pool,
+                                           const AutoScalingPolicy& policy) :
+   m_pool(pool),
+   m_policy(policy),
+   m_idleSinceMillis(0),
+   m_workersAdded(0),
+   m_workersRetired(0),
+   m_isRunning(false) {
+   LOG_INSTANCE_CREATE("ThreadPoolAutoScaler")
+
+   if (m_policy.minWorkers < 1) {
+      m_policy.minWorkers = 1;
+   }
+
+   if (m_policy.maxWorkers < m_policy.minWorkers) {
+      m_policy.maxWorkers = m_policy.minWorkers;
+   }
+}
+
+//******************************************************************************
+
+ThreadPoolAutoScaler::~ThreadPoolAutoScaler() {
+   LOG_INSTANCE_DESTROY("ThreadPoolAutoScaler")
+   stop();
+}
+
+//******************************************************************************
+
+bool ThreadPoolAutoScaler::start(ThreadingFactory* threadingFactory) {
+   if (m_isRunning) {
+      return false;
+   }
+
+   m_thread.reset(threadingFactory->createThread(this, "tpautoscaler"));
+
+   if (!m_thread) {
+      return false;
+   }
+
+   m_isRunning = true;
+   m_idleSinceMillis = 0;
+
+   if (!m_thread->start()) {
+      m_isRunning = false;
+      m_thread.reset();
+      return false;
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+bool ThreadPoolAutoScaler::stop() {
+   if (!m_isRunning) {
+      return false;
+   }
+
+   m_isRunning = false;
+
+   if (m_thread) {
+      m_thread->join();
+      m_thread.reset();
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+void ThreadPoolAutoScaler::run() {
+   std::uint64_t nextSampleMillis =
+      currentTimeMillis() + m_policy.sampleIntervalMillis;
+
+   while (m_isRunning) {
+      const std::uint64_t nowMillis = currentTimeMillis();
+
+      if (nowMillis < nextSampleMillis) {
+         Thread::sleep(static_cast<long>(
+            std::min(MAX_SLEEP_MILLIS, nextSampleMillis - nowMillis)));
+         continue;
+      }
+
+      nextSampleMillis = nowMillis + m_policy.sampleIntervalMillis;
+
+      AutoScalingSample sample;
+      m_pool.sampleLoad(sample);
+
+      const int change = evaluate(sample, nowMillis);
+
+      if (change > 0) {
+         if (m_pool.addWorkers(change)) {
+            m_workersAdded.fetch_add(change, std::memory_order_relaxed);
+            LOG_INFO("thread pool auto-scaler added " +
+                     std::to_string(change) + " worker(s)")
+         }
+      } else if (change < 0) {
+         if (m_pool.removeWorkers(-change)) {
+            m_workersRetired.fetch_add(-change, std::memory_order_relaxed);
+            LOG_INFO("thread pool auto-scaler retired " +
+                     std::to_string(-change) + " worker(s)")
+         }
+      }
+   }
+}
+
+//******************************************************************************
+
+int ThreadPoolAutoScaler::evaluate(const AutoScalingSample& sample,
+                                   std::uint64_t nowMillis) {
+   const int numberWorkers = sample.numberWorkers;
+
+   if (numberWorkers < m_policy.minWorkers) {
+      m_idleSinceMillis = 0;
+      return m_policy.minWorkers - numberWorkers;
+   }
+
+   // backed up: requests are waiting longer than the target and every
+   // worker is busy. grow by a quarter (at least one) per sample.
+   if ((sample.queueSize > 0) &&
+       (sample.idleWorkers == 0) &&
+       (sample.oldestWaitMicros > m_policy.targetDelayMicros)) {
+      m_idleSinceMillis = 0;
+
+      if (numberWorkers >= m_policy.maxWorkers) {
+         return 0;
+      }
+
+      const int growth = std::max(1, numberWorkers / 4);
+      return std::min(growth, m_policy.maxWorkers - numberWorkers);
+   }
+
+   // over-provisioned: some workers have had nothing to do for the whole
+   // cooldown. retire half of them (at least one), then start a new
+   // cooldown before retiring more.
+   if ((sample.queueSize == 0) && (sample.idleWorkers > 0)) {
+      if (m_idleSinceMillis == 0) {
+         m_idleSinceMillis = nowMillis;
+         return 0;
+      }
+
+      if ((nowMillis - m_idleSinceMillis < m_policy.idleCooldownMillis) ||
+          (numberWorkers <= m_policy.minWorkers)) {
+         return 0;
+      }
+
+      m_idleSinceMillis = nowMillis;
+
+      const int retirements =
+         std::max(1, static_cast<int>(sample.idleWorkers) / 2);
+      return -std::min(retirements, numberWorkers - m_policy.minWorkers);
+   }
+
+   m_idleSinceMillis = 0;
+   return 0;
+}
+
+//******************************************************************************
+
+const AutoScalingPolicy& ThreadPoolAutoScaler::getPolicy() const {
+   return m_policy;
+}
+
+//******************************************************************************
+
+std::uint64_t ThreadPoolAutoScaler::getNumberWorkersAdded() const {
+   return m_workersAdded.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+std::uint64_t ThreadPoolAutoScaler::getNumberWorkersRetired() const {
+   return m_workersRetired.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
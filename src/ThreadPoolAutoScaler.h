@@ -0,0 +1,139 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_THREADPOOLAUTOSCALER_H
+#define CHAUDIERE_THREADPOOLAUTOSCALER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "Runnable.h"
+
+
+namespace chaudiere
+{
+   class Thread;
+   class ThreadPool;
+   class ThreadingFactory;
+
+/**
+ * Limits and targets for a ThreadPoolAutoScaler
+ */
+struct AutoScalingPolicy {
+   int minWorkers;                       // never retire below this
+   int maxWorkers;                       // never grow above this
+   std::uint64_t targetDelayMicros;      // grow once a request waits longer
+   std::uint64_t idleCooldownMillis;     // retire once workers idle this long
+   std::uint64_t sampleIntervalMillis;   // how often the pool is sampled
+
+   AutoScalingPolicy() :
+      minWorkers(1),
+      maxWorkers(1),
+      targetDelayMicros(10000),
+      idleCooldownMillis(10000),
+      sampleIntervalMillis(100) {
+   }
+};
+
+/**
+ * One sample of a pool's load
+ */
+struct AutoScalingSample {
+   std::size_t queueSize;              // requests waiting to be taken
+   std::uint64_t oldestWaitMicros;     // wait of the oldest waiting request
+   std::size_t idleWorkers;            // workers waiting for a request
+   int numberWorkers;                  // workers in the pool
+
+   AutoScalingSample() :
+      queueSize(0),
+      oldestWaitMicros(0),
+      idleWorkers(0),
+      numberWorkers(0) {
+   }
+};
+
+/**
+ * ThreadPoolAutoScaler is a controller thread that periodically samples a
+ * ThreadPool's queue and resizes the pool between the policy's min and
+ * max. It grows the pool when the oldest waiting request has waited longer
+ * than the target delay (and no worker is idle), and retires workers once
+ * some have sat idle, with nothing queued, for the whole cooldown.
+ */
+class ThreadPoolAutoScaler : public Runnable
+{
+public:
+   /**
+    * Constructs the controller (not yet started)
+    * @param pool the pool to resize
+    * @param policy the limits and targets
+    * @see ThreadPool()
+    */
+   ThreadPoolAutoScaler(ThreadPool& pool, const AutoScalingPolicy& policy);
+
+   /**
+    * Destructor
+    */
+   ~ThreadPoolAutoScaler();
+
+   /**
+    * Starts the controller thread
+    * @param threadingFactory the factory for the controller thread
+    * @return boolean indicating if the controller was started
+    */
+   bool start(ThreadingFactory* threadingFactory);
+
+   /**
+    * Stops and joins the controller thread
+    * @return boolean indicating if the controller was stopped
+    */
+   bool stop();
+
+   /**
+    * The controller thread's sampling loop
+    */
+   void run() override;
+
+   /**
+    * Decides how to resize the pool for one sample. Called by run(); the
+    * decision only depends on its arguments and earlier calls.
+    * @param sample the pool's current load
+    * @param nowMillis the current time in milliseconds
+    * @return the number of workers to add (positive) or retire (negative)
+    */
+   int evaluate(const AutoScalingSample& sample, std::uint64_t nowMillis);
+
+   /**
+    * @return the policy the controller applies
+    */
+   const AutoScalingPolicy& getPolicy() const;
+
+   /**
+    * @return number of workers the controller has added
+    */
+   std::uint64_t getNumberWorkersAdded() const;
+
+   /**
+    * @return number of workers the controller has retired
+    */
+   std::uint64_t getNumberWorkersRetired() const;
+
+
+private:
+   ThreadPool& m_pool;
+   AutoScalingPolicy m_policy;
+   std::unique_ptr<Thread> m_thread;
+   std::uint64_t m_idleSinceMillis;
+   std::atomic<std::uint64_t> m_workersAdded;
+   std::atomic<std::uint64_t> m_workersRetired;
+   std::atomic<bool> m_isRunning;
+
+   // disallow copies
+   ThreadPoolAutoScaler(const ThreadPoolAutoScaler&);
+   ThreadPoolAutoScaler& operator=(const ThreadPoolAutoScaler&);
+};
+
+}
+
+#endif
@@ -1,29 +1,42 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
-#include <stdio.h>
-
-/*
-#if defined(__FreeBSD__) || defined(__APPLE__)
-#define HAVE_GCD 1
-// libdispatch (core of Apple's Grand Central Dispatch)
-#include <dispatch/dispatch.h>
-#include <dispatch/queue.h>
-#else
-#undef HAVE_GCD
-#endif
-*/
+#include <thread>
 
 #include "ThreadPoolDispatch.h"
+#include "ThreadPool.h"
+#include "ThreadingFactory.h"
 #include "Runnable.h"
 #include "Logger.h"
-#include "BasicException.h"
 
 using namespace chaudiere;
 
 //******************************************************************************
 
+static int defaultNumberWorkers() {
+   const unsigned int numberCpus = std::thread::hardware_concurrency();
+   return (numberCpus > 0) ? static_cast<int>(numberCpus) : 4;
+}
+
+//******************************************************************************
+
 ThreadPoolDispatch::ThreadPoolDispatch() :
+   ThreadPoolDispatch(ThreadingFactory::getThreadingFactory(),
+                      defaultNumberWorkers(),
+                      "dispatch") {
+}
+
+//******************************************************************************
+
+ThreadPoolDispatch::ThreadPoolDispatch(ThreadingFactory* threadingFactory,
+                                       int numberWorkers,
+                                       const std::string& name) :
+   m_threadingFactory(threadingFactory),
+   m_workers(new ThreadPool(threadingFactory, numberWorkers, name)),
+   m_globalQueue(new DispatchQueue(threadingFactory,
+                                   *m_workers,
+                                   DispatchQueueType::Concurrent,
+                                   "global")),
    m_isRunning(false) {
    LOG_INSTANCE_CREATE("ThreadPoolDispatch")
 }
@@ -32,20 +45,37 @@ ThreadPoolDispatch::ThreadPoolDispatch() :
 
 ThreadPoolDispatch::~ThreadPoolDispatch() {
    LOG_INSTANCE_DESTROY("ThreadPoolDispatch")
+
+   if (m_isRunning) {
+      stop();
+   }
 }
 
 //******************************************************************************
 
 bool ThreadPoolDispatch::start() {
-   m_isRunning = true;
-   return true;
+   if (m_isRunning) {
+      return false;
+   }
+
+   // (the shared pool starts running when it's constructed)
+   if (!m_workers->isRunning()) {
+      m_workers->start();
+   }
+
+   m_isRunning = m_workers->isRunning();
+   return m_isRunning;
 }
 
 //******************************************************************************
 
 bool ThreadPoolDispatch::stop() {
+   if (!m_isRunning) {
+      return false;
+   }
+
    m_isRunning = false;
-   return true;
+   return m_workers->stop();
 }
 
 //******************************************************************************
@@ -55,29 +85,43 @@ bool ThreadPoolDispatch::addRequest(Runnable* runnableRequest) {
       return false;
    }
 
-#ifdef HAVE_GCD
-   dispatch_queue_t queue =
-      dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
-
-   dispatch_async(queue, ^{
-      try {
-         runnableRequest->run();
-      } catch (const BasicException& be) {
-         LOG_ERROR("exception running request: " + be.whatString())
-      } catch (const std::exception& e) {
-         LOG_ERROR("exception running request: " + std::string(e.what()))
-      } catch (...) {
-         LOG_ERROR("unknown exception running request")
-      }
-
-      runnableRequest->notifyOnCompletion();
-   });
-
-   return true;
-#else
-   return false;
-#endif
+   return m_globalQueue->dispatchAsync(runnableRequest);
 }
 
 //******************************************************************************
 
+bool ThreadPoolDispatch::setWorkerThreadAttributes(const ThreadAttributes& threadAttributes) {
+   return m_workers->setWorkerThreadAttributes(threadAttributes);
+}
+
+//******************************************************************************
+
+DispatchQueue& ThreadPoolDispatch::getGlobalQueue() {
+   return *m_globalQueue;
+}
+
+//******************************************************************************
+
+DispatchQueue* ThreadPoolDispatch::createSerialQueue(const std::string& label) {
+   return new DispatchQueue(m_threadingFactory,
+                            *m_workers,
+                            DispatchQueueType::Serial,
+                            label);
+}
+
+//******************************************************************************
+
+DispatchQueue* ThreadPoolDispatch::createConcurrentQueue(const std::string& label) {
+   return new DispatchQueue(m_threadingFactory,
+                            *m_workers,
+                            DispatchQueueType::Concurrent,
+                            label);
+}
+
+//******************************************************************************
+
+int ThreadPoolDispatch::getNumberWorkers() const {
+   return m_workers->getNumberWorkers();
+}
+
+//******************************************************************************
@@ -4,24 +4,46 @@
 #ifndef CHAUDIERE_THREADPOOLDISPATCH_H
 #define CHAUDIERE_THREADPOOLDISPATCH_H
 
+#include <memory>
+#include <string>
+
 #include "ThreadPoolDispatcher.h"
+#include "DispatchQueue.h"
 
 
 namespace chaudiere
 {
    class Runnable;
+   class ThreadPool;
+   class ThreadingFactory;
 
 /**
- *
+ * ThreadPoolDispatch dispatches requests through dispatch queues in the
+ * style of Grand Central Dispatch, natively (no libdispatch): a global
+ * concurrent queue, plus as many cheap serial queues as needed (e.g., one
+ * per connection, for ordering), all running on one shared worker pool.
+ * Requests added with addRequest go to the global concurrent queue.
  */
 class ThreadPoolDispatch : public ThreadPoolDispatcher
 {
 public:
    /**
-    * Default constructor
+    * Constructs a dispatcher with one worker per cpu, using the
+    * ThreadingFactory singleton
     */
    ThreadPoolDispatch();
 
+   /**
+    * Constructs a dispatcher
+    * @param threadingFactory the threading factory
+    * @param numberWorkers the number of workers in the shared pool
+    * @param name the name of the shared pool
+    * @see ThreadingFactory()
+    */
+   ThreadPoolDispatch(ThreadingFactory* threadingFactory,
+                      int numberWorkers,
+                      const std::string& name);
+
    /**
     * Destructor
     */
@@ -41,16 +63,55 @@ public:
    virtual bool stop();
 
    /**
-    *
+    * Dispatches a request on the global concurrent queue
     * @param runnableRequest
     * @return
     * @see Runnable()
     */
    virtual bool addRequest(Runnable* runnableRequest);
 
+   // addRequest(Task&&) wraps the task in a TaskRunnable
+   using ThreadPoolDispatcher::addRequest;
+
+   /**
+    * Sets the attributes of the shared pool's worker threads
+    * @param threadAttributes the attributes for worker threads
+    * @return true
+    * @see ThreadAttributes()
+    */
+   virtual bool setWorkerThreadAttributes(const ThreadAttributes& threadAttributes);
+
+   /**
+    * @return the global concurrent queue
+    */
+   DispatchQueue& getGlobalQueue();
+
+   /**
+    * Creates a serial queue on the shared pool
+    * @param label the queue's name
+    * @return the new queue (owned by the caller)
+    * @see DispatchQueue()
+    */
+   DispatchQueue* createSerialQueue(const std::string& label);
+
+   /**
+    * Creates a concurrent queue on the shared pool
+    * @param label the queue's name
+    * @return the new queue (owned by the caller)
+    * @see DispatchQueue()
+    */
+   DispatchQueue* createConcurrentQueue(const std::string& label);
+
+   /**
+    * @return the number of workers in the shared pool
+    */
+   int getNumberWorkers() const;
 
 
 private:
+   ThreadingFactory* m_threadingFactory;
+   std::unique_ptr<ThreadPool> m_workers;
+   std::unique_ptr<DispatchQueue> m_globalQueue;
    bool m_isRunning;
 
    // disallow copies
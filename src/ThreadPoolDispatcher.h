@@ -4,13 +4,16 @@
 #ifndef CHAUDIERE_THREADPOOLDISPATCHER_H
 #define CHAUDIERE_THREADPOOLDISPATCHER_H
 
+#include <cstddef>
 #include <memory>
+#include <span>
+#include <utility>
 
-
+#include "TaskRunnable.h"
 
 namespace chaudiere
 {
-   class Runnable;
+   class ThreadAttributes;
 
 /**
  * ThreadPoolDispatcher is an abstract base class for handing off requests
@@ -49,6 +52,61 @@ public:
     */
    virtual bool addRequest(Runnable* runnableRequest) = 0;
 
+   /**
+    * Adds a task. Dispatchers that can queue a Task as is, without
+    * allocating, override this; by default it's wrapped in a TaskRunnable.
+    * @param task the task (moved from only if it's added)
+    * @return boolean indicating if the task was added
+    * @see Task()
+    */
+   virtual bool addRequest(Task&& task) {
+      TaskRunnable* taskRunnable = new TaskRunnable(std::move(task));
+      taskRunnable->setAutoDelete();
+
+      if (addRequest(taskRunnable)) {
+         return true;
+      }
+
+      // hand the task back to the caller
+      task = std::move(taskRunnable->getTask());
+      delete taskRunnable;
+      return false;
+   }
+
+   /**
+    * Adds a batch of requests. Dispatchers that can hand off a batch more
+    * cheaply than one request at a time (e.g., under one lock acquisition)
+    * override this.
+    * @param runnableRequests the requests to add
+    * @return the number of requests added (a prefix of runnableRequests)
+    * @see Runnable()
+    */
+   virtual std::size_t addRequests(std::span<Runnable* const> runnableRequests) {
+      std::size_t numberAdded = 0;
+
+      for (Runnable* runnableRequest : runnableRequests) {
+         if (!addRequest(runnableRequest)) {
+            break;
+         }
+         ++numberAdded;
+      }
+
+      return numberAdded;
+   }
+
+   /**
+    * Sets the attributes (cpu affinity, stack size, scheduling) of the
+    * pool's worker threads, in place of the threading factory's. Applies to
+    * workers started afterwards.
+    * @param threadAttributes the attributes for worker threads
+    * @return boolean indicating if the dispatcher supports worker attributes
+    * @see ThreadAttributes()
+    */
+   virtual bool setWorkerThreadAttributes(const ThreadAttributes& threadAttributes) {
+      (void) threadAttributes;
+      return false;
+   }
+
 
 private:
    // disallow copies
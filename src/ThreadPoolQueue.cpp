@@ -1,64 +1,76 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <exception>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "ThreadPoolQueue.h"
-#include "ThreadingFactory.h"
-#include "ConditionVariable.h"
-#include "MutexLock.h"
+#include "ThreadPoolQueueImpl.h"
 #include "Logger.h"
 #include "BasicException.h"
-#include "Thread.h"
 
 using namespace chaudiere;
 
+// requests a lane may take per weighted round-robin round, Critical to Bulk
+static const unsigned int DEFAULT_LANE_WEIGHTS[NUMBER_PRIORITY_CLASSES] = { 8, 4, 2, 1 };
+
+// how long a request may wait under strict priority before it goes first
+static const std::uint64_t DEFAULT_STARVATION_THRESHOLD = 100000;   // 100ms
+
+// how long a backlog may stand before load shedding tightens to the target
+static const std::uint64_t DEFAULT_SHEDDING_INTERVAL = 100000;      // 100ms
+
 
 //******************************************************************************
 
 ThreadPoolQueue::ThreadPoolQueue(ThreadingFactory* threadingFactory) :
+   ThreadPoolQueue(threadingFactory, true) {
+}
+
+//******************************************************************************
+
+ThreadPoolQueue::ThreadPoolQueue(ThreadingFactory* threadingFactory,
+                                 bool isCreatingLocks) :
    m_threadingFactory(threadingFactory),
-   m_mutex(m_threadingFactory->createMutex("ThreadPoolQueue")),
-   m_condQueueNotEmpty(m_threadingFactory->createConditionVariable("queue-not-empty")),
-   m_condQueueEmpty(m_threadingFactory->createConditionVariable("queue-empty")),
-   m_condQueueNotFull(m_threadingFactory->createConditionVariable("queue-not-full")),
    m_isInitialized(false),
    m_isRunning(false),
    m_activeTakeRequests(0),
    m_activeAddRequests(0),
+   m_waitingTakeRequests(0),
    m_maxQueueSize(0),
-   m_queueFullPolicy(QueueFullPolicy::Reject) {
+   m_queueFullPolicy(QueueFullPolicy::Reject),
+   m_priorityScheduling(PriorityScheduling::Strict),
+   m_starvationThreshold(DEFAULT_STARVATION_THRESHOLD),
+   m_sheddingTarget(0),
+   m_sheddingInterval(DEFAULT_SHEDDING_INTERVAL),
+   m_lastEmptyTime(now()),
+   m_queueSize(0),
+   m_spinLimit(0),
+   m_adaptiveSpinLimit(0),
+   m_spinHits(0),
+   m_parks(0),
+   m_expiredRequests(0),
+   m_shedRequests(0) {
 
    LOG_INSTANCE_CREATE("ThreadPoolQueue")
 
-   try {
-      if (m_mutex && m_condQueueNotEmpty && m_condQueueEmpty && m_condQueueNotFull) {
-         m_isInitialized = true;
-         m_isRunning = true;
-      } else {
-         LOG_ERROR("unable to initialize ThreadPoolQueue")
-         if (!m_mutex) {
-            LOG_ERROR("unable to create mutex")
-         }
-         if (!m_condQueueNotEmpty) {
-            LOG_ERROR("unable to create queue not empty condition variable")
-         }
-         if (!m_condQueueEmpty) {
-            LOG_ERROR("unable to create queue empty condition variable")
-         }
-         if (!m_condQueueNotFull) {
-            LOG_ERROR("unable to create queue not full condition variable")
-         }
-         printf("error: unable to initialize thread pool queue, aborting\n");
-         exit(1);
-      }
-   } catch (const BasicException& be) {
-      LOG_ERROR("exception setting up thread pool queue: " + be.whatString())
-   } catch (const std::exception& e) {
-      LOG_ERROR("exception setting up thread pool queue: " + std::string(e.what()))
-   } catch (...) {
-      LOG_ERROR("unknown exception setting up thread pool queue")
+   for (std::size_t i = 0; i < m_lanes.size(); ++i) {
+      Lane& lane = m_lanes[i];
+      lane.maxSize = 0;
+      lane.queueFullPolicy = QueueFullPolicy::Reject;
+      lane.weight = DEFAULT_LANE_WEIGHTS[i];
+      lane.credits = lane.weight;
+   }
+
+   if (isCreatingLocks) {
+      initializeLocks(m_locks);
    }
 }
 
@@ -67,235 +79,374 @@ ThreadPoolQueue::ThreadPoolQueue(ThreadingFactory* threadingFactory) :
 ThreadPoolQueue::~ThreadPoolQueue() {
    LOG_INSTANCE_DESTROY("ThreadPoolQueue")
 
-   shutDown();
-
-   while (m_activeAddRequests > 0 || m_activeTakeRequests > 0) {
-#if defined(DEBUG)
-      printf("ThreadPoolQueue::~ThreadPoolQueue  active adds=%d, active takes=%d\n",
-             m_activeAddRequests, m_activeTakeRequests);
-#endif
-      Thread::sleep(3);
+   // (a BasicThreadPoolQueue drains with its own locks)
+   if (m_locks.mutex) {
+      drain(m_locks);
    }
-
-#if defined(DEBUG)
-   printf("ThreadPoolQueue::~ThreadPoolQueue  active adds=%d, active takes=%d\n",
-          m_activeAddRequests, m_activeTakeRequests);
-#endif
 }
 
 //******************************************************************************
 
 bool ThreadPoolQueue::addRequest(Runnable* runnableRequest) {
-   if (!m_isInitialized) {
-      LOG_WARNING("ThreadPoolQueue::addRequest queue not initialized")
-      return false;
-   }
+   return addRequestWith(m_locks, runnableRequest);
+}
 
-   if (nullptr == runnableRequest) {
-      LOG_WARNING("ThreadPoolQueue::addRequest rejecting nullptr request")
-      return false;
-   }
+//******************************************************************************
+
+bool ThreadPoolQueue::addRequest(Task&& task, PriorityClass priority) {
+   return addRequestWith(m_locks, std::move(task), priority);
+}
+
+//******************************************************************************
+
+void ThreadPoolQueue::takeRequest(TakeRequestContext& ctx) {
+   takeRequestWith(m_locks, ctx);
+}
+
+//******************************************************************************
+
+std::size_t ThreadPoolQueue::addRequests(std::span<Runnable* const> runnableRequests) {
+   return addRequestsWith(m_locks, runnableRequests);
+}
+
+//******************************************************************************
+
+void ThreadPoolQueue::takeRequests(TakeRequestContext& ctx, std::size_t maxBatch) {
+   takeRequestsWith(m_locks, ctx, maxBatch);
+}
+
+//******************************************************************************
+
+void ThreadPoolQueue::interruptTakers() {
+   interruptTakersWith(m_locks);
+}
+
+//******************************************************************************
+
+bool ThreadPoolQueue::shutDown() {
+   return shutDownWith(m_locks);
+}
+
+//******************************************************************************
+
+bool ThreadPoolQueue::restart() {
+   return restartWith(m_locks);
+}
+
+//******************************************************************************
+
+void ThreadPoolQueue::setMaxQueueSize(std::size_t maxSize, QueueFullPolicy policy) {
+   setMaxQueueSizeWith(m_locks, maxSize, policy);
+}
+
+//******************************************************************************
+
+bool ThreadPoolQueue::setLaneMaxQueueSize(PriorityClass priority,
+                                          std::size_t maxSize,
+                                          QueueFullPolicy policy) {
+   return setLaneMaxQueueSizeWith(m_locks, priority, maxSize, policy);
+}
+
+//******************************************************************************
+
+bool ThreadPoolQueue::setPriorityScheduling(PriorityScheduling scheduling) {
+   return setPrioritySchedulingWith(m_locks, scheduling);
+}
+
+//******************************************************************************
+
+bool ThreadPoolQueue::setLaneWeight(PriorityClass priority, unsigned int weight) {
+   return setLaneWeightWith(m_locks, priority, weight);
+}
 
-   MutexLock lock(*m_mutex, "ThreadPoolQueue::addRequest");
+//******************************************************************************
+
+void ThreadPoolQueue::setStarvationThreshold(std::uint64_t thresholdMicros) {
+   setStarvationThresholdWith(m_locks, thresholdMicros);
+}
+
+//******************************************************************************
+
+bool ThreadPoolQueue::setLoadShedding(std::uint64_t targetDelayMicros,
+                                      std::uint64_t intervalMicros) {
+   return setLoadSheddingWith(m_locks, targetDelayMicros, intervalMicros);
+}
+
+//******************************************************************************
 
-   ++m_activeAddRequests;
+std::size_t ThreadPoolQueue::getLaneSize(PriorityClass priority) const {
+   return getLaneSizeWith(m_locks, priority);
+}
+
+//******************************************************************************
 
-   if (!m_isRunning) {
-      LOG_WARNING("ThreadPoolQueue::addRequest rejecting request, queue is shutting down")
-      --m_activeAddRequests;
-      return false;
+std::uint64_t ThreadPoolQueue::getOldestRequestWaitTime() const {
+   return getOldestRequestWaitTimeWith(m_locks);
+}
+
+//******************************************************************************
+
+ThreadPoolQueue::Lane& ThreadPoolQueue::laneFor(PriorityClass priority) {
+   const std::size_t index = static_cast<std::size_t>(priority);
+   return m_lanes[std::min(index, m_lanes.size() - 1)];
+}
+
+//******************************************************************************
+
+bool ThreadPoolQueue::isFull(const Lane& lane) const {
+   return ((m_maxQueueSize > 0) && (getQueueSize() >= m_maxQueueSize)) ||
+          ((lane.maxSize > 0) && (lane.requests.size() >= lane.maxSize));
+}
+
+//******************************************************************************
+
+QueueFullPolicy ThreadPoolQueue::fullPolicy(const Lane& lane) const {
+   // the lane's own limit (if that's the one reached) decides
+   if ((lane.maxSize > 0) && (lane.requests.size() >= lane.maxSize)) {
+      return lane.queueFullPolicy;
    }
 
-   if (!m_mutex->haveValidMutex()) {
-      LOG_ERROR("don't have valid mutex in addRequest")
-      ::exit(1);
+   return m_queueFullPolicy;
+}
+
+//******************************************************************************
+
+void ThreadPoolQueue::pushRequest(Lane& lane, QueuedRequest&& queuedRequest) {
+   if (0 == queuedRequest.addedTime) {
+      queuedRequest.addedTime = now();
    }
 
-   if ((m_maxQueueSize > 0) && (m_queue.size() >= m_maxQueueSize)) {
-      if (m_queueFullPolicy == QueueFullPolicy::Reject) {
-         LOG_WARNING("ThreadPoolQueue::addRequest rejecting request, queue is full")
-         --m_activeAddRequests;
-         return false;
-      }
+   lane.requests.push_back(std::move(queuedRequest));
+   m_queueSize.store(getQueueSize() + 1, std::memory_order_relaxed);
+}
+
+//******************************************************************************
 
-      // Block policy: wait for a slot to free up. Re-checks m_maxQueueSize
-      // on every wakeup, since setMaxQueueSize() may have raised or
-      // removed the limit while we were waiting.
-      while ((m_maxQueueSize > 0) && (m_queue.size() >= m_maxQueueSize) && m_isRunning) {
-         LOG_DEBUG("ThreadPoolQueue::addRequest - waiting on queue-not-full")
-         m_condQueueNotFull->wait(m_mutex.get());
+bool ThreadPoolQueue::popLiveRequest(QueuedRequest& taken,
+                                     std::vector<Runnable*>& dropped) {
+   // (only called with the lock held and at least one request queued)
+   const std::uint64_t currentTime = now();
+   const std::uint64_t maxWait = getMaxQueueWait(currentTime);
+
+   while (!isEmpty()) {
+      Lane& lane = m_lanes[selectLane()];
+      taken = std::move(lane.requests.front());
+      lane.requests.pop_front();
+      m_queueSize.store(getQueueSize() - 1, std::memory_order_relaxed);
+
+      if (isEmpty()) {
+         m_lastEmptyTime = currentTime;
       }
 
-      if (!m_isRunning) {
-         LOG_WARNING("ThreadPoolQueue::addRequest rejecting request, queue is shutting down")
-         --m_activeAddRequests;
-         return false;
+      Runnable* runnable = taken.runnable;
+
+      if (nullptr == runnable) {
+         // a task (never expired or shed)
+         return true;
+      } else if (runnable->isExpired(currentTime)) {
+         recordExpired();
+         dropped.push_back(runnable);
+      } else if ((maxWait > 0) &&
+                 (currentTime > taken.addedTime) &&
+                 (currentTime - taken.addedTime > maxWait)) {
+         m_shedRequests.fetch_add(1, std::memory_order_relaxed);
+         dropped.push_back(runnable);
+      } else {
+         return true;
       }
    }
 
-   LOG_DEBUG("ThreadPoolQueue::addRequest accepting request")
+   return false;
+}
 
-   const bool wasEmpty = m_queue.empty();
+//******************************************************************************
 
-   // add new request to the queue
-   m_queue.push_back(runnableRequest);
+std::uint64_t ThreadPoolQueue::getMaxQueueWait(std::uint64_t currentTime) const {
+   const std::uint64_t sheddingTarget = m_sheddingTarget.load(std::memory_order_relaxed);
 
-   // did we just transition from QUEUE_EMPTY to QUEUE_NOT_EMPTY?
-   if (wasEmpty) {
-      // signal QUEUE_NOT_EMPTY (wake up a worker thread)
-      LOG_DEBUG("signalling queue_not_empty")
-      m_condQueueNotEmpty->notifyAll();
+   if (0 == sheddingTarget) {
+      return 0;
    }
 
-   --m_activeAddRequests;
+   // a queue that hasn't drained within the last interval has a standing
+   // backlog: from then on, only requests that have waited less than the
+   // target are still worth running. otherwise a burst gets a whole
+   // interval to drain.
+   const bool isStanding = (currentTime > m_lastEmptyTime) &&
+                           (currentTime - m_lastEmptyTime > m_sheddingInterval);
 
-   return true;
+   return isStanding ? sheddingTarget : m_sheddingInterval;
 }
 
 //******************************************************************************
 
-void ThreadPoolQueue::takeRequest(TakeRequestContext& ctx) {
-   if (!m_isInitialized) {
-      LOG_WARNING("ThreadPoolQueue::takeRequest queue not initialized")
-      ctx.runnable = nullptr;
-      ctx.isQueueRunning = false;
-      return;
+void ThreadPoolQueue::dropRequests(const std::vector<Runnable*>& dropped) {
+   for (Runnable* runnable : dropped) {
+      try {
+         runnable->notifyOnDropped();
+      } catch (const BasicException& be) {
+         LOG_ERROR("exception dropping request: " + be.whatString())
+      } catch (const std::exception& e) {
+         LOG_ERROR("exception dropping request: " + std::string(e.what()))
+      } catch (...) {
+         LOG_ERROR("exception dropping request")
+      }
+
+      if (runnable->isAutoDelete()) {
+         delete runnable;
+      }
    }
+}
 
-   MutexLock lock(*m_mutex, "ThreadPoolQueue::takeRequest");
+//******************************************************************************
 
-   // is the queue shut down?
-   if (!m_isRunning) {
-      ctx.runnable = nullptr;
-      ctx.isQueueRunning = false;
-      return;
-   }
+std::size_t ThreadPoolQueue::selectLane() {
+   // (only called with the lock held and at least one request queued)
+   if (m_priorityScheduling == PriorityScheduling::WeightedRoundRobin) {
+      // a round ends once every non-empty lane has used up its credits
+      for (int round = 0; round < 2; ++round) {
+         for (std::size_t i = 0; i < m_lanes.size(); ++i) {
+            Lane& lane = m_lanes[i];
+            if (!lane.requests.empty() && (lane.credits > 0)) {
+               --lane.credits;
+               return i;
+            }
+         }
 
-   if (!m_mutex->haveValidMutex()) {
-      LOG_ERROR("don't have valid mutex in takeRequest")
-      exit(1);
+         for (Lane& lane : m_lanes) {
+            lane.credits = lane.weight;
+         }
+      }
+   } else if (m_starvationThreshold > 0) {
+      // starvation protection: the highest priority lane whose oldest
+      // request has waited too long goes first
+      const std::uint64_t currentTime = now();
+
+      for (std::size_t i = 0; i < m_lanes.size(); ++i) {
+         const Lane& lane = m_lanes[i];
+         if (!lane.requests.empty() &&
+             (currentTime - lane.requests.front().addedTime > m_starvationThreshold)) {
+            return i;
+         }
+      }
    }
 
-   ++m_activeTakeRequests;
-
-   if (ctx.waitIfNone) {
-      // is the queue empty?
-      while (m_queue.empty() && m_isRunning) {
-         // empty queue -- wait for QUEUE_NOT_EMPTY event
-#if defined(DEBUG)
-         printf("ThreadPoolQueue::takeRequest - waiting on queue-not-empty\n");
-#endif
-         m_condQueueNotEmpty->wait(m_mutex.get());
+   // strict priority: highest non-empty lane
+   for (std::size_t i = 0; i < m_lanes.size(); ++i) {
+      if (!m_lanes[i].requests.empty()) {
+         return i;
       }
-   } else {
-#if defined(DEBUG)
-      printf("ThreadPoolQueue::takeRequest - not waiting\n");
-#endif
    }
 
-   if (!m_isRunning) {
-#if defined(DEBUG)
-      printf("ThreadPoolQueue::takeRequest - queue not running\n");
-#endif
-      ctx.runnable = nullptr;
-      ctx.isQueueRunning = false;
-   } else {
-      ctx.isQueueRunning = true;
+   return 0;
+}
 
-      if (!m_queue.empty()) {
-         // take a request from the queue
-#if defined(DEBUG)
-         printf("ThreadPoolQueue::takeRequest - have request from queue\n");
-#endif
-         ctx.runnable = m_queue.front();
-         m_queue.pop_front();
+//******************************************************************************
 
-         // did we just empty the queue?
-         if (m_queue.empty()) {
-#if defined(DEBUG)
-            printf("ThreadPoolQueue::takeRequest - emptied queue - notifying queue-empty\n");
-#endif
-            m_condQueueEmpty->notifyOne();
-         }
+std::size_t ThreadPoolQueue::getMaxQueueSize() const {
+   return m_maxQueueSize;
+}
 
-         // a slot just freed up - wake one producer blocked under the
-         // Block policy, if any. Harmless no-op when the queue is
-         // unbounded or no one is waiting.
-         m_condQueueNotFull->notifyOne();
-      } else {
-#if defined(DEBUG)
-         printf("ThreadPoolQueue::takeRequest - no runnable found in queue - returning nullptr\n");
-#endif
-         ctx.runnable = nullptr;
-      }
-   }
+//******************************************************************************
 
-   --m_activeTakeRequests;
+PriorityScheduling ThreadPoolQueue::getPriorityScheduling() const {
+   return m_priorityScheduling;
 }
 
 //******************************************************************************
 
-bool ThreadPoolQueue::shutDown() {
-   bool wasShutDown = false;
+std::uint64_t ThreadPoolQueue::getStarvationThreshold() const {
+   return m_starvationThreshold;
+}
 
-#if defined(DEBUG)
-   printf("ThreadPoolQueue::shutdown called\n");
-#endif
+//******************************************************************************
 
-   if (m_isInitialized && m_isRunning) {
-      MutexLock lock(*m_mutex, "ThreadPoolQueue::shutDown");
+std::uint64_t ThreadPoolQueue::getLoadSheddingTarget() const {
+   return m_sheddingTarget.load(std::memory_order_relaxed);
+}
 
-      m_isRunning = false;
-      wasShutDown = true;
+//******************************************************************************
 
-#if defined(DEBUG)
-      printf("ThreadPoolQueue::shutdown - m_isRunning now false\n");
-#endif
+std::uint64_t ThreadPoolQueue::getNumberExpiredRequests() const {
+   return m_expiredRequests.load(std::memory_order_relaxed);
+}
 
-      // wake up workers so that they can exit
-      m_condQueueNotEmpty->notifyAll();
+//******************************************************************************
 
-      // wake up any producer blocked in addRequest() under the Block
-      // policy, so it can see m_isRunning is now false and return
-      // rather than waiting forever
-      m_condQueueNotFull->notifyAll();
-   }
+std::uint64_t ThreadPoolQueue::getNumberShedRequests() const {
+   return m_shedRequests.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
 
-   return wasShutDown;
+void ThreadPoolQueue::setSpinLimit(std::size_t maxSpins) {
+   static const bool isSingleCpu = std::thread::hardware_concurrency() <= 1;
+
+   m_spinLimit.store(maxSpins, std::memory_order_relaxed);
+   m_adaptiveSpinLimit.store(isSingleCpu ? 0 : maxSpins, std::memory_order_relaxed);
 }
 
 //******************************************************************************
 
-bool ThreadPoolQueue::restart() {
-   bool wasRestarted = false;
+std::size_t ThreadPoolQueue::getSpinLimit() const {
+   return m_spinLimit.load(std::memory_order_relaxed);
+}
 
-   if (m_isInitialized && !m_isRunning) {
-      MutexLock lock(*m_mutex, "ThreadPoolQueue::restart");
+//******************************************************************************
+
+std::uint64_t ThreadPoolQueue::getNumberSpinHits() const {
+   return m_spinHits.load(std::memory_order_relaxed);
+}
 
-      m_isRunning = true;
-      wasRestarted = true;
+//******************************************************************************
+
+std::uint64_t ThreadPoolQueue::getNumberParks() const {
+   return m_parks.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void ThreadPoolQueue::recordSpin(bool isHit) {
+   const std::size_t maxSpins = m_spinLimit.load(std::memory_order_relaxed);
+   const std::size_t minSpins = (maxSpins / 16) + 1;
+   const std::size_t spinLimit = m_adaptiveSpinLimit.load(std::memory_order_relaxed);
+
+   if (isHit) {
+      m_spinHits.fetch_add(1, std::memory_order_relaxed);
    }
 
-   return wasRestarted;
+   // racing takers may lose an adjustment, which doesn't matter here
+   if (maxSpins == 0) {
+      m_adaptiveSpinLimit.store(0, std::memory_order_relaxed);
+   } else if (isHit) {
+      m_adaptiveSpinLimit.store(std::min(maxSpins, spinLimit * 2),
+                                std::memory_order_relaxed);
+   } else {
+      m_adaptiveSpinLimit.store(std::max(minSpins, spinLimit / 2),
+                                std::memory_order_relaxed);
+   }
 }
 
 //******************************************************************************
 
-void ThreadPoolQueue::setMaxQueueSize(std::size_t maxSize, QueueFullPolicy policy) {
-   MutexLock lock(*m_mutex, "ThreadPoolQueue::setMaxQueueSize");
+void ThreadPoolQueue::recordPark() {
+   m_parks.fetch_add(1, std::memory_order_relaxed);
+}
 
-   m_maxQueueSize = maxSize;
-   m_queueFullPolicy = policy;
+//******************************************************************************
 
-   // raising or removing the limit may unblock a producer waiting under
-   // the Block policy
-   m_condQueueNotFull->notifyAll();
+void ThreadPoolQueue::recordExpired() {
+   m_expiredRequests.fetch_add(1, std::memory_order_relaxed);
 }
 
 //******************************************************************************
 
-std::size_t ThreadPoolQueue::getMaxQueueSize() const {
-   return m_maxQueueSize;
+void ThreadPoolQueue::cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+   __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+   __asm__ __volatile__("yield");
+#endif
 }
 
 //******************************************************************************
@@ -307,7 +458,25 @@ bool ThreadPoolQueue::isRunning() const {
 //******************************************************************************
 
 bool ThreadPoolQueue::isEmpty() const {
-   return m_queue.empty();
+   return m_queueSize.load(std::memory_order_relaxed) == 0;
+}
+
+//******************************************************************************
+
+std::size_t ThreadPoolQueue::getQueueSize() const {
+   return m_queueSize.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+std::size_t ThreadPoolQueue::getNumberWaitingTakers() const {
+   return static_cast<std::size_t>(m_waitingTakeRequests.load(std::memory_order_relaxed));
+}
+
+//******************************************************************************
+
+std::uint64_t ThreadPoolQueue::now() {
+   return Runnable::currentTimeMicros();
 }
 
 //******************************************************************************
@@ -4,17 +4,23 @@
 #ifndef CHAUDIERE_THREADPOOLQUEUE_H
 #define CHAUDIERE_THREADPOOLQUEUE_H
 
+#include <array>
+#include <atomic>
 #include <cstddef>
-#include <deque>
+#include <cstdint>
 #include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "CircularQueue.h"
+#include "LockPolicy.h"
+#include "Runnable.h"
+#include "Task.h"
 
 
 namespace chaudiere
 {
-   class ConditionVariable;
-   class Mutex;
-   class Runnable;
-   class ThreadingFactory;
 
 
 /**
@@ -29,22 +35,46 @@ enum class QueueFullPolicy {
 };
 
 
+/**
+ * How ThreadPoolQueue chooses between its priority lanes
+ */
+enum class PriorityScheduling {
+   Strict,        // highest non-empty lane first; a lane whose oldest request
+                  // has waited past the starvation threshold goes first
+   WeightedRoundRobin  // lanes take turns, each taking up to its weight per round
+};
+
+
 struct TakeRequestContext {
    Runnable* runnable;
+   Task task;                         // set by takeRequest instead of runnable
+   std::vector<Runnable*> runnables;  // filled by takeRequests
+   std::vector<Task> tasks;           // filled by takeRequests
+   std::vector<PriorityClass> taskPriorities;  // the lane of each of tasks
+   PriorityClass taskPriority;        // the lane task was taken from
+   const std::atomic<bool>* stopRequested;  // lets a waiting take return early
    bool isQueueRunning;
    bool waitIfNone;
 
    TakeRequestContext() :
       runnable(nullptr),
+      taskPriority(PriorityClass::Normal),
+      stopRequested(nullptr),
       isQueueRunning(false),
       waitIfNone(true) {
    }
+
+   bool isStopRequested() const {
+      return (nullptr != stopRequested) && stopRequested->load();
+   }
 };
 
 
 /**
  * ThreadPoolQueue is an abstract base class for a queue being serviced
- * by a thread from a thread pool.
+ * by a thread from a thread pool. It locks and waits with the Mutex and
+ * ConditionVariables of its ThreadingFactory; BasicThreadPoolQueue is the
+ * same queue with its locking bound at compile time.
  */
 class ThreadPoolQueue
 {
@@ -70,12 +100,52 @@ public:
    virtual bool addRequest(Runnable* runnableRequest);
 
    /**
-    *
-    * @return
+    * Adds a task, stored in the queue as is. Tasks are taken in FIFO
+    * order with the Runnables of their lane. They have no deadline and
+    * aren't load shed, since there'd be nothing to complete them through.
+    * @param task the task (moved from only if it's added)
+    * @param priority the lane to queue the task in
+    * @return boolean indicating if the task was added
+    * @see Task()
+    */
+   virtual bool addRequest(Task&& task,
+                           PriorityClass priority = PriorityClass::Normal);
+
+   /**
+    * Takes a request into ctx.runnable, or a task into ctx.task
+    * @param ctx receives the request taken and whether the queue is running
     * @see Runnable()
     */
    virtual void takeRequest(TakeRequestContext& ctx);
 
+   /**
+    * Adds a batch of requests under a single acquisition of the queue's
+    * lock, waking no more waiting takers than there are requests to take.
+    * Requests are added in order; under QueueFullPolicy::Reject, adding
+    * stops at the first request that doesn't fit.
+    * @param runnableRequests the requests to add
+    * @return the number of requests added (a prefix of runnableRequests)
+    * @see Runnable()
+    */
+   virtual std::size_t addRequests(std::span<Runnable* const> runnableRequests);
+
+   /**
+    * Takes up to maxBatch requests at once into ctx.runnables and
+    * ctx.tasks (waiting
+    * for at least one if ctx.waitIfNone). Leaves a share of what's queued
+    * for other takers that are waiting, so that a burst is spread across
+    * workers rather than drained by the first one to wake.
+    * @param ctx receives the requests taken and whether the queue is running
+    * @param maxBatch the maximum number of requests to take
+    */
+   virtual void takeRequests(TakeRequestContext& ctx, std::size_t maxBatch);
+
+   /**
+    * Wakes every waiting taker, so that one whose ctx.stopRequested has
+    * been set returns (with nothing taken) instead of waiting on
+    */
+   virtual void interruptTakers();
+
    /**
     *
     * @return
@@ -109,6 +179,117 @@ public:
     */
    virtual std::size_t getMaxQueueSize() const;
 
+   /**
+    * Sets a maximum number of pending requests for one priority lane, on
+    * top of the queue-wide maximum, and how adding behaves once the lane
+    * is at that limit
+    * @param priority the lane's priority class
+    * @param maxSize maximum number of pending requests (0 == unbounded)
+    * @param policy what adding does once the lane is at maxSize
+    * @return boolean indicating if the queue supports priority lanes
+    */
+   virtual bool setLaneMaxQueueSize(PriorityClass priority,
+                                    std::size_t maxSize,
+                                    QueueFullPolicy policy = QueueFullPolicy::Reject);
+
+   /**
+    * Sets how requests are chosen between the priority lanes
+    * @param scheduling strict priority (default) or weighted round-robin
+    * @return boolean indicating if the queue supports priority lanes
+    */
+   virtual bool setPriorityScheduling(PriorityScheduling scheduling);
+
+   /**
+    * @return how requests are chosen between the priority lanes
+    */
+   PriorityScheduling getPriorityScheduling() const;
+
+   /**
+    * Sets a lane's weight for weighted round-robin: the number of requests
+    * it may take per round (defaults are 8, 4, 2, 1 from Critical to Bulk)
+    * @param priority the lane's priority class
+    * @param weight the lane's weight (at least 1)
+    * @return boolean indicating if the queue supports priority lanes
+    */
+   virtual bool setLaneWeight(PriorityClass priority, unsigned int weight);
+
+   /**
+    * Sets how long a request may wait under strict priority before its
+    * lane is served ahead of higher priority lanes
+    * @param thresholdMicros the starvation threshold in microseconds
+    * (0 == never; default 100ms)
+    */
+   virtual void setStarvationThreshold(std::uint64_t thresholdMicros);
+
+   /**
+    * @return the starvation threshold in microseconds
+    */
+   std::uint64_t getStarvationThreshold() const;
+
+   /**
+    * Turns on CoDel-style load shedding. A queue that has drained at least
+    * once within the last interval is only absorbing a burst, and its
+    * requests may wait up to the interval. A queue that hasn't is carrying
+    * a standing backlog, and requests that have waited longer than the
+    * target are shed instead of run -- by the time a worker got to them,
+    * their clients have likely given up. Shed (and expired) requests are
+    * completed through Runnable::notifyOnDropped().
+    * @param targetDelayMicros the acceptable queueing delay (0 == off)
+    * @param intervalMicros how long a backlog may stand before shedding
+    * tightens to the target (default 100ms)
+    * @return boolean indicating if the queue supports load shedding
+    */
+   virtual bool setLoadShedding(std::uint64_t targetDelayMicros,
+                                std::uint64_t intervalMicros = 100000);
+
+   /**
+    * @return the load shedding target delay in microseconds (0 == off)
+    */
+   std::uint64_t getLoadSheddingTarget() const;
+
+   /**
+    * @return the number of requests dropped because their deadline passed
+    */
+   std::uint64_t getNumberExpiredRequests() const;
+
+   /**
+    * @return the number of requests shed because they waited too long
+    */
+   std::uint64_t getNumberShedRequests() const;
+
+   /**
+    * @param priority the lane's priority class
+    * @return the number of requests waiting in the lane
+    */
+   virtual std::size_t getLaneSize(PriorityClass priority) const;
+
+   /**
+    * Lets a taker that finds the queue empty spin for a while before it
+    * parks, so that a request added shortly after is picked up without a
+    * sleep and wake-up round trip. The spin adapts between maxSpins/16 and
+    * maxSpins iterations, growing when spinning finds requests and
+    * shrinking when it doesn't. Never spins on a single-CPU machine, where
+    * the spinning taker would only keep the adder from running.
+    * @param maxSpins upper bound on spin iterations (0 == park right away,
+    * the default)
+    */
+   void setSpinLimit(std::size_t maxSpins);
+
+   /**
+    * @return the configured upper bound on spin iterations
+    */
+   std::size_t getSpinLimit() const;
+
+   /**
+    * @return number of takes that found a request by spinning
+    */
+   std::uint64_t getNumberSpinHits() const;
+
+   /**
+    * @return number of times a taker parked waiting for a request
+    */
+   std::uint64_t getNumberParks() const;
+
    /**
     *
     * @return
@@ -121,28 +302,243 @@ public:
     */
    virtual bool isEmpty() const;
 
+   /**
+    * @return the number of requests waiting to be taken
+    */
+   virtual std::size_t getQueueSize() const;
+
+   /**
+    * @return how long (in microseconds) the oldest request still in the
+    * queue has been waiting, or 0 if the queue is empty
+    */
+   virtual std::uint64_t getOldestRequestWaitTime() const;
+
+   /**
+    * @return the number of takers waiting for a request
+    */
+   virtual std::size_t getNumberWaitingTakers() const;
+
    /**
     *
     * @return
     */
    virtual bool isInitialized() const;
 
+   /**
+    * Completes dropped (expired, shed or refused) requests through
+    * Runnable::notifyOnDropped(), and deletes the auto-delete ones. Called
+    * without the queue's lock held.
+    * @param dropped the requests to drop
+    */
+   static void dropRequests(const std::vector<Runnable*>& dropped);
+
+protected:
+   /**
+    * The mutex and condition variables that a queue locks and waits with
+    */
+   template <typename LockPolicy>
+   struct QueueLocks {
+      std::unique_ptr<typename LockPolicy::MutexType> mutex;
+      std::unique_ptr<typename LockPolicy::ConditionVariableType> queueNotEmpty;
+      std::unique_ptr<typename LockPolicy::ConditionVariableType> queueEmpty;
+      std::unique_ptr<typename LockPolicy::ConditionVariableType> queueNotFull;
+   };
+
+   /**
+    * Constructs the queue without creating its locks, for a derived class
+    * that locks with its own (see initializeLocks)
+    * @param threadingFactory
+    * @param isCreatingLocks false to leave the locks to the derived class
+    */
+   ThreadPoolQueue(ThreadingFactory* threadingFactory, bool isCreatingLocks);
+
+   /**
+    * Creates the given locks, and marks the queue as initialized and
+    * running if that succeeds
+    * @param locks receives the mutex and condition variables
+    */
+   template <typename LockPolicy>
+   void initializeLocks(QueueLocks<LockPolicy>& locks);
+
+   /**
+    * Shuts the queue down and waits for the adds and takes in progress,
+    * before the given locks are destroyed
+    * @param locks the queue's locks
+    */
+   template <typename LockPolicy>
+   void drain(QueueLocks<LockPolicy>& locks);
+
+   // the queue's operations, locking and waiting with the given locks
+   // (each public virtual function calls its counterpart with the locks
+   // of the queue's class)
+   template <typename LockPolicy>
+   bool addRequestWith(QueueLocks<LockPolicy>& locks, Runnable* runnableRequest);
+   template <typename LockPolicy>
+   bool addRequestWith(QueueLocks<LockPolicy>& locks, Task&& task, PriorityClass priority);
+   template <typename LockPolicy>
+   void takeRequestWith(QueueLocks<LockPolicy>& locks, TakeRequestContext& ctx);
+   template <typename LockPolicy>
+   std::size_t addRequestsWith(QueueLocks<LockPolicy>& locks,
+                               std::span<Runnable* const> runnableRequests);
+   template <typename LockPolicy>
+   void takeRequestsWith(QueueLocks<LockPolicy>& locks,
+                         TakeRequestContext& ctx,
+                         std::size_t maxBatch);
+   template <typename LockPolicy>
+   void interruptTakersWith(QueueLocks<LockPolicy>& locks);
+   template <typename LockPolicy>
+   bool shutDownWith(QueueLocks<LockPolicy>& locks);
+   template <typename LockPolicy>
+   bool restartWith(QueueLocks<LockPolicy>& locks);
+   template <typename LockPolicy>
+   void setMaxQueueSizeWith(QueueLocks<LockPolicy>& locks,
+                            std::size_t maxSize,
+                            QueueFullPolicy policy);
+   template <typename LockPolicy>
+   bool setLaneMaxQueueSizeWith(QueueLocks<LockPolicy>& locks,
+                                PriorityClass priority,
+                                std::size_t maxSize,
+                                QueueFullPolicy policy);
+   template <typename LockPolicy>
+   bool setPrioritySchedulingWith(QueueLocks<LockPolicy>& locks,
+                                  PriorityScheduling scheduling);
+   template <typename LockPolicy>
+   bool setLaneWeightWith(QueueLocks<LockPolicy>& locks,
+                          PriorityClass priority,
+                          unsigned int weight);
+   template <typename LockPolicy>
+   void setStarvationThresholdWith(QueueLocks<LockPolicy>& locks,
+                                   std::uint64_t thresholdMicros);
+   template <typename LockPolicy>
+   bool setLoadSheddingWith(QueueLocks<LockPolicy>& locks,
+                            std::uint64_t targetDelayMicros,
+                            std::uint64_t intervalMicros);
+   template <typename LockPolicy>
+   std::size_t getLaneSizeWith(const QueueLocks<LockPolicy>& locks,
+                               PriorityClass priority) const;
+   template <typename LockPolicy>
+   std::uint64_t getOldestRequestWaitTimeWith(const QueueLocks<LockPolicy>& locks) const;
+
+   /**
+    * Spins (per setSpinLimit) until isReady returns true
+    * @param isReady predicate for a request being available to take
+    * @return boolean indicating if isReady returned true before the spin
+    * limit ran out
+    */
+   template <typename Predicate>
+   bool spinUntil(Predicate isReady) {
+      const std::size_t spinLimit =
+         m_adaptiveSpinLimit.load(std::memory_order_relaxed);
+
+      for (std::size_t i = 0; i < spinLimit; ++i) {
+         if (isReady()) {
+            recordSpin(true);
+            return true;
+         }
+         cpuRelax();
+      }
+
+      if (spinLimit > 0) {
+         recordSpin(false);
+      }
+
+      return false;
+   }
+
+   /**
+    * Counts a taker parking for a request
+    */
+   void recordPark();
+
+   /**
+    * Counts a request dropped because its deadline passed
+    */
+   void recordExpired();
+
+   /**
+    * @return the current time (steady clock) in microseconds, for
+    * stamping when requests were added
+    */
+   static std::uint64_t now();
+
 
 private:
+   struct QueuedRequest {
+      Runnable* runnable;   // nullptr for a task
+      Task task;
+      std::uint64_t addedTime;
+      PriorityClass priority;   // the lane of a task (a Runnable has its own)
+
+      QueuedRequest() :
+         runnable(nullptr),
+         addedTime(0),
+         priority(PriorityClass::Normal) {
+      }
+
+      QueuedRequest(Runnable* aRunnable, std::uint64_t enqueuedTime) :
+         runnable(aRunnable),
+         addedTime(enqueuedTime),
+         priority(PriorityClass::Normal) {
+      }
+
+      QueuedRequest(Task&& aTask, PriorityClass aPriority) :
+         runnable(nullptr),
+         task(std::move(aTask)),
+         addedTime(0),
+         priority(aPriority) {
+      }
+   };
+
+   struct Lane {
+      CircularQueue<QueuedRequest> requests;
+      std::size_t maxSize;
+      QueueFullPolicy queueFullPolicy;
+      unsigned int weight;
+      unsigned int credits;   // requests left in the current round (WRR)
+   };
+
+   Lane& laneFor(PriorityClass priority);
+   template <typename LockPolicy>
+   bool enqueueRequest(QueueLocks<LockPolicy>& locks,
+                       Lane& lane,
+                       QueuedRequest& queuedRequest);
+   bool isFull(const Lane& lane) const;
+   QueueFullPolicy fullPolicy(const Lane& lane) const;
+   void pushRequest(Lane& lane, QueuedRequest&& queuedRequest);
+   bool popLiveRequest(QueuedRequest& taken, std::vector<Runnable*>& dropped);
+   std::uint64_t getMaxQueueWait(std::uint64_t currentTime) const;
+   template <typename LockPolicy>
+   void waitForRequest(QueueLocks<LockPolicy>& locks, const TakeRequestContext& ctx);
+   std::size_t selectLane();
+   template <typename LockPolicy>
+   void notifyTakers(QueueLocks<LockPolicy>& locks, std::size_t numberAdded);
+   void recordSpin(bool isHit);
+   static void cpuRelax();
+
    ThreadingFactory* m_threadingFactory;
-   std::deque<Runnable*> m_queue;
+   std::array<Lane, NUMBER_PRIORITY_CLASSES> m_lanes;
 
-   std::unique_ptr<Mutex> m_mutex;
-   std::unique_ptr<ConditionVariable> m_condQueueNotEmpty;
-   std::unique_ptr<ConditionVariable> m_condQueueEmpty;
-   std::unique_ptr<ConditionVariable> m_condQueueNotFull;
+   QueueLocks<VirtualLockPolicy> m_locks;   // (unused by BasicThreadPoolQueue)
 
    bool m_isInitialized;
    bool m_isRunning;
    int m_activeTakeRequests;
    int m_activeAddRequests;
+   std::atomic<int> m_waitingTakeRequests;
    std::size_t m_maxQueueSize;
    QueueFullPolicy m_queueFullPolicy;
+   PriorityScheduling m_priorityScheduling;
+   std::uint64_t m_starvationThreshold;
+   std::atomic<std::uint64_t> m_sheddingTarget;
+   std::uint64_t m_sheddingInterval;
+   std::uint64_t m_lastEmptyTime;
+   std::atomic<std::size_t> m_queueSize;
+   std::atomic<std::size_t> m_spinLimit;
+   std::atomic<std::size_t> m_adaptiveSpinLimit;
+   std::atomic<std::uint64_t> m_spinHits;
+   std::atomic<std::uint64_t> m_parks;
+   std::atomic<std::uint64_t> m_expiredRequests;
+   std::atomic<std::uint64_t> m_shedRequests;
 
    // disallow copies
    ThreadPoolQueue(const ThreadPoolQueue&);
@@ -0,0 +1,677 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_THREADPOOLQUEUEIMPL_H
+#define CHAUDIERE_THREADPOOLQUEUEIMPL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "ThreadPoolQueue.h"
+#include "MutexLock.h"
+#include "Logger.h"
+#include "BasicException.h"
+#include "Thread.h"
+
+// Definitions of ThreadPoolQueue's lock policy templates. Include this only
+// where a QueueLocks is instantiated (ThreadPoolQueue.cpp for the virtual
+// policy, BasicThreadPoolQueue.h for the others), along with the headers of
+// the mutex and condition variable types the policy names.
+
+namespace chaudiere
+{
+
+template <typename LockPolicy>
+void ThreadPoolQueue::initializeLocks(QueueLocks<LockPolicy>& locks) {
+   locks.mutex.reset(LockPolicy::createMutex(m_threadingFactory, "ThreadPoolQueue"));
+   locks.queueNotEmpty.reset(
+      LockPolicy::createConditionVariable(m_threadingFactory, "queue-not-empty"));
+   locks.queueEmpty.reset(
+      LockPolicy::createConditionVariable(m_threadingFactory, "queue-empty"));
+   locks.queueNotFull.reset(
+      LockPolicy::createConditionVariable(m_threadingFactory, "queue-not-full"));
+
+   try {
+      if (locks.mutex && locks.queueNotEmpty && locks.queueEmpty && locks.queueNotFull) {
+         m_isInitialized = true;
+         m_isRunning = true;
+      } else {
+         LOG_ERROR("unable to initialize ThreadPoolQueue")
+         if (!locks.mutex) {
+            LOG_ERROR("unable to create mutex")
+         }
+         if (!locks.queueNotEmpty) {
+            LOG_ERROR("unable to create queue not empty condition variable")
+         }
+         if (!locks.queueEmpty) {
+            LOG_ERROR("unable to create queue empty condition variable")
+         }
+         if (!locks.queueNotFull) {
+            LOG_ERROR("unable to create queue not full condition variable")
+         }
+         printf("error: unable to initialize thread pool queue, aborting\n");
+         exit(1);
+      }
+   } catch (const BasicException& be) {
+      LOG_ERROR("exception setting up thread pool queue: " + be.whatString())
+   } catch (const std::exception& e) {
+      LOG_ERROR("exception setting up thread pool queue: " + std::string(e.what()))
+   } catch (...) {
+      LOG_ERROR("unknown exception setting up thread pool queue")
+   }
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+void ThreadPoolQueue::drain(QueueLocks<LockPolicy>& locks) {
+   shutDownWith(locks);
+
+   while (m_activeAddRequests > 0 || m_activeTakeRequests > 0) {
+#if defined(DEBUG)
+      printf("ThreadPoolQueue::~ThreadPoolQueue  active adds=%d, active takes=%d\n",
+             m_activeAddRequests, m_activeTakeRequests);
+#endif
+      Thread::sleep(3);
+   }
+
+#if defined(DEBUG)
+   printf("ThreadPoolQueue::~ThreadPoolQueue  active adds=%d, active takes=%d\n",
+          m_activeAddRequests, m_activeTakeRequests);
+#endif
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+bool ThreadPoolQueue::addRequestWith(QueueLocks<LockPolicy>& locks, Runnable* runnableRequest) {
+   if (!m_isInitialized) {
+      LOG_WARNING("ThreadPoolQueue::addRequest queue not initialized")
+      return false;
+   }
+
+   if (nullptr == runnableRequest) {
+      LOG_WARNING("ThreadPoolQueue::addRequest rejecting nullptr request")
+      return false;
+   }
+
+   QueuedRequest queuedRequest(runnableRequest, runnableRequest->getEnqueuedTime());
+
+   return enqueueRequest(locks, laneFor(runnableRequest->getPriority()), queuedRequest);
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+bool ThreadPoolQueue::addRequestWith(QueueLocks<LockPolicy>& locks,
+                                     Task&& task,
+                                     PriorityClass priority) {
+   if (!m_isInitialized) {
+      LOG_WARNING("ThreadPoolQueue::addRequest queue not initialized")
+      return false;
+   }
+
+   if (!task) {
+      LOG_WARNING("ThreadPoolQueue::addRequest rejecting empty task")
+      return false;
+   }
+
+   QueuedRequest queuedRequest(std::move(task), priority);
+
+   if (!enqueueRequest(locks, laneFor(priority), queuedRequest)) {
+      // hand the task back to the caller
+      task = std::move(queuedRequest.task);
+      return false;
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+bool ThreadPoolQueue::enqueueRequest(QueueLocks<LockPolicy>& locks,
+                                     Lane& lane,
+                                     QueuedRequest& queuedRequest) {
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::addRequest");
+
+   ++m_activeAddRequests;
+
+   if (!m_isRunning) {
+      LOG_WARNING("ThreadPoolQueue::addRequest rejecting request, queue is shutting down")
+      --m_activeAddRequests;
+      return false;
+   }
+
+   if (!locks.mutex->haveValidMutex()) {
+      LOG_ERROR("don't have valid mutex in addRequest")
+      ::exit(1);
+   }
+
+   if (isFull(lane)) {
+      if (fullPolicy(lane) == QueueFullPolicy::Reject) {
+         LOG_WARNING("ThreadPoolQueue::addRequest rejecting request, queue is full")
+         --m_activeAddRequests;
+         return false;
+      }
+
+      // Block policy: wait for a slot to free up. Re-checks the limits
+      // on every wakeup, since setMaxQueueSize() may have raised or
+      // removed them while we were waiting.
+      while (isFull(lane) && m_isRunning) {
+         LOG_DEBUG("ThreadPoolQueue::addRequest - waiting on queue-not-full")
+         LockPolicy::wait(*locks.queueNotFull, *locks.mutex);
+      }
+
+      if (!m_isRunning) {
+         LOG_WARNING("ThreadPoolQueue::addRequest rejecting request, queue is shutting down")
+         --m_activeAddRequests;
+         return false;
+      }
+   }
+
+   LOG_DEBUG("ThreadPoolQueue::addRequest accepting request")
+
+   // add new request to its priority's lane
+   pushRequest(lane, std::move(queuedRequest));
+
+   // wake one sleeping worker (if any) for it, rather than every worker
+   // to fight over it
+   notifyTakers(locks, 1);
+
+   --m_activeAddRequests;
+
+   return true;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+void ThreadPoolQueue::takeRequestWith(QueueLocks<LockPolicy>& locks, TakeRequestContext& ctx) {
+   ctx.runnable = nullptr;
+   ctx.task.reset();
+
+   if (!m_isInitialized) {
+      LOG_WARNING("ThreadPoolQueue::takeRequest queue not initialized")
+      ctx.isQueueRunning = false;
+      return;
+   }
+
+   if (ctx.waitIfNone) {
+      spinUntil([this]() {
+         return m_queueSize.load(std::memory_order_relaxed) > 0;
+      });
+   }
+
+   std::vector<Runnable*> dropped;
+   QueuedRequest taken;
+   bool isTaken = false;
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::takeRequest");
+
+   // is the queue shut down?
+   if (!m_isRunning) {
+      ctx.isQueueRunning = false;
+      return;
+   }
+
+   if (!locks.mutex->haveValidMutex()) {
+      LOG_ERROR("don't have valid mutex in takeRequest")
+      exit(1);
+   }
+
+   ++m_activeTakeRequests;
+
+   // (repeats when everything queued was expired or shed)
+   for (;;) {
+      if (ctx.waitIfNone) {
+         waitForRequest(locks, ctx);
+      } else {
+#if defined(DEBUG)
+         printf("ThreadPoolQueue::takeRequest - not waiting\n");
+#endif
+      }
+
+      if (!m_isRunning || isEmpty()) {
+         break;
+      }
+
+      // take a request from the queue
+#if defined(DEBUG)
+      printf("ThreadPoolQueue::takeRequest - have request from queue\n");
+#endif
+      isTaken = popLiveRequest(taken, dropped);
+
+      if (isTaken || !ctx.waitIfNone || ctx.isStopRequested()) {
+         break;
+      }
+   }
+
+   if (!m_isRunning) {
+#if defined(DEBUG)
+      printf("ThreadPoolQueue::takeRequest - queue not running\n");
+#endif
+      ctx.isQueueRunning = false;
+   } else {
+      ctx.isQueueRunning = true;
+
+      if (isTaken) {
+         if (nullptr != taken.runnable) {
+            ctx.runnable = taken.runnable;
+         } else {
+            ctx.task = std::move(taken.task);
+            ctx.taskPriority = taken.priority;
+         }
+      }
+
+      if (isTaken || !dropped.empty()) {
+         // did we just empty the queue?
+         if (isEmpty()) {
+#if defined(DEBUG)
+            printf("ThreadPoolQueue::takeRequest - emptied queue - notifying queue-empty\n");
+#endif
+            locks.queueEmpty->notifyOne();
+         }
+
+         // a slot just freed up - wake one producer blocked under the
+         // Block policy, if any. Harmless no-op when the queue is
+         // unbounded or no one is waiting.
+         if (dropped.empty()) {
+            locks.queueNotFull->notifyOne();
+         } else {
+            locks.queueNotFull->notifyAll();
+         }
+      } else {
+#if defined(DEBUG)
+         printf("ThreadPoolQueue::takeRequest - no runnable found in queue - returning nullptr\n");
+#endif
+      }
+   }
+
+   --m_activeTakeRequests;
+
+   // dropped requests are completed outside the lock
+   lock.unlock();
+   dropRequests(dropped);
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+void ThreadPoolQueue::waitForRequest(QueueLocks<LockPolicy>& locks,
+                                     const TakeRequestContext& ctx) {
+   // (only called with the lock held)
+   ++m_waitingTakeRequests;
+
+   if (isEmpty() && m_isRunning && !ctx.isStopRequested()) {
+      m_lastEmptyTime = now();
+      recordPark();
+   }
+
+   // is the queue empty?
+   while (isEmpty() && m_isRunning && !ctx.isStopRequested()) {
+      // empty queue -- wait for QUEUE_NOT_EMPTY event
+#if defined(DEBUG)
+      printf("ThreadPoolQueue::waitForRequest - waiting on queue-not-empty\n");
+#endif
+      LockPolicy::wait(*locks.queueNotEmpty, *locks.mutex);
+   }
+
+   --m_waitingTakeRequests;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+void ThreadPoolQueue::notifyTakers(QueueLocks<LockPolicy>& locks, std::size_t numberAdded) {
+   // one wake-up per request, and none for takers that would find nothing
+   const std::size_t numberToWake =
+      std::min(numberAdded, static_cast<std::size_t>(m_waitingTakeRequests));
+
+   for (std::size_t i = 0; i < numberToWake; ++i) {
+      locks.queueNotEmpty->notifyOne();
+   }
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+std::size_t ThreadPoolQueue::addRequestsWith(QueueLocks<LockPolicy>& locks,
+                                             std::span<Runnable* const> runnableRequests) {
+   if (!m_isInitialized) {
+      LOG_WARNING("ThreadPoolQueue::addRequests queue not initialized")
+      return 0;
+   }
+
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::addRequests");
+
+   ++m_activeAddRequests;
+
+   std::size_t numberAdded = 0;
+   std::size_t numberNotNotified = 0;
+
+   for (Runnable* runnableRequest : runnableRequests) {
+      if (!m_isRunning) {
+         LOG_WARNING("ThreadPoolQueue::addRequests rejecting request, queue is shutting down")
+         break;
+      }
+
+      if (nullptr == runnableRequest) {
+         LOG_WARNING("ThreadPoolQueue::addRequests rejecting nullptr request")
+         break;
+      }
+
+      Lane& lane = laneFor(runnableRequest->getPriority());
+
+      if (isFull(lane)) {
+         if (fullPolicy(lane) == QueueFullPolicy::Reject) {
+            LOG_WARNING("ThreadPoolQueue::addRequests rejecting request, queue is full")
+            break;
+         }
+
+         // Block policy: takers can only free up a slot for the requests
+         // they've been woken for
+         notifyTakers(locks, numberNotNotified);
+         numberNotNotified = 0;
+
+         while (isFull(lane) && m_isRunning) {
+            LOG_DEBUG("ThreadPoolQueue::addRequests - waiting on queue-not-full")
+            LockPolicy::wait(*locks.queueNotFull, *locks.mutex);
+         }
+
+         if (!m_isRunning) {
+            LOG_WARNING("ThreadPoolQueue::addRequests rejecting request, queue is shutting down")
+            break;
+         }
+      }
+
+      pushRequest(lane, QueuedRequest(runnableRequest, runnableRequest->getEnqueuedTime()));
+      ++numberAdded;
+      ++numberNotNotified;
+   }
+
+   notifyTakers(locks, numberNotNotified);
+
+   --m_activeAddRequests;
+
+   return numberAdded;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+void ThreadPoolQueue::takeRequestsWith(QueueLocks<LockPolicy>& locks,
+                                       TakeRequestContext& ctx,
+                                       std::size_t maxBatch) {
+   ctx.runnable = nullptr;
+   ctx.task.reset();
+   ctx.runnables.clear();
+   ctx.tasks.clear();
+   ctx.taskPriorities.clear();
+
+   if (!m_isInitialized) {
+      LOG_WARNING("ThreadPoolQueue::takeRequests queue not initialized")
+      ctx.isQueueRunning = false;
+      return;
+   }
+
+   if (ctx.waitIfNone) {
+      spinUntil([this]() {
+         return m_queueSize.load(std::memory_order_relaxed) > 0;
+      });
+   }
+
+   std::vector<Runnable*> dropped;
+   QueuedRequest taken;
+   std::size_t numberTaken = 0;
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::takeRequests");
+
+   ++m_activeTakeRequests;
+
+   // (repeats when everything queued was expired or shed)
+   for (;;) {
+      if (ctx.waitIfNone) {
+         waitForRequest(locks, ctx);
+      }
+
+      if (!m_isRunning || isEmpty()) {
+         break;
+      }
+
+      // leave an even share for the takers that are still waiting (or
+      // have been woken and not yet gotten the lock)
+      const std::size_t fairShare =
+         getQueueSize() / static_cast<std::size_t>(m_waitingTakeRequests + 1);
+      const std::size_t numberToTake =
+         std::max(static_cast<std::size_t>(1), std::min(fairShare, maxBatch));
+
+      while ((numberTaken < numberToTake) && !isEmpty()) {
+         if (popLiveRequest(taken, dropped)) {
+            if (nullptr != taken.runnable) {
+               ctx.runnables.push_back(taken.runnable);
+            } else {
+               ctx.tasks.push_back(std::move(taken.task));
+               ctx.taskPriorities.push_back(taken.priority);
+            }
+            ++numberTaken;
+         }
+      }
+
+      if ((numberTaken > 0) || !ctx.waitIfNone || ctx.isStopRequested()) {
+         break;
+      }
+   }
+
+   ctx.isQueueRunning = m_isRunning;
+
+   const std::size_t numberFreed = numberTaken + dropped.size();
+
+   if (m_isRunning && (numberFreed > 0)) {
+      if (isEmpty()) {
+         locks.queueEmpty->notifyOne();
+      }
+
+      // slots just freed up -- wake producers blocked under the Block policy
+      if (numberFreed > 1) {
+         locks.queueNotFull->notifyAll();
+      } else {
+         locks.queueNotFull->notifyOne();
+      }
+   }
+
+   --m_activeTakeRequests;
+
+   // dropped requests are completed outside the lock
+   lock.unlock();
+   dropRequests(dropped);
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+void ThreadPoolQueue::interruptTakersWith(QueueLocks<LockPolicy>& locks) {
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::interruptTakers");
+   locks.queueNotEmpty->notifyAll();
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+bool ThreadPoolQueue::shutDownWith(QueueLocks<LockPolicy>& locks) {
+   bool wasShutDown = false;
+
+#if defined(DEBUG)
+   printf("ThreadPoolQueue::shutdown called\n");
+#endif
+
+   if (m_isInitialized && m_isRunning) {
+      BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+         "ThreadPoolQueue::shutDown");
+
+      m_isRunning = false;
+      wasShutDown = true;
+
+#if defined(DEBUG)
+      printf("ThreadPoolQueue::shutdown - m_isRunning now false\n");
+#endif
+
+      // wake up workers so that they can exit
+      locks.queueNotEmpty->notifyAll();
+
+      // wake up any producer blocked in addRequest() under the Block
+      // policy, so it can see m_isRunning is now false and return
+      // rather than waiting forever
+      locks.queueNotFull->notifyAll();
+   }
+
+   return wasShutDown;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+bool ThreadPoolQueue::restartWith(QueueLocks<LockPolicy>& locks) {
+   bool wasRestarted = false;
+
+   if (m_isInitialized && !m_isRunning) {
+      BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+         "ThreadPoolQueue::restart");
+
+      m_isRunning = true;
+      m_lastEmptyTime = now();
+      wasRestarted = true;
+   }
+
+   return wasRestarted;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+void ThreadPoolQueue::setMaxQueueSizeWith(QueueLocks<LockPolicy>& locks,
+                                          std::size_t maxSize,
+                                          QueueFullPolicy policy) {
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::setMaxQueueSize");
+
+   m_maxQueueSize = maxSize;
+   m_queueFullPolicy = policy;
+
+   // raising or removing the limit may unblock a producer waiting under
+   // the Block policy
+   locks.queueNotFull->notifyAll();
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+bool ThreadPoolQueue::setLaneMaxQueueSizeWith(QueueLocks<LockPolicy>& locks,
+                                              PriorityClass priority,
+                                              std::size_t maxSize,
+                                              QueueFullPolicy policy) {
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::setLaneMaxQueueSize");
+
+   Lane& lane = m_lanes[static_cast<std::size_t>(priority)];
+   lane.maxSize = maxSize;
+   lane.queueFullPolicy = policy;
+
+   // raising or removing the limit may unblock a producer waiting under
+   // the Block policy
+   locks.queueNotFull->notifyAll();
+
+   return true;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+bool ThreadPoolQueue::setPrioritySchedulingWith(QueueLocks<LockPolicy>& locks,
+                                                PriorityScheduling scheduling) {
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::setPriorityScheduling");
+   m_priorityScheduling = scheduling;
+   return true;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+bool ThreadPoolQueue::setLaneWeightWith(QueueLocks<LockPolicy>& locks,
+                                        PriorityClass priority,
+                                        unsigned int weight) {
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::setLaneWeight");
+
+   Lane& lane = m_lanes[static_cast<std::size_t>(priority)];
+   lane.weight = std::max(1U, weight);
+   lane.credits = std::min(lane.credits, lane.weight);
+
+   return true;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+void ThreadPoolQueue::setStarvationThresholdWith(QueueLocks<LockPolicy>& locks,
+                                                 std::uint64_t thresholdMicros) {
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::setStarvationThreshold");
+   m_starvationThreshold = thresholdMicros;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+bool ThreadPoolQueue::setLoadSheddingWith(QueueLocks<LockPolicy>& locks,
+                                          std::uint64_t targetDelayMicros,
+                                          std::uint64_t intervalMicros) {
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::setLoadShedding");
+   m_sheddingTarget.store(targetDelayMicros, std::memory_order_relaxed);
+   m_sheddingInterval = std::max(intervalMicros, targetDelayMicros);
+   return true;
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+std::size_t ThreadPoolQueue::getLaneSizeWith(const QueueLocks<LockPolicy>& locks,
+                                             PriorityClass priority) const {
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::getLaneSize");
+   return m_lanes[static_cast<std::size_t>(priority)].requests.size();
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+std::uint64_t ThreadPoolQueue::getOldestRequestWaitTimeWith(
+   const QueueLocks<LockPolicy>& locks) const {
+   BasicMutexLock<typename LockPolicy::MutexType> lock(*locks.mutex,
+      "ThreadPoolQueue::getOldestRequestWaitTime");
+
+   std::uint64_t oldestAddedTime = 0;
+
+   for (const Lane& lane : m_lanes) {
+      if (!lane.requests.empty() &&
+          ((0 == oldestAddedTime) || (lane.requests.front().addedTime < oldestAddedTime))) {
+         oldestAddedTime = lane.requests.front().addedTime;
+      }
+   }
+
+   if (0 == oldestAddedTime) {
+      return 0;
+   }
+
+   return now() - oldestAddedTime;
+}
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <exception>
+#include <utility>
 
 #include "ThreadPoolWorker.h"
 #include "ThreadPoolQueue.h"
@@ -15,6 +16,9 @@
 
 using namespace chaudiere;
 
+// most requests a worker takes from the queue at once
+static const std::size_t MAX_TAKE_BATCH = 16;
+
 //******************************************************************************
 
 ThreadPoolWorker::ThreadPoolWorker(ThreadingFactory* threadingFactory,
@@ -24,7 +28,8 @@ ThreadPoolWorker::ThreadPoolWorker(ThreadingFactory* threadingFactory,
    m_workerThread(nullptr),
    m_poolQueue(queue),
    m_workerId(workerId),
-   m_isRunning(false) {
+   m_isRunning(false),
+   m_isStopRequested(false) {
    LOG_INSTANCE_CREATE("ThreadPoolWorker")
 }
 
@@ -39,9 +44,14 @@ ThreadPoolWorker::~ThreadPoolWorker() {
 void ThreadPoolWorker::start() {
    if (!m_workerThread) {
       m_workerThread.reset(
-         m_threadingFactory->createThread(this, "threadpoolworker"));
+         m_threadingFactory->createThread(this,
+            "tpworker-" + StrUtils::toString(m_workerId)));
 
       if (m_workerThread) {
+         if (m_threadAttributes) {
+            m_workerThread->setThreadAttributes(*m_threadAttributes);
+         }
+
          m_workerThread->setPoolWorkerStatus(true);
          m_workerThread->setWorkerId(StrUtils::toString(m_workerId));
          m_isRunning = true;
@@ -67,8 +77,21 @@ void ThreadPoolWorker::stop() {
 
 //******************************************************************************
 
+void ThreadPoolWorker::requestStop() {
+   m_isStopRequested = true;
+}
+
+//******************************************************************************
+
+void ThreadPoolWorker::setThreadAttributes(const ThreadAttributes& threadAttributes) {
+   m_threadAttributes.reset(new ThreadAttributes(threadAttributes));
+}
+
+//******************************************************************************
+
 void ThreadPoolWorker::run() {
    TakeRequestContext ctx;
+   ctx.stopRequested = &m_isStopRequested;
 
 #if defined(DEBUG)
    printf("ThreadPoolWorker::run starting\n");
@@ -76,6 +99,12 @@ void ThreadPoolWorker::run() {
 
    while (true) {
 
+      // retired while the queue keeps running?
+      if (m_isStopRequested) {
+         m_isRunning = false;
+         break;
+      }
+
 #if defined(DEBUG)
       if (Logger::isLogging(LogLevel::Debug)) {
          char message[128];
@@ -84,7 +113,7 @@ void ThreadPoolWorker::run() {
       }
 #endif
 
-      m_poolQueue.takeRequest(ctx);
+      m_poolQueue.takeRequests(ctx, MAX_TAKE_BATCH);
       if (!ctx.isQueueRunning) {
 #if defined(DEBUG)
          printf("ThreadPoolWorker::run - detected queue no longer running\n");
@@ -93,45 +122,28 @@ void ThreadPoolWorker::run() {
          break;
       }
 
-      Runnable* runnable = ctx.runnable;
-
-      if (runnable != nullptr) {
+      // run what was taken back-to-back
+      for (std::size_t i = 0; i < ctx.runnables.size(); ++i) {
          // has our thread been notified to shut down?
          if (!m_workerThread->isAlive()) {
-            // put the request back on the queue for another worker to
-            // pick up, and stop this worker.
-            m_poolQueue.addRequest(runnable);
+            // put the rest of the batch back on the queue for other
+            // workers to pick up, and stop this worker.
+            requeueRequests(ctx, i, 0);
+            m_isRunning = false;
+            return;
+         }
+
+         runRequest(ctx.runnables[i]);
+      }
+
+      for (std::size_t i = 0; i < ctx.tasks.size(); ++i) {
+         if (!m_workerThread->isAlive()) {
+            requeueRequests(ctx, ctx.runnables.size(), i);
             m_isRunning = false;
-            break;
-         } else {
-            // mark it
-            runnable->setRunByThreadId(m_workerId);
-            runnable->setRunByThreadWorkerId(m_workerThread->getWorkerId());
-
-            try {
-               runnable->run();
-            } catch (const BasicException& be) {
-               LOG_ERROR("run method of runnable threw exception: " + be.whatString())
-            } catch (const std::exception& e) {
-               LOG_ERROR("run method of runnable threw exception: " + std::string(e.what()))
-            } catch (...) {
-               LOG_ERROR("run method of runnable threw exception")
-            }
-
-            runnable->notifyOnCompletion();
-
-            if (Logger::isLogging(LogLevel::Debug)) {
-               char message[128];
-               ::snprintf(message, 128,
-                             "ending processing request on thread %d",
-                             m_workerId);
-               LOG_DEBUG(message)
-            }
-
-            if (runnable->isAutoDelete()) {
-               delete runnable;
-            }
+            return;
          }
+
+         runTask(ctx.tasks[i]);
       }
    }
 
@@ -142,4 +154,75 @@ void ThreadPoolWorker::run() {
 
 //******************************************************************************
 
+void ThreadPoolWorker::runRequest(Runnable* runnable) {
+   // mark it
+   runnable->setRunByThreadId(m_workerId);
+   runnable->setRunByThreadWorkerId(m_workerThread->getWorkerId());
+
+   runnable->notifyOnStart();
+
+   try {
+      runnable->run();
+   } catch (const BasicException& be) {
+      LOG_ERROR("run method of runnable threw exception: " + be.whatString())
+   } catch (const std::exception& e) {
+      LOG_ERROR("run method of runnable threw exception: " + std::string(e.what()))
+   } catch (...) {
+      LOG_ERROR("run method of runnable threw exception")
+   }
+
+   runnable->notifyOnCompletion();
+
+   if (Logger::isLogging(LogLevel::Debug)) {
+      char message[128];
+      ::snprintf(message, 128,
+                    "ending processing request on thread %d",
+                    m_workerId);
+      LOG_DEBUG(message)
+   }
+
+   if (runnable->isAutoDelete()) {
+      delete runnable;
+   }
+}
+
+//******************************************************************************
+
+void ThreadPoolWorker::runTask(Task& task) {
+   try {
+      task();
+   } catch (const BasicException& be) {
+      LOG_ERROR("task threw exception: " + be.whatString())
+   } catch (const std::exception& e) {
+      LOG_ERROR("task threw exception: " + std::string(e.what()))
+   } catch (...) {
+      LOG_ERROR("task threw exception")
+   }
+
+   // release whatever the callable holds now, not when the slot is reused
+   task.reset();
+}
 
+//******************************************************************************
+
+void ThreadPoolWorker::requeueRequests(TakeRequestContext& ctx,
+                                       std::size_t firstRunnable,
+                                       std::size_t firstTask) {
+   const std::span<Runnable* const> runnables =
+      std::span<Runnable* const>(ctx.runnables).subspan(firstRunnable);
+   const std::size_t numberAdded = m_poolQueue.addRequests(runnables);
+
+   // when the pool is stopping, the queue is already shut down and takes
+   // nothing back; no one else will run what it refuses, so it's dropped
+   if (numberAdded < runnables.size()) {
+      ThreadPoolQueue::dropRequests(
+         std::vector<Runnable*>(runnables.begin() + numberAdded, runnables.end()));
+   }
+
+   for (std::size_t i = firstTask; i < ctx.tasks.size(); ++i) {
+      // (a task the queue refuses is simply destroyed with the context)
+      m_poolQueue.addRequest(std::move(ctx.tasks[i]), ctx.taskPriorities[i]);
+   }
+}
+
+//******************************************************************************
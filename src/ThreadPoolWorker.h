@@ -5,15 +5,19 @@
 #define CHAUDIERE_THREADPOOLWORKER_H
 
 #include <atomic>
+#include <cstddef>
 #include <memory>
 
 #include "Runnable.h"
+#include "ThreadAttributes.h"
 
 
 namespace chaudiere
 {
    class ThreadingFactory;
    class ThreadPoolQueue;
+   class Task;
+   struct TakeRequestContext;
    class Thread;
 
 /**
@@ -46,10 +50,27 @@ class ThreadPoolWorker : public Runnable
       void start();
 
       /**
-       *
+       * Waits for the worker's thread to finish (after the queue has shut
+       * down, or after requestStop)
        */
       void stop();
 
+      /**
+       * Asks the worker to finish the requests it has already taken and
+       * then exit, while the queue keeps running for the other workers. A
+       * worker waiting for a request only notices once the queue's takers
+       * are interrupted (see ThreadPoolQueue::interruptTakers).
+       */
+      void requestStop();
+
+      /**
+       * Sets the attributes of the worker's thread, in place of the
+       * threading factory's (must be called before start)
+       * @param threadAttributes the thread's cpu affinity, stack size, etc.
+       * @see ThreadAttributes()
+       */
+      void setThreadAttributes(const ThreadAttributes& threadAttributes);
+
       /**
        *
        */
@@ -57,11 +78,19 @@ class ThreadPoolWorker : public Runnable
 
 
    private:
+      void runRequest(Runnable* runnable);
+      void runTask(Task& task);
+      void requeueRequests(TakeRequestContext& ctx,
+                           std::size_t firstRunnable,
+                           std::size_t firstTask);
+
       ThreadingFactory* m_threadingFactory;
       std::unique_ptr<Thread> m_workerThread;
       ThreadPoolQueue& m_poolQueue;
       int m_workerId;
       std::atomic<bool> m_isRunning;
+      std::atomic<bool> m_isStopRequested;
+      std::unique_ptr<ThreadAttributes> m_threadAttributes;
 
       // disallow copies
       ThreadPoolWorker(const ThreadPoolWorker&);
@@ -6,6 +6,9 @@
 
 #include <string>
 
+#include "ReadWriteLock.h"
+#include "ThreadAttributes.h"
+
 namespace chaudiere
 {
    class Mutex;
@@ -14,6 +17,17 @@ namespace chaudiere
    class Runnable;
    class ThreadPoolDispatcher;
 
+/**
+ * The kind of ThreadPoolDispatcher created by
+ * ThreadingFactory::createThreadPoolDispatcher
+ */
+enum class ThreadPoolType {
+   Shared,       // ThreadPool: every worker takes from one shared queue
+   SharedRing,   // ThreadPool whose shared queue is a lock-free RingThreadPoolQueue
+   WorkStealing, // WorkStealingThreadPool: per-worker deques with stealing
+   Dispatch      // ThreadPoolDispatch: dispatch queues on a shared pool
+};
+
 /**
  * ThreadingFactory is a factory for creating Thread, Mutex, and ThreadPoolDispatcher
  * instances.
@@ -36,7 +50,9 @@ public:
    /**
     * Constructs a ThreadingFactory instance
     */
-   ThreadingFactory() {}
+   ThreadingFactory() :
+      m_threadPoolType(ThreadPoolType::Shared) {
+   }
 
    /**
     * Destructor
@@ -74,6 +90,17 @@ public:
     */
    virtual ConditionVariable* createConditionVariable(const std::string& name) = 0;
 
+   /**
+    * Create a new named ReadWriteLock
+    * @param name the name for the new ReadWriteLock
+    * @param preference which side the lock favors when readers and
+    * writers contend
+    * @return pointer to the newly created ReadWriteLock
+    * @see ReadWriteLock()
+    */
+   virtual ReadWriteLock* createReadWriteLock(const std::string& name,
+            ReadWritePreference preference = ReadWritePreference::Readers) = 0;
+
    /**
     * Creates a new ThreadPoolDispatcher
     * @param numberThreads the number of threads to initialize in the pool dispatcher
@@ -82,6 +109,41 @@ public:
    virtual ThreadPoolDispatcher* createThreadPoolDispatcher(int numberThreads,
             const std::string& name) = 0;
 
+   /**
+    * Sets the kind of thread pool created by createThreadPoolDispatcher
+    * @param threadPoolType the kind of thread pool
+    */
+   void setThreadPoolType(ThreadPoolType threadPoolType) {
+      m_threadPoolType = threadPoolType;
+   }
+
+   /**
+    * Retrieves the kind of thread pool created by createThreadPoolDispatcher
+    * @return the kind of thread pool (Shared by default)
+    */
+   ThreadPoolType getThreadPoolType() const {
+      return m_threadPoolType;
+   }
+
+   /**
+    * Sets the attributes (cpu affinity, stack size, scheduling) given to
+    * every thread created by createThread, e.g., to keep event loops and
+    * pool workers on the same NUMA node
+    * @param threadAttributes the attributes for new threads
+    * @see ThreadAttributes()
+    */
+   void setThreadAttributes(const ThreadAttributes& threadAttributes) {
+      m_threadAttributes = threadAttributes;
+   }
+
+   /**
+    * Retrieves the attributes given to every thread created by createThread
+    * @return the attributes for new threads (OS defaults unless set)
+    */
+   const ThreadAttributes& getThreadAttributes() const {
+      return m_threadAttributes;
+   }
+
 
 private:
    // disallow copies
@@ -90,6 +152,9 @@ private:
 
    static ThreadingFactory* threadingFactoryInstance;
 
+   ThreadPoolType m_threadPoolType;
+   ThreadAttributes m_threadAttributes;
+
 };
 
 }
@@ -0,0 +1,131 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "TimingWheel.h"
+#include "Logger.h"
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+TimingWheel::TimingWheel(std::size_t numberSlots) :
+   m_slots(numberSlots > 0 ? numberSlots : 1, -1),
+   m_currentTick(0),
+   m_cursor(0),
+   m_size(0) {
+   LOG_INSTANCE_CREATE("TimingWheel")
+}
+
+//******************************************************************************
+
+TimingWheel::~TimingWheel() {
+   LOG_INSTANCE_DESTROY("TimingWheel")
+}
+
+//******************************************************************************
+
+void TimingWheel::schedule(int id, std::uint32_t ticksFromNow) {
+   if (id < 0) {
+      return;
+   }
+
+   if (static_cast<std::size_t>(id) >= m_nodes.size()) {
+      m_nodes.resize(id + 1);
+   } else if (m_nodes[id].slot != -1) {
+      unlink(id);
+   }
+
+   if (ticksFromNow == 0) {
+      ticksFromNow = 1;
+   }
+
+   const std::size_t numberSlots = m_slots.size();
+   const std::size_t slot = (m_cursor + ticksFromNow) % numberSlots;
+
+   Node& node = m_nodes[id];
+   node.slot = static_cast<int>(slot);
+   node.rounds = static_cast<std::uint32_t>((ticksFromNow - 1) / numberSlots);
+   node.prev = -1;
+   node.next = m_slots[slot];
+
+   if (node.next != -1) {
+      m_nodes[node.next].prev = id;
+   }
+
+   m_slots[slot] = id;
+   ++m_size;
+}
+
+//******************************************************************************
+
+void TimingWheel::cancel(int id) {
+   if (isScheduled(id)) {
+      unlink(id);
+   }
+}
+
+//******************************************************************************
+
+bool TimingWheel::isScheduled(int id) const {
+   return (id >= 0) &&
+          (static_cast<std::size_t>(id) < m_nodes.size()) &&
+          (m_nodes[id].slot != -1);
+}
+
+//******************************************************************************
+
+void TimingWheel::unlink(int id) {
+   Node& node = m_nodes[id];
+
+   if (node.prev != -1) {
+      m_nodes[node.prev].next = node.next;
+   } else {
+      m_slots[node.slot] = node.next;
+   }
+
+   if (node.next != -1) {
+      m_nodes[node.next].prev = node.prev;
+   }
+
+   node.prev = -1;
+   node.next = -1;
+   node.slot = -1;
+   node.rounds = 0;
+   --m_size;
+}
+
+//******************************************************************************
+
+void TimingWheel::advance(std::vector<int>& expired) {
+   m_cursor = (m_cursor + 1) % m_slots.size();
+   ++m_currentTick;
+
+   int id = m_slots[m_cursor];
+   while (id != -1) {
+      Node& node = m_nodes[id];
+      const int next = node.next;
+
+      if (node.rounds == 0) {
+         unlink(id);
+         expired.push_back(id);
+      } else {
+         --node.rounds;
+      }
+
+      id = next;
+   }
+}
+
+//******************************************************************************
+
+std::uint64_t TimingWheel::getCurrentTick() const {
+   return m_currentTick;
+}
+
+//******************************************************************************
+
+std::size_t TimingWheel::size() const {
+   return m_size;
+}
+
+//******************************************************************************
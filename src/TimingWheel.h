@@ -0,0 +1,111 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TIMINGWHEEL_H
+#define CHAUDIERE_TIMINGWHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace chaudiere
+{
+
+/**
+ * TimingWheel is a hashed timing wheel for timers keyed by a small
+ * non-negative integer id (e.g., a file descriptor). Scheduling,
+ * rescheduling, and cancelling are O(1); advancing the wheel by one tick
+ * costs only the timers in the slot being passed over. Timers further out
+ * than one revolution of the wheel carry a count of remaining rounds, so
+ * there's no limit on how far ahead a timer can be scheduled.
+ *
+ * Each id has at most one timer -- scheduling an id that already has one
+ * replaces it. TimingWheel is not thread safe; it's meant to be owned and
+ * driven by a single thread such as an event loop.
+ */
+class TimingWheel
+{
+public:
+   /**
+    * Constructs a wheel with the given number of slots (one tick each)
+    * @param numberSlots the number of slots in one revolution of the wheel
+    */
+   explicit TimingWheel(std::size_t numberSlots);
+
+   /**
+    * Destructor
+    */
+   ~TimingWheel();
+
+   /**
+    * Schedules (or reschedules) the timer for an id
+    * @param id the timer id
+    * @param ticksFromNow number of ticks until the timer expires (0 is
+    * treated as 1)
+    */
+   void schedule(int id, std::uint32_t ticksFromNow);
+
+   /**
+    * Cancels the timer for an id, if it has one
+    * @param id the timer id
+    */
+   void cancel(int id);
+
+   /**
+    * Determines whether an id has a timer scheduled
+    * @param id the timer id
+    * @return boolean indicating if a timer is scheduled
+    */
+   bool isScheduled(int id) const;
+
+   /**
+    * Advances the wheel by one tick, removing the timers that expire
+    * @param expired receives the ids whose timers expired
+    */
+   void advance(std::vector<int>& expired);
+
+   /**
+    * Retrieves the number of ticks the wheel has advanced
+    * @return the current tick
+    */
+   std::uint64_t getCurrentTick() const;
+
+   /**
+    * Retrieves the number of scheduled timers
+    * @return number of scheduled timers
+    */
+   std::size_t size() const;
+
+
+private:
+   struct Node {
+      Node() :
+         prev(-1),
+         next(-1),
+         slot(-1),
+         rounds(0) {
+      }
+
+      int prev;
+      int next;
+      int slot;
+      std::uint32_t rounds;
+   };
+
+   void unlink(int id);
+
+   std::vector<Node> m_nodes;
+   std::vector<int> m_slots;
+   std::uint64_t m_currentTick;
+   std::size_t m_cursor;
+   std::size_t m_size;
+
+   // copying not allowed
+   TimingWheel(const TimingWheel&);
+   TimingWheel& operator=(const TimingWheel&);
+};
+
+}
+
+#endif
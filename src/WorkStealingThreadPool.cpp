@@ -0,0 +1,390 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+
+#include "WorkStealingThreadPool.h"
+#include "ChaseLevDeque.h"
+#include "ConditionVariable.h"
+#include "MutexLock.h"
+#include "Runnable.h"
+#include "Thread.h"
+#include "ThreadingFactory.h"
+#include "BasicException.h"
+#include "Logger.h"
+#include "StrUtils.h"
+
+using namespace chaudiere;
+
+static const std::size_t MAX_INJECTION_QUEUES = 8;
+
+/**
+ * A worker thread of the pool, with the deque it owns
+ */
+class WorkStealingThreadPool::Worker : public Runnable
+{
+public:
+   Worker(WorkStealingThreadPool& pool, int workerId) :
+      m_pool(pool),
+      m_workerId(workerId),
+      m_randomState(static_cast<std::uint32_t>(workerId) * 2654435761U + 1) {
+   }
+
+   void run() override {
+      m_pool.runWorker(*this);
+   }
+
+   // xorshift -- only needs to spread steal attempts across victims
+   std::uint32_t nextRandom() {
+      m_randomState ^= m_randomState << 13;
+      m_randomState ^= m_randomState >> 17;
+      m_randomState ^= m_randomState << 5;
+      return m_randomState;
+   }
+
+   WorkStealingThreadPool& m_pool;
+   ChaseLevDeque m_deque;
+   std::unique_ptr<Thread> m_thread;
+   int m_workerId;
+   std::uint32_t m_randomState;
+};
+
+// the worker (of any WorkStealingThreadPool) running on the current thread
+static thread_local void* currentWorker = nullptr;
+
+//******************************************************************************
+
+WorkStealingThreadPool::WorkStealingThreadPool(ThreadingFactory* threadingFactory,
+                                               int numberWorkers,
+                                               const std::string& name) :
+   m_threadingFactory(threadingFactory),
+   m_idleMutex(threadingFactory->createMutex("WorkStealingThreadPool")),
+   m_condRequestAdded(threadingFactory->createConditionVariable("request-added")),
+   m_name(name),
+   m_pendingRequests(0),
+   m_idleWorkers(0),
+   m_nextInjectionQueue(0),
+   m_steals(0),
+   m_injectedRequests(0),
+   m_isRunning(false),
+   m_workerCount(numberWorkers) {
+   LOG_INSTANCE_CREATE("WorkStealingThreadPool")
+
+   std::size_t numberInjectionQueues =
+      (numberWorkers > 0) ? static_cast<std::size_t>(numberWorkers) : 1;
+   if (numberInjectionQueues > MAX_INJECTION_QUEUES) {
+      numberInjectionQueues = MAX_INJECTION_QUEUES;
+   }
+
+   for (std::size_t i = 0; i < numberInjectionQueues; ++i) {
+      InjectionQueue* injectionQueue = new InjectionQueue;
+      injectionQueue->mutex.reset(threadingFactory->createMutex("injection-queue"));
+      m_injectionQueues.emplace_back(injectionQueue);
+   }
+
+   start();
+}
+
+//******************************************************************************
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+   LOG_INSTANCE_DESTROY("WorkStealingThreadPool")
+   stop();
+}
+
+//******************************************************************************
+
+bool WorkStealingThreadPool::start() {
+   if (m_isRunning || (m_workerCount < 1)) {
+      return false;
+   }
+
+   m_isRunning = true;
+
+   // every worker's deque has to exist before any worker starts stealing
+   for (int i = 0; i < m_workerCount; ++i) {
+      m_workers.emplace_back(new Worker(*this, i + 1));
+   }
+
+   for (auto& worker : m_workers) {
+      worker->m_thread.reset(
+         m_threadingFactory->createThread(worker.get(),
+            "wsworker-" + StrUtils::toString(worker->m_workerId)));
+
+      if (worker->m_thread) {
+         if (m_workerAttributes) {
+            worker->m_thread->setThreadAttributes(*m_workerAttributes);
+         }
+
+         worker->m_thread->setPoolWorkerStatus(true);
+         worker->m_thread->setWorkerId(StrUtils::toString(worker->m_workerId));
+         worker->m_thread->start();
+      }
+   }
+
+   return true;
+}
+
+//******************************************************************************
+
+bool WorkStealingThreadPool::stop() {
+   if (!m_isRunning) {
+      return false;
+   }
+
+   m_isRunning = false;
+
+   {
+      MutexLock lock(*m_idleMutex);
+      m_condRequestAdded->notifyAll();
+   }
+
+   // workers run whatever has already been added before they exit
+   for (auto& worker : m_workers) {
+      if (worker->m_thread) {
+         worker->m_thread->join();
+      }
+   }
+
+   m_workers.clear();
+
+   return true;
+}
+
+//******************************************************************************
+
+bool WorkStealingThreadPool::addRequest(Runnable* runnableRequest) {
+   return addRequests(std::span<Runnable* const>(&runnableRequest, 1)) == 1;
+}
+
+//******************************************************************************
+
+std::size_t WorkStealingThreadPool::addRequests(std::span<Runnable* const> runnableRequests) {
+   // a nullptr ends the batch
+   std::size_t numberRequests = 0;
+   while ((numberRequests < runnableRequests.size()) &&
+          (nullptr != runnableRequests[numberRequests])) {
+      ++numberRequests;
+   }
+
+   if (numberRequests == 0) {
+      return 0;
+   }
+
+   // counted before checking m_isRunning, so that a stopping worker either
+   // waits for these requests or this call sees that the pool has stopped
+   const std::int64_t numberPending = static_cast<std::int64_t>(numberRequests);
+   m_pendingRequests.fetch_add(numberPending, std::memory_order_seq_cst);
+
+   if (!m_isRunning.load(std::memory_order_seq_cst)) {
+      m_pendingRequests.fetch_sub(numberPending, std::memory_order_seq_cst);
+      return 0;
+   }
+
+   Worker* worker = static_cast<Worker*>(currentWorker);
+
+   if ((nullptr != worker) && (&worker->m_pool == this)) {
+      for (std::size_t i = 0; i < numberRequests; ++i) {
+         worker->m_deque.push(runnableRequests[i]);
+      }
+   } else {
+      const std::size_t index =
+         m_nextInjectionQueue.fetch_add(1, std::memory_order_relaxed) %
+         m_injectionQueues.size();
+      InjectionQueue& injectionQueue = *m_injectionQueues[index];
+      MutexLock lock(*injectionQueue.mutex);
+      injectionQueue.requests.insert(injectionQueue.requests.end(),
+                                     runnableRequests.begin(),
+                                     runnableRequests.begin() + numberRequests);
+      m_injectedRequests.fetch_add(numberRequests, std::memory_order_relaxed);
+   }
+
+   notifyRequestsAdded(numberRequests);
+
+   return numberRequests;
+}
+
+//******************************************************************************
+
+bool WorkStealingThreadPool::setWorkerThreadAttributes(const ThreadAttributes& threadAttributes) {
+   m_workerAttributes.reset(new ThreadAttributes(threadAttributes));
+   return true;
+}
+
+//******************************************************************************
+
+int WorkStealingThreadPool::getNumberWorkers() const {
+   return m_workerCount;
+}
+
+//******************************************************************************
+
+const std::string& WorkStealingThreadPool::getName() const {
+   return m_name;
+}
+
+//******************************************************************************
+
+bool WorkStealingThreadPool::isRunning() const {
+   return m_isRunning;
+}
+
+//******************************************************************************
+
+std::uint64_t WorkStealingThreadPool::getNumberSteals() const {
+   return m_steals.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+std::uint64_t WorkStealingThreadPool::getNumberInjectedRequests() const {
+   return m_injectedRequests.load(std::memory_order_relaxed);
+}
+
+//******************************************************************************
+
+void WorkStealingThreadPool::notifyRequestsAdded(std::size_t numberAdded) {
+   // pairs with waitForRequest: either an idle worker sees the requests
+   // counted, or we see it idle and wake it
+   const int numberIdle = m_idleWorkers.load(std::memory_order_seq_cst);
+
+   if (numberIdle > 0) {
+      const std::size_t numberToWake =
+         std::min(numberAdded, static_cast<std::size_t>(numberIdle));
+      MutexLock lock(*m_idleMutex);
+      for (std::size_t i = 0; i < numberToWake; ++i) {
+         m_condRequestAdded->notifyOne();
+      }
+   }
+}
+
+//******************************************************************************
+
+bool WorkStealingThreadPool::waitForRequest() {
+   MutexLock lock(*m_idleMutex);
+
+   m_idleWorkers.fetch_add(1, std::memory_order_seq_cst);
+
+   while ((m_pendingRequests.load(std::memory_order_seq_cst) <= 0) &&
+          m_isRunning.load(std::memory_order_seq_cst)) {
+      m_condRequestAdded->wait(m_idleMutex.get());
+   }
+
+   m_idleWorkers.fetch_sub(1, std::memory_order_seq_cst);
+
+   return m_isRunning || (m_pendingRequests.load(std::memory_order_seq_cst) > 0);
+}
+
+//******************************************************************************
+
+Runnable* WorkStealingThreadPool::takeInjectedRequest(std::size_t startIndex) {
+   const std::size_t numberQueues = m_injectionQueues.size();
+
+   for (std::size_t i = 0; i < numberQueues; ++i) {
+      InjectionQueue& injectionQueue =
+         *m_injectionQueues[(startIndex + i) % numberQueues];
+      MutexLock lock(*injectionQueue.mutex);
+
+      if (!injectionQueue.requests.empty()) {
+         Runnable* runnable = injectionQueue.requests.front();
+         injectionQueue.requests.pop_front();
+         return runnable;
+      }
+   }
+
+   return nullptr;
+}
+
+//******************************************************************************
+
+Runnable* WorkStealingThreadPool::findRequest(Worker& worker) {
+   // newest first from our own deque (it's the most likely to be cache-hot)
+   Runnable* runnable = worker.m_deque.pop();
+
+   if (nullptr == runnable) {
+      runnable = takeInjectedRequest(static_cast<std::size_t>(worker.m_workerId));
+   }
+
+   const std::size_t numberWorkers = m_workers.size();
+
+   if ((nullptr == runnable) && (numberWorkers > 1)) {
+      bool isRetryNeeded;
+
+      do {
+         isRetryNeeded = false;
+         const std::size_t startIndex = worker.nextRandom() % numberWorkers;
+
+         for (std::size_t i = 0; i < numberWorkers; ++i) {
+            Worker& victim = *m_workers[(startIndex + i) % numberWorkers];
+
+            if (&victim == &worker) {
+               continue;
+            }
+
+            const ChaseLevDeque::StealResult result =
+               victim.m_deque.steal(runnable);
+
+            if (result == ChaseLevDeque::StealResult::Success) {
+               m_steals.fetch_add(1, std::memory_order_relaxed);
+               break;
+            } else if (result == ChaseLevDeque::StealResult::Abort) {
+               isRetryNeeded = true;
+            }
+
+            runnable = nullptr;
+         }
+      } while ((nullptr == runnable) && isRetryNeeded);
+   }
+
+   if (nullptr != runnable) {
+      m_pendingRequests.fetch_sub(1, std::memory_order_seq_cst);
+   }
+
+   return runnable;
+}
+
+//******************************************************************************
+
+void WorkStealingThreadPool::runWorker(Worker& worker) {
+   currentWorker = &worker;
+
+   for (;;) {
+      Runnable* runnable = findRequest(worker);
+
+      if (nullptr == runnable) {
+         if (!waitForRequest()) {
+            break;
+         }
+         continue;
+      }
+
+      runnable->setRunByThreadId(worker.m_workerId);
+      if (worker.m_thread) {
+         runnable->setRunByThreadWorkerId(worker.m_thread->getWorkerId());
+      }
+
+      runnable->notifyOnStart();
+
+      try {
+         runnable->run();
+      } catch (const BasicException& be) {
+         LOG_ERROR("run method of runnable threw exception: " + be.whatString())
+      } catch (const std::exception& e) {
+         LOG_ERROR("run method of runnable threw exception: " + std::string(e.what()))
+      } catch (...) {
+         LOG_ERROR("run method of runnable threw exception")
+      }
+
+      runnable->notifyOnCompletion();
+
+      if (runnable->isAutoDelete()) {
+         delete runnable;
+      }
+   }
+
+   currentWorker = nullptr;
+}
+
+//******************************************************************************
@@ -0,0 +1,166 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_WORKSTEALINGTHREADPOOL_H
+#define CHAUDIERE_WORKSTEALINGTHREADPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ThreadAttributes.h"
+#include "ThreadPoolDispatcher.h"
+
+
+namespace chaudiere
+{
+   class ConditionVariable;
+   class Mutex;
+   class Runnable;
+   class ThreadingFactory;
+
+/**
+ * WorkStealingThreadPool is a ThreadPoolDispatcher whose workers don't
+ * share a queue. Each worker owns a ChaseLevDeque: requests submitted from
+ * one of the pool's own workers go onto that worker's deque, and the worker
+ * runs them newest first. Requests submitted from any other thread (e.g.,
+ * a kernel event loop) go onto one of several mutex-protected injection
+ * queues, spread round-robin so that submitters don't all contend on one
+ * lock. A worker with nothing on its own deque takes from the injection
+ * queues and then tries to steal the oldest request from another worker's
+ * deque before going to sleep.
+ *
+ * Created by ThreadingFactory::createThreadPoolDispatcher when the
+ * factory's thread pool type is ThreadPoolType::WorkStealing.
+ */
+class WorkStealingThreadPool : public ThreadPoolDispatcher
+{
+public:
+   /**
+    * Constructs and starts the pool
+    * @param threadingFactory the factory for threads, mutexes, and
+    * condition variables
+    * @param numberWorkers the number of worker threads
+    * @param name the name of the pool
+    * @see ThreadingFactory()
+    */
+   WorkStealingThreadPool(ThreadingFactory* threadingFactory,
+                          int numberWorkers,
+                          const std::string& name);
+
+   /**
+    * Destructor
+    */
+   ~WorkStealingThreadPool();
+
+   // ThreadPoolDispatcher
+   /**
+    * Starts the worker threads
+    * @return boolean indicating if the pool was started
+    */
+   virtual bool start();
+
+   /**
+    * Stops the worker threads once every request already added has run
+    * @return boolean indicating if the pool was stopped
+    */
+   virtual bool stop();
+
+   /**
+    * Adds a request to the pool -- onto the calling worker's own deque if
+    * called from one of the pool's workers, otherwise onto an injection queue
+    * @param runnableRequest the request to run
+    * @return boolean indicating if the request was accepted
+    * @see Runnable()
+    */
+   virtual bool addRequest(Runnable* runnableRequest);
+
+   // addRequest(Task&&) wraps the task in a TaskRunnable
+   using ThreadPoolDispatcher::addRequest;
+
+   /**
+    * Adds a batch of requests -- onto the calling worker's own deque, or
+    * onto one injection queue under a single lock acquisition
+    * @param runnableRequests the requests to add
+    * @return the number of requests added (a prefix of runnableRequests)
+    * @see Runnable()
+    */
+   virtual std::size_t addRequests(std::span<Runnable* const> runnableRequests);
+
+   /**
+    * Sets the attributes (cpu affinity, stack size, scheduling) of the
+    * pool's worker threads, in place of the threading factory's. Applies the
+    * next time the pool is started.
+    * @param threadAttributes the attributes for worker threads
+    * @return true
+    * @see ThreadAttributes()
+    */
+   virtual bool setWorkerThreadAttributes(const ThreadAttributes& threadAttributes);
+
+   /**
+    * @return the number of worker threads
+    */
+   int getNumberWorkers() const;
+
+   /**
+    * @return the name of the pool
+    */
+   const std::string& getName() const;
+
+   /**
+    * @return whether the pool is running
+    */
+   bool isRunning() const;
+
+   /**
+    * @return number of requests a worker stole from another worker's deque
+    */
+   std::uint64_t getNumberSteals() const;
+
+   /**
+    * @return number of requests added from outside the pool (i.e., onto an
+    * injection queue)
+    */
+   std::uint64_t getNumberInjectedRequests() const;
+
+
+private:
+   class Worker;
+
+   struct InjectionQueue {
+      std::unique_ptr<Mutex> mutex;
+      std::deque<Runnable*> requests;
+   };
+
+   Runnable* findRequest(Worker& worker);
+   Runnable* takeInjectedRequest(std::size_t startIndex);
+   bool waitForRequest();
+   void notifyRequestsAdded(std::size_t numberAdded);
+   void runWorker(Worker& worker);
+
+   ThreadingFactory* m_threadingFactory;
+   std::vector<std::unique_ptr<Worker>> m_workers;
+   std::vector<std::unique_ptr<InjectionQueue>> m_injectionQueues;
+   std::unique_ptr<Mutex> m_idleMutex;
+   std::unique_ptr<ConditionVariable> m_condRequestAdded;
+   std::unique_ptr<ThreadAttributes> m_workerAttributes;
+   std::string m_name;
+   std::atomic<std::int64_t> m_pendingRequests;
+   std::atomic<int> m_idleWorkers;
+   std::atomic<std::uint64_t> m_nextInjectionQueue;
+   std::atomic<std::uint64_t> m_steals;
+   std::atomic<std::uint64_t> m_injectedRequests;
+   std::atomic<bool> m_isRunning;
+   int m_workerCount;
+
+   // disallow copies
+   WorkStealingThreadPool(const WorkStealingThreadPool&);
+   WorkStealingThreadPool& operator=(const WorkStealingThreadPool&);
+};
+
+}
+
+#endif
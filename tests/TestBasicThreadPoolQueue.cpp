@@ -0,0 +1,191 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TestBasicThreadPoolQueue.h"
+#include "BasicThreadPoolQueue.h"
+#include "PthreadsMutex.h"
+#include "PthreadsConditionVariable.h"
+#include "StdMutex.h"
+#include "StdConditionVariable.h"
+#include "FutexMutex.h"
+#include "FutexConditionVariable.h"
+#include "PthreadsThreadingFactory.h"
+#include "LinuxThreadingFactory.h"
+#include "ThreadPool.h"
+#include "Runnable.h"
+
+using namespace chaudiere;
+
+static PthreadsThreadingFactory tf;
+
+class BasicQueueRunnable : public chaudiere::Runnable
+{
+   public:
+      virtual void run() {
+      }
+};
+
+//******************************************************************************
+
+TestBasicThreadPoolQueue::TestBasicThreadPoolQueue() :
+   poivre::TestSuite("TestBasicThreadPoolQueue") {
+}
+
+//******************************************************************************
+
+void TestBasicThreadPoolQueue::runTests() {
+   testVirtualLockPolicy();
+   testPthreadsLockPolicy();
+   testStdLockPolicy();
+   testFutexLockPolicy();
+   testBatchAddAndTake();
+   testShutDownWakesTakers();
+   testThreadPoolWithFutexQueue();
+}
+
+//******************************************************************************
+
+template <typename LockPolicy>
+void TestBasicThreadPoolQueue::requireAddAndTake(const char* policyName) {
+   const std::string policy(policyName);
+   BasicQueueRunnable r;
+   BasicThreadPoolQueue<LockPolicy> tpq(&tf);
+   require(tpq.isInitialized(), policy + ": should be initialized after construction");
+   require(tpq.isRunning(), policy + ": should be running after construction");
+   require(tpq.isEmpty(), policy + ": should be empty after construction");
+
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+   tpq.takeRequest(ctx);
+   require(nullptr == ctx.runnable, policy + ": takeRequest should return nullptr with nothing added");
+
+   require(tpq.addRequest(&r), policy + ": addRequest should succeed");
+   require(1 == tpq.getLaneSize(PriorityClass::Normal), policy + ": request should be in the normal lane");
+   tpq.takeRequest(ctx);
+   require(&r == ctx.runnable, policy + ": takeRequest should return what was added");
+   require(tpq.isEmpty(), policy + ": should be empty after taking last request");
+
+   tpq.shutDown();
+   require(!tpq.isRunning(), policy + ": should not be running after shutDown");
+   require(!tpq.addRequest(&r), policy + ": addRequest should fail after shutDown");
+}
+
+//******************************************************************************
+
+void TestBasicThreadPoolQueue::testVirtualLockPolicy() {
+   TEST_CASE("testVirtualLockPolicy");
+   requireAddAndTake<VirtualLockPolicy>("VirtualLockPolicy");
+}
+
+//******************************************************************************
+
+void TestBasicThreadPoolQueue::testPthreadsLockPolicy() {
+   TEST_CASE("testPthreadsLockPolicy");
+   requireAddAndTake<PthreadsLockPolicy>("PthreadsLockPolicy");
+}
+
+//******************************************************************************
+
+void TestBasicThreadPoolQueue::testStdLockPolicy() {
+   TEST_CASE("testStdLockPolicy");
+   requireAddAndTake<StdLockPolicy>("StdLockPolicy");
+}
+
+//******************************************************************************
+
+void TestBasicThreadPoolQueue::testFutexLockPolicy() {
+   TEST_CASE("testFutexLockPolicy");
+   requireAddAndTake<FutexLockPolicy>("FutexLockPolicy");
+}
+
+//******************************************************************************
+
+void TestBasicThreadPoolQueue::testBatchAddAndTake() {
+   TEST_CASE("testBatchAddAndTake");
+
+   BasicQueueRunnable runnables[8];
+   std::vector<Runnable*> requests;
+   for (BasicQueueRunnable& r : runnables) {
+      requests.push_back(&r);
+   }
+
+   BasicThreadPoolQueue<FutexLockPolicy> tpq(nullptr);
+   require(8 == tpq.addRequests(requests), "addRequests should add the whole batch");
+   require(8 == tpq.getQueueSize(), "queue should hold the whole batch");
+
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+   tpq.takeRequests(ctx, 5);
+   require(5 == ctx.runnables.size(), "takeRequests should take up to the batch limit");
+   require(ctx.runnables[0] == requests[0], "batch should be taken in FIFO order");
+   require(3 == tpq.getQueueSize(), "the rest of the batch should remain queued");
+}
+
+//******************************************************************************
+
+void TestBasicThreadPoolQueue::testShutDownWakesTakers() {
+   TEST_CASE("testShutDownWakesTakers");
+
+   BasicThreadPoolQueue<FutexLockPolicy> tpq(nullptr);
+   std::atomic<int> numberReturned(0);
+   std::vector<std::thread> takers;
+
+   for (int i = 0; i < 4; ++i) {
+      takers.emplace_back([&tpq, &numberReturned]() {
+         TakeRequestContext ctx;
+         tpq.takeRequest(ctx);
+         if (nullptr == ctx.runnable) {
+            ++numberReturned;
+         }
+      });
+   }
+
+   while (tpq.getNumberWaitingTakers() < 4) {
+      std::this_thread::yield();
+   }
+
+   tpq.shutDown();
+
+   for (std::thread& taker : takers) {
+      taker.join();
+   }
+
+   require(4 == numberReturned.load(), "shutDown should wake every waiting taker empty-handed");
+}
+
+//******************************************************************************
+
+void TestBasicThreadPoolQueue::testThreadPoolWithFutexQueue() {
+   TEST_CASE("testThreadPoolWithFutexQueue");
+
+   const int numberRequests = 10000;
+   LinuxThreadingFactory factory;
+   std::atomic<int> counter(0);
+   ThreadPool pool(&factory,
+                   new BasicThreadPoolQueue<FutexLockPolicy>(&factory),
+                   4,
+                   "futexQueuePool");
+   int numberAdded = 0;
+
+   for (int i = 0; i < numberRequests; ++i) {
+      if (pool.addRequest([&counter]() { ++counter; })) {
+         ++numberAdded;
+      }
+   }
+
+   require(numberRequests == numberAdded, "pool should accept every request");
+
+   for (int spins = 0; (counter.load() < numberRequests) && (spins < 10000000); ++spins) {
+      std::this_thread::yield();
+   }
+
+   require(numberRequests == counter.load(), "pool should run every request");
+   pool.stop();
+}
+
+//******************************************************************************
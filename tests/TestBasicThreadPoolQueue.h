@@ -0,0 +1,35 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTBASICTHREADPOOLQUEUE_H
+#define CHAUDIERE_TESTBASICTHREADPOOLQUEUE_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestBasicThreadPoolQueue : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testVirtualLockPolicy();
+   void testPthreadsLockPolicy();
+   void testStdLockPolicy();
+   void testFutexLockPolicy();
+   void testBatchAddAndTake();
+   void testShutDownWakesTakers();
+   void testThreadPoolWithFutexQueue();
+
+   template <typename LockPolicy>
+   void requireAddAndTake(const char* policyName);
+
+public:
+   TestBasicThreadPoolQueue();
+
+};
+
+}
+
+#endif
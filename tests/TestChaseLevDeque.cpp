@@ -0,0 +1,179 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "TestChaseLevDeque.h"
+#include "ChaseLevDeque.h"
+#include "Runnable.h"
+
+using namespace chaudiere;
+
+namespace {
+
+class NumberedRunnable : public chaudiere::Runnable {
+public:
+   NumberedRunnable() :
+      m_number(0) {
+   }
+
+   void run() override {
+   }
+
+   int m_number;
+};
+
+}
+
+//******************************************************************************
+
+TestChaseLevDeque::TestChaseLevDeque() :
+   poivre::TestSuite("TestChaseLevDeque") {
+}
+
+//******************************************************************************
+
+void TestChaseLevDeque::runTests() {
+   testPushPop();
+   testSteal();
+   testGrow();
+   testConcurrentSteal();
+}
+
+//******************************************************************************
+
+void TestChaseLevDeque::testPushPop() {
+   TEST_CASE("testPushPop");
+
+   ChaseLevDeque deque;
+   NumberedRunnable a, b, c;
+
+   require(deque.isEmpty(), "new deque should be empty");
+   require(nullptr == deque.pop(), "pop on an empty deque should return nullptr");
+
+   deque.push(&a);
+   deque.push(&b);
+   deque.push(&c);
+   require(3 == deque.size(), "size should count pushed requests");
+
+   require(&c == deque.pop(), "owner should pop the newest request first");
+   require(&b == deque.pop(), "owner should pop in LIFO order");
+   require(&a == deque.pop(), "owner should pop in LIFO order");
+   require(nullptr == deque.pop(), "pop should return nullptr once drained");
+   require(deque.isEmpty(), "drained deque should be empty");
+}
+
+//******************************************************************************
+
+void TestChaseLevDeque::testSteal() {
+   TEST_CASE("testSteal");
+
+   ChaseLevDeque deque;
+   NumberedRunnable a, b;
+   Runnable* stolen = nullptr;
+
+   require(ChaseLevDeque::StealResult::Empty == deque.steal(stolen), "steal from an empty deque should report empty");
+
+   deque.push(&a);
+   deque.push(&b);
+
+   require(ChaseLevDeque::StealResult::Success == deque.steal(stolen), "steal should succeed with requests present");
+   require(&a == stolen, "thief should steal the oldest request");
+   require(&b == deque.pop(), "owner should still get the remaining request");
+   require(ChaseLevDeque::StealResult::Empty == deque.steal(stolen), "nothing should be left to steal");
+}
+
+//******************************************************************************
+
+void TestChaseLevDeque::testGrow() {
+   TEST_CASE("testGrow");
+
+   ChaseLevDeque deque(4);
+   require(4 == deque.getCapacity(), "initial capacity should be honored");
+
+   std::vector<NumberedRunnable> runnables(100);
+   for (std::size_t i = 0; i < runnables.size(); ++i) {
+      runnables[i].m_number = static_cast<int>(i);
+      deque.push(&runnables[i]);
+   }
+
+   require(100 == deque.size(), "no request should be lost when the buffer grows");
+   require(deque.getCapacity() >= 100, "capacity should have grown to fit");
+
+   Runnable* stolen = nullptr;
+   require(ChaseLevDeque::StealResult::Success == deque.steal(stolen), "steal should succeed after growing");
+   require(0 == static_cast<NumberedRunnable*>(stolen)->m_number, "oldest request should survive the grow");
+   require(99 == static_cast<NumberedRunnable*>(deque.pop())->m_number, "newest request should survive the grow");
+}
+
+//******************************************************************************
+
+void TestChaseLevDeque::testConcurrentSteal() {
+   TEST_CASE("testConcurrentSteal");
+
+   const int numberRequests = 100000;
+   const int numberThieves = 3;
+
+   std::vector<NumberedRunnable> runnables(numberRequests);
+   std::vector<std::atomic<int>> timesTaken(numberRequests);
+   for (int i = 0; i < numberRequests; ++i) {
+      runnables[i].m_number = i;
+      timesTaken[i].store(0);
+   }
+
+   ChaseLevDeque deque(16);
+   std::atomic<bool> isOwnerDone(false);
+   std::atomic<int> numberTaken(0);
+
+   auto take = [&](Runnable* runnable) {
+      timesTaken[static_cast<NumberedRunnable*>(runnable)->m_number]++;
+      numberTaken++;
+   };
+
+   std::vector<std::thread> thieves;
+   for (int t = 0; t < numberThieves; ++t) {
+      thieves.push_back(std::thread([&]() {
+         while (!isOwnerDone || !deque.isEmpty()) {
+            Runnable* stolen = nullptr;
+            if (deque.steal(stolen) == ChaseLevDeque::StealResult::Success) {
+               take(stolen);
+            }
+         }
+      }));
+   }
+
+   // the owner interleaves pushes and pops while the thieves steal
+   for (int i = 0; i < numberRequests; ++i) {
+      deque.push(&runnables[i]);
+      if ((i % 3) == 0) {
+         Runnable* popped = deque.pop();
+         if (nullptr != popped) {
+            take(popped);
+         }
+      }
+   }
+
+   Runnable* popped = nullptr;
+   while ((popped = deque.pop()) != nullptr) {
+      take(popped);
+   }
+   isOwnerDone = true;
+
+   for (std::thread& thief : thieves) {
+      thief.join();
+   }
+
+   bool isEachTakenOnce = true;
+   for (int i = 0; i < numberRequests; ++i) {
+      if (timesTaken[i] != 1) {
+         isEachTakenOnce = false;
+      }
+   }
+
+   require(numberRequests == numberTaken, "every request should be taken");
+   require(isEachTakenOnce, "no request should be taken twice");
+}
+
+//******************************************************************************
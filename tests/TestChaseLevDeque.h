@@ -0,0 +1,29 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTCHASELEVDEQUE_H
+#define CHAUDIERE_TESTCHASELEVDEQUE_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestChaseLevDeque : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testPushPop();
+   void testSteal();
+   void testGrow();
+   void testConcurrentSteal();
+
+public:
+   TestChaseLevDeque();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,188 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "TestConnectionStateTable.h"
+#include "ConnectionStateTable.h"
+
+using namespace chaudiere;
+
+typedef ConnectionStateTable::InterestState InterestState;
+
+//******************************************************************************
+
+TestConnectionStateTable::TestConnectionStateTable() :
+   poivre::TestSuite("TestConnectionStateTable") {
+}
+
+//******************************************************************************
+
+void TestConnectionStateTable::runTests() {
+   testDefaultCapacity();
+   testBusyFlag();
+   testInterestState();
+   testCompareAndSetInterestState();
+   testLastActivity();
+   testPendingOutput();
+   testReset();
+   testOverflowDescriptor();
+   testInvalidDescriptor();
+}
+
+//******************************************************************************
+
+void TestConnectionStateTable::testDefaultCapacity() {
+   TEST_CASE("testDefaultCapacity");
+
+   const std::size_t capacity = ConnectionStateTable::defaultCapacity();
+   require(capacity > 0, "default capacity should be positive");
+   require(capacity <= ConnectionStateTable::MAX_CAPACITY, "default capacity should not exceed the cap");
+
+   ConnectionStateTable table;
+   require(table.getCapacity() == capacity, "default-constructed table should use the default capacity");
+}
+
+//******************************************************************************
+
+void TestConnectionStateTable::testBusyFlag() {
+   TEST_CASE("testBusyFlag");
+
+   ConnectionStateTable table(64);
+   requireFalse(table.isBusy(5), "fd should not be busy initially");
+
+   table.setBusy(5, true);
+   require(table.isBusy(5), "isBusy should reflect setBusy(true)");
+   requireFalse(table.isBusy(6), "setting one fd busy should not affect another");
+
+   table.setBusy(5, false);
+   requireFalse(table.isBusy(5), "isBusy should reflect setBusy(false)");
+}
+
+//******************************************************************************
+
+void TestConnectionStateTable::testInterestState() {
+   TEST_CASE("testInterestState");
+
+   ConnectionStateTable table(64);
+   require(table.getInterestState(7) == InterestState::Unregistered, "fd should be unregistered initially");
+
+   table.setBusy(7, true);
+   table.setInterestState(7, InterestState::Armed);
+   require(table.getInterestState(7) == InterestState::Armed, "getInterestState should reflect setInterestState");
+   require(table.isBusy(7), "setting the interest state should leave the busy flag alone");
+
+   table.setInterestState(7, InterestState::Disarmed);
+   require(table.getInterestState(7) == InterestState::Disarmed, "interest state should be changeable");
+}
+
+//******************************************************************************
+
+void TestConnectionStateTable::testCompareAndSetInterestState() {
+   TEST_CASE("testCompareAndSetInterestState");
+
+   ConnectionStateTable table(64);
+
+   require(table.compareAndSetInterestState(3, InterestState::Unregistered, InterestState::Armed), "compare-and-set should succeed when the expected state matches");
+   require(table.getInterestState(3) == InterestState::Armed, "state should be changed after a successful compare-and-set");
+
+   requireFalse(table.compareAndSetInterestState(3, InterestState::Disarmed, InterestState::Unregistered), "compare-and-set should fail when the expected state doesn't match");
+   require(table.getInterestState(3) == InterestState::Armed, "state should be unchanged after a failed compare-and-set");
+}
+
+//******************************************************************************
+
+void TestConnectionStateTable::testLastActivity() {
+   TEST_CASE("testLastActivity");
+
+   ConnectionStateTable table(64);
+   require(table.getLastActivity(11) == 0, "last activity should be zero initially");
+
+   table.setBusy(11, true);
+   table.setInterestState(11, InterestState::Armed);
+   const std::uint32_t generation = table.getGeneration(11);
+
+   table.setLastActivity(11, 12345);
+   require(table.getLastActivity(11) == 12345, "getLastActivity should reflect setLastActivity");
+   require(table.isBusy(11), "recording activity should leave the busy flag alone");
+   require(table.getInterestState(11) == InterestState::Armed, "recording activity should leave the interest state alone");
+   require(table.getGeneration(11) == generation, "recording activity should leave the generation alone");
+
+   table.setLastActivity(11, ConnectionStateTable::ACTIVITY_TICK_MASK + 5);
+   require(table.getLastActivity(11) == 4, "ticks should be truncated to the activity bits");
+
+   table.reset(11);
+   require(table.getLastActivity(11) == 0, "reset should clear the last activity");
+}
+
+//******************************************************************************
+
+void TestConnectionStateTable::testPendingOutput() {
+   TEST_CASE("testPendingOutput");
+
+   ConnectionStateTable table(64);
+   requireFalse(table.hasPendingOutput(12), "fd should have no pending output initially");
+
+   table.setBusy(12, true);
+   table.setInterestState(12, InterestState::WriteArmed);
+   table.setLastActivity(12, 77);
+
+   table.setPendingOutput(12, true);
+   require(table.hasPendingOutput(12), "hasPendingOutput should reflect setPendingOutput(true)");
+   require(table.isBusy(12), "pending output should leave the busy flag alone");
+   require(table.getInterestState(12) == InterestState::WriteArmed, "pending output should leave the interest state alone");
+   require(table.getLastActivity(12) == 77, "pending output should leave the last activity alone");
+
+   table.setPendingOutput(12, false);
+   requireFalse(table.hasPendingOutput(12), "hasPendingOutput should reflect setPendingOutput(false)");
+
+   table.setPendingOutput(12, true);
+   table.reset(12);
+   requireFalse(table.hasPendingOutput(12), "reset should clear pending output");
+}
+
+//******************************************************************************
+
+void TestConnectionStateTable::testReset() {
+   TEST_CASE("testReset");
+
+   ConnectionStateTable table(64);
+   const std::uint32_t initialGeneration = table.getGeneration(9);
+
+   requireFalse(table.reset(9), "reset should report no prior state for an untouched fd");
+   require(table.getGeneration(9) == initialGeneration + 1, "reset should advance the generation");
+
+   table.setBusy(9, true);
+   table.setInterestState(9, InterestState::Armed);
+   require(table.reset(9), "reset should report prior state for a busy, registered fd");
+   requireFalse(table.isBusy(9), "reset should clear the busy flag");
+   require(table.getInterestState(9) == InterestState::Unregistered, "reset should clear the interest state");
+   require(table.getGeneration(9) == initialGeneration + 2, "each reset should advance the generation");
+}
+
+//******************************************************************************
+
+void TestConnectionStateTable::testOverflowDescriptor() {
+   TEST_CASE("testOverflowDescriptor");
+
+   // fds past the flat array still get their own state
+   ConnectionStateTable table(4);
+   table.setBusy(100, true);
+   table.setInterestState(100, InterestState::Disarmed);
+   require(table.isBusy(100), "busy flag should be tracked for an fd beyond the array");
+   require(table.getInterestState(100) == InterestState::Disarmed, "interest state should be tracked for an fd beyond the array");
+   requireFalse(table.isBusy(101), "state of overflow fds should be independent");
+   require(table.reset(100), "reset should work for an fd beyond the array");
+   requireFalse(table.isBusy(100), "reset should clear an overflow fd's busy flag");
+}
+
+//******************************************************************************
+
+void TestConnectionStateTable::testInvalidDescriptor() {
+   TEST_CASE("testInvalidDescriptor");
+
+   ConnectionStateTable table(4);
+   table.setBusy(-1, true);
+   requireFalse(table.isBusy(-1), "a negative fd should never be reported busy");
+   requireFalse(table.compareAndSetInterestState(-1, InterestState::Unregistered, InterestState::Armed), "a negative fd's state can't be changed");
+}
+
+//******************************************************************************
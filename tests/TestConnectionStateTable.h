@@ -0,0 +1,34 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTCONNECTIONSTATETABLE_H
+#define CHAUDIERE_TESTCONNECTIONSTATETABLE_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestConnectionStateTable : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testDefaultCapacity();
+   void testBusyFlag();
+   void testInterestState();
+   void testCompareAndSetInterestState();
+   void testLastActivity();
+   void testPendingOutput();
+   void testReset();
+   void testOverflowDescriptor();
+   void testInvalidDescriptor();
+
+public:
+   TestConnectionStateTable();
+
+};
+
+}
+
+#endif
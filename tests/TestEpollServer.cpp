@@ -1,12 +1,17 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
+#include <errno.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
 
 #include "TestEpollServer.h"
 #include "EpollServer.h"
 #include "PthreadsMutex.h"
 #include "PthreadsThread.h"
+#include "PthreadsThreadingFactory.h"
+#include "ThreadPoolQueue.h"
 #include "SocketServiceHandler.h"
 #include "SocketRequest.h"
 #include "Socket.h"
@@ -29,6 +34,29 @@ public:
    }
 };
 
+// Exposes the listener drain, idle expiry, event tags, and the write path so
+// they can be exercised without run()'s endless event loop.
+class AcceptingEpollServer : public EpollServer {
+public:
+   AcceptingEpollServer(Mutex& fdMutex, Mutex& hwmMutex) :
+      EpollServer(fdMutex, hwmMutex) {
+   }
+
+   using EpollServer::acceptConnections;
+   using EpollServer::expireIdleConnections;
+   using EpollServer::getIdleTimerFileDescriptor;
+   using EpollServer::getEventTag;
+   using EpollServer::isCurrentEventTag;
+   using EpollServer::removeBusyFD;
+   using EpollServer::armFileDescriptorForRead;
+   using EpollServer::disarmFileDescriptorForRead;
+   using EpollServer::armFileDescriptorForWrite;
+   using EpollServer::handleWriteEvent;
+   using EpollServer::getInterestState;
+   using EpollServer::isBusyFD;
+   using EpollServer::setBusyFD;
+};
+
 // Drives EpollServer::getKernelEvents() (which blocks until at least one
 // fd it's watching becomes ready) on a background thread, so a test can
 // trigger readiness (e.g. by connecting a real client) from the main
@@ -50,6 +78,29 @@ private:
    EpollServer& m_server;
 };
 
+// Runs EpollServer::run() (the whole event loop) on a background thread.
+class RunLoopRunnable : public chaudiere::Runnable {
+public:
+   explicit RunLoopRunnable(EpollServer& server) :
+      m_server(server) {
+   }
+
+   void run() override {
+      m_server.run();
+   }
+
+private:
+   EpollServer& m_server;
+};
+
+// Queued behind an expired request so taking from the queue has something
+// to return once the expired one has been dropped.
+class LiveRunnable : public chaudiere::Runnable {
+public:
+   void run() override {
+   }
+};
+
 }
 
 //******************************************************************************
@@ -69,6 +120,15 @@ void TestEpollServer::runTests() {
    testAddFileDescriptorForRead();
    testRemoveFileDescriptorFromRead();
    testGetKernelEventsAndEventAccessors();
+   testInitWithReusePort();
+   testOneShotReadAndRearm();
+   testListenBacklog();
+   testAcceptConnectionsDrainsBacklog();
+   testIdleConnectionExpiry();
+   testStaleEventTag();
+   testAsyncWriteFlush();
+   testDroppedRequestClosesConnection();
+   testStopEndsRun();
 }
 
 //******************************************************************************
@@ -199,3 +259,303 @@ void TestEpollServer::testGetKernelEventsAndEventAccessors() {
 }
 
 //******************************************************************************
+
+void TestEpollServer::testInitWithReusePort() {
+   TEST_CASE("testInitWithReusePort");
+
+   const int port = 44755;
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   EpollServer firstServer(fdMutex, hwmMutex);
+   EpollServer secondServer(fdMutex, hwmMutex);
+
+   requireFalse(firstServer.isReusePort(), "reuse port should be off by default");
+   firstServer.setReusePort(true);
+   secondServer.setReusePort(true);
+   require(firstServer.isReusePort(), "isReusePort should reflect setReusePort");
+
+   // one listener per event loop, all on the same port
+   require(firstServer.init(new NoOpSocketServiceHandler(), port, 10), "first event loop should init with SO_REUSEPORT");
+   require(secondServer.init(new NoOpSocketServiceHandler(), port, 10), "second event loop should init on the same port with SO_REUSEPORT");
+}
+
+//******************************************************************************
+
+void TestEpollServer::testOneShotReadAndRearm() {
+   TEST_CASE("testOneShotReadAndRearm");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   EpollServer server(fdMutex, hwmMutex);
+   require(server.init(new NoOpSocketServiceHandler(), 44756, 10), "sanity check: init should succeed");
+   require(server.isOneShotSupported(), "epoll should support one-shot registration");
+
+   int fds[2];
+   require(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "sanity check: socketpair should succeed");
+
+   require(server.addFileDescriptorForOneShotRead(fds[0]), "addFileDescriptorForOneShotRead should succeed for a new fd");
+   requireFalse(server.addFileDescriptorForOneShotRead(fds[0]), "registering the same fd twice should fail");
+
+   // the data is left unread, so the fd stays readable; without the
+   // re-arm in between, the second epoll_wait would block
+   require(::write(fds[1], "x", 1) == 1, "sanity check: write should succeed");
+   require(server.getKernelEvents(10) == 1, "a readable one-shot fd should deliver one event");
+   require(server.fileDescriptorForEventIndex(0) == fds[0], "event should be for the registered fd");
+   require(server.isEventRead(0), "event should be a read event");
+
+   require(server.rearmFileDescriptorForRead(fds[0]), "rearmFileDescriptorForRead should succeed for a registered fd");
+   require(server.getKernelEvents(10) == 1, "a re-armed fd that is still readable should deliver another event");
+
+   ::close(fds[0]);
+   ::close(fds[1]);
+
+   const int unregisteredFD = Socket::createSocket();
+   requireFalse(server.rearmFileDescriptorForRead(unregisteredFD), "re-arming an fd that was never registered should fail");
+   ::close(unregisteredFD);
+}
+
+//******************************************************************************
+
+void TestEpollServer::testListenBacklog() {
+   TEST_CASE("testListenBacklog");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   EpollServer server(fdMutex, hwmMutex);
+
+   require(SOMAXCONN == server.getListenBacklog(), "listen backlog should default to SOMAXCONN");
+   server.setListenBacklog(512);
+   require(512 == server.getListenBacklog(), "getListenBacklog should reflect setListenBacklog");
+   require(server.init(new NoOpSocketServiceHandler(), 44757, 10), "init should succeed with a configured backlog");
+}
+
+//******************************************************************************
+
+void TestEpollServer::testAcceptConnectionsDrainsBacklog() {
+   TEST_CASE("testAcceptConnectionsDrainsBacklog");
+
+   const int port = 44758;
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   AcceptingEpollServer server(fdMutex, hwmMutex);
+   require(server.init(new NoOpSocketServiceHandler(), port, 10), "sanity check: init should succeed");
+
+   // the kernel completes these handshakes into the listen backlog
+   // without anyone calling accept()
+   Socket firstClient("127.0.0.1", port);
+   Socket secondClient("127.0.0.1", port);
+   Socket thirdClient("127.0.0.1", port);
+
+   require(3 == server.acceptConnections(), "one pass should accept every pending connection");
+   require(3 == server.getNumberAcceptedConnections(), "accepted connection counter should count each connection");
+   require(1 == server.getNumberAcceptBatches(), "accept batch counter should count the pass");
+   require(0 == server.getNumberAcceptFailures(), "draining an empty backlog should not count as a failure");
+
+   // the listener is non-blocking, so an empty backlog returns right away
+   require(0 == server.acceptConnections(), "a pass with nothing pending should accept nothing (and not block)");
+   require(2 == server.getNumberAcceptBatches(), "every pass should be counted");
+}
+
+//******************************************************************************
+
+void TestEpollServer::testIdleConnectionExpiry() {
+   TEST_CASE("testIdleConnectionExpiry");
+
+   const int port = 44759;
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   AcceptingEpollServer server(fdMutex, hwmMutex);
+
+   require(0 == server.getIdleTimeout(), "idle timeout should default to disabled");
+   server.setIdleTimeout(3);
+   require(3 == server.getIdleTimeout(), "getIdleTimeout should reflect setIdleTimeout");
+   require(server.init(new NoOpSocketServiceHandler(), port, 10), "sanity check: init should succeed");
+   require(-1 != server.getIdleTimerFileDescriptor(), "an idle timeout should create the idle timer");
+
+   Socket firstClient("127.0.0.1", port);
+   Socket secondClient("127.0.0.1", port);
+   require(2 == server.acceptConnections(), "sanity check: both connections should be accepted");
+
+   require(0 == server.expireIdleConnections(2), "connections should not be closed before the timeout");
+   require(2 == server.expireIdleConnections(1), "connections idle for the timeout should be closed");
+   require(2 == server.getNumberIdleConnectionsClosed(), "idle close counter should count each connection");
+
+   char buffer[1];
+   require(0 == ::recv(firstClient.getFileDescriptor(), buffer, sizeof(buffer), MSG_DONTWAIT),
+           "client should see the server end closed");
+
+   require(0 == server.expireIdleConnections(10), "closed connections should not be expired again");
+}
+
+//******************************************************************************
+
+void TestEpollServer::testStaleEventTag() {
+   TEST_CASE("testStaleEventTag");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   AcceptingEpollServer server(fdMutex, hwmMutex);
+   require(server.init(new NoOpSocketServiceHandler(), 44749, 10), "sanity check: init should succeed");
+
+   int fds[2];
+   require(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "sanity check: socketpair should succeed");
+
+   const std::uint64_t tag = server.getEventTag(fds[0]);
+   require(fds[0] == (int) (std::uint32_t) tag, "event tag should carry the fd in its low bits");
+   require(server.isCurrentEventTag(tag), "a fresh tag should be current");
+
+   require(server.addFileDescriptorForOneShotRead(fds[0]), "sanity check: registration should succeed");
+   require(::write(fds[1], "x", 1) == 1, "sanity check: write should succeed");
+   require(server.getKernelEvents(10) == 1, "sanity check: the readable fd should deliver an event");
+   require(server.eventTagForEventIndex(0) == tag, "event should carry the tag the fd was registered with");
+
+   // as if the connection were closed and the fd number handed to another
+   server.removeBusyFD(fds[0]);
+   requireFalse(server.isCurrentEventTag(server.eventTagForEventIndex(0)), "event for a reset fd should be stale");
+   require(server.isCurrentEventTag(server.getEventTag(fds[0])), "the new connection's tag should be current");
+
+   ::close(fds[0]);
+   ::close(fds[1]);
+}
+
+//******************************************************************************
+
+void TestEpollServer::testAsyncWriteFlush() {
+   TEST_CASE("testAsyncWriteFlush");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   AcceptingEpollServer server(fdMutex, hwmMutex);
+   require(server.init(new NoOpSocketServiceHandler(), 44748, 10), "sanity check: init should succeed");
+   require(server.isAsyncWriteSupported(), "epoll should support asynchronous writes");
+
+   int fds[2];
+   require(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "sanity check: socketpair should succeed");
+   const int fd = fds[0];
+
+   // the same steps the event loop takes up to handing a request to a worker
+   require(server.armFileDescriptorForRead(fd), "sanity check: arming for read should succeed");
+   require(::write(fds[1], "x", 1) == 1, "sanity check: write should succeed");
+   require(server.getKernelEvents(10) == 1, "sanity check: request should be readable");
+   server.disarmFileDescriptorForRead(fd);
+   server.setBusyFD(fd, true);
+
+   // far more than the socket buffers hold, so most of it is queued
+   std::string payload(4 * 1024 * 1024, 'a');
+   for (std::size_t i = 0; i < payload.size(); i += 4096) {
+      payload[i] = (char) ('a' + (i / 4096) % 26);
+   }
+
+   require(server.writeAsync(fd, payload.data(), payload.size()), "writeAsync should accept the output");
+   require(1 == server.getNumberDeferredWrites(), "output the socket couldn't take should be deferred");
+
+   // the worker completing the request
+   require(server.armFileDescriptorForWrite(fd), "arming for write should succeed");
+   require(server.getInterestState(fd) == ConnectionStateTable::InterestState::WriteArmed, "fd should be write armed");
+
+   std::string received;
+   char buffer[65536];
+   int iterations = 0;
+
+   while (server.isBusyFD(fd) && iterations++ < 10000) {
+      ssize_t bytesRead;
+      while ((bytesRead = ::recv(fds[1], buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+         received.append(buffer, bytesRead);
+      }
+
+      require(server.getKernelEvents(10) == 1, "write armed fd should report writability");
+      server.handleWriteEvent(fd);
+   }
+
+   ssize_t bytesRead;
+   while ((bytesRead = ::recv(fds[1], buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+      received.append(buffer, bytesRead);
+   }
+
+   requireFalse(server.isBusyFD(fd), "request should complete once the output is sent");
+   require(received == payload, "peer should receive all of the output, in order");
+   require(server.getInterestState(fd) == ConnectionStateTable::InterestState::Armed, "fd should be back to waiting for a request");
+
+   ::close(fds[0]);
+   ::close(fds[1]);
+}
+
+//******************************************************************************
+
+void TestEpollServer::testDroppedRequestClosesConnection() {
+   TEST_CASE("testDroppedRequestClosesConnection");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   AcceptingEpollServer server(fdMutex, hwmMutex);
+   require(server.init(new NoOpSocketServiceHandler(), 44747, 10), "sanity check: init should succeed");
+
+   int fds[2];
+   require(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "sanity check: socketpair should succeed");
+   const int fd = fds[0];
+
+   // the same steps the event loop takes up to handing a request to a worker
+   require(server.armFileDescriptorForRead(fd), "sanity check: arming for read should succeed");
+   require(::write(fds[1], "x", 1) == 1, "sanity check: write should succeed");
+   require(server.getKernelEvents(10) == 1, "sanity check: request should be readable");
+   server.disarmFileDescriptorForRead(fd);
+   server.setBusyFD(fd, true);
+
+   SocketRequest* request = SocketRequest::create(&server, fd, nullptr);
+   request->setDeadline(1);   // long gone
+
+   PthreadsThreadingFactory tf;
+   ThreadPoolQueue tpq(&tf);
+   LiveRunnable live;
+   require(tpq.addRequest(request), "sanity check: expired request should be queued");
+   require(tpq.addRequest(&live), "sanity check: live request should be queued");
+
+   TakeRequestContext ctx;
+   tpq.takeRequest(ctx);
+   require(&live == ctx.runnable, "expired request should be dropped at take time");
+   require(1 == tpq.getNumberExpiredRequests(), "sanity check: expired request should be counted");
+   SocketRequest::recycle(request);
+
+   requireFalse(server.isBusyFD(fd), "dropped request's fd should no longer be busy");
+   require(::fcntl(fd, F_GETFD) == -1, "dropped request's fd should be closed");
+
+   // (a reset rather than an orderly close, as the request went unread)
+   char buffer[1];
+   const ssize_t bytesRead = ::recv(fds[1], buffer, sizeof(buffer), MSG_DONTWAIT);
+   require((0 == bytesRead) || ((-1 == bytesRead) && (ECONNRESET == errno)),
+           "peer should see the server end closed");
+
+   ::close(fds[1]);
+}
+
+//******************************************************************************
+
+void TestEpollServer::testStopEndsRun() {
+   TEST_CASE("testStopEndsRun");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   EpollServer server(fdMutex, hwmMutex);
+   require(server.init(new NoOpSocketServiceHandler(), 44746, 10), "sanity check: init should succeed");
+
+   RunLoopRunnable runLoopRunnable(server);
+   PthreadsThread runLoopThread(&runLoopRunnable);
+   require(runLoopThread.start(), "sanity check: starting the event loop thread should succeed");
+
+   // give the loop a moment to block in epoll_wait()
+   Thread::sleep(50);
+
+   // the loop is waiting with no timeout, so only the wakeup gets it out
+   server.stop();
+   runLoopThread.join();
+   require(true, "stop should make run return");
+
+   // a stop that comes before run() starts isn't lost
+   EpollServer stoppedServer(fdMutex, hwmMutex);
+   require(stoppedServer.init(new NoOpSocketServiceHandler(), 44745, 10), "sanity check: init should succeed");
+   stoppedServer.stop();
+   stoppedServer.run();
+   require(true, "run should return right away after stop");
+}
+
+//******************************************************************************
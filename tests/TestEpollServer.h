@@ -22,6 +22,15 @@ protected:
    void testAddFileDescriptorForRead();
    void testRemoveFileDescriptorFromRead();
    void testGetKernelEventsAndEventAccessors();
+   void testInitWithReusePort();
+   void testOneShotReadAndRearm();
+   void testListenBacklog();
+   void testAcceptConnectionsDrainsBacklog();
+   void testIdleConnectionExpiry();
+   void testStaleEventTag();
+   void testAsyncWriteFlush();
+   void testDroppedRequestClosesConnection();
+   void testStopEndsRun();
 
 public:
    TestEpollServer();
@@ -0,0 +1,105 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "TestEventLoopStats.h"
+#include "EventLoopStats.h"
+#include "SocketRequest.h"
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+TestEventLoopStats::TestEventLoopStats() :
+   poivre::TestSuite("TestEventLoopStats") {
+}
+
+//******************************************************************************
+
+void TestEventLoopStats::runTests() {
+   testRecordWake();
+   testRecordBatchTime();
+   testCountBranch();
+   testDispatchLatency();
+}
+
+//******************************************************************************
+
+void TestEventLoopStats::testRecordWake() {
+   TEST_CASE("testRecordWake");
+
+   EventLoopStats stats;
+   stats.recordWake(1);
+   stats.recordWake(8);
+   stats.recordWake(8);
+
+   EventLoopStats::Snapshot snapshot;
+   stats.snapshot(snapshot);
+
+   require(3 == snapshot.eventsPerWake.count, "each wake should be recorded");
+   require(17 == snapshot.eventsPerWake.sum, "events per wake should add up");
+   require(8 == snapshot.eventsPerWake.max, "largest batch of events should be the max");
+}
+
+//******************************************************************************
+
+void TestEventLoopStats::testRecordBatchTime() {
+   TEST_CASE("testRecordBatchTime");
+
+   EventLoopStats stats;
+   const std::uint64_t startTime = EventLoopStats::now();
+   const std::uint64_t endTime = EventLoopStats::now();
+   require(endTime >= startTime, "now should be monotonic");
+
+   stats.recordBatchTime(1500);
+
+   EventLoopStats::Snapshot snapshot;
+   stats.snapshot(snapshot);
+
+   require(1 == snapshot.batchTime.count, "batch time should be recorded");
+   require(1500 == snapshot.batchTime.max, "batch time should be kept in nanoseconds");
+   require(0 == snapshot.dispatchLatency.count, "batch time shouldn't be counted as dispatch latency");
+}
+
+//******************************************************************************
+
+void TestEventLoopStats::testCountBranch() {
+   TEST_CASE("testCountBranch");
+
+   EventLoopStats stats;
+   stats.countBranch(EventLoopStats::Branch::Accept);
+   stats.countBranch(EventLoopStats::Branch::Read);
+   stats.countBranch(EventLoopStats::Branch::Read);
+   stats.countBranch(EventLoopStats::Branch::Disconnect);
+
+   EventLoopStats::Snapshot snapshot;
+   stats.snapshot(snapshot);
+
+   require(1 == snapshot.getBranchCount(EventLoopStats::Branch::Accept), "accept branch should be counted");
+   require(2 == snapshot.getBranchCount(EventLoopStats::Branch::Read), "read branch should be counted");
+   require(1 == snapshot.getBranchCount(EventLoopStats::Branch::Disconnect), "disconnect branch should be counted");
+   require(0 == snapshot.getBranchCount(EventLoopStats::Branch::ReadClose), "branches not taken should stay at 0");
+   require(0 == snapshot.getBranchCount(EventLoopStats::Branch::StaleEvent), "branches not taken should stay at 0");
+}
+
+//******************************************************************************
+
+void TestEventLoopStats::testDispatchLatency() {
+   TEST_CASE("testDispatchLatency");
+
+   EventLoopStats stats;
+
+   // a request created by a kernel event server records how long it took
+   // to get from its event being returned to its handler starting
+   SocketRequest socketRequest(nullptr, -1, nullptr);
+   socketRequest.setDispatchStats(&stats, EventLoopStats::now());
+   socketRequest.notifyOnStart();
+   socketRequest.notifyOnStart();
+
+   EventLoopStats::Snapshot snapshot;
+   stats.snapshot(snapshot);
+
+   require(1 == snapshot.dispatchLatency.count, "a request's dispatch latency should be recorded once, when it starts");
+   require(snapshot.dispatchLatency.max < 1000000000ULL, "dispatch latency should be measured from the ready time");
+}
+
+//******************************************************************************
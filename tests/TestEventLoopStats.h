@@ -0,0 +1,29 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTEVENTLOOPSTATS_H
+#define CHAUDIERE_TESTEVENTLOOPSTATS_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestEventLoopStats : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testRecordWake();
+   void testRecordBatchTime();
+   void testCountBranch();
+   void testDispatchLatency();
+
+public:
+   TestEventLoopStats();
+
+};
+
+}
+
+#endif
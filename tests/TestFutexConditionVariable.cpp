@@ -0,0 +1,272 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "TestFutexConditionVariable.h"
+#include "FutexConditionVariable.h"
+#include "FutexMutex.h"
+#include "PthreadsThread.h"
+#include "StdMutex.h"
+#include "Runnable.h"
+#include "Thread.h"
+
+using namespace chaudiere;
+
+namespace {
+
+struct SharedState {
+   FutexMutex mutex;
+   FutexConditionVariable cv;
+   bool ready;
+   bool notified;
+
+   SharedState() : mutex("waitMutex"), ready(false), notified(false) {}
+};
+
+class WaiterRunnable : public chaudiere::Runnable {
+public:
+   explicit WaiterRunnable(SharedState& state) : m_state(state) {}
+
+   void run() override {
+      m_state.mutex.lock();
+      while (!m_state.ready) {
+         m_state.cv.wait(&m_state.mutex);
+      }
+      m_state.notified = true;
+      m_state.mutex.unlock();
+   }
+
+private:
+   SharedState& m_state;
+};
+
+struct SharedStateAll {
+   FutexMutex mutex;
+   FutexConditionVariable cv;
+   bool ready;
+   std::atomic<int> notifiedCount;
+
+   SharedStateAll() : mutex("waitMutexAll"), ready(false), notifiedCount(0) {}
+};
+
+class WaiterAllRunnable : public chaudiere::Runnable {
+public:
+   explicit WaiterAllRunnable(SharedStateAll& state) : m_state(state) {}
+
+   void run() override {
+      m_state.mutex.lock();
+      while (!m_state.ready) {
+         m_state.cv.wait(&m_state.mutex);
+      }
+      ++m_state.notifiedCount;
+      m_state.mutex.unlock();
+   }
+
+private:
+   SharedStateAll& m_state;
+};
+
+}
+
+//******************************************************************************
+
+TestFutexConditionVariable::TestFutexConditionVariable() :
+   poivre::TestSuite("TestFutexConditionVariable") {
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::runTests() {
+   testConstructor();
+   testConstructorWithName();
+   testGetName();
+   testWaitWithNullMutex();
+   testWaitWithWrongMutexType();
+   testNotifyOneNoWaiters();
+   testWait();
+   testNotifyAll();
+   testNotifyAllRequeuesWaiters();
+   testPingPong();
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::testConstructor() {
+   TEST_CASE("testConstructor");
+
+   FutexConditionVariable cv;
+   require(cv.getName().empty(), "default-constructed condition variable should have an empty name");
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::testConstructorWithName() {
+   TEST_CASE("testConstructorWithName");
+
+   FutexConditionVariable cv("myCondVar");
+   requireStringEquals("myCondVar", cv.getName(), "name should match constructor argument");
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::testGetName() {
+   TEST_CASE("testGetName");
+
+   FutexConditionVariable cv("anotherName");
+   requireStringEquals("anotherName", cv.getName(), "getName should return the constructor-specified name");
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::testWaitWithNullMutex() {
+   TEST_CASE("testWaitWithNullMutex");
+
+   FutexConditionVariable cv;
+   requireFalse(cv.wait(nullptr), "wait with a null mutex should fail");
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::testWaitWithWrongMutexType() {
+   TEST_CASE("testWaitWithWrongMutexType");
+
+   FutexConditionVariable cv;
+   StdMutex wrongTypeMutex;
+   requireFalse(cv.wait(&wrongTypeMutex), "wait should fail when given a mutex that isn't a FutexMutex");
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::testNotifyOneNoWaiters() {
+   TEST_CASE("testNotifyOneNoWaiters");
+
+   FutexConditionVariable cv;
+   cv.notifyOne();
+   require(true, "notifyOne with no waiters should not throw");
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::testWait() {
+   TEST_CASE("testWait");
+
+   SharedState state;
+   WaiterRunnable runnable(state);
+   PthreadsThread thread(&runnable);
+   require(thread.start(), "starting the waiter thread should succeed");
+
+   // give the waiter thread a moment to actually reach cv.wait()
+   Thread::sleep(50);
+
+   state.mutex.lock();
+   state.ready = true;
+   state.mutex.unlock();
+   state.cv.notifyOne();
+
+   thread.join();
+   require(state.notified, "the waiting thread should have been woken up and observed ready==true");
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::testNotifyAll() {
+   TEST_CASE("testNotifyAll");
+
+   SharedStateAll state;
+   WaiterAllRunnable r1(state);
+   WaiterAllRunnable r2(state);
+   WaiterAllRunnable r3(state);
+   PthreadsThread t1(&r1);
+   PthreadsThread t2(&r2);
+   PthreadsThread t3(&r3);
+
+   require(t1.start() && t2.start() && t3.start(), "starting all three waiter threads should succeed");
+
+   Thread::sleep(50);
+
+   state.mutex.lock();
+   state.ready = true;
+   state.mutex.unlock();
+   state.cv.notifyAll();
+
+   t1.join();
+   t2.join();
+   t3.join();
+
+   require(3 == state.notifiedCount.load(), "all three waiting threads should have been woken up by notifyAll");
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::testNotifyAllRequeuesWaiters() {
+   TEST_CASE("testNotifyAllRequeuesWaiters");
+
+   // enough waiters that most of them get requeued onto the mutex, and
+   // each must still be woken (one at a time, as the mutex is released)
+   const int numberWaiters = 16;
+   SharedStateAll state;
+   std::vector<std::thread> waiters;
+
+   for (int i = 0; i < numberWaiters; ++i) {
+      waiters.emplace_back([&state]() {
+         WaiterAllRunnable runnable(state);
+         runnable.run();
+      });
+   }
+
+   Thread::sleep(100);
+
+   state.mutex.lock();
+   state.ready = true;
+   state.cv.notifyAll();
+   state.mutex.unlock();
+
+   for (std::thread& waiter : waiters) {
+      waiter.join();
+   }
+
+   require(numberWaiters == state.notifiedCount.load(),
+           "every waiting thread should have been woken up by notifyAll");
+   requireFalse(state.mutex.isLocked(), "mutex should be unlocked once every waiter is done");
+}
+
+//******************************************************************************
+
+void TestFutexConditionVariable::testPingPong() {
+   TEST_CASE("testPingPong");
+
+   // two threads take turns, each waiting for the other's notify
+   const int numberTurns = 10000;
+   FutexMutex mutex("pingPong");
+   FutexConditionVariable cv("pingPong");
+   int turn = 0;
+
+   auto player = [&](int parity, bool useNotifyAll) {
+      mutex.lock();
+      while (turn < numberTurns) {
+         if ((turn % 2) == parity) {
+            ++turn;
+            if (useNotifyAll) {
+               cv.notifyAll();
+            } else {
+               cv.notifyOne();
+            }
+         } else {
+            cv.wait(&mutex);
+         }
+      }
+      mutex.unlock();
+   };
+
+   std::thread ping(player, 0, false);
+   std::thread pong(player, 1, true);
+   ping.join();
+   pong.join();
+
+   require(numberTurns == turn, "players should take every turn without a lost wakeup");
+}
+
+//******************************************************************************
@@ -0,0 +1,35 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTFUTEXCONDITIONVARIABLE_H
+#define CHAUDIERE_TESTFUTEXCONDITIONVARIABLE_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestFutexConditionVariable : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testConstructor();
+   void testConstructorWithName();
+   void testGetName();
+   void testWaitWithNullMutex();
+   void testWaitWithWrongMutexType();
+   void testNotifyOneNoWaiters();
+   void testWait();
+   void testNotifyAll();
+   void testNotifyAllRequeuesWaiters();
+   void testPingPong();
+
+public:
+   TestFutexConditionVariable();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <thread>
+#include <vector>
+
+#include "TestFutexMutex.h"
+#include "FutexMutex.h"
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+TestFutexMutex::TestFutexMutex() :
+   poivre::TestSuite("TestFutexMutex") {
+}
+
+//******************************************************************************
+
+void TestFutexMutex::runTests() {
+   testConstructor();
+   testConstructorWithName();
+   testLock();
+   testUnlock();
+   testHaveValidMutex();
+   testGetPlatformPrimitive();
+   testGetName();
+   testIsLocked();
+   testUnlockWhenNotLocked();
+   testContention();
+}
+
+//******************************************************************************
+
+void TestFutexMutex::testConstructor() {
+   TEST_CASE("testConstructor");
+
+   FutexMutex mutex;
+   require(mutex.haveValidMutex(), "constructor should result in valid mutex");
+}
+
+//******************************************************************************
+
+void TestFutexMutex::testConstructorWithName() {
+   TEST_CASE("testConstructorWithName");
+
+   FutexMutex mutex("testMutex");
+   require(mutex.haveValidMutex(), "constructor with name should result in valid mutex");
+}
+
+//******************************************************************************
+
+void TestFutexMutex::testLock() {
+   TEST_CASE("testLock");
+
+   FutexMutex mutex;
+   require(mutex.lock(), "should be able to lock");
+   require(mutex.isLocked(), "isLocked should return true");
+}
+
+//******************************************************************************
+
+void TestFutexMutex::testUnlock() {
+   TEST_CASE("testUnlock");
+
+   FutexMutex mutex;
+   require(mutex.lock(), "should be able to lock");
+   require(mutex.isLocked(), "isLocked should return true");
+   require(mutex.unlock(), "should be able to unlock");
+   requireFalse(mutex.isLocked(), "isLocked should return false after unlock");
+}
+
+//******************************************************************************
+
+void TestFutexMutex::testHaveValidMutex() {
+   TEST_CASE("testHaveValidMutex");
+
+   FutexMutex mutex;
+   require(mutex.haveValidMutex(), "constructor should result in valid mutex");
+}
+
+//******************************************************************************
+
+void TestFutexMutex::testGetPlatformPrimitive() {
+   TEST_CASE("testGetPlatformPrimitive");
+
+   FutexMutex mutex;
+   require(0 == mutex.getPlatformPrimitive().load(), "futex word should start unlocked");
+   mutex.lock();
+   require(1 == mutex.getPlatformPrimitive().load(), "uncontended lock should leave futex word at 1");
+   mutex.unlock();
+   require(0 == mutex.getPlatformPrimitive().load(), "unlock should reset futex word");
+}
+
+//******************************************************************************
+
+void TestFutexMutex::testGetName() {
+   TEST_CASE("testGetName");
+
+   const std::string name = "testMutex";
+   FutexMutex mutex(name);
+   requireStringEquals(name, mutex.getName(), "name should match value given to ctor");
+}
+
+//******************************************************************************
+
+void TestFutexMutex::testIsLocked() {
+   TEST_CASE("testIsLocked");
+
+   FutexMutex mutex;
+   if (mutex.lock()) {
+      require(mutex.isLocked(), "isLock should return true when locked");
+      if (mutex.unlock()) {
+         requireFalse(mutex.isLocked(), "isLock should return false when unlocked");
+      }
+   }
+}
+
+//******************************************************************************
+
+void TestFutexMutex::testUnlockWhenNotLocked() {
+   TEST_CASE("testUnlockWhenNotLocked");
+
+   FutexMutex mutex;
+   requireFalse(mutex.unlock(), "unlock of a mutex that isn't locked should fail");
+   requireFalse(mutex.isLocked(), "failed unlock should leave mutex unlocked");
+   require(mutex.lock(), "mutex should still be usable after a failed unlock");
+   require(mutex.unlock(), "mutex should still be usable after a failed unlock");
+}
+
+//******************************************************************************
+
+void TestFutexMutex::testContention() {
+   TEST_CASE("testContention");
+
+   const int numberThreads = 4;
+   const int numberIncrements = 100000;
+   FutexMutex mutex("contended");
+   long counter = 0;
+   std::vector<std::thread> threads;
+
+   for (int i = 0; i < numberThreads; ++i) {
+      threads.emplace_back([&]() {
+         for (int j = 0; j < numberIncrements; ++j) {
+            mutex.lock();
+            ++counter;
+            mutex.unlock();
+         }
+      });
+   }
+
+   for (std::thread& thread : threads) {
+      thread.join();
+   }
+
+   require(numberThreads * numberIncrements == counter,
+           "mutex should keep every increment of a contended counter");
+   requireFalse(mutex.isLocked(), "mutex should be unlocked once every thread is done");
+   require(mutex.getSpinLimit() > 0, "spin limit should stay positive");
+}
+
+//******************************************************************************
@@ -0,0 +1,36 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTFUTEXMUTEX_H
+#define CHAUDIERE_TESTFUTEXMUTEX_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestFutexMutex : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testConstructor();
+   void testConstructorWithName();
+
+   void testLock();
+   void testUnlock();
+   void testHaveValidMutex();
+   void testGetPlatformPrimitive();
+   void testGetName();
+   void testIsLocked();
+   void testUnlockWhenNotLocked();
+   void testContention();
+
+public:
+   TestFutexMutex();
+
+};
+
+}
+
+#endif
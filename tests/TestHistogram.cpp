@@ -0,0 +1,131 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <thread>
+#include <vector>
+
+#include "TestHistogram.h"
+#include "Histogram.h"
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+TestHistogram::TestHistogram() :
+   poivre::TestSuite("TestHistogram") {
+}
+
+//******************************************************************************
+
+void TestHistogram::runTests() {
+   testBucketForValue();
+   testRecord();
+   testValueAtPercentile();
+   testEmptySnapshot();
+   testConcurrentRecord();
+}
+
+//******************************************************************************
+
+void TestHistogram::testBucketForValue() {
+   TEST_CASE("testBucketForValue");
+
+   require(0 == Histogram::bucketForValue(0), "0 should have a bucket of its own");
+   require(1 == Histogram::bucketForValue(1), "1 should be in bucket 1");
+   require(2 == Histogram::bucketForValue(2), "2 should be in bucket 2");
+   require(2 == Histogram::bucketForValue(3), "3 should share bucket 2 with 2");
+   require(3 == Histogram::bucketForValue(4), "4 should start bucket 3");
+   require(64 == Histogram::bucketForValue(UINT64_MAX), "the largest value should be in the last bucket");
+
+   require(3 == Histogram::bucketUpperBound(2), "bucket 2 should top out at 3");
+   require(UINT64_MAX == Histogram::bucketUpperBound(64), "the last bucket should top out at the largest value");
+}
+
+//******************************************************************************
+
+void TestHistogram::testRecord() {
+   TEST_CASE("testRecord");
+
+   Histogram histogram;
+   histogram.record(0);
+   histogram.record(5);
+   histogram.record(6);
+   histogram.record(100);
+
+   Histogram::Snapshot snapshot;
+   histogram.snapshot(snapshot);
+
+   require(4 == snapshot.count, "count should reflect every recorded sample");
+   require(111 == snapshot.sum, "sum should add up the recorded samples");
+   require(100 == snapshot.max, "max should be the largest recorded sample");
+   require(1 == snapshot.buckets[0], "0 should be counted in bucket 0");
+   require(2 == snapshot.buckets[3], "5 and 6 should be counted in bucket 3");
+   require(1 == snapshot.buckets[7], "100 should be counted in bucket 7");
+   require(snapshot.mean() > 27.7 && snapshot.mean() < 27.8, "mean should be sum over count");
+}
+
+//******************************************************************************
+
+void TestHistogram::testValueAtPercentile() {
+   TEST_CASE("testValueAtPercentile");
+
+   Histogram histogram;
+   for (int i = 0; i < 99; ++i) {
+      histogram.record(10);
+   }
+   histogram.record(5000);
+
+   Histogram::Snapshot snapshot;
+   histogram.snapshot(snapshot);
+
+   require(15 == snapshot.valueAtPercentile(50.0), "median should be the top of the bucket holding 10");
+   require(15 == snapshot.valueAtPercentile(99.0), "p99 should still be in the bucket holding 10");
+   require(5000 == snapshot.valueAtPercentile(100.0), "p100 should be capped at the max sample");
+}
+
+//******************************************************************************
+
+void TestHistogram::testEmptySnapshot() {
+   TEST_CASE("testEmptySnapshot");
+
+   Histogram histogram;
+   Histogram::Snapshot snapshot;
+   histogram.snapshot(snapshot);
+
+   require(0 == snapshot.count, "new histogram should have no samples");
+   require(0 == snapshot.valueAtPercentile(99.0), "percentile of an empty histogram should be 0");
+   require(0.0 == snapshot.mean(), "mean of an empty histogram should be 0");
+}
+
+//******************************************************************************
+
+void TestHistogram::testConcurrentRecord() {
+   TEST_CASE("testConcurrentRecord");
+
+   const int numberThreads = 4;
+   const int samplesPerThread = 10000;
+
+   Histogram histogram;
+   std::vector<std::thread> threads;
+
+   for (int t = 0; t < numberThreads; ++t) {
+      threads.push_back(std::thread([&histogram, t]() {
+         for (int i = 0; i < samplesPerThread; ++i) {
+            histogram.record(static_cast<std::uint64_t>(t + 1));
+         }
+      }));
+   }
+
+   for (std::thread& thread : threads) {
+      thread.join();
+   }
+
+   Histogram::Snapshot snapshot;
+   histogram.snapshot(snapshot);
+
+   require(numberThreads * samplesPerThread == (int) snapshot.count, "no sample should be lost to concurrent recording");
+   require(4 == snapshot.max, "max should be the largest sample from any thread");
+   require(samplesPerThread == (int) snapshot.buckets[1], "bucket counts should be exact after concurrent recording");
+}
+
+//******************************************************************************
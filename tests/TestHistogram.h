@@ -0,0 +1,30 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTHISTOGRAM_H
+#define CHAUDIERE_TESTHISTOGRAM_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestHistogram : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testBucketForValue();
+   void testRecord();
+   void testValueAtPercentile();
+   void testEmptySnapshot();
+   void testConcurrentRecord();
+
+public:
+   TestHistogram();
+
+};
+
+}
+
+#endif
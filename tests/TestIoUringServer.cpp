@@ -0,0 +1,173 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "TestIoUringServer.h"
+#include "IoUringServer.h"
+#include "PthreadsMutex.h"
+#include "SocketServiceHandler.h"
+#include "SocketRequest.h"
+#include "Socket.h"
+
+using namespace chaudiere;
+
+namespace {
+
+// Unused by these tests directly, but required to init an IoUringServer.
+class NoOpSocketServiceHandler : public chaudiere::SocketServiceHandler {
+public:
+   void serviceSocket(chaudiere::SocketRequest*) override {
+   }
+
+   const std::string& getName() const override {
+      static const std::string name = "NoOpSocketServiceHandler";
+      return name;
+   }
+};
+
+}
+
+//******************************************************************************
+
+TestIoUringServer::TestIoUringServer() :
+   poivre::TestSuite("TestIoUringServer") {
+}
+
+//******************************************************************************
+
+void TestIoUringServer::runTests() {
+   testIsSupportedPlatform();
+   testConstructor();
+   testInitWithNullHandler();
+
+   // io_uring may be compiled in but disabled at runtime (old kernel,
+   // kernel.io_uring_disabled, seccomp), in which case there's no ring
+   // to exercise
+   if (IoUringServer::isSupportedPlatform()) {
+      testInit();
+      testListenerEvent();
+      testOneShotReadAndRearm();
+      testReadCloseEvent();
+   }
+}
+
+//******************************************************************************
+
+void TestIoUringServer::testIsSupportedPlatform() {
+   TEST_CASE("testIsSupportedPlatform");
+
+   // the probe is cached, so asking twice must give the same answer
+   require(IoUringServer::isSupportedPlatform() == IoUringServer::isSupportedPlatform(), "isSupportedPlatform should be stable");
+}
+
+//******************************************************************************
+
+void TestIoUringServer::testConstructor() {
+   TEST_CASE("testConstructor");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   IoUringServer server(fdMutex, hwmMutex);
+   require(true, "constructing an IoUringServer should not throw, even without io_uring support");
+}
+
+//******************************************************************************
+
+void TestIoUringServer::testInitWithNullHandler() {
+   TEST_CASE("testInitWithNullHandler");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   IoUringServer server(fdMutex, hwmMutex);
+
+   requireFalse(server.init(nullptr, 44760, 10), "init should fail when given a null socket service handler");
+}
+
+//******************************************************************************
+
+void TestIoUringServer::testInit() {
+   TEST_CASE("testInit");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   IoUringServer server(fdMutex, hwmMutex);
+
+   require(server.init(new NoOpSocketServiceHandler(), 44761, 10), "init should succeed with a valid handler, port, and connection limit");
+   require(server.isOneShotSupported(), "io_uring should support one-shot registration");
+}
+
+//******************************************************************************
+
+void TestIoUringServer::testListenerEvent() {
+   TEST_CASE("testListenerEvent");
+
+   const int port = 44762;
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   IoUringServer server(fdMutex, hwmMutex);
+   require(server.init(new NoOpSocketServiceHandler(), port, 10), "sanity check: init should succeed");
+
+   // the connection is queued on the listener before we wait, so the
+   // wait can't block
+   Socket clientSocket("127.0.0.1", port);
+
+   require(server.getKernelEvents(10) == 1, "a pending connection should produce one listener event");
+   require(server.isEventRead(0), "the listener becoming accept-ready should be reported as a read event");
+   requireFalse(server.isEventDisconnect(0), "a listener read event should not be reported as a disconnect");
+   requireFalse(server.isEventReadClose(0), "a listener read event should not be reported as a read-close");
+}
+
+//******************************************************************************
+
+void TestIoUringServer::testOneShotReadAndRearm() {
+   TEST_CASE("testOneShotReadAndRearm");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   IoUringServer server(fdMutex, hwmMutex);
+   require(server.init(new NoOpSocketServiceHandler(), 44763, 10), "sanity check: init should succeed");
+
+   int fds[2];
+   require(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "sanity check: socketpair should succeed");
+
+   require(server.addFileDescriptorForOneShotRead(fds[0]), "addFileDescriptorForOneShotRead should succeed");
+   require(::write(fds[1], "x", 1) == 1, "sanity check: write should succeed");
+
+   require(server.getKernelEvents(10) == 1, "a readable fd should deliver one event");
+   require(server.fileDescriptorForEventIndex(0) == fds[0], "event should be for the registered fd");
+   require(server.isEventRead(0), "event should be a read event");
+
+   // the data is left unread; the re-armed poll completes right away
+   require(server.rearmFileDescriptorForRead(fds[0]), "rearmFileDescriptorForRead should succeed");
+   require(server.getKernelEvents(10) == 1, "a re-armed fd that is still readable should deliver another event");
+   require(server.fileDescriptorForEventIndex(0) == fds[0], "re-armed event should be for the registered fd");
+
+   ::close(fds[0]);
+   ::close(fds[1]);
+}
+
+//******************************************************************************
+
+void TestIoUringServer::testReadCloseEvent() {
+   TEST_CASE("testReadCloseEvent");
+
+   PthreadsMutex fdMutex("fdMutex");
+   PthreadsMutex hwmMutex("hwmMutex");
+   IoUringServer server(fdMutex, hwmMutex);
+   require(server.init(new NoOpSocketServiceHandler(), 44764, 10), "sanity check: init should succeed");
+
+   int fds[2];
+   require(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "sanity check: socketpair should succeed");
+
+   require(server.addFileDescriptorForOneShotRead(fds[0]), "addFileDescriptorForOneShotRead should succeed");
+   ::close(fds[1]);
+
+   require(server.getKernelEvents(10) == 1, "the peer closing should deliver one event");
+   require(server.isEventReadClose(0), "the peer closing should be reported as a read-close");
+
+   ::close(fds[0]);
+}
+
+//******************************************************************************
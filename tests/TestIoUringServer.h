@@ -0,0 +1,32 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTIOURINGSERVER_H
+#define CHAUDIERE_TESTIOURINGSERVER_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestIoUringServer : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testIsSupportedPlatform();
+   void testConstructor();
+   void testInitWithNullHandler();
+   void testInit();
+   void testListenerEvent();
+   void testOneShotReadAndRearm();
+   void testReadCloseEvent();
+
+public:
+   TestIoUringServer();
+
+};
+
+}
+
+#endif
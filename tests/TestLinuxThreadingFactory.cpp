@@ -0,0 +1,136 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <thread>
+
+#include "TestLinuxThreadingFactory.h"
+#include "LinuxThreadingFactory.h"
+#include "FutexMutex.h"
+#include "FutexConditionVariable.h"
+#include "Thread.h"
+#include "ThreadPoolDispatcher.h"
+#include "Runnable.h"
+
+using namespace chaudiere;
+
+namespace {
+
+class DoNothingRunnable : public chaudiere::Runnable {
+public:
+   void run() override {
+   }
+};
+
+}
+
+//******************************************************************************
+
+TestLinuxThreadingFactory::TestLinuxThreadingFactory() :
+   poivre::TestSuite("TestLinuxThreadingFactory") {
+}
+
+//******************************************************************************
+
+void TestLinuxThreadingFactory::runTests() {
+   testCreateMutex();
+   testCreateThreadWithName();
+   testCreateThreadWithRunnable();
+   testCreateConditionVariable();
+   testCreateThreadPoolDispatcher();
+   testThreadPoolRunsRequests();
+}
+
+//******************************************************************************
+
+void TestLinuxThreadingFactory::testCreateMutex() {
+   TEST_CASE("testCreateMutex");
+
+   LinuxThreadingFactory factory;
+   Mutex* mutex = factory.createMutex("myMutex");
+   require(nullptr != mutex, "createMutex should return a non-null Mutex");
+   require(mutex->haveValidMutex(), "created mutex should be valid");
+   require(nullptr != dynamic_cast<FutexMutex*>(mutex), "created mutex should be a FutexMutex");
+   requireStringEquals("myMutex", mutex->getName(), "created mutex should have the given name");
+   delete mutex;
+}
+
+//******************************************************************************
+
+void TestLinuxThreadingFactory::testCreateThreadWithName() {
+   TEST_CASE("testCreateThreadWithName");
+
+   LinuxThreadingFactory factory;
+   Thread* thread = factory.createThread("myThread");
+   require(nullptr != thread, "createThread(name) should return a non-null Thread");
+   require(nullptr == thread->getRunnable(), "a thread created without a runnable should have none");
+   delete thread;
+}
+
+//******************************************************************************
+
+void TestLinuxThreadingFactory::testCreateThreadWithRunnable() {
+   TEST_CASE("testCreateThreadWithRunnable");
+
+   LinuxThreadingFactory factory;
+   DoNothingRunnable runnable;
+   Thread* thread = factory.createThread(&runnable, "myThread");
+   require(nullptr != thread, "createThread(runnable, name) should return a non-null Thread");
+   require(&runnable == thread->getRunnable(), "the created thread should hold the given runnable");
+   delete thread;
+}
+
+//******************************************************************************
+
+void TestLinuxThreadingFactory::testCreateConditionVariable() {
+   TEST_CASE("testCreateConditionVariable");
+
+   LinuxThreadingFactory factory;
+   ConditionVariable* cv = factory.createConditionVariable("myCondVar");
+   require(nullptr != cv, "createConditionVariable should return a non-null ConditionVariable");
+   require(nullptr != dynamic_cast<FutexConditionVariable*>(cv),
+           "created condition variable should be a FutexConditionVariable");
+   delete cv;
+}
+
+//******************************************************************************
+
+void TestLinuxThreadingFactory::testCreateThreadPoolDispatcher() {
+   TEST_CASE("testCreateThreadPoolDispatcher");
+
+   LinuxThreadingFactory factory;
+   ThreadPoolDispatcher* dispatcher = factory.createThreadPoolDispatcher(2, "myPool");
+   require(nullptr != dispatcher, "createThreadPoolDispatcher should return a non-null ThreadPoolDispatcher");
+   delete dispatcher;
+}
+
+//******************************************************************************
+
+void TestLinuxThreadingFactory::testThreadPoolRunsRequests() {
+   TEST_CASE("testThreadPoolRunsRequests");
+
+   // the pool's queue is a BasicThreadPoolQueue<FutexLockPolicy>
+   const int numberRequests = 10000;
+   LinuxThreadingFactory factory;
+   std::atomic<int> counter(0);
+   ThreadPoolDispatcher* dispatcher = factory.createThreadPoolDispatcher(4, "futexPool");
+   int numberAdded = 0;
+
+   for (int i = 0; i < numberRequests; ++i) {
+      if (dispatcher->addRequest([&counter]() { ++counter; })) {
+         ++numberAdded;
+      }
+   }
+
+   require(numberRequests == numberAdded, "pool should accept every request");
+
+   for (int spins = 0; (counter.load() < numberRequests) && (spins < 10000000); ++spins) {
+      std::this_thread::yield();
+   }
+
+   require(numberRequests == counter.load(), "pool should run every request");
+   dispatcher->stop();
+   delete dispatcher;
+}
+
+//******************************************************************************
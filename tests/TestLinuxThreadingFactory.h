@@ -0,0 +1,31 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTLINUXTHREADINGFACTORY_H
+#define CHAUDIERE_TESTLINUXTHREADINGFACTORY_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestLinuxThreadingFactory : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testCreateMutex();
+   void testCreateThreadWithName();
+   void testCreateThreadWithRunnable();
+   void testCreateConditionVariable();
+   void testCreateThreadPoolDispatcher();
+   void testThreadPoolRunsRequests();
+
+public:
+   TestLinuxThreadingFactory();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TestLockProfiler.h"
+#include "LockProfiler.h"
+#include "MutexLock.h"
+#include "FutexMutex.h"
+#include "PthreadsMutex.h"
+
+using namespace chaudiere;
+
+static const LockSiteStats* findStats(const std::vector<LockSiteStats>& allStats,
+                                      const std::string& mutexName,
+                                      const std::string& callSite) {
+   for (const LockSiteStats& stats : allStats) {
+      if ((stats.mutexName == mutexName) && (stats.callSite == callSite)) {
+         return &stats;
+      }
+   }
+
+   return nullptr;
+}
+
+//******************************************************************************
+
+TestLockProfiler::TestLockProfiler() :
+   poivre::TestSuite("TestLockProfiler") {
+}
+
+//******************************************************************************
+
+void TestLockProfiler::runTests() {
+   testDisabledByDefault();
+   testRecordsAcquisitions();
+   testContendedAcquisition();
+   testExitedThreadsAreKept();
+   testReset();
+   testDump();
+
+   LockProfiler::setEnabled(false);
+   LockProfiler::reset();
+}
+
+//******************************************************************************
+
+void TestLockProfiler::testDisabledByDefault() {
+   TEST_CASE("testDisabledByDefault");
+
+   requireFalse(LockProfiler::isEnabled(), "profiling should be off by default");
+
+   PthreadsMutex mutex("unprofiled");
+   {
+      MutexLock lock(mutex, "TestLockProfiler::testDisabledByDefault");
+   }
+
+   require(nullptr == findStats(LockProfiler::getStats(), "unprofiled",
+                                "TestLockProfiler::testDisabledByDefault"),
+           "locks should not be recorded while profiling is off");
+}
+
+//******************************************************************************
+
+void TestLockProfiler::testRecordsAcquisitions() {
+   TEST_CASE("testRecordsAcquisitions");
+
+   LockProfiler::reset();
+   LockProfiler::setEnabled(true);
+
+   FutexMutex mutex("profiled");
+   for (int i = 0; i < 3; ++i) {
+      BasicMutexLock<FutexMutex> lock(mutex, "TestLockProfiler::site");
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+   }
+   {
+      MutexLock lock(mutex);
+   }
+
+   LockProfiler::setEnabled(false);
+
+   const std::vector<LockSiteStats> allStats = LockProfiler::getStats();
+   const LockSiteStats* stats = findStats(allStats, "profiled", "TestLockProfiler::site");
+   require(nullptr != stats, "locks should be recorded under the mutex and call site names");
+   if (stats != nullptr) {
+      require(3 == stats->acquisitions, "each acquisition should be counted");
+      require(0 == stats->contendedAcquisitions, "uncontended locks should not count as contended");
+      require(stats->maxHoldNanos >= 2000000, "max hold should cover the time the lock was held");
+      require(stats->totalHoldNanos >= 6000000, "total hold should add up each hold");
+   }
+
+   const LockSiteStats* unnamed = findStats(allStats, "profiled", "(unnamed)");
+   require(nullptr != unnamed && (1 == unnamed->acquisitions),
+           "a lock without a call site name should be recorded as unnamed");
+}
+
+//******************************************************************************
+
+void TestLockProfiler::testContendedAcquisition() {
+   TEST_CASE("testContendedAcquisition");
+
+   LockProfiler::reset();
+   LockProfiler::setEnabled(true);
+
+   FutexMutex mutex("contended");
+   std::atomic<bool> isHolding(false);
+
+   std::thread holder([&mutex, &isHolding]() {
+      MutexLock lock(mutex, "TestLockProfiler::holder");
+      isHolding = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+   });
+
+   while (!isHolding.load()) {
+      std::this_thread::yield();
+   }
+
+   {
+      MutexLock lock(mutex, "TestLockProfiler::waiter");
+   }
+
+   holder.join();
+   LockProfiler::setEnabled(false);
+
+   const std::vector<LockSiteStats> allStats = LockProfiler::getStats();
+   const LockSiteStats* waiter = findStats(allStats, "contended", "TestLockProfiler::waiter");
+   require(nullptr != waiter, "the waiting lock should be recorded");
+   if (waiter != nullptr) {
+      require(1 == waiter->contendedAcquisitions, "the waiting lock should count as contended");
+      require(waiter->maxWaitNanos >= 5000000, "the wait should be recorded");
+   }
+
+   require(!allStats.empty() && (allStats[0].callSite == "TestLockProfiler::waiter"),
+           "stats should be ordered by total wait");
+}
+
+//******************************************************************************
+
+void TestLockProfiler::testExitedThreadsAreKept() {
+   TEST_CASE("testExitedThreadsAreKept");
+
+   LockProfiler::reset();
+   LockProfiler::setEnabled(true);
+
+   FutexMutex mutex("threads");
+   std::vector<std::thread> threads;
+
+   for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&mutex]() {
+         for (int j = 0; j < 1000; ++j) {
+            MutexLock lock(mutex, "TestLockProfiler::worker");
+         }
+      });
+   }
+
+   for (std::thread& thread : threads) {
+      thread.join();
+   }
+
+   LockProfiler::setEnabled(false);
+
+   const LockSiteStats* stats =
+      findStats(LockProfiler::getStats(), "threads", "TestLockProfiler::worker");
+   require(nullptr != stats && (4000 == stats->acquisitions),
+           "counters of exited threads should be merged");
+}
+
+//******************************************************************************
+
+void TestLockProfiler::testReset() {
+   TEST_CASE("testReset");
+
+   LockProfiler::setEnabled(true);
+
+   FutexMutex mutex("reset");
+   {
+      MutexLock lock(mutex, "TestLockProfiler::testReset");
+   }
+
+   LockProfiler::setEnabled(false);
+   require(nullptr != findStats(LockProfiler::getStats(), "reset", "TestLockProfiler::testReset"),
+           "sanity check: lock should be recorded");
+
+   LockProfiler::reset();
+   require(LockProfiler::getStats().empty(), "reset should clear all counters");
+}
+
+//******************************************************************************
+
+void TestLockProfiler::testDump() {
+   TEST_CASE("testDump");
+
+   LockProfiler::reset();
+   LockProfiler::setEnabled(true);
+
+   FutexMutex mutex("dumped");
+   {
+      MutexLock lock(mutex, "TestLockProfiler::testDump");
+   }
+
+   LockProfiler::setEnabled(false);
+
+   const std::string table = LockProfiler::dump();
+   require(table.find("dumped") != std::string::npos, "dump should list the mutex name");
+   require(table.find("TestLockProfiler::testDump") != std::string::npos,
+           "dump should list the call site");
+}
+
+//******************************************************************************
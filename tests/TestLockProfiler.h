@@ -0,0 +1,31 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTLOCKPROFILER_H
+#define CHAUDIERE_TESTLOCKPROFILER_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestLockProfiler : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testDisabledByDefault();
+   void testRecordsAcquisitions();
+   void testContendedAcquisition();
+   void testExitedThreadsAreKept();
+   void testReset();
+   void testDump();
+
+public:
+   TestLockProfiler();
+
+};
+
+}
+
+#endif
@@ -4,6 +4,8 @@
 #include "TestMutexLock.h"
 #include "MutexLock.h"
 #include "PthreadsMutex.h"
+#include "FutexMutex.h"
+#include "StdMutex.h"
 
 using namespace chaudiere;
 
@@ -21,6 +23,7 @@ void TestMutexLock::runTests() {
    testDestructorUnlocksMutex();
    testUnlock();
    testUnlockThenDestroy();
+   testBasicMutexLock();
 }
 
 //******************************************************************************
@@ -86,3 +89,25 @@ void TestMutexLock::testUnlockThenDestroy() {
 }
 
 //******************************************************************************
+
+void TestMutexLock::testBasicMutexLock() {
+   TEST_CASE("testBasicMutexLock");
+
+   FutexMutex futexMutex;
+   {
+      BasicMutexLock<FutexMutex> lock(futexMutex, "futexLock");
+      require(futexMutex.isLocked(), "a BasicMutexLock<FutexMutex> should lock the mutex");
+      lock.unlock();
+      requireFalse(futexMutex.isLocked(), "unlock() should release the FutexMutex early");
+   }
+   requireFalse(futexMutex.isLocked(), "FutexMutex should remain unlocked after destruction");
+
+   StdMutex stdMutex;
+   {
+      BasicMutexLock<StdMutex> lock(stdMutex);
+      require(stdMutex.isLocked(), "a BasicMutexLock<StdMutex> should lock the mutex");
+   }
+   requireFalse(stdMutex.isLocked(), "StdMutex should be unlocked once the lock goes out of scope");
+}
+
+//******************************************************************************
@@ -19,6 +19,7 @@ protected:
    void testDestructorUnlocksMutex();
    void testUnlock();
    void testUnlockThenDestroy();
+   void testBasicMutexLock();
 
 public:
    TestMutexLock();
@@ -0,0 +1,141 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "TestObjectPool.h"
+#include "ObjectPool.h"
+
+using namespace chaudiere;
+
+namespace {
+
+// each test uses its own type, so that each gets a pool of its own
+template <int N>
+struct PooledObject {
+   int value;
+};
+
+}
+
+//******************************************************************************
+
+TestObjectPool::TestObjectPool() :
+   poivre::TestSuite("TestObjectPool") {
+}
+
+//******************************************************************************
+
+void TestObjectPool::runTests() {
+   testAcquireEmpty();
+   testReleaseAndAcquire();
+   testCrossThreadRelease();
+   testMaxIdle();
+}
+
+//******************************************************************************
+
+void TestObjectPool::testAcquireEmpty() {
+   TEST_CASE("testAcquireEmpty");
+
+   ObjectPool<PooledObject<1>>& pool = ObjectPool<PooledObject<1>>::instance();
+   require(nullptr == pool.acquire(), "empty pool should have nothing to acquire");
+
+   const ObjectPoolStats stats = pool.getStats();
+   require(0 == stats.hits, "empty pool should have no hits");
+   require(1 == stats.misses, "acquire from empty pool should count a miss");
+}
+
+//******************************************************************************
+
+void TestObjectPool::testReleaseAndAcquire() {
+   TEST_CASE("testReleaseAndAcquire");
+
+   ObjectPool<PooledObject<2>>& pool = ObjectPool<PooledObject<2>>::instance();
+   PooledObject<2>* object = new PooledObject<2>;
+   object->value = 42;
+
+   pool.release(object);
+   PooledObject<2>* acquired = pool.acquire();
+
+   require(object == acquired, "acquire should return the object released");
+   require(42 == acquired->value, "pool should not touch the object's state");
+   require(1 == pool.getStats().hits, "acquire of a released object should count a hit");
+   require(nullptr == pool.acquire(), "pool should be empty once its object is taken");
+
+   delete acquired;
+}
+
+//******************************************************************************
+
+void TestObjectPool::testCrossThreadRelease() {
+   TEST_CASE("testCrossThreadRelease");
+
+   typedef PooledObject<3> Object;
+   ObjectPool<Object>& pool = ObjectPool<Object>::instance();
+   const int numberObjects = 100;
+   std::set<Object*> released;
+
+   for (int i = 0; i < numberObjects; ++i) {
+      released.insert(new Object);
+   }
+
+   // release everything on another thread (its cache goes to the depot
+   // when the thread exits)
+   std::thread releaser([&pool, &released]() {
+      for (Object* object : released) {
+         pool.release(object);
+      }
+   });
+   releaser.join();
+
+   std::vector<Object*> acquired;
+   Object* object;
+   while ((object = pool.acquire()) != nullptr) {
+      acquired.push_back(object);
+   }
+
+   require(numberObjects == static_cast<int>(acquired.size()),
+           "objects released on another thread should be acquired here");
+   require(released == std::set<Object*>(acquired.begin(), acquired.end()),
+           "acquired objects should be the ones released");
+   require(numberObjects == static_cast<int>(pool.getStats().hits),
+           "each acquire of a released object should count a hit");
+
+   for (Object* o : acquired) {
+      delete o;
+   }
+}
+
+//******************************************************************************
+
+void TestObjectPool::testMaxIdle() {
+   TEST_CASE("testMaxIdle");
+
+   typedef PooledObject<4> Object;
+   ObjectPool<Object>& pool = ObjectPool<Object>::instance();
+   pool.setMaxIdle(10);
+   const int numberObjects = 100;
+
+   std::thread releaser([&pool]() {
+      for (int i = 0; i < numberObjects; ++i) {
+         pool.release(new Object);
+      }
+   });
+   releaser.join();
+
+   int numberAcquired = 0;
+   Object* object;
+   while ((object = pool.acquire()) != nullptr) {
+      ++numberAcquired;
+      delete object;
+   }
+
+   require(10 == numberAcquired, "depot should keep only max idle objects");
+   require(numberObjects - 10 == static_cast<int>(pool.getStats().discards),
+           "releases beyond max idle should count as discards");
+}
+
+//******************************************************************************
@@ -0,0 +1,29 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTOBJECTPOOL_H
+#define CHAUDIERE_TESTOBJECTPOOL_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestObjectPool : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testAcquireEmpty();
+   void testReleaseAndAcquire();
+   void testCrossThreadRelease();
+   void testMaxIdle();
+
+public:
+   TestObjectPool();
+
+};
+
+}
+
+#endif
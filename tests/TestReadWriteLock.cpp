@@ -0,0 +1,259 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TestReadWriteLock.h"
+#include "PthreadsReadWriteLock.h"
+#include "StdReadWriteLock.h"
+#include "FutexReadWriteLock.h"
+#include "SharedLock.h"
+#include "ExclusiveLock.h"
+#include "PthreadsThreadingFactory.h"
+#include "StdThreadingFactory.h"
+#include "LinuxThreadingFactory.h"
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+TestReadWriteLock::TestReadWriteLock() :
+   poivre::TestSuite("TestReadWriteLock") {
+}
+
+//******************************************************************************
+
+void TestReadWriteLock::runTests() {
+   testConcurrentReaders();
+   testWritersExcludeReaders();
+   testWriterPreference();
+   testSharedLock();
+   testExclusiveLock();
+   testUnlockWhenNotLocked();
+   testCreateReadWriteLock();
+}
+
+//******************************************************************************
+
+template <typename L>
+void TestReadWriteLock::requireConcurrentReaders(const char* lockType) {
+   const std::string type(lockType);
+   L rwLock("readers");
+   std::atomic<bool> otherReaderIn(false);
+
+   require(rwLock.lockShared(), type + ": should be able to lock shared");
+
+   // a second reader gets in while the first still holds the lock
+   std::thread reader([&rwLock, &otherReaderIn]() {
+      rwLock.lockShared();
+      otherReaderIn = true;
+      rwLock.unlockShared();
+   });
+   reader.join();
+
+   require(otherReaderIn.load(), type + ": a second reader should share the lock");
+   require(rwLock.unlockShared(), type + ": should be able to unlock shared");
+   require(rwLock.lockExclusive(), type + ": should be able to lock exclusive once readers leave");
+   require(rwLock.unlockExclusive(), type + ": should be able to unlock exclusive");
+}
+
+//******************************************************************************
+
+template <typename L>
+void TestReadWriteLock::requireWritersExcludeReaders(const char* lockType) {
+   const std::string type(lockType);
+   const int numberThreads = 4;
+   const int numberIterations = 20000;
+   L rwLock("contended");
+   long first = 0;
+   long second = 0;
+   std::atomic<int> numberTornReads(0);
+   std::vector<std::thread> threads;
+
+   for (int i = 0; i < numberThreads; ++i) {
+      threads.emplace_back([&]() {
+         for (int j = 0; j < numberIterations; ++j) {
+            rwLock.lockExclusive();
+            ++first;
+            ++second;
+            rwLock.unlockExclusive();
+         }
+      });
+      threads.emplace_back([&]() {
+         for (int j = 0; j < numberIterations; ++j) {
+            rwLock.lockShared();
+            if (first != second) {
+               ++numberTornReads;
+            }
+            rwLock.unlockShared();
+         }
+      });
+   }
+
+   for (std::thread& thread : threads) {
+      thread.join();
+   }
+
+   require(numberThreads * numberIterations == first, type + ": no write should be lost");
+   require(0 == numberTornReads.load(), type + ": no reader should see a write in progress");
+}
+
+//******************************************************************************
+
+template <typename L>
+void TestReadWriteLock::requireWriterPreference(const char* lockType) {
+   const std::string type(lockType);
+   L rwLock("writerPreferring", ReadWritePreference::Writers);
+   require(ReadWritePreference::Writers == rwLock.getPreference(),
+           type + ": lock should report its preference");
+
+   std::atomic<int> order(0);
+   std::atomic<int> writerOrder(0);
+   std::atomic<int> readerOrder(0);
+
+   rwLock.lockShared();
+
+   std::thread writer([&]() {
+      rwLock.lockExclusive();
+      writerOrder = ++order;
+      rwLock.unlockExclusive();
+   });
+
+   // give the writer time to start waiting behind the first reader
+   std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+   std::thread reader([&]() {
+      rwLock.lockShared();
+      readerOrder = ++order;
+      rwLock.unlockShared();
+   });
+
+   std::this_thread::sleep_for(std::chrono::milliseconds(50));
+   require(0 == readerOrder.load(), type + ": a new reader should wait behind a waiting writer");
+
+   rwLock.unlockShared();
+   writer.join();
+   reader.join();
+
+   require(1 == writerOrder.load(), type + ": the waiting writer should go first");
+   require(2 == readerOrder.load(), type + ": the new reader should follow the writer");
+}
+
+//******************************************************************************
+
+void TestReadWriteLock::testConcurrentReaders() {
+   TEST_CASE("testConcurrentReaders");
+
+   requireConcurrentReaders<PthreadsReadWriteLock>("PthreadsReadWriteLock");
+   requireConcurrentReaders<StdReadWriteLock>("StdReadWriteLock");
+   requireConcurrentReaders<FutexReadWriteLock>("FutexReadWriteLock");
+}
+
+//******************************************************************************
+
+void TestReadWriteLock::testWritersExcludeReaders() {
+   TEST_CASE("testWritersExcludeReaders");
+
+   requireWritersExcludeReaders<PthreadsReadWriteLock>("PthreadsReadWriteLock");
+   requireWritersExcludeReaders<StdReadWriteLock>("StdReadWriteLock");
+   requireWritersExcludeReaders<FutexReadWriteLock>("FutexReadWriteLock");
+}
+
+//******************************************************************************
+
+void TestReadWriteLock::testWriterPreference() {
+   TEST_CASE("testWriterPreference");
+
+#if defined(__GLIBC__)
+   requireWriterPreference<PthreadsReadWriteLock>("PthreadsReadWriteLock");
+#endif
+   requireWriterPreference<StdReadWriteLock>("StdReadWriteLock");
+   requireWriterPreference<FutexReadWriteLock>("FutexReadWriteLock");
+}
+
+//******************************************************************************
+
+void TestReadWriteLock::testSharedLock() {
+   TEST_CASE("testSharedLock");
+
+   FutexReadWriteLock rwLock("shared");
+   {
+      SharedLock first(rwLock);
+      SharedLock second(rwLock, "TestReadWriteLock::testSharedLock");
+      second.unlock();
+   }
+
+   // both shared locks have been released
+   require(rwLock.lockExclusive(), "lock should be free once SharedLocks go out of scope");
+   require(rwLock.unlockExclusive(), "should be able to unlock exclusive");
+}
+
+//******************************************************************************
+
+void TestReadWriteLock::testExclusiveLock() {
+   TEST_CASE("testExclusiveLock");
+
+   StdReadWriteLock rwLock("exclusive");
+   std::atomic<bool> readerIn(false);
+   std::thread reader;
+   {
+      BasicExclusiveLock<StdReadWriteLock> lock(rwLock);
+      reader = std::thread([&rwLock, &readerIn]() {
+         SharedLock shared(rwLock);
+         readerIn = true;
+      });
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      requireFalse(readerIn.load(), "a reader should wait while an ExclusiveLock is held");
+   }
+
+   reader.join();
+   require(readerIn.load(), "the reader should get in once the ExclusiveLock goes out of scope");
+}
+
+//******************************************************************************
+
+void TestReadWriteLock::testUnlockWhenNotLocked() {
+   TEST_CASE("testUnlockWhenNotLocked");
+
+   FutexReadWriteLock rwLock("notLocked");
+   requireFalse(rwLock.unlockShared(), "unlockShared should fail when not locked");
+   requireFalse(rwLock.unlockExclusive(), "unlockExclusive should fail when not locked");
+
+   rwLock.lockShared();
+   requireFalse(rwLock.unlockExclusive(), "unlockExclusive should fail when locked shared");
+   require(rwLock.unlockShared(), "unlockShared should still succeed");
+}
+
+//******************************************************************************
+
+void TestReadWriteLock::testCreateReadWriteLock() {
+   TEST_CASE("testCreateReadWriteLock");
+
+   PthreadsThreadingFactory pthreadsFactory;
+   std::unique_ptr<ReadWriteLock> pthreadsLock(pthreadsFactory.createReadWriteLock("pthreads"));
+   require(nullptr != dynamic_cast<PthreadsReadWriteLock*>(pthreadsLock.get()),
+           "PthreadsThreadingFactory should create a PthreadsReadWriteLock");
+   requireStringEquals("pthreads", pthreadsLock->getName(), "lock should have the given name");
+   require(ReadWritePreference::Readers == pthreadsLock->getPreference(),
+           "locks should prefer readers by default");
+
+   StdThreadingFactory stdFactory;
+   std::unique_ptr<ReadWriteLock> stdLock(
+      stdFactory.createReadWriteLock("std", ReadWritePreference::Writers));
+   require(nullptr != dynamic_cast<StdReadWriteLock*>(stdLock.get()),
+           "StdThreadingFactory should create a StdReadWriteLock");
+   require(ReadWritePreference::Writers == stdLock->getPreference(),
+           "lock should have the given preference");
+
+   LinuxThreadingFactory linuxFactory;
+   std::unique_ptr<ReadWriteLock> futexLock(linuxFactory.createReadWriteLock("futex"));
+   require(nullptr != dynamic_cast<FutexReadWriteLock*>(futexLock.get()),
+           "LinuxThreadingFactory should create a FutexReadWriteLock");
+}
+
+//******************************************************************************
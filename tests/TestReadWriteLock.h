@@ -0,0 +1,39 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTREADWRITELOCK_H
+#define CHAUDIERE_TESTREADWRITELOCK_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestReadWriteLock : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testConcurrentReaders();
+   void testWritersExcludeReaders();
+   void testWriterPreference();
+   void testSharedLock();
+   void testExclusiveLock();
+   void testUnlockWhenNotLocked();
+   void testCreateReadWriteLock();
+
+   template <typename L>
+   void requireConcurrentReaders(const char* lockType);
+   template <typename L>
+   void requireWritersExcludeReaders(const char* lockType);
+   template <typename L>
+   void requireWriterPreference(const char* lockType);
+
+public:
+   TestReadWriteLock();
+
+};
+
+}
+
+#endif
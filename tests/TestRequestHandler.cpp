@@ -1,6 +1,8 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
+#include <cstdint>
+
 #include "TestRequestHandler.h"
 #include "RequestHandler.h"
 #include "Socket.h"
@@ -29,6 +31,19 @@ public:
    }
 };
 
+// A handler with a member that needs more alignment than the pools give.
+class OverAlignedRequestHandler : public chaudiere::RequestHandler {
+public:
+   explicit OverAlignedRequestHandler(chaudiere::Socket* socket) :
+      chaudiere::RequestHandler(socket) {
+   }
+
+   void run() override {
+   }
+
+   alignas(64) unsigned char cacheLine[64];
+};
+
 class RecordingCompletionObserver : public chaudiere::RunCompletionObserver {
 public:
    RecordingCompletionObserver() : notifiedRunnable(nullptr) {}
@@ -71,6 +86,8 @@ void TestRequestHandler::runTests() {
    testIsSocketOwned();
    testSetSocketOwned();
    testNotifyOnCompletion();
+   testPooledStorage();
+   testOverAlignedStorage();
 }
 
 //******************************************************************************
@@ -191,3 +208,40 @@ void TestRequestHandler::testNotifyOnCompletion() {
 }
 
 //******************************************************************************
+
+void TestRequestHandler::testPooledStorage() {
+   TEST_CASE("testPooledStorage");
+
+   ConcreteRequestHandler* handler = new ConcreteRequestHandler(new Socket(-1));
+   void* storage = handler;
+   delete handler;
+
+   const ObjectPoolStats statsBefore = RequestHandler::getPoolStats();
+   handler = new ConcreteRequestHandler(new Socket(-1));
+   const ObjectPoolStats statsAfter = RequestHandler::getPoolStats();
+
+   require(storage == handler, "a new handler should reuse the storage of the one just deleted");
+   require(statsAfter.hits == statsBefore.hits + 1, "reuse should count as a pool hit");
+   require(nullptr != handler->getSocket(), "handler in recycled storage should be constructed normally");
+
+   delete handler;
+}
+
+//******************************************************************************
+
+void TestRequestHandler::testOverAlignedStorage() {
+   TEST_CASE("testOverAlignedStorage");
+
+   const ObjectPoolStats statsBefore = RequestHandler::getPoolStats();
+   OverAlignedRequestHandler* handler = new OverAlignedRequestHandler(new Socket(-1));
+   const ObjectPoolStats statsAfter = RequestHandler::getPoolStats();
+
+   require(0 == reinterpret_cast<std::uintptr_t>(handler) % 64, "an over-aligned handler should get storage aligned for it");
+   require(0 == reinterpret_cast<std::uintptr_t>(handler->cacheLine) % 64, "an over-aligned member should be aligned");
+   require(statsAfter.hits == statsBefore.hits && statsAfter.misses == statsBefore.misses,
+           "an over-aligned handler should not come from the pools");
+
+   delete handler;
+}
+
+//******************************************************************************
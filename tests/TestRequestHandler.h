@@ -22,6 +22,8 @@ protected:
    void testIsSocketOwned();
    void testSetSocketOwned();
    void testNotifyOnCompletion();
+   void testPooledStorage();
+   void testOverAlignedStorage();
 
 public:
    TestRequestHandler();
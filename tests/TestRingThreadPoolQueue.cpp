@@ -0,0 +1,349 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "TestRingThreadPoolQueue.h"
+#include "RingThreadPoolQueue.h"
+#include "PthreadsThreadingFactory.h"
+#include "Thread.h"
+#include "Runnable.h"
+
+using namespace chaudiere;
+
+static PthreadsThreadingFactory tf;
+
+namespace {
+
+class NumberedRunnable : public chaudiere::Runnable {
+public:
+   NumberedRunnable() :
+      m_number(0) {
+   }
+
+   void run() override {
+   }
+
+   int m_number;
+};
+
+// runs producers and consumers against a small ring, and reports whether
+// every request was taken exactly once
+bool isEachRequestTakenOnce(std::size_t spinLimit) {
+   const int numberProducers = 3;
+   const int numberConsumers = 3;
+   const int requestsPerProducer = 50000;
+   const int numberRequests = numberProducers * requestsPerProducer;
+
+   std::vector<NumberedRunnable> runnables(numberRequests);
+   std::vector<std::atomic<int>> timesTaken(numberRequests);
+   for (int i = 0; i < numberRequests; ++i) {
+      runnables[i].m_number = i;
+      timesTaken[i].store(0);
+   }
+
+   // small ring so that producers regularly find it full and park
+   RingThreadPoolQueue queue(&tf, 64);
+   queue.setSpinLimit(spinLimit);
+   std::atomic<int> numberTaken(0);
+
+   std::vector<std::thread> consumers;
+   for (int c = 0; c < numberConsumers; ++c) {
+      consumers.push_back(std::thread([&]() {
+         TakeRequestContext ctx;
+         for (;;) {
+            queue.takeRequest(ctx);
+            if (!ctx.isQueueRunning) {
+               break;
+            }
+            if (nullptr != ctx.runnable) {
+               timesTaken[static_cast<NumberedRunnable*>(ctx.runnable)->m_number]++;
+               numberTaken++;
+            }
+         }
+      }));
+   }
+
+   std::vector<std::thread> producers;
+   for (int p = 0; p < numberProducers; ++p) {
+      producers.push_back(std::thread([&, p]() {
+         for (int i = 0; i < requestsPerProducer; ++i) {
+            queue.addRequest(&runnables[p * requestsPerProducer + i]);
+         }
+      }));
+   }
+
+   for (std::thread& producer : producers) {
+      producer.join();
+   }
+
+   while (numberTaken < numberRequests) {
+      std::this_thread::yield();
+   }
+
+   queue.shutDown();
+   for (std::thread& consumer : consumers) {
+      consumer.join();
+   }
+
+   for (int i = 0; i < numberRequests; ++i) {
+      if (timesTaken[i] != 1) {
+         return false;
+      }
+   }
+
+   return numberRequests == numberTaken;
+}
+
+}
+
+//******************************************************************************
+
+TestRingThreadPoolQueue::TestRingThreadPoolQueue() :
+   poivre::TestSuite("TestRingThreadPoolQueue") {
+}
+
+//******************************************************************************
+
+void TestRingThreadPoolQueue::runTests() {
+   testConstructor();
+   testAddTakeRequest();
+   testAddTakeRequests();
+   testMaxQueueSizeRejectPolicy();
+   testExpiredRequestsDropped();
+   testFullRingBlocks();
+   testShutDownWakesTaker();
+   testConcurrentAddTake();
+   testConcurrentAddTakeSpinning();
+}
+
+//******************************************************************************
+
+void TestRingThreadPoolQueue::testConstructor() {
+   TEST_CASE("testConstructor");
+
+   RingThreadPoolQueue queue(&tf, 100);
+   require(queue.isInitialized(), "should be initialized after construction");
+   require(queue.isRunning(), "should be running after construction");
+   require(queue.isEmpty(), "should be empty after construction");
+   require(128 == queue.getCapacity(), "capacity should be rounded up to a power of 2");
+   require(0 == queue.getMaxQueueSize(), "max queue size should default to 0 (ring capacity)");
+}
+
+//******************************************************************************
+
+void TestRingThreadPoolQueue::testAddTakeRequest() {
+   TEST_CASE("testAddTakeRequest");
+
+   RingThreadPoolQueue queue(&tf, 4);
+   NumberedRunnable a, b, c;
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+
+   queue.takeRequest(ctx);
+   require(nullptr == ctx.runnable, "takeRequest should return nullptr with nothing added");
+   require(ctx.isQueueRunning, "takeRequest should report the queue running");
+
+   require(!queue.addRequest(nullptr), "addRequest should reject nullptr");
+
+   // go around the ring a few times to exercise the wrap
+   for (int lap = 0; lap < 3; ++lap) {
+      require(queue.addRequest(&a), "addRequest should succeed");
+      require(queue.addRequest(&b), "addRequest should succeed");
+      require(queue.addRequest(&c), "addRequest should succeed");
+      require(!queue.isEmpty(), "should not be empty after adding requests");
+
+      queue.takeRequest(ctx);
+      require(&a == ctx.runnable, "takeRequest should return the oldest request (FIFO)");
+      queue.takeRequest(ctx);
+      require(&b == ctx.runnable, "takeRequest should return requests in FIFO order");
+      queue.takeRequest(ctx);
+      require(&c == ctx.runnable, "takeRequest should return requests in FIFO order");
+      require(queue.isEmpty(), "should be empty after taking last request");
+   }
+
+   queue.shutDown();
+   require(!queue.isRunning(), "should not be running after shutDown");
+   require(!queue.addRequest(&a), "addRequest should fail after shutDown");
+   queue.takeRequest(ctx);
+   require(!ctx.isQueueRunning, "takeRequest should report the queue shut down");
+
+   require(queue.restart(), "restart should succeed after shutDown");
+   require(queue.addRequest(&a), "addRequest should succeed after restart");
+}
+
+//******************************************************************************
+
+void TestRingThreadPoolQueue::testAddTakeRequests() {
+   TEST_CASE("testAddTakeRequests");
+
+   RingThreadPoolQueue queue(&tf, 4);
+   NumberedRunnable runnables[6];
+   Runnable* requests[6];
+   for (int i = 0; i < 6; ++i) {
+      runnables[i].m_number = i;
+      requests[i] = &runnables[i];
+   }
+
+   queue.setMaxQueueSize(4, QueueFullPolicy::Reject);
+   require(4 == queue.addRequests(requests), "addRequests should add the prefix of the batch that fits");
+
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+   queue.takeRequests(ctx, 3);
+   require(3 == ctx.runnables.size(), "takeRequests should take no more than maxBatch");
+   require(&runnables[0] == ctx.runnables[0] && &runnables[2] == ctx.runnables[2], "takeRequests should take the oldest requests in order");
+
+   queue.takeRequests(ctx, 3);
+   require(1 == ctx.runnables.size(), "takeRequests should take what's left");
+   require(&runnables[3] == ctx.runnables[0], "takeRequests should continue in FIFO order");
+
+   queue.takeRequests(ctx, 3);
+   require(ctx.runnables.empty(), "takeRequests should take nothing from an empty queue");
+
+   Runnable* withNullptr[] = { &runnables[4], nullptr, &runnables[5] };
+   require(1 == queue.addRequests(withNullptr), "addRequests should stop at a nullptr request");
+}
+
+//******************************************************************************
+
+void TestRingThreadPoolQueue::testMaxQueueSizeRejectPolicy() {
+   TEST_CASE("testMaxQueueSizeRejectPolicy");
+
+   RingThreadPoolQueue queue(&tf, 16);
+   queue.setMaxQueueSize(2, QueueFullPolicy::Reject);
+   require(2 == queue.getMaxQueueSize(), "getMaxQueueSize should reflect what was set");
+
+   NumberedRunnable r1, r2, r3;
+
+   require(queue.addRequest(&r1), "request 1 should be accepted (0 -> 1, max 2)");
+   require(queue.addRequest(&r2), "request 2 should be accepted (1 -> 2, max 2)");
+   require(!queue.addRequest(&r3), "request 3 should be rejected - queue already at max size 2");
+
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+   queue.takeRequest(ctx);
+   require(&r1 == ctx.runnable, "takeRequest should return the oldest request");
+
+   require(queue.addRequest(&r3), "request 3 should now be accepted after a slot freed up");
+
+   // the ring is a single FIFO -- no priority lanes to configure
+   requireFalse(queue.setLaneMaxQueueSize(PriorityClass::Bulk, 1), "ring should refuse lane max sizes");
+   requireFalse(queue.setPriorityScheduling(PriorityScheduling::WeightedRoundRobin), "ring should refuse priority scheduling");
+   requireFalse(queue.setLaneWeight(PriorityClass::Critical, 4), "ring should refuse lane weights");
+   requireFalse(queue.setLoadShedding(1000), "ring should refuse load shedding");
+}
+
+//******************************************************************************
+
+void TestRingThreadPoolQueue::testExpiredRequestsDropped() {
+   TEST_CASE("testExpiredRequestsDropped");
+
+   RingThreadPoolQueue queue(&tf, 8);
+   NumberedRunnable expired, live;
+   expired.setDeadline(1);   // long gone
+
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+
+   queue.addRequest(&expired);
+   queue.addRequest(&live);
+   queue.takeRequest(ctx);
+   require(&live == ctx.runnable, "takeRequest should skip an expired request");
+
+   queue.addRequest(&expired);
+   queue.addRequest(&live);
+   queue.takeRequests(ctx, 4);
+   require(1 == ctx.runnables.size() && &live == ctx.runnables[0], "takeRequests should skip an expired request");
+   require(2 == queue.getNumberExpiredRequests(), "expired requests should be counted");
+   require(queue.isEmpty(), "expired requests should not stay queued");
+}
+
+//******************************************************************************
+
+void TestRingThreadPoolQueue::testFullRingBlocks() {
+   TEST_CASE("testFullRingBlocks");
+
+   // no max size: a full ring blocks the adder rather than dropping
+   RingThreadPoolQueue queue(&tf, 2);
+   NumberedRunnable r1, r2, r3;
+
+   require(queue.addRequest(&r1), "request 1 should be accepted");
+   require(queue.addRequest(&r2), "request 2 should be accepted");
+
+   std::atomic<bool> isAddCompleted(false);
+   std::atomic<bool> addResult(false);
+   std::thread adder([&]() {
+      addResult = queue.addRequest(&r3);
+      isAddCompleted = true;
+   });
+
+   Thread::sleep(200);
+   require(!isAddCompleted, "addRequest for request 3 should still be blocked - ring is full");
+
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+   queue.takeRequest(ctx);
+   require(&r1 == ctx.runnable, "takeRequest should return request 1");
+
+   adder.join();
+   require(addResult, "blocked addRequest should succeed once a slot freed up");
+
+   // and under Block, a blocked adder wakes (and fails) on shutdown
+   queue.setMaxQueueSize(2, QueueFullPolicy::Block);
+   isAddCompleted = false;
+   std::thread blockedAdder([&]() {
+      addResult = queue.addRequest(&r1);
+      isAddCompleted = true;
+   });
+
+   Thread::sleep(200);
+   require(!isAddCompleted, "addRequest should be blocked at max size under Block");
+
+   queue.shutDown();
+   blockedAdder.join();
+   require(!addResult, "blocked addRequest should fail once the queue has shut down");
+}
+
+//******************************************************************************
+
+void TestRingThreadPoolQueue::testShutDownWakesTaker() {
+   TEST_CASE("testShutDownWakesTaker");
+
+   RingThreadPoolQueue queue(&tf, 8);
+   std::atomic<bool> isTakeCompleted(false);
+   TakeRequestContext ctx;
+
+   std::thread taker([&]() {
+      queue.takeRequest(ctx);
+      isTakeCompleted = true;
+   });
+
+   Thread::sleep(200);
+   require(!isTakeCompleted, "takeRequest should be waiting on an empty queue");
+
+   queue.shutDown();
+   taker.join();
+   require(!ctx.isQueueRunning, "woken takeRequest should report the queue shut down");
+   require(nullptr == ctx.runnable, "woken takeRequest should not return a request");
+}
+
+//******************************************************************************
+
+void TestRingThreadPoolQueue::testConcurrentAddTake() {
+   TEST_CASE("testConcurrentAddTake");
+
+   require(isEachRequestTakenOnce(0), "every request should be taken exactly once");
+}
+
+//******************************************************************************
+
+void TestRingThreadPoolQueue::testConcurrentAddTakeSpinning() {
+   TEST_CASE("testConcurrentAddTakeSpinning");
+
+   require(isEachRequestTakenOnce(2000), "every request should be taken exactly once by spinning takers");
+}
+
+//******************************************************************************
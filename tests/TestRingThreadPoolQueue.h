@@ -0,0 +1,34 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTRINGTHREADPOOLQUEUE_H
+#define CHAUDIERE_TESTRINGTHREADPOOLQUEUE_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestRingThreadPoolQueue : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testConstructor();
+   void testAddTakeRequest();
+   void testAddTakeRequests();
+   void testMaxQueueSizeRejectPolicy();
+   void testExpiredRequestsDropped();
+   void testFullRingBlocks();
+   void testShutDownWakesTaker();
+   void testConcurrentAddTake();
+   void testConcurrentAddTakeSpinning();
+
+public:
+   TestRingThreadPoolQueue();
+
+};
+
+}
+
+#endif
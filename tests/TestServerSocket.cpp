@@ -1,6 +1,9 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "TestServerSocket.h"
 #include "ServerSocket.h"
 #include "Socket.h"
@@ -20,6 +23,8 @@ void TestServerSocket::runTests() {
    testConstructor();
    testAccept();
    testClose();
+   testSetReusePort();
+   testSetNonBlocking();
 }
 
 //******************************************************************************
@@ -82,3 +87,40 @@ void TestServerSocket::testClose() {
 }
 
 //******************************************************************************
+
+void TestServerSocket::testSetReusePort() {
+   TEST_CASE("testSetReusePort");
+
+   const int port = 44703;
+   const int firstFD = Socket::createSocket();
+   const int secondFD = Socket::createSocket();
+
+   require(ServerSocket::setReusePort(firstFD), "setReusePort should succeed on a new socket");
+   require(ServerSocket::setReusePort(secondFD), "setReusePort should succeed on a second new socket");
+
+   // with SO_REUSEPORT on both, the second bind to the same port should
+   // succeed rather than failing with EADDRINUSE
+   require(ServerSocket::bind(firstFD, port), "first bind should succeed");
+   require(ServerSocket::listen(firstFD, 10), "first listen should succeed");
+   require(ServerSocket::bind(secondFD, port), "second bind to the same port should succeed with SO_REUSEPORT");
+   require(ServerSocket::listen(secondFD, 10), "second listen should succeed");
+
+   ::close(firstFD);
+   ::close(secondFD);
+}
+
+//******************************************************************************
+
+void TestServerSocket::testSetNonBlocking() {
+   TEST_CASE("testSetNonBlocking");
+
+   const int fd = Socket::createSocket();
+   requireFalse(::fcntl(fd, F_GETFL, 0) & O_NONBLOCK, "a new socket should be blocking");
+   require(ServerSocket::setNonBlocking(fd), "setNonBlocking should succeed on a new socket");
+   require(::fcntl(fd, F_GETFL, 0) & O_NONBLOCK, "socket should be non-blocking after setNonBlocking");
+   ::close(fd);
+
+   requireFalse(ServerSocket::setNonBlocking(-1), "setNonBlocking should fail for an invalid fd");
+}
+
+//******************************************************************************
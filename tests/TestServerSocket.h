@@ -17,6 +17,8 @@ protected:
    void testConstructor();
    void testAccept();
    void testClose();
+   void testSetReusePort();
+   void testSetNonBlocking();
 
 public:
    TestServerSocket();
@@ -44,6 +44,24 @@ public:
    chaudiere::Socket* notifiedSocket;
 };
 
+class AsyncWriteSocketCompletionObserver : public RecordingSocketCompletionObserver {
+public:
+   AsyncWriteSocketCompletionObserver() : socketFD(-1) {}
+
+   bool isAsyncWriteSupported() const override {
+      return true;
+   }
+
+   bool writeAsync(int fd, const char* buffer, std::size_t bufferLength) override {
+      socketFD = fd;
+      written.append(buffer, bufferLength);
+      return true;
+   }
+
+   int socketFD;
+   std::string written;
+};
+
 }
 
 
@@ -336,6 +354,7 @@ void TestSocket::runTests() {
    testSend();
    testWriteWithBuffer();
    testWriteWithString();
+   testWriteAsync();
    testReceive();
    testRead();
    testReadSocket();
@@ -563,6 +582,44 @@ void TestSocket::testWriteWithString() {
 
 //******************************************************************************
 
+void TestSocket::testWriteAsync() {
+   TEST_CASE("testWriteAsync");
+
+   int fds[2];
+   require(0 == ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), "socketpair should succeed");
+
+   // without an observer that takes output, it's a plain write
+   {
+      Socket s(fds[0]);
+      require(s.writeAsync(string("sync")), "writeAsync without an async observer should write");
+      char buffer[8];
+      require(::read(fds[1], buffer, sizeof(buffer)) == 4, "bytes should be written directly");
+      s.releaseFileDescriptor();
+   }
+
+   // an observer that takes output gets the bytes instead
+   AsyncWriteSocketCompletionObserver observer;
+   {
+      Socket s(&observer, fds[0]);
+      require(s.writeAsync(string("async")), "writeAsync should hand output to the observer");
+      require(observer.socketFD == fds[0], "observer should be given the socket's fd");
+      requireStringEquals("async", observer.written);
+
+      // the size prefix has to be queued along with the payload
+      observer.written.clear();
+      s.setIncludeMessageSize(true);
+      require(s.writeAsync(string("abc")), "writeAsync with message size should succeed");
+      require(observer.written.size() == 5, "message size prefix should be included");
+      require(observer.written[0] == 0 && observer.written[1] == 3, "message size prefix should be in network byte order");
+      s.releaseFileDescriptor();
+   }
+
+   ::close(fds[0]);
+   ::close(fds[1]);
+}
+
+//******************************************************************************
+
 void TestSocket::testReceive() {
    TEST_CASE("testReceive");
 
@@ -28,6 +28,7 @@ protected:
    void testSend();
    void testWriteWithBuffer();
    void testWriteWithString();
+   void testWriteAsync();
 
    void testReceive();
    void testRead();
@@ -1,6 +1,9 @@
 // Copyright Paul Dardeau, SwampBits LLC 2014
 // BSD License
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "TestSocketRequest.h"
 #include "SocketRequest.h"
 #include "SocketServiceHandler.h"
@@ -70,6 +73,8 @@ void TestSocketRequest::runTests() {
    testIsSocketOwned();
    testSetSocketOwned();
    testNotifyOnCompletion();
+   testDestructorLeavesUnownedDescriptorOpen();
+   testCreateAndRecycle();
 }
 
 //******************************************************************************
@@ -207,3 +212,65 @@ void TestSocketRequest::testNotifyOnCompletion() {
 }
 
 //******************************************************************************
+
+void TestSocketRequest::testDestructorLeavesUnownedDescriptorOpen() {
+   TEST_CASE("testDestructorLeavesUnownedDescriptorOpen");
+
+   RecordingSocketCompletionObserver observer;
+   const int fd = Socket::createSocket();
+   require(fd != -1, "sanity check: createSocket should succeed");
+
+   SocketRequest* request = new SocketRequest(&observer, fd, nullptr);
+   requireFalse(request->isSocketOwned(), "a request built from a raw fd should not own the socket");
+   delete request;
+
+   // a kernel event server keeps the connection watched across requests,
+   // so the request must not close it on destruction
+   require(::fcntl(fd, F_GETFD) != -1, "destroying an unowned request should leave its fd open");
+
+   ::close(fd);
+}
+
+//******************************************************************************
+
+void TestSocketRequest::testCreateAndRecycle() {
+   TEST_CASE("testCreateAndRecycle");
+
+   RecordingSocketCompletionObserver observer;
+   RecordingSocketServiceHandler handler;
+   const int fd = Socket::createSocket();
+   const int otherFD = Socket::createSocket();
+   require((fd != -1) && (otherFD != -1), "sanity check: createSocket should succeed");
+
+   SocketRequest* request = SocketRequest::create(&observer, fd, &handler);
+   require(fd == request->getSocketFD(), "created request should use the given fd");
+   requireFalse(request->isSocketOwned(), "created request should not own the socket");
+   request->setAutoDelete();
+   request->getSocket()->setUserIndex(7);
+
+   SocketRequest::recycle(request);
+   require(::fcntl(fd, F_GETFD) != -1, "recycling a request should leave its fd open");
+
+   const ObjectPoolStats statsBefore = SocketRequest::getPoolStats();
+   SocketRequest* recycled = SocketRequest::create(&observer, otherFD, &handler);
+   const ObjectPoolStats statsAfter = SocketRequest::getPoolStats();
+
+   require(request == recycled, "create should reuse the request just recycled on this thread");
+   require(statsAfter.hits == statsBefore.hits + 1, "reuse should count as a pool hit");
+   require(otherFD == recycled->getSocketFD(), "recycled request should use the new fd");
+   requireFalse(recycled->isAutoDelete(), "recycled request should have its runnable state reset");
+   require(-1 == recycled->getSocket()->getUserIndex(), "recycled request should have its socket reset");
+
+   recycled->run();
+   require(recycled == handler.servicedRequest, "recycled request should run its new handler");
+
+   recycled->requestComplete();
+   require(recycled->getSocket() == observer.notifiedSocket, "recycled request should notify its new observer");
+
+   SocketRequest::recycle(recycled);
+
+   ::close(fd);
+   ::close(otherFD);
+}
+
+//******************************************************************************
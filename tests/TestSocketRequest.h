@@ -23,6 +23,8 @@ protected:
    void testIsSocketOwned();
    void testSetSocketOwned();
    void testNotifyOnCompletion();
+   void testDestructorLeavesUnownedDescriptorOpen();
+   void testCreateAndRecycle();
 
 public:
    TestSocketRequest();
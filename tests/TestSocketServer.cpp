@@ -46,6 +46,19 @@ public:
    }
 };
 
+// An echo handler that declares itself cheap enough to run on the event
+// loop thread
+class InlineEchoRequestHandler : public EchoRequestHandler {
+public:
+   explicit InlineEchoRequestHandler(chaudiere::SocketRequest* socketRequest) :
+      EchoRequestHandler(socketRequest) {
+   }
+
+   bool isInlineCapable() const override {
+      return true;
+   }
+};
+
 class EchoSocketServiceHandler : public chaudiere::SocketServiceHandler {
 public:
    void serviceSocket(chaudiere::SocketRequest* socketRequest) override {
@@ -80,6 +93,19 @@ public:
    }
 };
 
+class InlineSocketServer : public TestableSocketServer {
+public:
+   InlineSocketServer(const std::string& serverName,
+                      const std::string& serverVersion,
+                      const std::string& configFilePath) :
+      TestableSocketServer(serverName, serverVersion, configFilePath) {
+   }
+
+   RequestHandler* handlerForSocketRequest(SocketRequest* socketRequest) override {
+      return new InlineEchoRequestHandler(socketRequest);
+   }
+};
+
 void writeServerConfig(const std::string& configPath,
                        int port,
                        const std::string& extraLines = "") {
@@ -112,9 +138,15 @@ void TestSocketServer::runTests() {
    testGetLocalDateTime();
    testHasTrueValue();
    testGetIntValue();
+   testGetNonNegativeIntValue();
    testReplaceVariables();
    testServiceSocket();
    testRunSocketServer();
+   testGetNumberEventLoops();
+   testGetListenBacklog();
+   testGetInlineThreshold();
+   testServiceSocketInlineCapable();
+   testServiceSocketAdaptiveInline();
 }
 
 //******************************************************************************
@@ -276,6 +308,31 @@ void TestSocketServer::testGetIntValue() {
 
 //******************************************************************************
 
+void TestSocketServer::testGetNonNegativeIntValue() {
+   TEST_CASE("testGetNonNegativeIntValue");
+
+   const std::string configPath = getTempFile();
+   writeServerConfig(configPath, 44735);
+
+   TestableSocketServer server("TestServer", "0.1", configPath);
+
+   KeyValuePairs kvp;
+   kvp.addPair("count", "42");
+   kvp.addPair("zero", "0");
+   kvp.addPair("negative", "-3");
+   kvp.addPair("text", "abc");
+
+   require(42 == server.getNonNegativeIntValue(kvp, "count"), "getNonNegativeIntValue should parse the configured integer value");
+   require(0 == server.getNonNegativeIntValue(kvp, "zero"), "getNonNegativeIntValue should accept zero");
+   require(-1 == server.getNonNegativeIntValue(kvp, "negative"), "getNonNegativeIntValue should reject a negative value");
+   require(-1 == server.getNonNegativeIntValue(kvp, "text"), "getNonNegativeIntValue should reject a value that isn't a number");
+   require(-1 == server.getNonNegativeIntValue(kvp, "missing"), "getNonNegativeIntValue should return -1 for a setting that isn't present");
+
+   deleteFile(configPath);
+}
+
+//******************************************************************************
+
 void TestSocketServer::testReplaceVariables() {
    TEST_CASE("testReplaceVariables");
 
@@ -373,3 +430,163 @@ void TestSocketServer::testRunSocketServer() {
 }
 
 //******************************************************************************
+
+void TestSocketServer::testGetNumberEventLoops() {
+   TEST_CASE("testGetNumberEventLoops");
+
+   const std::string configPath = getTempFile();
+   writeServerConfig(configPath, 44725);
+
+   {
+      TestableSocketServer server("TestServer", "0.1", configPath);
+      require(1 == server.getNumberEventLoops(), "number of event loops should default to 1 when not configured");
+   }
+
+   writeServerConfig(configPath, 44726, "event_loops = 4\n");
+
+   {
+      TestableSocketServer server("TestServer", "0.1", configPath);
+      require(4 == server.getNumberEventLoops(), "number of event loops should reflect the event_loops setting");
+   }
+
+   deleteFile(configPath);
+}
+
+//******************************************************************************
+
+void TestSocketServer::testGetListenBacklog() {
+   TEST_CASE("testGetListenBacklog");
+
+   const std::string configPath = getTempFile();
+   writeServerConfig(configPath, 44727);
+
+   {
+      TestableSocketServer server("TestServer", "0.1", configPath);
+      require(SOMAXCONN == server.getListenBacklog(), "listen backlog should default to SOMAXCONN when not configured");
+   }
+
+   writeServerConfig(configPath, 44728, "listen_backlog = 2048\n");
+
+   {
+      TestableSocketServer server("TestServer", "0.1", configPath);
+      require(2048 == server.getListenBacklog(), "listen backlog should reflect the listen_backlog setting");
+   }
+
+   deleteFile(configPath);
+}
+
+//******************************************************************************
+
+void TestSocketServer::testGetInlineThreshold() {
+   TEST_CASE("testGetInlineThreshold");
+
+   const std::string configPath = getTempFile();
+   writeServerConfig(configPath, 44729);
+
+   {
+      TestableSocketServer server("TestServer", "0.1", configPath);
+      require(0 == server.getInlineThreshold(), "inline threshold should default to 0 (off) when not configured");
+   }
+
+   writeServerConfig(configPath, 44730, "inline_threshold_us = 50\n");
+
+   {
+      TestableSocketServer server("TestServer", "0.1", configPath);
+      require(50 == server.getInlineThreshold(), "inline threshold should reflect the inline_threshold_us setting");
+   }
+
+   deleteFile(configPath);
+}
+
+//******************************************************************************
+
+void TestSocketServer::testServiceSocketInlineCapable() {
+   TEST_CASE("testServiceSocketInlineCapable");
+
+   const std::string configPath = getTempFile();
+   {
+      std::ofstream configFile(configPath.c_str());
+      configFile << "[server]\n";
+      configFile << "port = 44731\n";
+      configFile << "threading = pthreads\n";
+      configFile << "thread_pool_size = 2\n";
+      configFile.close();
+   }
+
+   InlineSocketServer server("TestServer", "0.1", configPath);
+
+   const int port = 44732;
+   ServerSocket serverListener(port);
+   Socket clientSocket("127.0.0.1", port);
+   Socket* acceptedSocket = serverListener.accept();
+
+   // the request borrows the accepted socket's descriptor (the way a kernel
+   // event server's requests do) and is deleted along with its handler
+   SocketRequest* socketRequest =
+      new SocketRequest(nullptr, acceptedSocket->getFileDescriptor(), nullptr);
+   socketRequest->setAutoDelete();
+
+   require(clientSocket.write("ping"), "writing to the client socket should succeed");
+   server.serviceSocket(socketRequest);
+
+   // an inline capable handler has already run by the time serviceSocket
+   // returns, even though there's a thread pool
+   require(1 == server.getNumberInlineRequests(), "an inline capable handler should be run inline");
+   require(0 == server.getNumberOffloadedRequests(), "an inline capable handler should not be handed to the thread pool");
+
+   char responseBuffer[5];
+   ::memset(responseBuffer, 0, sizeof(responseBuffer));
+   require(clientSocket.readSocket(responseBuffer, 4) > 0, "client should receive an echoed response");
+   requireStringEquals("ping", std::string(responseBuffer), "the inline handler should have echoed the request");
+
+   delete acceptedSocket;
+   deleteFile(configPath);
+}
+
+//******************************************************************************
+
+void TestSocketServer::testServiceSocketAdaptiveInline() {
+   TEST_CASE("testServiceSocketAdaptiveInline");
+
+   const std::string configPath = getTempFile();
+   {
+      std::ofstream configFile(configPath.c_str());
+      configFile << "[server]\n";
+      configFile << "port = 44733\n";
+      configFile << "threading = pthreads\n";
+      configFile << "thread_pool_size = 2\n";
+      configFile << "inline_threshold_us = 1000000\n";
+      configFile.close();
+   }
+
+   TestableSocketServer server("TestServer", "0.1", configPath);
+
+   const int port = 44734;
+   ServerSocket serverListener(port);
+   Socket clientSocket("127.0.0.1", port);
+   Socket* acceptedSocket = serverListener.accept();
+
+   for (int i = 0; i < 3; ++i) {
+      SocketRequest* socketRequest =
+         new SocketRequest(nullptr, acceptedSocket->getFileDescriptor(), nullptr);
+      socketRequest->setAutoDelete();
+
+      require(clientSocket.write("ping"), "writing to the client socket should succeed");
+      server.serviceSocket(socketRequest);
+
+      char responseBuffer[5];
+      ::memset(responseBuffer, 0, sizeof(responseBuffer));
+      require(clientSocket.readSocket(responseBuffer, 4) > 0, "client should receive an echoed response");
+      requireStringEquals("ping", std::string(responseBuffer), "each request should be echoed");
+   }
+
+   // an echo is far below a one second threshold, so none of the requests
+   // should have been handed to the thread pool
+   require(3 == server.getNumberInlineRequests(), "handlers measured below the inline threshold should be run inline");
+   require(0 == server.getNumberOffloadedRequests(), "handlers measured below the inline threshold should not be handed to the thread pool");
+
+   delete acceptedSocket;
+   deleteFile(configPath);
+}
+
+//******************************************************************************
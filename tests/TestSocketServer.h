@@ -24,9 +24,15 @@ protected:
    void testGetLocalDateTime();
    void testHasTrueValue();
    void testGetIntValue();
+   void testGetNonNegativeIntValue();
    void testReplaceVariables();
    void testServiceSocket();
    void testRunSocketServer();
+   void testGetNumberEventLoops();
+   void testGetListenBacklog();
+   void testGetInlineThreshold();
+   void testServiceSocketInlineCapable();
+   void testServiceSocketAdaptiveInline();
 
 public:
    TestSocketServer();
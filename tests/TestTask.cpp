@@ -0,0 +1,265 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "TestTask.h"
+#include "Task.h"
+#include "ThreadPool.h"
+#include "ThreadPoolQueue.h"
+#include "PthreadsThreadingFactory.h"
+
+using namespace chaudiere;
+
+// counts every heap allocation made by the test program (on any thread),
+// so that tests can measure allocations per request
+static std::atomic<std::size_t> numberAllocations(0);
+
+void* operator new(std::size_t size) {
+   numberAllocations.fetch_add(1, std::memory_order_relaxed);
+
+   void* p = std::malloc((size > 0) ? size : 1);
+   if (nullptr == p) {
+      throw std::bad_alloc();
+   }
+
+   return p;
+}
+
+void operator delete(void* p) noexcept {
+   std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+   std::free(p);
+}
+
+namespace {
+
+std::size_t getNumberAllocations() {
+   return numberAllocations.load(std::memory_order_relaxed);
+}
+
+// a callable that's too big to be stored inline
+struct BigCallable {
+   BigCallable(int& counter) :
+      m_counter(&counter) {
+   }
+
+   void operator()() {
+      ++(*m_counter);
+   }
+
+   int* m_counter;
+   char m_padding[Task::INLINE_SIZE];
+};
+
+// counts how many instances are alive
+struct TrackedCallable {
+   explicit TrackedCallable(int& liveCount) :
+      m_liveCount(&liveCount) {
+      ++(*m_liveCount);
+   }
+
+   TrackedCallable(TrackedCallable&& other) noexcept :
+      m_liveCount(other.m_liveCount) {
+      ++(*m_liveCount);
+   }
+
+   ~TrackedCallable() {
+      --(*m_liveCount);
+   }
+
+   void operator()() {
+   }
+
+   int* m_liveCount;
+};
+
+}
+
+//******************************************************************************
+
+TestTask::TestTask() :
+   poivre::TestSuite("TestTask") {
+}
+
+//******************************************************************************
+
+void TestTask::runTests() {
+   testEmpty();
+   testInlineCallable();
+   testHeapCallable();
+   testMove();
+   testReset();
+   testQueueAllocations();
+   testThreadPoolAllocations();
+}
+
+//******************************************************************************
+
+void TestTask::testEmpty() {
+   TEST_CASE("testEmpty");
+
+   Task task;
+   requireFalse(static_cast<bool>(task), "default constructed task should be empty");
+   requireFalse(task.isInline(), "empty task should not report inline storage");
+}
+
+//******************************************************************************
+
+void TestTask::testInlineCallable() {
+   TEST_CASE("testInlineCallable");
+
+   int counter = 0;
+   const std::size_t allocationsBefore = getNumberAllocations();
+
+   Task task([&counter]() { ++counter; });
+   task();
+   task();
+
+   // (read before require, whose message is a std::string)
+   const std::size_t allocations = getNumberAllocations() - allocationsBefore;
+
+   require(0 == allocations, "small lambda should not allocate");
+   require(static_cast<bool>(task), "task with a callable should not be empty");
+   require(task.isInline(), "small lambda should be stored inline");
+   require(2 == counter, "invoking the task should run the lambda");
+}
+
+//******************************************************************************
+
+void TestTask::testHeapCallable() {
+   TEST_CASE("testHeapCallable");
+
+   int counter = 0;
+   Task task{BigCallable(counter)};
+   requireFalse(task.isInline(), "callable larger than INLINE_SIZE should be on the heap");
+
+   Task moved(std::move(task));
+   moved();
+   require(1 == counter, "moved heap callable should still run");
+   requireFalse(static_cast<bool>(task), "moved-from task should be empty");
+}
+
+//******************************************************************************
+
+void TestTask::testMove() {
+   TEST_CASE("testMove");
+
+   int liveCount = 0;
+   {
+      Task first{TrackedCallable(liveCount)};
+      require(1 == liveCount, "task should hold exactly one callable");
+
+      Task second(std::move(first));
+      require(1 == liveCount, "move construction should not leave a copy behind");
+
+      Task third;
+      third = std::move(second);
+      require(1 == liveCount, "move assignment should not leave a copy behind");
+      require(static_cast<bool>(third), "move assigned task should have the callable");
+      requireFalse(static_cast<bool>(second), "moved-from task should be empty");
+   }
+   require(0 == liveCount, "callable should be destroyed with its task");
+}
+
+//******************************************************************************
+
+void TestTask::testReset() {
+   TEST_CASE("testReset");
+
+   int liveCount = 0;
+   Task task{TrackedCallable(liveCount)};
+   task.reset();
+   require(0 == liveCount, "reset should destroy the callable");
+   requireFalse(static_cast<bool>(task), "reset task should be empty");
+}
+
+//******************************************************************************
+
+void TestTask::testQueueAllocations() {
+   TEST_CASE("testQueueAllocations");
+
+   PthreadsThreadingFactory threadingFactory;
+   ThreadPoolQueue queue(&threadingFactory);
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+   int counter = 0;
+
+   auto addAndRun = [&]() {
+      for (int i = 0; i < 8; ++i) {
+         queue.addRequest([&counter]() { ++counter; });
+      }
+
+      queue.takeRequests(ctx, 8);
+      for (Task& task : ctx.tasks) {
+         task();
+      }
+   };
+
+   // warm up (grows the lane and the context's vector)
+   addAndRun();
+
+   const std::size_t allocationsBefore = getNumberAllocations();
+
+   for (int i = 0; i < 100; ++i) {
+      addAndRun();
+   }
+
+   const std::size_t allocations = getNumberAllocations() - allocationsBefore;
+
+   require(0 == allocations,
+           "adding, taking and running small tasks should not allocate");
+   require(808 == counter, "every task should run");
+   require(queue.isEmpty(), "every task should be taken");
+
+   // a rejected task is left with the caller
+   queue.shutDown();
+   Task task([&counter]() { ++counter; });
+   requireFalse(queue.addRequest(std::move(task)), "stopped queue should reject a task");
+   require(static_cast<bool>(task), "rejected task should not be moved from");
+}
+
+//******************************************************************************
+
+void TestTask::testThreadPoolAllocations() {
+   TEST_CASE("testThreadPoolAllocations");
+
+   std::atomic<int> counter(0);
+   ThreadPool tp(1);
+
+   auto dispatchAndWait = [&]() {
+      const int expected = counter.load() + 1;
+      tp.addRequest([&counter]() { ++counter; });
+
+      for (int spins = 0; (counter.load() < expected) && (spins < 10000000); ++spins) {
+         std::this_thread::yield();
+      }
+   };
+
+   // warm up
+   for (int i = 0; i < 10; ++i) {
+      dispatchAndWait();
+   }
+
+   const std::size_t allocationsBefore = getNumberAllocations();
+
+   for (int i = 0; i < 1000; ++i) {
+      dispatchAndWait();
+   }
+
+   const std::size_t allocations = getNumberAllocations() - allocationsBefore;
+
+   require(1010 == counter, "pool should run every task");
+   require(0 == allocations,
+           "dispatching a small task through a pool should not allocate");
+
+   tp.stop();
+}
+
+//******************************************************************************
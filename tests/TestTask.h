@@ -0,0 +1,32 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTTASK_H
+#define CHAUDIERE_TESTTASK_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestTask : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testEmpty();
+   void testInlineCallable();
+   void testHeapCallable();
+   void testMove();
+   void testReset();
+   void testQueueAllocations();
+   void testThreadPoolAllocations();
+
+public:
+   TestTask();
+
+};
+
+}
+
+#endif
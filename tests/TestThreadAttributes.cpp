@@ -0,0 +1,198 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "TestThreadAttributes.h"
+#include "ThreadAttributes.h"
+#include "PthreadsThreadingFactory.h"
+#include "StdThreadingFactory.h"
+#include "Thread.h"
+#include "Runnable.h"
+
+using namespace chaudiere;
+
+namespace {
+
+// records what the thread it runs on looks like from the inside
+class ThreadInspector : public chaudiere::Runnable {
+public:
+   ThreadInspector() :
+      m_stackSize(0),
+      m_numberCpus(0),
+      m_isOnCpu0(false) {
+   }
+
+   void run() override {
+#if defined(__linux__)
+      char name[16];
+      if (0 == ::pthread_getname_np(::pthread_self(), name, sizeof(name))) {
+         m_name = name;
+      }
+
+      pthread_attr_t attr;
+      if (0 == ::pthread_getattr_np(::pthread_self(), &attr)) {
+         ::pthread_attr_getstacksize(&attr, &m_stackSize);
+         ::pthread_attr_destroy(&attr);
+      }
+
+      cpu_set_t cpuSet;
+      CPU_ZERO(&cpuSet);
+      if (0 == ::pthread_getaffinity_np(::pthread_self(), sizeof(cpuSet), &cpuSet)) {
+         m_numberCpus = CPU_COUNT(&cpuSet);
+         m_isOnCpu0 = CPU_ISSET(0, &cpuSet);
+      }
+#endif
+   }
+
+   std::string m_name;
+   std::size_t m_stackSize;
+   int m_numberCpus;
+   bool m_isOnCpu0;
+};
+
+ThreadAttributes makePinnedAttributes() {
+   ThreadAttributes attributes;
+   attributes.setCpuSet(std::vector<int>{0});
+   attributes.setStackSize(256 * 1024);
+   return attributes;
+}
+
+}
+
+//******************************************************************************
+
+TestThreadAttributes::TestThreadAttributes() :
+   poivre::TestSuite("TestThreadAttributes") {
+}
+
+//******************************************************************************
+
+void TestThreadAttributes::runTests() {
+   testConstructor();
+   testParseCpuList();
+   testParseSchedulingPolicy();
+   testResolveCpus();
+   testAppliedToPthreadsThread();
+   testAppliedToStdThread();
+}
+
+//******************************************************************************
+
+void TestThreadAttributes::testConstructor() {
+   TEST_CASE("testConstructor");
+
+   ThreadAttributes attributes;
+   require(attributes.getCpuSet().empty(), "no cpu set by default");
+   require(-1 == attributes.getNumaNode(), "no NUMA node by default");
+   require(0 == attributes.getStackSize(), "default stack size by default");
+   require(ThreadSchedulingPolicy::Default == attributes.getSchedulingPolicy(),
+           "default scheduling policy by default");
+   requireFalse(attributes.hasCpuAffinity(), "no cpu affinity by default");
+   require(attributes.applyToCurrentThread(""), "applying defaults should succeed");
+}
+
+//******************************************************************************
+
+void TestThreadAttributes::testParseCpuList() {
+   TEST_CASE("testParseCpuList");
+
+   std::vector<int> cpus;
+   require(ThreadAttributes::parseCpuList("0-3,8,10-11\n", cpus), "valid cpu list should parse");
+   require(cpus == std::vector<int>({0, 1, 2, 3, 8, 10, 11}), "ranges and single cpus should be expanded");
+
+   require(ThreadAttributes::parseCpuList("5", cpus), "single cpu should parse");
+   require(cpus == std::vector<int>({5}), "single cpu should be parsed");
+
+   requireFalse(ThreadAttributes::parseCpuList("", cpus), "empty cpu list should not parse");
+   requireFalse(ThreadAttributes::parseCpuList("a", cpus), "non-numeric cpu should not parse");
+   requireFalse(ThreadAttributes::parseCpuList("3-1", cpus), "descending range should not parse");
+   requireFalse(ThreadAttributes::parseCpuList("1-", cpus), "open range should not parse");
+   requireFalse(ThreadAttributes::parseCpuList("1x", cpus), "trailing garbage should not parse");
+   require(cpus.empty(), "invalid cpu list should leave no cpus");
+}
+
+//******************************************************************************
+
+void TestThreadAttributes::testParseSchedulingPolicy() {
+   TEST_CASE("testParseSchedulingPolicy");
+
+   ThreadSchedulingPolicy policy = ThreadSchedulingPolicy::Default;
+   require(ThreadAttributes::parseSchedulingPolicy("batch", policy), "batch should parse");
+   require(ThreadSchedulingPolicy::Batch == policy, "batch should map to Batch");
+   require(ThreadAttributes::parseSchedulingPolicy("rr", policy), "rr should parse");
+   require(ThreadSchedulingPolicy::RoundRobin == policy, "rr should map to RoundRobin");
+   requireFalse(ThreadAttributes::parseSchedulingPolicy("deadline", policy), "unknown policy should not parse");
+   require(ThreadSchedulingPolicy::RoundRobin == policy, "unknown policy should leave the policy alone");
+}
+
+//******************************************************************************
+
+void TestThreadAttributes::testResolveCpus() {
+   TEST_CASE("testResolveCpus");
+
+   ThreadAttributes attributes;
+   std::vector<int> cpus;
+   requireFalse(attributes.resolveCpus(cpus), "no restriction by default");
+
+   attributes.setNumaNode(0);
+   require(attributes.hasCpuAffinity(), "NUMA node should restrict cpus");
+
+   std::vector<int> nodeCpus;
+   if (ThreadAttributes::getNumaNodeCpus(0, nodeCpus)) {
+      require(attributes.resolveCpus(cpus), "NUMA node 0 should resolve to cpus");
+      require(cpus == nodeCpus, "NUMA node should resolve to its cpus");
+   }
+
+   attributes.setCpuSet(std::vector<int>{1, 2});
+   require(attributes.resolveCpus(cpus), "explicit cpu set should resolve");
+   require(cpus == std::vector<int>({1, 2}), "explicit cpu set should take precedence over NUMA node");
+}
+
+//******************************************************************************
+
+void TestThreadAttributes::testAppliedToPthreadsThread() {
+   TEST_CASE("testAppliedToPthreadsThread");
+
+#if defined(__linux__)
+   PthreadsThreadingFactory factory;
+   factory.setThreadAttributes(makePinnedAttributes());
+
+   ThreadInspector inspector;
+   std::unique_ptr<Thread> thread(factory.createThread(&inspector, "inspector-thread-1"));
+   require(thread->start(), "thread should start");
+   thread->join();
+
+   requireStringEquals("inspector-threa", inspector.m_name, "thread name should be set (and truncated)");
+   require(256 * 1024 == inspector.m_stackSize, "thread stack size should be set");
+   require(1 == inspector.m_numberCpus, "thread should be restricted to one cpu");
+   require(inspector.m_isOnCpu0, "thread should be pinned to cpu 0");
+#endif
+}
+
+//******************************************************************************
+
+void TestThreadAttributes::testAppliedToStdThread() {
+   TEST_CASE("testAppliedToStdThread");
+
+#if defined(__linux__)
+   StdThreadingFactory factory;
+   factory.setThreadAttributes(makePinnedAttributes());
+
+   ThreadInspector inspector;
+   std::unique_ptr<Thread> thread(factory.createThread(&inspector, "inspector"));
+   require(thread->start(), "thread should start");
+   thread->join();
+
+   requireStringEquals("inspector", inspector.m_name, "thread name should be set");
+   require(1 == inspector.m_numberCpus, "thread should be restricted to one cpu");
+   require(inspector.m_isOnCpu0, "thread should be pinned to cpu 0");
+#endif
+}
+
+//******************************************************************************
@@ -0,0 +1,31 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTTHREADATTRIBUTES_H
+#define CHAUDIERE_TESTTHREADATTRIBUTES_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestThreadAttributes : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testConstructor();
+   void testParseCpuList();
+   void testParseSchedulingPolicy();
+   void testResolveCpus();
+   void testAppliedToPthreadsThread();
+   void testAppliedToStdThread();
+
+public:
+   TestThreadAttributes();
+
+};
+
+}
+
+#endif
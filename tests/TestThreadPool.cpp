@@ -3,11 +3,18 @@
 
 #include <stdio.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 #include "TestThreadPool.h"
 #include "ThreadPool.h"
+#include "RingThreadPoolQueue.h"
 #include "PthreadsThreadingFactory.h"
 #include "Runnable.h"
+#include "Task.h"
 
 
 class DoNothingRunnable : public chaudiere::Runnable
@@ -17,6 +24,68 @@ class DoNothingRunnable : public chaudiere::Runnable
       }
 };
 
+class CountingRunnable : public chaudiere::Runnable
+{
+   public:
+      explicit CountingRunnable(std::atomic<int>& counter) :
+         m_counter(&counter) {
+      }
+
+      virtual void run() {
+         (*m_counter)++;
+      }
+
+   private:
+      std::atomic<int>* m_counter;
+};
+
+class SleepingRunnable : public chaudiere::Runnable
+{
+   public:
+      SleepingRunnable(std::atomic<int>& counter, int sleepMillis) :
+         m_counter(&counter),
+         m_sleepMillis(sleepMillis) {
+      }
+
+      virtual void run() {
+         usleep(m_sleepMillis * 1000);
+         (*m_counter)++;
+      }
+
+   private:
+      std::atomic<int>* m_counter;
+      int m_sleepMillis;
+};
+
+class ThreadNameRunnable : public chaudiere::Runnable
+{
+   public:
+      ThreadNameRunnable() :
+         m_isDone(false),
+         m_isOnCpu0Only(false) {
+      }
+
+      virtual void run() {
+#if defined(__linux__)
+         char name[16];
+         if (0 == ::pthread_getname_np(::pthread_self(), name, sizeof(name))) {
+            m_name = name;
+         }
+
+         cpu_set_t cpuSet;
+         CPU_ZERO(&cpuSet);
+         if (0 == ::pthread_getaffinity_np(::pthread_self(), sizeof(cpuSet), &cpuSet)) {
+            m_isOnCpu0Only = (1 == CPU_COUNT(&cpuSet)) && CPU_ISSET(0, &cpuSet);
+         }
+#endif
+         m_isDone = true;
+      }
+
+      std::string m_name;
+      std::atomic<bool> m_isDone;
+      bool m_isOnCpu0Only;
+};
+
 using namespace chaudiere;
 
 
@@ -181,27 +250,93 @@ POIVRE_TEST_CASE(TestThreadPool, testAddWorkers) {
 
 //******************************************************************************
 
-// TEMPORARILY DISABLED: removeWorkers() deadlocks here. The workers it
-// tries to remove are idle (blocked in ThreadPoolQueue::takeRequest()'s
-// condition-variable wait, since nothing was ever added to the queue),
-// and adjustNumberWorkers()'s removal path only shuts down the specific
-// ThreadPoolWorker objects being removed - it never signals
-// m_condQueueNotEmpty, which is the only thing that would wake them.
-// ThreadPoolWorker::stop() then busy-waits forever for a worker that can
-// never wake up on its own. Root-caused during the POIVRE_TEST_CASE
-// retrofit; reported upstream rather than silently fixed here.
-//
-// POIVRE_TEST_CASE(TestThreadPool, testRemoveWorkers) {
-//    int numWorkers = 6;
-//    const int numToRemove = 2;
-//    ThreadPool tp(numWorkers);
-//    require(tp.removeWorkers(numToRemove), "remove workers should succeed");
-//    numWorkers -= numToRemove;
-//    require(tp.getNumberWorkers() == numWorkers, "number workers should match expected after removing");
-//    require(!tp.removeWorkers(0), "remove 0 workers should fail");
-//    require(!tp.removeWorkers(-2), "remove negative workers should fail");
-//    tp.stop();
-// }
+POIVRE_TEST_CASE(TestThreadPool, testRemoveWorkers) {
+   // the workers being removed are idle (waiting on an empty queue), so
+   // this also checks that removal wakes them up rather than hanging
+   int numWorkers = 6;
+   const int numToRemove = 2;
+   ThreadPool tp(numWorkers);
+   require(tp.removeWorkers(numToRemove), "remove workers should succeed");
+   numWorkers -= numToRemove;
+   require(tp.getNumberWorkers() == numWorkers, "number workers should match expected after removing");
+   require(!tp.removeWorkers(0), "remove 0 workers should fail");
+   require(!tp.removeWorkers(-2), "remove negative workers should fail");
+
+   std::atomic<int> counter(0);
+   CountingRunnable runnable(counter);
+   require(tp.addRequest(&runnable), "add runnable after removing workers should succeed");
+   for (int i = 0; i < 5000 && counter < 1; ++i) {
+      usleep(1000);
+   }
+   require(1 == counter, "remaining workers should still run requests");
+   tp.stop();
+}
+
+//******************************************************************************
+
+POIVRE_TEST_CASE(TestThreadPool, testRemoveWorkersRingQueue) {
+   PthreadsThreadingFactory threadingFactory;
+   ThreadPool tp(&threadingFactory,
+                 new RingThreadPoolQueue(&threadingFactory, 16),
+                 4, "ring_pool");
+   require(tp.removeWorkers(3), "remove idle workers parked on a ring queue should succeed");
+   require(1 == tp.getNumberWorkers(), "number workers should match expected after removing");
+
+   std::atomic<int> counter(0);
+   CountingRunnable runnable(counter);
+   require(tp.addRequest(&runnable), "add runnable after removing workers should succeed");
+   for (int i = 0; i < 5000 && counter < 1; ++i) {
+      usleep(1000);
+   }
+   require(1 == counter, "remaining worker should still run requests");
+   tp.stop();
+}
+
+//******************************************************************************
+
+POIVRE_TEST_CASE(TestThreadPool, testAutoScaling) {
+   ThreadPool tp(1);
+   require(!tp.isAutoScaling(), "auto-scaling should be off by default");
+
+   AutoScalingPolicy policy;
+   policy.minWorkers = 1;
+   policy.maxWorkers = 4;
+   policy.targetDelayMicros = 1000;
+   policy.idleCooldownMillis = 50;
+   policy.sampleIntervalMillis = 10;
+   require(tp.enableAutoScaling(policy), "enable auto-scaling should succeed");
+   require(tp.isAutoScaling(), "auto-scaling should be on once enabled");
+   require(!tp.enableAutoScaling(policy), "enable auto-scaling twice should fail");
+
+   // back the queue up with requests that each hold a worker for a while
+   std::atomic<int> counter(0);
+   std::vector<std::unique_ptr<SleepingRunnable>> runnables;
+   for (int i = 0; i < 40; ++i) {
+      runnables.emplace_back(new SleepingRunnable(counter, 20));
+      require(tp.addRequest(runnables.back().get()), "add runnable should succeed");
+   }
+
+   for (int i = 0; i < 5000 && tp.getNumberWorkers() < 2; ++i) {
+      usleep(1000);
+   }
+   require(tp.getNumberWorkers() > 1, "pool should grow while requests wait past the target delay");
+
+   for (int i = 0; i < 5000 && counter < 40; ++i) {
+      usleep(1000);
+   }
+   require(40 == counter, "every request should be run");
+
+   // idle again: the pool should shrink back to its minimum
+   for (int i = 0; i < 5000 && tp.getNumberWorkers() > 1; ++i) {
+      usleep(1000);
+   }
+   require(1 == tp.getNumberWorkers(), "pool should shrink back to its minimum once idle");
+   require(tp.getAutoScaler()->getNumberWorkersAdded() > 0, "auto-scaler should count the workers it added");
+   require(tp.getAutoScaler()->getNumberWorkersRetired() > 0, "auto-scaler should count the workers it retired");
+
+   tp.stop();
+   require(!tp.isRunning(), "pool should stop with auto-scaling enabled");
+}
 
 //******************************************************************************
 
@@ -232,3 +367,102 @@ POIVRE_TEST_CASE(TestThreadPool, testIsRunning) {
 }
 
 //******************************************************************************
+
+POIVRE_TEST_CASE(TestThreadPool, testRingQueue) {
+   PthreadsThreadingFactory threadingFactory;
+   RingThreadPoolQueue* queue = new RingThreadPoolQueue(&threadingFactory, 16);
+   ThreadPool tp(&threadingFactory, queue, 2, "ring_pool");
+   require(tp.isRunning(), "pool with a ring queue should be running after construction");
+
+   tp.setMaxQueueSize(8, QueueFullPolicy::Block);
+   require(8 == queue->getMaxQueueSize(), "setMaxQueueSize should reach the ring queue");
+
+   DoNothingRunnable* runnable = new DoNothingRunnable;
+   require(tp.addRequest(runnable), "add runnable should succeed");
+   sleep(1);
+   require(queue->isEmpty(), "worker should have taken the request from the ring");
+   tp.stop();
+   require(!queue->isRunning(), "stopping the pool should shut down its ring queue");
+   delete runnable;
+}
+
+//******************************************************************************
+
+POIVRE_TEST_CASE(TestThreadPool, testAddTask) {
+   std::atomic<int> counter(0);
+
+   // default queue stores tasks as is; the ring queue wraps them
+   PthreadsThreadingFactory threadingFactory;
+   ThreadPool tp(&threadingFactory, 2, "task_pool");
+   ThreadPool ringPool(&threadingFactory,
+                       new RingThreadPoolQueue(&threadingFactory, 16),
+                       2, "ring_task_pool");
+
+   for (int i = 0; i < 20; ++i) {
+      require(tp.addRequest([&counter]() { ++counter; }), "add task should succeed");
+      require(ringPool.addRequest([&counter]() { ++counter; }), "add task to ring pool should succeed");
+   }
+
+   for (int i = 0; i < 5000 && counter < 40; ++i) {
+      usleep(1000);
+   }
+   require(40 == counter, "every task should be run");
+
+   tp.stop();
+   ringPool.stop();
+
+   Task task([&counter]() { ++counter; });
+   require(!tp.addRequest(std::move(task)), "add task to stopped pool should fail");
+   require(static_cast<bool>(task), "rejected task should be left with the caller");
+}
+
+//******************************************************************************
+
+POIVRE_TEST_CASE(TestThreadPool, testAddRequests) {
+   std::atomic<int> counter(0);
+   std::vector<std::unique_ptr<CountingRunnable>> runnables;
+   std::vector<Runnable*> requests;
+   for (int i = 0; i < 50; ++i) {
+      runnables.emplace_back(new CountingRunnable(counter));
+      requests.push_back(runnables.back().get());
+   }
+
+   ThreadPool tp(2);
+   require(requests.size() == tp.addRequests(requests), "running pool should accept the whole batch");
+
+   for (int i = 0; i < 5000 && counter < 50; ++i) {
+      usleep(1000);
+   }
+   require(50 == counter, "every request in the batch should be run");
+
+   tp.stop();
+   require(0 == tp.addRequests(requests), "stopped pool should accept none of a batch");
+}
+
+//******************************************************************************
+
+POIVRE_TEST_CASE(TestThreadPool, testWorkerThreadAttributes) {
+   ThreadPool tp(1);
+
+   ThreadAttributes attributes;
+   attributes.setCpuSet(std::vector<int>{0});
+   require(tp.setWorkerThreadAttributes(attributes), "set worker thread attributes should succeed");
+
+   // only workers started from here on get the attributes
+   tp.stop();
+   require(tp.start(), "restart should succeed");
+
+   ThreadNameRunnable runnable;
+   require(tp.addRequest(&runnable), "add runnable should succeed");
+   for (int i = 0; i < 5000 && !runnable.m_isDone; ++i) {
+      usleep(1000);
+   }
+   require(runnable.m_isDone, "runnable should be run");
+#if defined(__linux__)
+   require(0 == runnable.m_name.find("tpworker-"), "worker threads should be named");
+   require(runnable.m_isOnCpu0Only, "worker threads should be pinned to the pool's cpus");
+#endif
+   tp.stop();
+}
+
+//******************************************************************************
@@ -0,0 +1,167 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include "TestThreadPoolAutoScaler.h"
+#include "ThreadPoolAutoScaler.h"
+#include "ThreadPool.h"
+#include "PthreadsThreadingFactory.h"
+
+using namespace chaudiere;
+
+static PthreadsThreadingFactory tf;
+
+namespace {
+
+AutoScalingPolicy makePolicy(int minWorkers, int maxWorkers) {
+   AutoScalingPolicy policy;
+   policy.minWorkers = minWorkers;
+   policy.maxWorkers = maxWorkers;
+   policy.targetDelayMicros = 10000;
+   policy.idleCooldownMillis = 1000;
+   return policy;
+}
+
+AutoScalingSample makeSample(int numberWorkers,
+                             std::size_t queueSize,
+                             std::uint64_t oldestWaitMicros,
+                             std::size_t idleWorkers) {
+   AutoScalingSample sample;
+   sample.numberWorkers = numberWorkers;
+   sample.queueSize = queueSize;
+   sample.oldestWaitMicros = oldestWaitMicros;
+   sample.idleWorkers = idleWorkers;
+   return sample;
+}
+
+}
+
+//******************************************************************************
+
+TestThreadPoolAutoScaler::TestThreadPoolAutoScaler() :
+   poivre::TestSuite("TestThreadPoolAutoScaler") {
+}
+
+//******************************************************************************
+
+void TestThreadPoolAutoScaler::runTests() {
+   testConstructor();
+   testGrowsWhenBackedUp();
+   testGrowthCappedAtMax();
+   testNoGrowthWithIdleWorkers();
+   testRetiresAfterCooldown();
+   testRetirementCappedAtMin();
+   testGrowsToMin();
+}
+
+//******************************************************************************
+
+void TestThreadPoolAutoScaler::testConstructor() {
+   TEST_CASE("testConstructor");
+
+   ThreadPool pool(&tf, 1);
+   ThreadPoolAutoScaler scaler(pool, makePolicy(0, -1));
+   require(1 == scaler.getPolicy().minWorkers, "min workers should be at least 1");
+   require(1 == scaler.getPolicy().maxWorkers, "max workers should be at least min workers");
+   require(0 == scaler.getNumberWorkersAdded(), "no workers added before starting");
+   require(0 == scaler.getNumberWorkersRetired(), "no workers retired before starting");
+   pool.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolAutoScaler::testGrowsWhenBackedUp() {
+   TEST_CASE("testGrowsWhenBackedUp");
+
+   ThreadPool pool(&tf, 1);
+   ThreadPoolAutoScaler scaler(pool, makePolicy(2, 32));
+   require(1 == scaler.evaluate(makeSample(2, 10, 20000, 0), 100),
+           "small backed-up pool should grow by one");
+   require(4 == scaler.evaluate(makeSample(16, 10, 20000, 0), 200),
+           "larger backed-up pool should grow by a quarter");
+   require(0 == scaler.evaluate(makeSample(16, 10, 5000, 0), 300),
+           "pool should not grow while the wait is under the target");
+   pool.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolAutoScaler::testGrowthCappedAtMax() {
+   TEST_CASE("testGrowthCappedAtMax");
+
+   ThreadPool pool(&tf, 1);
+   ThreadPoolAutoScaler scaler(pool, makePolicy(2, 18));
+   require(2 == scaler.evaluate(makeSample(16, 10, 20000, 0), 100),
+           "growth should stop at max workers");
+   require(0 == scaler.evaluate(makeSample(18, 10, 20000, 0), 200),
+           "pool at max workers should not grow");
+   pool.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolAutoScaler::testNoGrowthWithIdleWorkers() {
+   TEST_CASE("testNoGrowthWithIdleWorkers");
+
+   ThreadPool pool(&tf, 1);
+   ThreadPoolAutoScaler scaler(pool, makePolicy(2, 32));
+   require(0 == scaler.evaluate(makeSample(4, 10, 20000, 1), 100),
+           "pool with an idle worker should not grow");
+   pool.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolAutoScaler::testRetiresAfterCooldown() {
+   TEST_CASE("testRetiresAfterCooldown");
+
+   ThreadPool pool(&tf, 1);
+   ThreadPoolAutoScaler scaler(pool, makePolicy(2, 32));
+   require(0 == scaler.evaluate(makeSample(10, 0, 0, 6), 1000),
+           "idle workers should not be retired before the cooldown starts");
+   require(0 == scaler.evaluate(makeSample(10, 0, 0, 6), 1500),
+           "idle workers should not be retired during the cooldown");
+   require(-3 == scaler.evaluate(makeSample(10, 0, 0, 6), 2000),
+           "half of the idle workers should be retired after the cooldown");
+   require(0 == scaler.evaluate(makeSample(7, 0, 0, 3), 2500),
+           "retiring should start a new cooldown");
+
+   // any work in between restarts the cooldown
+   require(0 == scaler.evaluate(makeSample(7, 1, 0, 2), 3000),
+           "queued work should not retire workers");
+   require(0 == scaler.evaluate(makeSample(7, 0, 0, 3), 3100),
+           "cooldown should restart after queued work");
+   require(0 == scaler.evaluate(makeSample(7, 0, 0, 3), 4000),
+           "idle workers should not be retired during the restarted cooldown");
+   require(-1 == scaler.evaluate(makeSample(7, 0, 0, 3), 4100),
+           "at least one idle worker should be retired after the cooldown");
+   pool.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolAutoScaler::testRetirementCappedAtMin() {
+   TEST_CASE("testRetirementCappedAtMin");
+
+   ThreadPool pool(&tf, 1);
+   ThreadPoolAutoScaler scaler(pool, makePolicy(4, 32));
+   scaler.evaluate(makeSample(5, 0, 0, 5), 1000);
+   require(-1 == scaler.evaluate(makeSample(5, 0, 0, 5), 2000),
+           "retirement should stop at min workers");
+   require(0 == scaler.evaluate(makeSample(4, 0, 0, 4), 3000),
+           "pool at min workers should not shrink");
+   pool.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolAutoScaler::testGrowsToMin() {
+   TEST_CASE("testGrowsToMin");
+
+   ThreadPool pool(&tf, 1);
+   ThreadPoolAutoScaler scaler(pool, makePolicy(4, 8));
+   require(3 == scaler.evaluate(makeSample(1, 0, 0, 1), 100),
+           "pool below min workers should grow to min");
+   pool.stop();
+}
+
+//******************************************************************************
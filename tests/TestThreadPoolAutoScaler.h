@@ -0,0 +1,32 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTTHREADPOOLAUTOSCALER_H
+#define CHAUDIERE_TESTTHREADPOOLAUTOSCALER_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestThreadPoolAutoScaler : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testConstructor();
+   void testGrowsWhenBackedUp();
+   void testGrowthCappedAtMax();
+   void testNoGrowthWithIdleWorkers();
+   void testRetiresAfterCooldown();
+   void testRetirementCappedAtMin();
+   void testGrowsToMin();
+
+public:
+   TestThreadPoolAutoScaler();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,224 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "TestThreadPoolDispatch.h"
+#include "ThreadPoolDispatch.h"
+#include "DispatchQueue.h"
+#include "PthreadsThreadingFactory.h"
+#include "Runnable.h"
+#include "Thread.h"
+
+using namespace chaudiere;
+
+static PthreadsThreadingFactory tf;
+
+namespace {
+
+// counts its runs, and records its number in run order (when given a list)
+class CountingRunnable : public chaudiere::Runnable {
+public:
+   CountingRunnable(std::atomic<int>& runCount,
+                    std::atomic<int>& inFlight,
+                    std::atomic<int>& maxInFlight,
+                    std::vector<int>* runOrder,
+                    int number) :
+      m_runCount(runCount),
+      m_inFlight(inFlight),
+      m_maxInFlight(maxInFlight),
+      m_runOrder(runOrder),
+      m_number(number) {
+   }
+
+   void run() override {
+      const int inFlight = m_inFlight.fetch_add(1) + 1;
+      int maxInFlight = m_maxInFlight.load();
+      while ((inFlight > maxInFlight) &&
+             !m_maxInFlight.compare_exchange_weak(maxInFlight, inFlight)) {
+      }
+
+      if (nullptr != m_runOrder) {
+         m_runOrder->push_back(m_number);
+      }
+
+      m_inFlight.fetch_sub(1);
+      m_runCount.fetch_add(1);
+   }
+
+private:
+   std::atomic<int>& m_runCount;
+   std::atomic<int>& m_inFlight;
+   std::atomic<int>& m_maxInFlight;
+   std::vector<int>* m_runOrder;
+   int m_number;
+};
+
+// waits (up to 5 seconds) for the count to reach the expected value
+bool waitForCount(const std::atomic<int>& count, int expected) {
+   for (int i = 0; (i < 500) && (count.load() < expected); ++i) {
+      Thread::sleep(10);
+   }
+
+   return count.load() == expected;
+}
+
+}
+
+//******************************************************************************
+
+TestThreadPoolDispatch::TestThreadPoolDispatch() :
+   poivre::TestSuite("TestThreadPoolDispatch") {
+}
+
+//******************************************************************************
+
+void TestThreadPoolDispatch::runTests() {
+   testStartStop();
+   testGlobalQueue();
+   testSerialQueueOrder();
+   testSerialQueueOutlivesHandle();
+   testConcurrentQueue();
+   testThreadingFactory();
+}
+
+//******************************************************************************
+
+void TestThreadPoolDispatch::testStartStop() {
+   TEST_CASE("testStartStop");
+
+   ThreadPoolDispatch dispatch(&tf, 2, "dispatch");
+   require(2 == dispatch.getNumberWorkers(), "shared pool should have the requested workers");
+
+   std::atomic<int> runCount(0), inFlight(0), maxInFlight(0);
+   CountingRunnable runnable(runCount, inFlight, maxInFlight, nullptr, 0);
+
+   requireFalse(dispatch.addRequest(&runnable), "addRequest should fail before start");
+   require(dispatch.start(), "start should succeed");
+   requireFalse(dispatch.start(), "start should fail when already running");
+   require(dispatch.stop(), "stop should succeed");
+   requireFalse(dispatch.addRequest(&runnable), "addRequest should fail after stop");
+   require(dispatch.start(), "start should succeed after stop");
+   require(dispatch.addRequest(&runnable), "addRequest should succeed after restart");
+   require(waitForCount(runCount, 1), "request should run after restart");
+   dispatch.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolDispatch::testGlobalQueue() {
+   TEST_CASE("testGlobalQueue");
+
+   ThreadPoolDispatch dispatch(&tf, 3, "dispatch");
+   dispatch.start();
+   require(DispatchQueueType::Concurrent == dispatch.getGlobalQueue().getType(), "global queue should be concurrent");
+
+   const int numberRequests = 100;
+   std::atomic<int> runCount(0), inFlight(0), maxInFlight(0);
+   std::vector<std::unique_ptr<CountingRunnable>> runnables;
+
+   for (int i = 0; i < numberRequests; ++i) {
+      runnables.emplace_back(new CountingRunnable(runCount, inFlight, maxInFlight, nullptr, i));
+      require(dispatch.addRequest(runnables.back().get()), "addRequest should succeed");
+   }
+
+   require(waitForCount(runCount, numberRequests), "every request should run");
+   dispatch.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolDispatch::testSerialQueueOrder() {
+   TEST_CASE("testSerialQueueOrder");
+
+   ThreadPoolDispatch dispatch(&tf, 4, "dispatch");
+   dispatch.start();
+
+   std::unique_ptr<DispatchQueue> queue(dispatch.createSerialQueue("connection"));
+   require(DispatchQueueType::Serial == queue->getType(), "queue should be serial");
+   requireStringEquals("connection", queue->getLabel(), "queue should keep its label");
+
+   // more than a drain batch, so that the queue hands off to new drains
+   const int numberRequests = 200;
+   std::atomic<int> runCount(0), inFlight(0), maxInFlight(0);
+   std::vector<int> runOrder;
+   std::vector<std::unique_ptr<CountingRunnable>> runnables;
+
+   for (int i = 0; i < numberRequests; ++i) {
+      runnables.emplace_back(new CountingRunnable(runCount, inFlight, maxInFlight, &runOrder, i));
+      require(queue->dispatchAsync(runnables.back().get()), "dispatchAsync should succeed");
+   }
+
+   require(waitForCount(runCount, numberRequests), "every request should run");
+   require(1 == maxInFlight.load(), "a serial queue should run one request at a time");
+
+   bool isInOrder = runOrder.size() == static_cast<std::size_t>(numberRequests);
+   for (int i = 0; isInOrder && (i < numberRequests); ++i) {
+      isInOrder = runOrder[i] == i;
+   }
+   require(isInOrder, "a serial queue should run requests in the order dispatched");
+   require(0 == queue->getNumberPending(), "nothing should be left pending");
+
+   requireFalse(queue->dispatchAsync(nullptr), "dispatchAsync should reject nullptr");
+   dispatch.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolDispatch::testSerialQueueOutlivesHandle() {
+   TEST_CASE("testSerialQueueOutlivesHandle");
+
+   ThreadPoolDispatch dispatch(&tf, 2, "dispatch");
+   dispatch.start();
+
+   const int numberRequests = 50;
+   std::atomic<int> runCount(0), inFlight(0), maxInFlight(0);
+   std::vector<std::unique_ptr<CountingRunnable>> runnables;
+
+   DispatchQueue* queue = dispatch.createSerialQueue("short-lived");
+   for (int i = 0; i < numberRequests; ++i) {
+      runnables.emplace_back(new CountingRunnable(runCount, inFlight, maxInFlight, nullptr, i));
+      queue->dispatchAsync(runnables.back().get());
+   }
+   delete queue;
+
+   require(waitForCount(runCount, numberRequests), "pending requests should run after the queue is destroyed");
+   dispatch.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolDispatch::testConcurrentQueue() {
+   TEST_CASE("testConcurrentQueue");
+
+   ThreadPoolDispatch dispatch(&tf, 2, "dispatch");
+   dispatch.start();
+
+   std::unique_ptr<DispatchQueue> queue(dispatch.createConcurrentQueue("bulk"));
+   require(DispatchQueueType::Concurrent == queue->getType(), "queue should be concurrent");
+
+   std::atomic<int> runCount(0), inFlight(0), maxInFlight(0);
+   CountingRunnable a(runCount, inFlight, maxInFlight, nullptr, 0);
+   CountingRunnable b(runCount, inFlight, maxInFlight, nullptr, 1);
+   require(queue->dispatchAsync(&a), "dispatchAsync should succeed");
+   require(queue->dispatchAsync(&b), "dispatchAsync should succeed");
+   require(waitForCount(runCount, 2), "every request should run");
+   require(0 == queue->getNumberPending(), "concurrent queues hold nothing themselves");
+   dispatch.stop();
+}
+
+//******************************************************************************
+
+void TestThreadPoolDispatch::testThreadingFactory() {
+   TEST_CASE("testThreadingFactory");
+
+   PthreadsThreadingFactory factory;
+   factory.setThreadPoolType(ThreadPoolType::Dispatch);
+   std::unique_ptr<ThreadPoolDispatcher> dispatcher(
+      factory.createThreadPoolDispatcher(2, "dispatch"));
+   require(nullptr != dynamic_cast<ThreadPoolDispatch*>(dispatcher.get()), "factory should create a ThreadPoolDispatch");
+}
+
+//******************************************************************************
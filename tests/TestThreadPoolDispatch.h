@@ -0,0 +1,31 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTTHREADPOOLDISPATCH_H
+#define CHAUDIERE_TESTTHREADPOOLDISPATCH_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestThreadPoolDispatch : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testStartStop();
+   void testGlobalQueue();
+   void testSerialQueueOrder();
+   void testSerialQueueOutlivesHandle();
+   void testConcurrentQueue();
+   void testThreadingFactory();
+
+public:
+   TestThreadPoolDispatch();
+
+};
+
+}
+
+#endif
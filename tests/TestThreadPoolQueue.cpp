@@ -3,6 +3,8 @@
 
 #include <stdio.h>
 #include <atomic>
+#include <thread>
+#include <vector>
 
 #include "TestThreadPoolQueue.h"
 #include "ThreadPoolQueue.h"
@@ -280,3 +282,377 @@ POIVRE_TEST_CASE(TestThreadPoolQueue, testMaxQueueSizeBlockPolicyWakesOnShutdown
 
 //******************************************************************************
 
+POIVRE_TEST_CASE(TestThreadPoolQueue, testAddRequestsTakeRequests) {
+   ThreadPoolQueue tpq(&tf);
+   DoNothingRunnable runnables[5];
+   Runnable* requests[5];
+   for (int i = 0; i < 5; ++i) {
+      requests[i] = &runnables[i];
+   }
+
+   require(5 == tpq.addRequests(requests), "addRequests should add the whole batch");
+
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+   tpq.takeRequests(ctx, 3);
+   require(ctx.isQueueRunning, "takeRequests should report the queue running");
+   require(3 == ctx.runnables.size(), "takeRequests should take no more than maxBatch");
+   require(&runnables[0] == ctx.runnables[0] && &runnables[2] == ctx.runnables[2], "takeRequests should take the oldest requests in order");
+
+   tpq.takeRequests(ctx, 3);
+   require(2 == ctx.runnables.size(), "takeRequests should take what's left");
+   require(&runnables[3] == ctx.runnables[0], "takeRequests should continue in FIFO order");
+
+   tpq.takeRequests(ctx, 3);
+   require(ctx.runnables.empty(), "takeRequests should take nothing from an empty queue");
+
+   tpq.shutDown();
+   require(0 == tpq.addRequests(requests), "addRequests should add nothing after shutDown");
+   tpq.takeRequests(ctx, 3);
+   require(!ctx.isQueueRunning, "takeRequests should report the queue shut down");
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testAddRequestsRejectPolicy) {
+   ThreadPoolQueue tpq(&tf);
+   tpq.setMaxQueueSize(2, QueueFullPolicy::Reject);
+
+   DoNothingRunnable r1, r2, r3;
+   Runnable* requests[] = { &r1, &r2, &r3 };
+   require(2 == tpq.addRequests(requests), "addRequests should add the prefix of the batch that fits");
+
+   Runnable* withNullptr[] = { nullptr };
+   tpq.setMaxQueueSize(0);
+   require(0 == tpq.addRequests(withNullptr), "addRequests should stop at a nullptr request");
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testTakeRequestsLeavesShareForWaitingTakers) {
+   ThreadPoolQueue tpq(&tf);
+
+   // a taker parked on the empty queue
+   TakeRequestContext waitingCtx;
+   std::atomic<bool> isTaken(false);
+   std::thread waitingTaker([&]() {
+      tpq.takeRequests(waitingCtx, 16);
+      isTaken = true;
+   });
+   Thread::sleep(200);
+
+   DoNothingRunnable runnables[8];
+   Runnable* requests[8];
+   for (int i = 0; i < 8; ++i) {
+      requests[i] = &runnables[i];
+   }
+
+   require(8 == tpq.addRequests(requests), "addRequests should add the whole batch");
+
+   waitingTaker.join();
+   require(isTaken, "the parked taker should have been woken by the batch");
+   require(!waitingCtx.runnables.empty(), "the woken taker should have taken requests");
+
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+   tpq.takeRequests(ctx, 16);
+   require(8 == waitingCtx.runnables.size() + ctx.runnables.size(), "every request should be taken exactly once between the takers");
+}
+
+//******************************************************************************
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testAddRequestWakesOneTakerPerRequest) {
+   ThreadPoolQueue tpq(&tf);
+
+   const int numberTakers = 3;
+   std::atomic<int> numberTaken(0);
+   std::vector<std::thread> takers;
+
+   for (int i = 0; i < numberTakers; ++i) {
+      takers.push_back(std::thread([&]() {
+         TakeRequestContext ctx;
+         tpq.takeRequest(ctx);
+         if (nullptr != ctx.runnable) {
+            numberTaken++;
+         }
+      }));
+   }
+   Thread::sleep(200);
+   require(numberTakers == (int) tpq.getNumberParks(), "every taker should have parked on the empty queue");
+
+   DoNothingRunnable r1, r2;
+   require(tpq.addRequest(&r1), "request 1 should be accepted");
+   Thread::sleep(200);
+   require(1 == numberTaken, "one request should wake exactly one taker");
+
+   require(tpq.addRequest(&r2), "request 2 should be accepted");
+   Thread::sleep(200);
+   require(2 == numberTaken, "a second request should wake a second taker");
+
+   tpq.shutDown();
+   for (std::thread& taker : takers) {
+      taker.join();
+   }
+   require(2 == numberTaken, "the remaining taker should wake empty-handed on shutdown");
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testSpinLimit) {
+   ThreadPoolQueue tpq(&tf);
+   require(0 == tpq.getSpinLimit(), "spinning should be off by default");
+
+   tpq.setSpinLimit(4000);
+   require(4000 == tpq.getSpinLimit(), "getSpinLimit should reflect what was set");
+
+   // a spinning taker still gets its request (whether it finds it by
+   // spinning or after parking) and still wakes on shutdown
+   DoNothingRunnable r1;
+   TakeRequestContext ctx;
+   std::thread taker([&]() {
+      tpq.takeRequest(ctx);
+   });
+   require(tpq.addRequest(&r1), "request should be accepted");
+   taker.join();
+   require(&r1 == ctx.runnable, "spinning taker should take the request");
+   require(tpq.getNumberSpinHits() + tpq.getNumberParks() <= 1, "a take should find its request by spinning or park at most once");
+
+   std::thread idleTaker([&]() {
+      tpq.takeRequest(ctx);
+   });
+   Thread::sleep(100);
+   tpq.shutDown();
+   idleTaker.join();
+   require(!ctx.isQueueRunning, "spinning taker should wake on shutdown");
+}
+
+//******************************************************************************
+
+namespace {
+
+// takes whatever is queued (without waiting), in the order the queue
+// hands it out
+std::vector<Runnable*> takeAll(ThreadPoolQueue& queue) {
+   std::vector<Runnable*> taken;
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+
+   for (;;) {
+      queue.takeRequest(ctx);
+      if (nullptr == ctx.runnable) {
+         break;
+      }
+      taken.push_back(ctx.runnable);
+   }
+
+   return taken;
+}
+
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testStrictPriority) {
+   ThreadPoolQueue tpq(&tf);
+   require(PriorityScheduling::Strict == tpq.getPriorityScheduling(), "strict priority should be the default");
+
+   DoNothingRunnable bulk, normal, high, critical;
+   bulk.setPriority(PriorityClass::Bulk);
+   high.setPriority(PriorityClass::High);
+   critical.setPriority(PriorityClass::Critical);
+   require(PriorityClass::Normal == normal.getPriority(), "runnables should default to Normal priority");
+
+   tpq.addRequest(&bulk);
+   tpq.addRequest(&normal);
+   tpq.addRequest(&critical);
+   tpq.addRequest(&high);
+   require(1 == tpq.getLaneSize(PriorityClass::Bulk), "each request should be queued in its own lane");
+   require(4 == tpq.getQueueSize(), "queue size should count every lane");
+
+   const std::vector<Runnable*> expected = { &critical, &high, &normal, &bulk };
+   require(expected == takeAll(tpq), "higher priority lanes should be taken first");
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testTakenTaskPriority) {
+   ThreadPoolQueue tpq(&tf);
+
+   require(tpq.addRequest(Task([]() {}), PriorityClass::Bulk), "sanity check: a task should be added");
+   require(tpq.addRequest(Task([]() {}), PriorityClass::High), "sanity check: a task should be added");
+   require(tpq.addRequest(Task([]() {}), PriorityClass::Critical), "sanity check: a task should be added");
+
+   // so that a taken task can be put back in the lane it came from
+   TakeRequestContext ctx;
+   ctx.waitIfNone = false;
+   tpq.takeRequest(ctx);
+   require(PriorityClass::Critical == ctx.taskPriority, "takeRequest should report the lane of the task taken");
+
+   tpq.takeRequests(ctx, 4);
+   require(2 == ctx.tasks.size() && 2 == ctx.taskPriorities.size(), "takeRequests should report a lane for each task");
+   require(PriorityClass::High == ctx.taskPriorities[0], "the first task should come from the High lane");
+   require(PriorityClass::Bulk == ctx.taskPriorities[1], "the second task should come from the Bulk lane");
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testStarvationProtection) {
+   ThreadPoolQueue tpq(&tf);
+   tpq.setStarvationThreshold(1000);
+   require(1000 == tpq.getStarvationThreshold(), "getStarvationThreshold should reflect what was set");
+
+   DoNothingRunnable bulk, critical;
+   bulk.setPriority(PriorityClass::Bulk);
+   critical.setPriority(PriorityClass::Critical);
+
+   tpq.addRequest(&bulk);
+   Thread::sleep(10);
+   tpq.addRequest(&critical);
+
+   const std::vector<Runnable*> expected = { &bulk, &critical };
+   require(expected == takeAll(tpq), "a starved lane should be taken ahead of higher priority lanes");
+
+   tpq.setStarvationThreshold(0);
+   tpq.addRequest(&bulk);
+   Thread::sleep(10);
+   tpq.addRequest(&critical);
+
+   const std::vector<Runnable*> expectedStrict = { &critical, &bulk };
+   require(expectedStrict == takeAll(tpq), "no starvation protection with a threshold of 0");
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testWeightedRoundRobin) {
+   ThreadPoolQueue tpq(&tf);
+   require(tpq.setPriorityScheduling(PriorityScheduling::WeightedRoundRobin), "mutex queue should support priority lanes");
+   require(tpq.setLaneWeight(PriorityClass::Critical, 2), "set lane weight should succeed");
+   require(tpq.setLaneWeight(PriorityClass::Bulk, 1), "set lane weight should succeed");
+
+   DoNothingRunnable critical[6];
+   DoNothingRunnable bulk[3];
+   for (auto& runnable : critical) {
+      runnable.setPriority(PriorityClass::Critical);
+      tpq.addRequest(&runnable);
+   }
+   for (auto& runnable : bulk) {
+      runnable.setPriority(PriorityClass::Bulk);
+      tpq.addRequest(&runnable);
+   }
+
+   const std::vector<Runnable*> expected = {
+      &critical[0], &critical[1], &bulk[0],
+      &critical[2], &critical[3], &bulk[1],
+      &critical[4], &critical[5], &bulk[2]
+   };
+   require(expected == takeAll(tpq), "lanes should take turns in proportion to their weights");
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testLaneMaxQueueSize) {
+   ThreadPoolQueue tpq(&tf);
+   require(tpq.setLaneMaxQueueSize(PriorityClass::Bulk, 2, QueueFullPolicy::Reject), "set lane max size should succeed");
+
+   DoNothingRunnable bulk[3];
+   for (auto& runnable : bulk) {
+      runnable.setPriority(PriorityClass::Bulk);
+   }
+   DoNothingRunnable critical;
+   critical.setPriority(PriorityClass::Critical);
+
+   require(tpq.addRequest(&bulk[0]), "bulk lane should accept request 1");
+   require(tpq.addRequest(&bulk[1]), "bulk lane should accept request 2");
+   requireFalse(tpq.addRequest(&bulk[2]), "full bulk lane should reject request 3");
+   require(tpq.addRequest(&critical), "a full bulk lane should not hold back other lanes");
+
+   Runnable* batch[] = { &bulk[2] };
+   require(0 == tpq.addRequests(batch), "full bulk lane should reject a batch");
+
+   require(3 == takeAll(tpq).size(), "accepted requests should all be taken");
+   require(tpq.addRequest(&bulk[2]), "bulk lane should accept again once drained");
+   takeAll(tpq);
+}
+
+//******************************************************************************
+
+namespace {
+
+// counts how often it was dropped instead of run
+class DroppableRunnable : public chaudiere::Runnable {
+public:
+   DroppableRunnable() :
+      m_numberDropped(0) {
+   }
+
+   void run() override {
+   }
+
+   void notifyOnDropped() override {
+      ++m_numberDropped;
+      Runnable::notifyOnDropped();
+   }
+
+   int m_numberDropped;
+};
+
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testExpiredRequestsDropped) {
+   ThreadPoolQueue tpq(&tf);
+   DroppableRunnable expired, live, noDeadline;
+
+   expired.setDeadline(1);   // long gone
+   live.setTimeout(60000000);
+   require(expired.isExpired(Runnable::currentTimeMicros()), "a deadline in the past should be expired");
+   requireFalse(noDeadline.isExpired(Runnable::currentTimeMicros()), "no deadline should never expire");
+
+   tpq.addRequest(&expired);
+   tpq.addRequest(&live);
+   tpq.addRequest(&noDeadline);
+
+   const std::vector<Runnable*> expected = { &live, &noDeadline };
+   require(expected == takeAll(tpq), "expired requests should be skipped at take time");
+   require(1 == expired.m_numberDropped, "expired request should be notified that it was dropped");
+   require(0 == live.m_numberDropped, "live request should not be dropped");
+   require(1 == tpq.getNumberExpiredRequests(), "expired requests should be counted");
+   require(0 == tpq.getNumberShedRequests(), "expired requests are not shed");
+
+   // a waiting batch taker keeps the live requests and drops the rest
+   tpq.addRequest(&expired);
+   tpq.addRequest(&live);
+   TakeRequestContext ctx;
+   ctx.waitIfNone = true;
+   tpq.takeRequests(ctx, 4);
+   require(1 == ctx.runnables.size() && &live == ctx.runnables[0], "takeRequests should only return live requests");
+   require(2 == expired.m_numberDropped, "takeRequests should drop expired requests");
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testLoadSheddingStandingQueue) {
+   ThreadPoolQueue tpq(&tf);
+   require(0 == tpq.getLoadSheddingTarget(), "load shedding should be off by default");
+
+   // 1ms target, 5ms interval
+   require(tpq.setLoadShedding(1000, 5000), "mutex queue should support load shedding");
+   require(1000 == tpq.getLoadSheddingTarget(), "getLoadSheddingTarget should reflect what was set");
+
+   DroppableRunnable a, b, c;
+   tpq.addRequest(&a);
+   tpq.addRequest(&b);
+
+   // the queue hasn't been empty for longer than the interval, and both
+   // requests have waited longer than the target
+   Thread::sleep(20);
+   require(takeAll(tpq).empty(), "requests behind a standing backlog should be shed");
+   require(1 == a.m_numberDropped && 1 == b.m_numberDropped, "shed requests should be notified that they were dropped");
+   require(2 == tpq.getNumberShedRequests(), "shed requests should be counted");
+
+   // the queue drained, so a fresh request goes through
+   tpq.addRequest(&c);
+   const std::vector<Runnable*> expected = { &c };
+   require(expected == takeAll(tpq), "a request after the backlog drained should be taken");
+}
+
+POIVRE_TEST_CASE(TestThreadPoolQueue, testLoadSheddingAbsorbsBurst) {
+   ThreadPoolQueue tpq(&tf);
+   DroppableRunnable a, b;
+
+   // without load shedding, waiting doesn't matter
+   tpq.addRequest(&a);
+   Thread::sleep(10);
+   require(1 == takeAll(tpq).size(), "requests should not be shed with load shedding off");
+
+   // 1ms target, but a 10s interval: a burst gets the whole interval
+   tpq.setLoadShedding(1000, 10000000);
+   tpq.addRequest(&a);
+   tpq.addRequest(&b);
+   Thread::sleep(10);
+   require(2 == takeAll(tpq).size(), "a queue that drained recently should not shed");
+   require(0 == tpq.getNumberShedRequests(), "nothing should have been shed");
+}
+
+//******************************************************************************
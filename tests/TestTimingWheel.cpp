@@ -0,0 +1,147 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <vector>
+
+#include "TestTimingWheel.h"
+#include "TimingWheel.h"
+
+using namespace chaudiere;
+
+//******************************************************************************
+
+TestTimingWheel::TestTimingWheel() :
+   poivre::TestSuite("TestTimingWheel") {
+}
+
+//******************************************************************************
+
+void TestTimingWheel::runTests() {
+   testSchedule();
+   testExpiry();
+   testReschedule();
+   testCancel();
+   testMultipleRounds();
+   testZeroTicks();
+}
+
+//******************************************************************************
+
+void TestTimingWheel::testSchedule() {
+   TEST_CASE("testSchedule");
+
+   TimingWheel wheel(8);
+   require(wheel.size() == 0, "new wheel should be empty");
+   requireFalse(wheel.isScheduled(3), "id should not be scheduled initially");
+
+   wheel.schedule(3, 2);
+   wheel.schedule(100, 5);
+   require(wheel.isScheduled(3), "scheduled id should be reported");
+   require(wheel.isScheduled(100), "id beyond the initial node count should be scheduled");
+   require(wheel.size() == 2, "size should count scheduled timers");
+   requireFalse(wheel.isScheduled(-1), "negative id should never be scheduled");
+}
+
+//******************************************************************************
+
+void TestTimingWheel::testExpiry() {
+   TEST_CASE("testExpiry");
+
+   TimingWheel wheel(8);
+   std::vector<int> expired;
+
+   wheel.schedule(1, 1);
+   wheel.schedule(2, 3);
+   wheel.schedule(3, 3);
+
+   wheel.advance(expired);
+   require(expired.size() == 1 && expired[0] == 1, "timer should expire after its ticks");
+   require(wheel.getCurrentTick() == 1, "advance should move the current tick");
+
+   expired.clear();
+   wheel.advance(expired);
+   require(expired.empty(), "nothing should expire before it's due");
+
+   expired.clear();
+   wheel.advance(expired);
+   require(expired.size() == 2, "timers due on the same tick should expire together");
+   require(wheel.size() == 0, "expired timers should be removed from the wheel");
+   requireFalse(wheel.isScheduled(2), "expired id should no longer be scheduled");
+}
+
+//******************************************************************************
+
+void TestTimingWheel::testReschedule() {
+   TEST_CASE("testReschedule");
+
+   TimingWheel wheel(8);
+   std::vector<int> expired;
+
+   wheel.schedule(4, 2);
+   wheel.schedule(4, 4);
+   require(wheel.size() == 1, "rescheduling should replace the existing timer");
+
+   wheel.advance(expired);
+   wheel.advance(expired);
+   wheel.advance(expired);
+   require(expired.empty(), "rescheduled timer should not expire at its old time");
+
+   wheel.advance(expired);
+   require(expired.size() == 1 && expired[0] == 4, "rescheduled timer should expire at its new time");
+}
+
+//******************************************************************************
+
+void TestTimingWheel::testCancel() {
+   TEST_CASE("testCancel");
+
+   TimingWheel wheel(4);
+   std::vector<int> expired;
+
+   wheel.schedule(5, 1);
+   wheel.schedule(6, 1);
+   wheel.schedule(7, 1);
+   wheel.cancel(6);
+   wheel.cancel(42);  // never scheduled
+
+   require(wheel.size() == 2, "cancel should remove the timer");
+   requireFalse(wheel.isScheduled(6), "cancelled id should not be scheduled");
+
+   wheel.advance(expired);
+   require(expired.size() == 2, "cancelled timer should not expire");
+   require(expired[0] != 6 && expired[1] != 6, "cancelled id should not be reported");
+}
+
+//******************************************************************************
+
+void TestTimingWheel::testMultipleRounds() {
+   TEST_CASE("testMultipleRounds");
+
+   TimingWheel wheel(4);
+   std::vector<int> expired;
+
+   wheel.schedule(9, 10);
+
+   for (int i = 0; i < 9; ++i) {
+      wheel.advance(expired);
+   }
+   require(expired.empty(), "timer beyond one revolution should not expire early");
+
+   wheel.advance(expired);
+   require(expired.size() == 1 && expired[0] == 9, "timer should expire after multiple revolutions");
+}
+
+//******************************************************************************
+
+void TestTimingWheel::testZeroTicks() {
+   TEST_CASE("testZeroTicks");
+
+   TimingWheel wheel(4);
+   std::vector<int> expired;
+
+   wheel.schedule(2, 0);
+   wheel.advance(expired);
+   require(expired.size() == 1 && expired[0] == 2, "zero ticks should expire on the next tick");
+}
+
+//******************************************************************************
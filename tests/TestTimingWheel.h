@@ -0,0 +1,31 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTTIMINGWHEEL_H
+#define CHAUDIERE_TESTTIMINGWHEEL_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestTimingWheel : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testSchedule();
+   void testExpiry();
+   void testReschedule();
+   void testCancel();
+   void testMultipleRounds();
+   void testZeroTicks();
+
+public:
+   TestTimingWheel();
+
+};
+
+}
+
+#endif
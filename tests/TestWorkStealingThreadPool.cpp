@@ -0,0 +1,224 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "TestWorkStealingThreadPool.h"
+#include "WorkStealingThreadPool.h"
+#include "ThreadPool.h"
+#include "PthreadsThreadingFactory.h"
+#include "Runnable.h"
+#include "Thread.h"
+
+using namespace chaudiere;
+
+namespace {
+
+class CountingRunnable : public chaudiere::Runnable {
+public:
+   explicit CountingRunnable(std::atomic<int>& counter) :
+      m_counter(counter) {
+   }
+
+   void run() override {
+      m_counter++;
+   }
+
+private:
+   std::atomic<int>& m_counter;
+};
+
+// Adds its children to the pool from the worker that runs it, which puts
+// them on that worker's own deque (where idle workers can steal them)
+class SpawningRunnable : public chaudiere::Runnable {
+public:
+   SpawningRunnable(WorkStealingThreadPool& pool,
+                    std::atomic<int>& counter,
+                    int numberChildren) :
+      m_pool(pool),
+      m_counter(counter),
+      m_numberChildren(numberChildren) {
+   }
+
+   void run() override {
+      for (int i = 0; i < m_numberChildren; ++i) {
+         CountingRunnable* child = new CountingRunnable(m_counter);
+         child->setAutoDelete();
+         m_pool.addRequest(child);
+      }
+   }
+
+private:
+   WorkStealingThreadPool& m_pool;
+   std::atomic<int>& m_counter;
+   int m_numberChildren;
+};
+
+bool waitForCount(const std::atomic<int>& counter, int expected) {
+   for (int i = 0; i < 5000 && counter < expected; ++i) {
+      Thread::sleep(1);
+   }
+   return counter == expected;
+}
+
+}
+
+//******************************************************************************
+
+TestWorkStealingThreadPool::TestWorkStealingThreadPool() :
+   poivre::TestSuite("TestWorkStealingThreadPool") {
+}
+
+//******************************************************************************
+
+void TestWorkStealingThreadPool::runTests() {
+   testConstructor();
+   testAddRequest();
+   testAddRequests();
+   testLocalSubmission();
+   testStopRunsPendingRequests();
+   testThreadingFactory();
+}
+
+//******************************************************************************
+
+void TestWorkStealingThreadPool::testConstructor() {
+   TEST_CASE("testConstructor");
+
+   PthreadsThreadingFactory threadingFactory;
+
+   {
+      WorkStealingThreadPool pool(&threadingFactory, 4, "test_pool");
+      require(pool.isRunning(), "pool should be started by its constructor");
+      require(4 == pool.getNumberWorkers(), "number of workers should match the constructor argument");
+      requireStringEquals("test_pool", pool.getName(), "name should match the constructor argument");
+   }
+
+   {
+      WorkStealingThreadPool pool(&threadingFactory, 0, "empty_pool");
+      requireFalse(pool.isRunning(), "pool with no workers should not run");
+      std::atomic<int> counter(0);
+      CountingRunnable runnable(counter);
+      requireFalse(pool.addRequest(&runnable), "pool that isn't running should reject requests");
+   }
+}
+
+//******************************************************************************
+
+void TestWorkStealingThreadPool::testAddRequest() {
+   TEST_CASE("testAddRequest");
+
+   PthreadsThreadingFactory threadingFactory;
+   WorkStealingThreadPool pool(&threadingFactory, 4, "test_pool");
+
+   const int numberRequests = 1000;
+   std::atomic<int> counter(0);
+
+   for (int i = 0; i < numberRequests; ++i) {
+      CountingRunnable* runnable = new CountingRunnable(counter);
+      runnable->setAutoDelete();
+      require(pool.addRequest(runnable), "running pool should accept requests");
+   }
+
+   require(waitForCount(counter, numberRequests), "every request should be run exactly once");
+   require(numberRequests == (int) pool.getNumberInjectedRequests(), "requests from outside the pool should go to the injection queues");
+   requireFalse(pool.addRequest(nullptr), "nullptr request should be rejected");
+}
+
+//******************************************************************************
+
+void TestWorkStealingThreadPool::testAddRequests() {
+   TEST_CASE("testAddRequests");
+
+   PthreadsThreadingFactory threadingFactory;
+   WorkStealingThreadPool pool(&threadingFactory, 4, "test_pool");
+
+   const int numberRequests = 100;
+   std::atomic<int> counter(0);
+   std::vector<Runnable*> runnables;
+
+   for (int i = 0; i < numberRequests; ++i) {
+      CountingRunnable* runnable = new CountingRunnable(counter);
+      runnable->setAutoDelete();
+      runnables.push_back(runnable);
+   }
+
+   require(numberRequests == (int) pool.addRequests(runnables), "running pool should accept the whole batch");
+   require(waitForCount(counter, numberRequests), "every request in the batch should be run exactly once");
+   require(numberRequests == (int) pool.getNumberInjectedRequests(), "a batch from outside the pool should go to an injection queue");
+
+   Runnable* withNullptr[] = { nullptr };
+   require(0 == pool.addRequests(withNullptr), "a batch should stop at a nullptr request");
+}
+
+//******************************************************************************
+
+void TestWorkStealingThreadPool::testLocalSubmission() {
+   TEST_CASE("testLocalSubmission");
+
+   PthreadsThreadingFactory threadingFactory;
+   WorkStealingThreadPool pool(&threadingFactory, 4, "test_pool");
+
+   const int numberChildren = 2000;
+   std::atomic<int> counter(0);
+
+   SpawningRunnable* spawner = new SpawningRunnable(pool, counter, numberChildren);
+   spawner->setAutoDelete();
+   require(pool.addRequest(spawner), "running pool should accept requests");
+
+   require(waitForCount(counter, numberChildren), "requests added by a worker should all be run");
+   require(1 == pool.getNumberInjectedRequests(), "requests added by a worker should go to its own deque");
+}
+
+//******************************************************************************
+
+void TestWorkStealingThreadPool::testStopRunsPendingRequests() {
+   TEST_CASE("testStopRunsPendingRequests");
+
+   PthreadsThreadingFactory threadingFactory;
+   std::atomic<int> counter(0);
+
+   {
+      WorkStealingThreadPool pool(&threadingFactory, 2, "test_pool");
+      for (int i = 0; i < 500; ++i) {
+         CountingRunnable* runnable = new CountingRunnable(counter);
+         runnable->setAutoDelete();
+         pool.addRequest(runnable);
+      }
+
+      require(pool.stop(), "stop should succeed on a running pool");
+      requireFalse(pool.isRunning(), "pool should not be running after stop");
+
+      CountingRunnable runnable(counter);
+      requireFalse(pool.addRequest(&runnable), "stopped pool should reject requests");
+   }
+
+   require(500 == counter, "requests added before stop should all have been run");
+}
+
+//******************************************************************************
+
+void TestWorkStealingThreadPool::testThreadingFactory() {
+   TEST_CASE("testThreadingFactory");
+
+   PthreadsThreadingFactory threadingFactory;
+   require(ThreadPoolType::Shared == threadingFactory.getThreadPoolType(), "threading factory should create shared-queue pools by default");
+
+   {
+      std::unique_ptr<ThreadPoolDispatcher> dispatcher(
+         threadingFactory.createThreadPoolDispatcher(2, "shared"));
+      require(nullptr != dynamic_cast<ThreadPool*>(dispatcher.get()), "default pool type should be ThreadPool");
+   }
+
+   threadingFactory.setThreadPoolType(ThreadPoolType::WorkStealing);
+
+   {
+      std::unique_ptr<ThreadPoolDispatcher> dispatcher(
+         threadingFactory.createThreadPoolDispatcher(2, "stealing"));
+      require(nullptr != dynamic_cast<WorkStealingThreadPool*>(dispatcher.get()), "work stealing pool type should create a WorkStealingThreadPool");
+   }
+}
+
+//******************************************************************************
@@ -0,0 +1,31 @@
+// Copyright Paul Dardeau, SwampBits LLC 2014
+// BSD License
+
+#ifndef CHAUDIERE_TESTWORKSTEALINGTHREADPOOL_H
+#define CHAUDIERE_TESTWORKSTEALINGTHREADPOOL_H
+
+#include "TestSuite.h"
+
+namespace chaudiere
+{
+
+class TestWorkStealingThreadPool : public poivre::TestSuite
+{
+protected:
+   void runTests();
+
+   void testConstructor();
+   void testAddRequest();
+   void testAddRequests();
+   void testLocalSubmission();
+   void testStopRunsPendingRequests();
+   void testThreadingFactory();
+
+public:
+   TestWorkStealingThreadPool();
+
+};
+
+}
+
+#endif
@@ -2,24 +2,37 @@
 // BSD License
 
 #include "TestAutoPointer.h"
+#include "TestBasicThreadPoolQueue.h"
 #include "TestByteBuffer.h"
 #include "TestCharBuffer.h"
+#include "TestChaseLevDeque.h"
+#include "TestConnectionStateTable.h"
 #include "TestDateTime.h"
 #include "TestDynamicLibrary.h"
 #include "TestEpollServer.h"
+#include "TestEventLoopStats.h"
 #include "TestFileLogger.h"
+#include "TestFutexConditionVariable.h"
+#include "TestFutexMutex.h"
+#include "TestHistogram.h"
 #include "TestIniReader.h"
 #include "TestInvalidKeyException.h"
+#include "TestIoUringServer.h"
 #include "TestKeyValuePairs.h"
 #include "TestKqueueServer.h"
+#include "TestLinuxThreadingFactory.h"
+#include "TestLockProfiler.h"
 #include "TestMutexLock.h"
 #include "TestNumberFormatException.h"
+#include "TestObjectPool.h"
 #include "TestOptionParser.h"
 #include "TestOSUtils.h"
 #include "TestPthreadsConditionVariable.h"
 #include "TestPthreadsMutex.h"
 #include "TestPthreadsThreadingFactory.h"
+#include "TestReadWriteLock.h"
 #include "TestRequestHandler.h"
+#include "TestRingThreadPoolQueue.h"
 #include "TestServerSocket.h"
 #include "TestServiceInfo.h"
 #include "TestSocket.h"
@@ -34,12 +47,18 @@
 #include "TestStringTokenizer.h"
 #include "TestSystemInfo.h"
 #include "TestSystemStats.h"
+#include "TestTask.h"
 #include "TestThread.h"
+#include "TestThreadAttributes.h"
 #include "TestThreadInfo.h"
+#include "TestThreadPoolAutoScaler.h"
+#include "TestThreadPoolDispatch.h"
 #include "TestThreadPoolQueue.h"
 #include "TestThreadPoolWorker.h"
 #include "TestThreadingFactory.h"
+#include "TestTimingWheel.h"
 #include "TestUtils.h"
+#include "TestWorkStealingThreadPool.h"
 
 #include "TestRegistry.h"
 
@@ -54,23 +73,36 @@ void run_test(poivre::TestSuite* test_suite) {
 
 void run_tests() {
    run_test(new TestAutoPointer);
+   run_test(new TestBasicThreadPoolQueue);
    run_test(new TestByteBuffer);
    run_test(new TestCharBuffer);
+   run_test(new TestChaseLevDeque);
+   run_test(new TestConnectionStateTable);
    run_test(new TestDateTime);
    run_test(new TestDynamicLibrary);
    run_test(new TestEpollServer);
+   run_test(new TestEventLoopStats);
    run_test(new TestFileLogger);
+   run_test(new TestFutexConditionVariable);
+   run_test(new TestFutexMutex);
+   run_test(new TestHistogram);
    run_test(new TestIniReader);
    run_test(new TestInvalidKeyException);
+   run_test(new TestIoUringServer);
    run_test(new TestKeyValuePairs);
    run_test(new TestKqueueServer);
+   run_test(new TestLinuxThreadingFactory);
+   run_test(new TestLockProfiler);
    run_test(new TestMutexLock);
    run_test(new TestNumberFormatException);
+   run_test(new TestObjectPool);
    run_test(new TestOptionParser);
    run_test(new TestOSUtils);
    run_test(new TestPthreadsConditionVariable);
    run_test(new TestPthreadsMutex);
    run_test(new TestPthreadsThreadingFactory);
+   run_test(new TestReadWriteLock);
+   run_test(new TestRingThreadPoolQueue);
    run_test(new TestStdMutex);
    run_test(new TestRequestHandler);
    run_test(new TestServerSocket);
@@ -86,12 +118,18 @@ void run_tests() {
    run_test(new TestStrUtils);
    run_test(new TestSystemInfo);
    run_test(new TestSystemStats);
+   run_test(new TestTask);
    run_test(new TestThread);
+   run_test(new TestThreadAttributes);
    run_test(new TestThreadInfo);
+   run_test(new TestThreadPoolAutoScaler);
+   run_test(new TestThreadPoolDispatch);
    run_test(new TestThreadPoolQueue);
    run_test(new TestThreadPoolWorker);
    run_test(new TestThreadingFactory);
+   run_test(new TestTimingWheel);
    run_test(new TestUtils);
+   run_test(new TestWorkStealingThreadPool);
 }
 
 int main(int argc, char* argv[]) {